@@ -0,0 +1,27 @@
+set(BENCHMARK_DIR "${PROJECT_SOURCE_DIR}/Benchmarks")
+set(BENCHMARK_TARGET_NAME "${PROJECT_NAME}Benchmarks")
+
+add_executable(${BENCHMARK_TARGET_NAME} "")
+target_link_libraries(${BENCHMARK_TARGET_NAME} PRIVATE ${CORE_LIBRARY_NAME})
+
+target_sources(${BENCHMARK_TARGET_NAME} PRIVATE
+   "${BENCHMARK_DIR}/Benchmark.cpp"
+   "${BENCHMARK_DIR}/Benchmark.h"
+   "${BENCHMARK_DIR}/BenchmarkMain.cpp"
+   "${BENCHMARK_DIR}/ContainerBenchmarks.cpp"
+   "${BENCHMARK_DIR}/CoreBenchmarks.cpp"
+   "${BENCHMARK_DIR}/ImageBenchmarks.cpp"
+   "${BENCHMARK_DIR}/MathBenchmarks.cpp"
+   "${BENCHMARK_DIR}/RendererBenchmarks.cpp"
+   "${BENCHMARK_DIR}/SceneBenchmarks.cpp"
+)
+
+get_target_property(BENCHMARK_SOURCE_FILES ${BENCHMARK_TARGET_NAME} SOURCES)
+source_group(TREE "${BENCHMARK_DIR}" PREFIX Benchmarks FILES ${BENCHMARK_SOURCE_FILES})
+
+# Replaces the global allocation functions, so it is compiled into each executable that counts allocations instead of into the core library (added after grouping the
+# sources above, since it lives outside of their directory)
+target_sources(${BENCHMARK_TARGET_NAME} PRIVATE
+   "${SRC_DIR}/Core/Memory/AllocationCounter.cpp"
+   "${SRC_DIR}/Core/Memory/AllocationCounter.h"
+)
@@ -0,0 +1,161 @@
+#include "Benchmark.h"
+
+#include "Core/Json.h"
+#include "Core/Memory/AllocationCounter.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <thread>
+
+namespace
+{
+   const volatile void* volatile escapeSink = nullptr;
+
+   const char* getPlatformName()
+   {
+#if FORGE_PLATFORM_WINDOWS
+      return "Windows";
+#elif FORGE_PLATFORM_MACOS
+      return "macOS";
+#elif FORGE_PLATFORM_LINUX
+      return "Linux";
+#else
+      return "Unknown";
+#endif
+   }
+
+   const char* getCompilerName()
+   {
+#if defined(__clang__)
+      return "Clang " __clang_version__;
+#elif defined(__GNUC__)
+      return "GCC " __VERSION__;
+#elif defined(_MSC_VER)
+      return "MSVC";
+#else
+      return "Unknown";
+#endif
+   }
+}
+
+namespace Benchmark
+{
+   void escape(const volatile void* pointer)
+   {
+      escapeSink = pointer;
+   }
+
+   uint64_t getAllocationCount()
+   {
+      return AllocationCounter::getCount();
+   }
+
+   void State::setCounter(std::string name, double value)
+   {
+      auto location = std::find_if(result.counters.begin(), result.counters.end(), [&name](const std::pair<std::string, double>& counter) { return counter.first == name; });
+      if (location == result.counters.end())
+      {
+         result.counters.emplace_back(std::move(name), value);
+      }
+      else
+      {
+         location->second = value;
+      }
+   }
+
+   void Registry::add(std::string name, Function function)
+   {
+      benchmarks.emplace_back(std::move(name), std::move(function));
+   }
+
+   void Registry::list(std::ostream& stream) const
+   {
+      for (const std::pair<std::string, Function>& benchmark : benchmarks)
+      {
+         stream << benchmark.first << "\n";
+      }
+   }
+
+   std::vector<Result> Registry::run(std::string_view filter, uint32_t numSamples, uint64_t datasetSeed, std::ostream& progressStream) const
+   {
+      std::vector<Result> results;
+
+      for (const std::pair<std::string, Function>& benchmark : benchmarks)
+      {
+         if (!filter.empty() && benchmark.first.find(filter) == std::string::npos)
+         {
+            continue;
+         }
+
+         progressStream << benchmark.first << "... " << std::flush;
+
+         Result result;
+         result.name = benchmark.first;
+
+         State state(numSamples, datasetSeed, result);
+         benchmark.second(state);
+
+         if (!result.sampleMs.empty())
+         {
+            std::vector<double> sorted = result.sampleMs;
+            std::sort(sorted.begin(), sorted.end());
+            progressStream << std::fixed << std::setprecision(3) << sorted[sorted.size() / 2] << " ms\n";
+         }
+         else
+         {
+            progressStream << "no samples\n";
+         }
+
+         results.push_back(std::move(result));
+      }
+
+      return results;
+   }
+
+   void writeJson(std::ostream& stream, const std::vector<Result>& results, uint32_t numSamples, uint64_t datasetSeed)
+   {
+      stream << std::setprecision(6) << std::fixed;
+      stream << "{\n";
+      stream << "  \"project\": \"" << FORGE_PROJECT_NAME << "\",\n";
+      stream << "  \"version\": \"" << FORGE_VERSION_MAJOR << "." << FORGE_VERSION_MINOR << "." << FORGE_VERSION_PATCH << "\",\n";
+      stream << "  \"platform\": \"" << getPlatformName() << "\",\n";
+      stream << "  \"compiler\": \"" << Json::escape(getCompilerName()) << "\",\n";
+      stream << "  \"debug\": " << (FORGE_DEBUG ? "true" : "false") << ",\n";
+      stream << "  \"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n";
+      stream << "  \"samples\": " << numSamples << ",\n";
+      stream << "  \"seed\": " << datasetSeed << ",\n";
+      stream << "  \"benchmarks\": [";
+
+      for (std::size_t i = 0; i < results.size(); ++i)
+      {
+         const Result& result = results[i];
+
+         std::vector<double> sorted = result.sampleMs;
+         std::sort(sorted.begin(), sorted.end());
+
+         double minMs = sorted.empty() ? 0.0 : sorted.front();
+         double maxMs = sorted.empty() ? 0.0 : sorted.back();
+         double medianMs = sorted.empty() ? 0.0 : sorted[sorted.size() / 2];
+         double meanMs = sorted.empty() ? 0.0 : std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+         double itemsPerSecond = medianMs > 0.0 ? result.itemsPerRun / (medianMs / 1000.0) : 0.0;
+
+         stream << (i == 0 ? "" : ",") << "\n    {\n";
+         stream << "      \"name\": \"" << Json::escape(result.name) << "\",\n";
+         stream << "      \"itemsPerRun\": " << result.itemsPerRun << ",\n";
+         stream << "      \"minMs\": " << minMs << ",\n";
+         stream << "      \"medianMs\": " << medianMs << ",\n";
+         stream << "      \"meanMs\": " << meanMs << ",\n";
+         stream << "      \"maxMs\": " << maxMs << ",\n";
+         stream << "      \"itemsPerSecond\": " << itemsPerSecond << ",\n";
+         stream << "      \"counters\": {";
+         for (std::size_t j = 0; j < result.counters.size(); ++j)
+         {
+            stream << (j == 0 ? "" : ",") << "\n        \"" << Json::escape(result.counters[j].first) << "\": " << result.counters[j].second;
+         }
+         stream << (result.counters.empty() ? "}" : "\n      }") << "\n    }";
+      }
+
+      stream << (results.empty() ? "]" : "\n  ]") << "\n}\n";
+   }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Benchmark
+{
+   // SplitMix64, which (unlike the std distributions) produces the same sequence on every platform and standard library, keeping datasets identical across machines
+   class Random
+   {
+   public:
+      Random(uint64_t seed)
+         : state(seed)
+      {
+      }
+
+      uint64_t next()
+      {
+         uint64_t value = (state += 0x9e3779b97f4a7c15ull);
+         value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+         value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+         return value ^ (value >> 31);
+      }
+
+      // Uniform in [0, count)
+      uint32_t nextIndex(uint32_t count)
+      {
+         return static_cast<uint32_t>(((next() >> 32) * count) >> 32);
+      }
+
+      // Uniform in [0, 1)
+      float nextFloat()
+      {
+         return static_cast<float>(next() >> 40) * (1.0f / static_cast<float>(1 << 24));
+      }
+
+      float nextFloat(float min, float max)
+      {
+         return min + (max - min) * nextFloat();
+      }
+
+   private:
+      uint64_t state = 0;
+   };
+
+   void escape(const volatile void* pointer);
+
+   // Prevents the compiler from optimizing away the computation of a value that is otherwise unused
+   template<typename T>
+   inline void doNotOptimize(const T& value)
+   {
+#if defined(__GNUC__) || defined(__clang__)
+      asm volatile("" : : "r,m"(value) : "memory");
+#else
+      escape(&value);
+#endif
+   }
+
+   // Number of global operator new calls made so far (by any thread)
+   uint64_t getAllocationCount();
+
+   struct Result
+   {
+      std::string name;
+      uint64_t itemsPerRun = 0;
+      std::vector<double> sampleMs;
+      std::vector<std::pair<std::string, double>> counters;
+   };
+
+   class State
+   {
+   public:
+      State(uint32_t numSamples, uint64_t datasetSeed, Result& benchmarkResult)
+         : samples(numSamples)
+         , seed(datasetSeed)
+         , result(benchmarkResult)
+      {
+      }
+
+      uint64_t getSeed() const
+      {
+         return seed;
+      }
+
+      // Runs the function once to warm up, then times it once per sample. Setup runs before every run, and is not timed.
+      template<typename Setup, typename Function>
+      void measure(uint64_t itemsPerRun, Setup&& setup, Function&& function)
+      {
+         result.itemsPerRun = itemsPerRun;
+         result.sampleMs.clear();
+         result.sampleMs.reserve(samples);
+
+         for (uint32_t i = 0; i <= samples; ++i)
+         {
+            setup();
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            function();
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+            if (i > 0)
+            {
+               result.sampleMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+         }
+      }
+
+      template<typename Function>
+      void measure(uint64_t itemsPerRun, Function&& function)
+      {
+         measure(itemsPerRun, [] {}, std::forward<Function>(function));
+      }
+
+      // Extra values (hit rates, allocation counts, and so on) to include in the results
+      void setCounter(std::string name, double value);
+
+   private:
+      uint32_t samples = 0;
+      uint64_t seed = 0;
+      Result& result;
+   };
+
+   using Function = std::function<void(State& state)>;
+
+   class Registry
+   {
+   public:
+      // Names are hierarchical ("Group/Benchmark"), which is what filters match against
+      void add(std::string name, Function function);
+
+      void list(std::ostream& stream) const;
+      std::vector<Result> run(std::string_view filter, uint32_t numSamples, uint64_t datasetSeed, std::ostream& progressStream) const;
+
+   private:
+      std::vector<std::pair<std::string, Function>> benchmarks;
+   };
+
+   void writeJson(std::ostream& stream, const std::vector<Result>& results, uint32_t numSamples, uint64_t datasetSeed);
+}
+
+void registerContainerBenchmarks(Benchmark::Registry& registry);
+void registerCoreBenchmarks(Benchmark::Registry& registry);
+void registerImageBenchmarks(Benchmark::Registry& registry);
+void registerMathBenchmarks(Benchmark::Registry& registry);
+void registerRendererBenchmarks(Benchmark::Registry& registry);
+void registerSceneBenchmarks(Benchmark::Registry& registry);
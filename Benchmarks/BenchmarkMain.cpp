@@ -0,0 +1,131 @@
+#include "Benchmark.h"
+
+#include "Core/Jobs/JobSystem.h"
+
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace
+{
+   const uint32_t kDefaultNumSamples = 10;
+   const uint64_t kDefaultDatasetSeed = 0x466f726765ull; // "Forge"
+
+   template<typename T>
+   std::optional<T> parseNumber(std::string_view text)
+   {
+      T value = 0;
+      std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+      if (result.ec != std::errc() || result.ptr != text.data() + text.size())
+      {
+         return std::nullopt;
+      }
+
+      return value;
+   }
+
+   void printUsage(const char* executableName)
+   {
+      std::cerr << "Usage: " << executableName << " [--filter <substring>] [--samples <count>] [--seed <value>] [--workers <count>] [--out <path>] [--list]\n";
+      std::cerr << "Results are written as JSON to the output path (or stdout), progress is written to stderr\n";
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   std::string filter;
+   std::string outputPath;
+   uint32_t numSamples = kDefaultNumSamples;
+   uint64_t datasetSeed = kDefaultDatasetSeed;
+   uint32_t numWorkers = 0;
+   bool listOnly = false;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string_view argument = argv[i];
+      std::string_view value = i + 1 < argc ? argv[i + 1] : "";
+
+      bool valid = true;
+      if (argument == "--list")
+      {
+         listOnly = true;
+         continue;
+      }
+      else if (argument == "--filter")
+      {
+         filter = value;
+      }
+      else if (argument == "--out")
+      {
+         outputPath = value;
+      }
+      else if (argument == "--samples")
+      {
+         std::optional<uint32_t> parsedSamples = parseNumber<uint32_t>(value);
+         valid = parsedSamples && *parsedSamples > 0;
+         numSamples = parsedSamples.value_or(numSamples);
+      }
+      else if (argument == "--seed")
+      {
+         std::optional<uint64_t> parsedSeed = parseNumber<uint64_t>(value);
+         valid = parsedSeed.has_value();
+         datasetSeed = parsedSeed.value_or(datasetSeed);
+      }
+      else if (argument == "--workers")
+      {
+         std::optional<uint32_t> parsedWorkers = parseNumber<uint32_t>(value);
+         valid = parsedWorkers.has_value();
+         numWorkers = parsedWorkers.value_or(numWorkers);
+      }
+      else
+      {
+         valid = false;
+      }
+
+      if (!valid || i + 1 >= argc)
+      {
+         printUsage(argv[0]);
+         return 1;
+      }
+
+      ++i;
+   }
+
+   Benchmark::Registry registry;
+   registerContainerBenchmarks(registry);
+   registerCoreBenchmarks(registry);
+   registerImageBenchmarks(registry);
+   registerMathBenchmarks(registry);
+   registerRendererBenchmarks(registry);
+   registerSceneBenchmarks(registry);
+
+   if (listOnly)
+   {
+      registry.list(std::cout);
+      return 0;
+   }
+
+   JobSystem::initialize(numWorkers);
+   std::vector<Benchmark::Result> results = registry.run(filter, numSamples, datasetSeed, std::cerr);
+   JobSystem::terminate();
+
+   if (outputPath.empty())
+   {
+      Benchmark::writeJson(std::cout, results, numSamples, datasetSeed);
+   }
+   else
+   {
+      std::ofstream file(outputPath);
+      Benchmark::writeJson(file, results, numSamples, datasetSeed);
+      if (!file)
+      {
+         std::cerr << "Failed to write results to " << outputPath << "\n";
+         return 1;
+      }
+   }
+
+   return 0;
+}
@@ -0,0 +1,239 @@
+#include "Benchmark.h"
+
+#include "Core/Containers/GenerationalArray.h"
+#include "Core/Containers/ReflectedMap.h"
+#include "Core/Containers/StaticVector.h"
+#include "Core/Hash.h"
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+   struct Payload
+   {
+      uint64_t a = 0;
+      uint64_t b = 0;
+      float c = 0.0f;
+   };
+
+   // Mirrors the shape of the resource keys that ResourceContainer caches (canonical path + load options)
+   struct ResourceKey
+   {
+      std::string canonicalPath;
+      uint32_t options = 0;
+
+      std::size_t hash() const
+      {
+         return Hash::of(canonicalPath, options);
+      }
+
+      bool operator==(const ResourceKey& other) const = default;
+   };
+}
+
+USE_MEMBER_HASH_FUNCTION(ResourceKey);
+
+namespace
+{
+   using PayloadArray = GenerationalArray<Payload>;
+   using ResourceHandle = GenerationalArrayHandle<ResourceKey>;
+
+   std::vector<ResourceKey> createResourceKeys(uint32_t count, Benchmark::Random& random)
+   {
+      static const char* kDirectories[] = { "Meshes/Sponza/", "Meshes/Bistro/Exterior/", "Textures/Environment/", "Textures/Props/Metal/" };
+
+      std::vector<ResourceKey> keys;
+      keys.reserve(count);
+      for (uint32_t i = 0; i < count; ++i)
+      {
+         keys.push_back(ResourceKey{ std::string(kDirectories[random.nextIndex(4)]) + "Asset_" + std::to_string(i) + ".gltf", random.nextIndex(8) });
+      }
+
+      return keys;
+   }
+
+   // Adds a million values, then repeatedly removes and re-adds random subsets while looking values up through their handles
+   void generationalArrayChurn(Benchmark::State& state)
+   {
+      static const uint32_t kNumValues = 1'000'000;
+      static const uint32_t kNumRounds = 4;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<uint32_t> removalOrder(kNumValues);
+      std::iota(removalOrder.begin(), removalOrder.end(), 0);
+      for (uint32_t i = kNumValues - 1; i > 0; --i)
+      {
+         std::swap(removalOrder[i], removalOrder[random.nextIndex(i + 1)]);
+      }
+
+      PayloadArray array;
+      std::vector<PayloadArray::Handle> handles(kNumValues);
+      uint64_t sum = 0;
+
+      state.measure(static_cast<uint64_t>(kNumValues) * (kNumRounds * 3 + 1), [&]
+      {
+         array.removeAll();
+         for (uint32_t i = 0; i < kNumValues; ++i)
+         {
+            handles[i] = array.add(Payload{ i, i * 2ull, static_cast<float>(i) });
+         }
+
+         for (uint32_t round = 0; round < kNumRounds; ++round)
+         {
+            for (uint32_t i = round; i < kNumValues; i += 2)
+            {
+               array.remove(handles[removalOrder[i]]);
+            }
+
+            for (uint32_t i = 0; i < kNumValues; ++i)
+            {
+               if (const Payload* payload = array.get(handles[i]))
+               {
+                  sum += payload->a;
+               }
+            }
+
+            for (uint32_t i = round; i < kNumValues; i += 2)
+            {
+               handles[removalOrder[i]] = array.add(Payload{ i, i * 3ull, static_cast<float>(round) });
+            }
+         }
+
+         Benchmark::doNotOptimize(sum);
+      });
+
+      state.setCounter("finalSize", static_cast<double>(array.size()));
+   }
+
+   void generationalArrayIterate(Benchmark::State& state)
+   {
+      static const uint32_t kNumValues = 1'000'000;
+
+      PayloadArray array;
+      for (uint32_t i = 0; i < kNumValues; ++i)
+      {
+         array.add(Payload{ i, i * 2ull, static_cast<float>(i) });
+      }
+
+      state.measure(kNumValues, [&]
+      {
+         float sum = 0.0f;
+         array.forEach([&sum](PayloadArray::Handle handle, Payload& payload)
+         {
+            sum += payload.c;
+         });
+
+         Benchmark::doNotOptimize(sum);
+      });
+   }
+
+   void reflectedMapAdd(Benchmark::State& state)
+   {
+      static const uint32_t kNumResources = 100'000;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<ResourceKey> keys = createResourceKeys(kNumResources, random);
+
+      GenerationalArray<ResourceKey> resources;
+      std::vector<ResourceHandle> handles;
+      handles.reserve(kNumResources);
+      for (const ResourceKey& key : keys)
+      {
+         handles.push_back(resources.add(key));
+      }
+
+      ReflectedMap<ResourceKey, ResourceHandle> map;
+      state.measure(kNumResources, [&] { map.clear(); }, [&]
+      {
+         for (uint32_t i = 0; i < kNumResources; ++i)
+         {
+            map.add(keys[i], handles[i]);
+         }
+
+         Benchmark::doNotOptimize(map);
+      });
+   }
+
+   // Looks up every resource by key (findHandle), then every key by handle (findKey), in a shuffled order
+   void reflectedMapFind(Benchmark::State& state)
+   {
+      static const uint32_t kNumResources = 100'000;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<ResourceKey> keys = createResourceKeys(kNumResources, random);
+
+      GenerationalArray<ResourceKey> resources;
+      std::vector<ResourceHandle> handles;
+      handles.reserve(kNumResources);
+
+      ReflectedMap<ResourceKey, ResourceHandle> map;
+      for (const ResourceKey& key : keys)
+      {
+         handles.push_back(resources.add(key));
+         map.add(key, handles.back());
+      }
+
+      std::vector<uint32_t> lookupOrder(kNumResources);
+      std::iota(lookupOrder.begin(), lookupOrder.end(), 0);
+      for (uint32_t i = kNumResources - 1; i > 0; --i)
+      {
+         std::swap(lookupOrder[i], lookupOrder[random.nextIndex(i + 1)]);
+      }
+
+      uint32_t hits = 0;
+      state.measure(kNumResources * 2ull, [&]
+      {
+         hits = 0;
+         for (uint32_t index : lookupOrder)
+         {
+            hits += map.find(keys[index]) != nullptr;
+         }
+         for (uint32_t index : lookupOrder)
+         {
+            hits += map.find(handles[index]) != nullptr;
+         }
+
+         Benchmark::doNotOptimize(hits);
+      });
+
+      state.setCounter("hitRate", hits / (kNumResources * 2.0));
+   }
+
+   void staticVectorHash(Benchmark::State& state)
+   {
+      static const uint32_t kNumVectors = 100'000;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<StaticVector<uint64_t, 8>> vectors(kNumVectors);
+      for (StaticVector<uint64_t, 8>& vector : vectors)
+      {
+         uint32_t size = 1 + random.nextIndex(8);
+         for (uint32_t i = 0; i < size; ++i)
+         {
+            vector.push(random.next());
+         }
+      }
+
+      state.measure(kNumVectors, [&]
+      {
+         std::size_t combined = 0;
+         for (const StaticVector<uint64_t, 8>& vector : vectors)
+         {
+            combined ^= vector.hash();
+         }
+
+         Benchmark::doNotOptimize(combined);
+      });
+   }
+}
+
+void registerContainerBenchmarks(Benchmark::Registry& registry)
+{
+   registry.add("Containers/GenerationalArray/Churn", generationalArrayChurn);
+   registry.add("Containers/GenerationalArray/Iterate", generationalArrayIterate);
+   registry.add("Containers/ReflectedMap/Add", reflectedMapAdd);
+   registry.add("Containers/ReflectedMap/Find", reflectedMapFind);
+   registry.add("Containers/StaticVector/Hash", staticVectorHash);
+}
@@ -0,0 +1,520 @@
+#include "Benchmark.h"
+
+#include "Core/Containers/FrameVector.h"
+#include "Core/Delegate.h"
+#include "Core/Hash.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Core/Log.h"
+#include "Core/Memory/FrameAllocator.h"
+#include "Core/Task.h"
+
+#include "Graphics/DescriptorSetLayoutHash.h"
+
+#include "Renderer/Passes/Depth/DepthPass.h"
+#include "Renderer/Passes/Forward/ForwardPass.h"
+#include "Renderer/Passes/Normal/NormalPass.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <future>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+   std::vector<PipelineDescription<DepthPass>> createDepthPipelineDescriptions()
+   {
+      std::vector<PipelineDescription<DepthPass>> descriptions;
+      for (uint32_t bits = 0; bits < 8; ++bits)
+      {
+         PipelineDescription<DepthPass> description;
+         description.masked = (bits & 1) != 0;
+         description.twoSided = (bits & 2) != 0;
+         description.cubemap = (bits & 4) != 0;
+         descriptions.push_back(description);
+      }
+
+      return descriptions;
+   }
+
+   std::vector<PipelineDescription<NormalPass>> createNormalPipelineDescriptions()
+   {
+      std::vector<PipelineDescription<NormalPass>> descriptions;
+      for (uint32_t bits = 0; bits < 8; ++bits)
+      {
+         PipelineDescription<NormalPass> description;
+         description.shaderConstants.withTextures = (bits & 1) != 0;
+         description.shaderConstants.masked = (bits & 2) != 0;
+         description.twoSided = (bits & 4) != 0;
+         descriptions.push_back(description);
+      }
+
+      return descriptions;
+   }
+
+   std::vector<PipelineDescription<ForwardPass>> createForwardPipelineDescriptions()
+   {
+      std::vector<PipelineDescription<ForwardPass>> descriptions;
+      for (uint32_t bits = 0; bits < 16; ++bits)
+      {
+         PipelineDescription<ForwardPass> description;
+         description.shaderConstants.withTextures = (bits & 1) != 0;
+         description.shaderConstants.withBlending = (bits & 2) != 0;
+         description.twoSided = (bits & 4) != 0;
+         description.skybox = (bits & 8) != 0;
+         descriptions.push_back(description);
+      }
+
+      return descriptions;
+   }
+
+   // Reports how many distinct keys share a full hash, and how often keys land in an occupied bucket of a power of two table (compared to an ideal random hash)
+   void setCollisionCounters(Benchmark::State& state, std::vector<std::size_t> hashes)
+   {
+      std::size_t numBuckets = std::bit_ceil(hashes.size() * 2);
+      std::vector<bool> occupied(numBuckets);
+      std::size_t bucketCollisions = 0;
+      for (std::size_t hash : hashes)
+      {
+         std::size_t bucket = hash & (numBuckets - 1);
+         bucketCollisions += occupied[bucket];
+         occupied[bucket] = true;
+      }
+
+      std::sort(hashes.begin(), hashes.end());
+      std::size_t fullCollisions = hashes.size() - (std::unique(hashes.begin(), hashes.end()) - hashes.begin());
+
+      double load = static_cast<double>(hashes.size()) / numBuckets;
+      double idealCollisionRate = 1.0 - (1.0 - std::exp(-load)) / load;
+
+      state.setCounter("fullHashCollisions", static_cast<double>(fullCollisions));
+      state.setCounter("bucketCollisionRate", static_cast<double>(bucketCollisions) / hashes.size());
+      state.setCounter("idealBucketCollisionRate", idealCollisionRate);
+   }
+
+   void hashBytes(Benchmark::State& state, std::size_t blockSize)
+   {
+      static const std::size_t kTotalBytes = 64 * 1024 * 1024;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<uint64_t> data(kTotalBytes / sizeof(uint64_t));
+      for (uint64_t& value : data)
+      {
+         value = random.next();
+      }
+
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+      state.measure(kTotalBytes / blockSize, [&]
+      {
+         uint64_t combined = 0;
+         for (std::size_t offset = 0; offset + blockSize <= kTotalBytes; offset += blockSize)
+         {
+            combined ^= Hash::bytes(bytes + offset, blockSize);
+         }
+
+         Benchmark::doNotOptimize(combined);
+      });
+
+      state.setCounter("blockSize", static_cast<double>(blockSize));
+   }
+
+   // Looks up the pipeline of every draw in a pass's pipeline map, as SceneRenderPass::getPipeline() does
+   template<typename PassType>
+   void hashPipelineDescriptions(Benchmark::State& state, const std::vector<PipelineDescription<PassType>>& descriptions)
+   {
+      static const uint32_t kNumDraws = 100'000;
+
+      std::unordered_map<PipelineDescription<PassType>, uint32_t> pipelineMap;
+      std::vector<std::size_t> hashes;
+      for (const PipelineDescription<PassType>& description : descriptions)
+      {
+         pipelineMap.emplace(description, static_cast<uint32_t>(pipelineMap.size()));
+         hashes.push_back(std::hash<PipelineDescription<PassType>>{}(description));
+      }
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<PipelineDescription<PassType>> draws(kNumDraws);
+      for (PipelineDescription<PassType>& draw : draws)
+      {
+         draw = descriptions[random.nextIndex(static_cast<uint32_t>(descriptions.size()))];
+      }
+
+      state.measure(kNumDraws, [&]
+      {
+         uint32_t sum = 0;
+         for (const PipelineDescription<PassType>& draw : draws)
+         {
+            sum += pipelineMap.find(draw)->second;
+         }
+
+         Benchmark::doNotOptimize(sum);
+      });
+
+      setCollisionCounters(state, hashes);
+   }
+
+   void hashDescriptorSetLayouts(Benchmark::State& state)
+   {
+      static const uint32_t kNumLayouts = 100'000;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<std::vector<vk::DescriptorSetLayoutBinding>> layoutBindings;
+      std::set<std::vector<uint32_t>> uniqueLayouts;
+      for (uint32_t i = 0; i < kNumLayouts; ++i)
+      {
+         std::vector<vk::DescriptorSetLayoutBinding> bindings;
+         std::vector<uint32_t> uniqueKey;
+
+         uint32_t numBindings = 1 + random.nextIndex(8);
+         for (uint32_t binding = 0; binding < numBindings; ++binding)
+         {
+            vk::DescriptorType descriptorType = static_cast<vk::DescriptorType>(random.nextIndex(11));
+            uint32_t descriptorCount = 1 + random.nextIndex(2) * random.nextIndex(16);
+            vk::ShaderStageFlags stageFlags = static_cast<vk::ShaderStageFlagBits>(1u << random.nextIndex(5));
+
+            bindings.push_back(vk::DescriptorSetLayoutBinding(binding, descriptorType, descriptorCount, stageFlags));
+            uniqueKey.insert(uniqueKey.end(), { binding, static_cast<uint32_t>(descriptorType), descriptorCount, static_cast<vk::ShaderStageFlags::MaskType>(stageFlags) });
+         }
+
+         // Only distinct layouts count towards collisions
+         if (uniqueLayouts.insert(std::move(uniqueKey)).second)
+         {
+            layoutBindings.push_back(std::move(bindings));
+         }
+      }
+
+      std::vector<vk::DescriptorSetLayoutCreateInfo> createInfos;
+      createInfos.reserve(layoutBindings.size());
+      for (const std::vector<vk::DescriptorSetLayoutBinding>& bindings : layoutBindings)
+      {
+         createInfos.push_back(vk::DescriptorSetLayoutCreateInfo().setBindings(bindings));
+      }
+
+      std::vector<std::size_t> hashes(createInfos.size());
+      state.measure(createInfos.size(), [&]
+      {
+         std::hash<vk::DescriptorSetLayoutCreateInfo> hasher;
+         for (std::size_t i = 0; i < createInfos.size(); ++i)
+         {
+            hashes[i] = hasher(createInfos[i]);
+         }
+
+         Benchmark::doNotOptimize(hashes.data());
+      });
+
+      setCollisionCounters(state, hashes);
+   }
+
+   // Binds listeners that capture as much state as a typical member function lambda does, and verifies that broadcasting never allocates
+   void delegateBroadcast(Benchmark::State& state)
+   {
+      static const uint32_t kNumListeners = 16;
+      static const uint32_t kNumBroadcasts = 100'000;
+
+      float total = 0.0f;
+      float scale = 0.5f;
+      uint32_t calls = 0;
+
+      uint64_t allocationsBeforeBind = Benchmark::getAllocationCount();
+      MulticastDelegate<void, float> delegate;
+      for (uint32_t i = 0; i < kNumListeners; ++i)
+      {
+         delegate.add([&total, &scale, &calls](float dt)
+         {
+            total += dt * scale;
+            ++calls;
+         });
+      }
+      uint64_t bindAllocations = Benchmark::getAllocationCount() - allocationsBeforeBind;
+
+      uint64_t broadcastAllocations = 0;
+      state.measure(static_cast<uint64_t>(kNumListeners) * kNumBroadcasts, [&]
+      {
+         uint64_t allocationsBefore = Benchmark::getAllocationCount();
+         for (uint32_t i = 0; i < kNumBroadcasts; ++i)
+         {
+            delegate.broadcast(1.0f / 60.0f);
+         }
+         broadcastAllocations += Benchmark::getAllocationCount() - allocationsBefore;
+
+         Benchmark::doNotOptimize(total);
+      });
+
+      state.setCounter("allocationsPerBind", static_cast<double>(bindAllocations) / kNumListeners);
+      state.setCounter("broadcastAllocations", static_cast<double>(broadcastAllocations));
+   }
+
+   void jobsScheduleWait(Benchmark::State& state)
+   {
+      static const uint32_t kNumJobs = 10'000;
+
+      std::vector<JobHandle> handles(kNumJobs);
+      std::atomic<uint64_t> sum = 0;
+
+      state.measure(kNumJobs, [&]
+      {
+         for (uint32_t i = 0; i < kNumJobs; ++i)
+         {
+            handles[i] = JobSystem::schedule([i, &sum]()
+            {
+               sum.fetch_add(i, std::memory_order_relaxed);
+            });
+         }
+
+         for (const JobHandle& handle : handles)
+         {
+            JobSystem::wait(handle);
+         }
+      });
+
+      state.setCounter("workers", JobSystem::getNumWorkers());
+   }
+
+   // Simulates a burst of resource loads that each produce a buffer, comparing the job system to a thread per load. Besides the time for the whole burst, reports how long
+   // each load took from being submitted to being finished, and how many new threads each burst started.
+   template<bool kUseAsync>
+   void jobsLoadBurst(Benchmark::State& state)
+   {
+      static const uint32_t kNumLoads = 256;
+      static const uint32_t kLoadSize = 64 * 1024;
+
+      // A new thread gets fresh thread local storage, even when the OS reuses the ID of a thread that has exited
+      static thread_local bool threadCounted = false;
+      std::atomic<uint64_t> numNewThreads = 0;
+
+      std::vector<std::chrono::steady_clock::time_point> submitTimes(kNumLoads);
+      std::vector<std::chrono::steady_clock::time_point> finishTimes(kNumLoads);
+      std::vector<double> latencyMs;
+
+      auto load = [&numNewThreads, &finishTimes](uint32_t index)
+      {
+         if (!threadCounted)
+         {
+            threadCounted = true;
+            numNewThreads.fetch_add(1, std::memory_order_relaxed);
+         }
+
+         Benchmark::Random random(index);
+         std::vector<uint32_t> data(kLoadSize / sizeof(uint32_t));
+         for (uint32_t& value : data)
+         {
+            value = static_cast<uint32_t>(random.next());
+         }
+
+         finishTimes[index] = std::chrono::steady_clock::now();
+         return data;
+      };
+
+      uint64_t checksum = 0;
+      uint32_t numRuns = 0;
+      state.measure(kNumLoads, [&]
+      {
+         if constexpr (kUseAsync)
+         {
+            std::vector<std::future<std::vector<uint32_t>>> futures;
+            futures.reserve(kNumLoads);
+            for (uint32_t i = 0; i < kNumLoads; ++i)
+            {
+               submitTimes[i] = std::chrono::steady_clock::now();
+               futures.push_back(std::async(std::launch::async, load, i));
+            }
+
+            for (std::future<std::vector<uint32_t>>& future : futures)
+            {
+               checksum += future.get().front();
+            }
+         }
+         else
+         {
+            std::vector<Task<std::vector<uint32_t>>> tasks;
+            tasks.reserve(kNumLoads);
+            for (uint32_t i = 0; i < kNumLoads; ++i)
+            {
+               submitTimes[i] = std::chrono::steady_clock::now();
+               tasks.emplace_back(load, i);
+            }
+
+            for (Task<std::vector<uint32_t>>& task : tasks)
+            {
+               JobSystem::wait(task.getJobHandle());
+               checksum += task.getResult().front();
+            }
+         }
+
+         // Every load has finished (and its finish time is visible) once its result has been retrieved
+         for (uint32_t i = 0; i < kNumLoads; ++i)
+         {
+            latencyMs.push_back(std::chrono::duration<double, std::milli>(finishTimes[i] - submitTimes[i]).count());
+         }
+         ++numRuns;
+
+         Benchmark::doNotOptimize(checksum);
+      });
+
+      std::sort(latencyMs.begin(), latencyMs.end());
+      state.setCounter("medianLoadLatencyMs", latencyMs[latencyMs.size() / 2]);
+      state.setCounter("p99LoadLatencyMs", latencyMs[latencyMs.size() * 99 / 100]);
+      state.setCounter("maxLoadLatencyMs", latencyMs.back());
+
+      // Includes the warm up run, which is where the job system's workers (and the waiting thread, if it helps out) are counted
+      state.setCounter("newThreadsPerBurst", static_cast<double>(numNewThreads.load()) / numRuns);
+   }
+
+   void jobsParallelFor(Benchmark::State& state)
+   {
+      static const uint32_t kNumValues = 4'000'000;
+      static const uint32_t kBatchSize = 16 * 1024;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<float> input(kNumValues);
+      for (float& value : input)
+      {
+         value = random.nextFloat(0.0f, 100.0f);
+      }
+      std::vector<float> output(kNumValues);
+
+      state.measure(kNumValues, [&]
+      {
+         JobSystem::parallelFor(kNumValues, kBatchSize, [&input, &output](std::size_t begin, std::size_t end)
+         {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+               output[i] = std::sqrt(input[i]) * std::sin(input[i]);
+            }
+         });
+
+         Benchmark::doNotOptimize(output.data());
+      });
+   }
+
+   // Loader-style logging from every worker at once, written to a stream that discards everything so that only the logging overhead is measured
+   void logSubmit(Benchmark::State& state)
+   {
+      static const uint32_t kNumRecords = 64 * 1024;
+      static const uint32_t kBatchSize = 256;
+
+      std::ostream nullStream(nullptr);
+      Log::initialize(nullStream);
+      Log::Stats initialStats = Log::getStats();
+
+      state.measure(kNumRecords, [] { Log::flush(); }, [&]
+      {
+         JobSystem::parallelFor(kNumRecords, kBatchSize, [](std::size_t begin, std::size_t end)
+         {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+               LOG_INFO("Loaded mesh " << i << " (" << 0.5f * i << " KiB) from Meshes/Sponza/sponza.gltf");
+            }
+         });
+      });
+
+      Log::terminate();
+
+      Log::Stats stats = Log::getStats();
+      uint64_t numSubmitted = stats.numWritten + stats.numDropped - initialStats.numWritten - initialStats.numDropped;
+      state.setCounter("droppedFraction", numSubmitted > 0 ? static_cast<double>(stats.numDropped - initialStats.numDropped) / numSubmitted : 0.0);
+   }
+
+   // Formats every record on the logging thread and writes it under a lock, as the previous synchronous logger did
+   void logSubmitStreamBaseline(Benchmark::State& state)
+   {
+      static const uint32_t kNumRecords = 64 * 1024;
+      static const uint32_t kBatchSize = 256;
+
+      std::ostream nullStream(nullptr);
+      std::mutex streamMutex;
+
+      state.measure(kNumRecords, [&]
+      {
+         JobSystem::parallelFor(kNumRecords, kBatchSize, [&nullStream, &streamMutex](std::size_t begin, std::size_t end)
+         {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+               time_t now = std::time(nullptr);
+               tm time = *std::localtime(&now);
+
+               std::stringstream timeStream;
+               timeStream << std::setfill('0') << std::setw(2) << time.tm_hour << ':' << std::setw(2) << time.tm_min << ':' << std::setw(2) << time.tm_sec;
+
+               std::lock_guard<std::mutex> lock(streamMutex);
+               nullStream << __FILE__ << "(" << __LINE__ << "): [  info   ] <" << timeStream.str() << "> " << "Loaded mesh " << i << " (" << 0.5f * i << " KiB) from Meshes/Sponza/sponza.gltf" << std::endl;
+            }
+         });
+      });
+   }
+
+   // Builds many short-lived per-frame arrays, as scene extraction does, either from the frame allocator or from the heap
+   template<bool kUseFrameAllocator>
+   void frameArrays(Benchmark::State& state)
+   {
+      static const uint32_t kNumArrays = 10'000;
+      static const uint32_t kArraySize = 64;
+
+      using Vector = std::conditional_t<kUseFrameAllocator, FrameVector<glm::vec4>, std::vector<glm::vec4>>;
+
+      state.measure(static_cast<uint64_t>(kNumArrays) * kArraySize, [&]
+      {
+         FrameAllocatorBase::beginFrame();
+
+         for (uint32_t i = 0; i < kNumArrays; ++i)
+         {
+            Vector values;
+            for (uint32_t j = 0; j < kArraySize; ++j)
+            {
+               values.push_back(glm::vec4(static_cast<float>(j)));
+            }
+
+            Benchmark::doNotOptimize(values.data());
+         }
+      });
+
+      if constexpr (kUseFrameAllocator)
+      {
+         std::size_t peakBytes = 0;
+         std::size_t reservedBytes = 0;
+         for (const FrameAllocatorStats& stats : FrameAllocatorBase::getStats())
+         {
+            peakBytes = std::max(peakBytes, stats.peakBytes);
+            reservedBytes += stats.reservedBytes;
+         }
+
+         state.setCounter("peakBytes", static_cast<double>(peakBytes));
+         state.setCounter("reservedBytes", static_cast<double>(reservedBytes));
+      }
+   }
+}
+
+void registerCoreBenchmarks(Benchmark::Registry& registry)
+{
+   registry.add("Hash/Bytes/16", [](Benchmark::State& state) { hashBytes(state, 16); });
+   registry.add("Hash/Bytes/64", [](Benchmark::State& state) { hashBytes(state, 64); });
+   registry.add("Hash/Bytes/4096", [](Benchmark::State& state) { hashBytes(state, 4096); });
+   registry.add("Hash/PipelineDescriptions/Depth", [](Benchmark::State& state) { hashPipelineDescriptions(state, createDepthPipelineDescriptions()); });
+   registry.add("Hash/PipelineDescriptions/Normal", [](Benchmark::State& state) { hashPipelineDescriptions(state, createNormalPipelineDescriptions()); });
+   registry.add("Hash/PipelineDescriptions/Forward", [](Benchmark::State& state) { hashPipelineDescriptions(state, createForwardPipelineDescriptions()); });
+   registry.add("Hash/DescriptorSetLayouts", hashDescriptorSetLayouts);
+
+   registry.add("Delegate/Broadcast", delegateBroadcast);
+
+   registry.add("Jobs/ScheduleWait", jobsScheduleWait);
+   registry.add("Jobs/LoadBurst/Task", jobsLoadBurst<false>);
+   registry.add("Jobs/LoadBurst/AsyncBaseline", jobsLoadBurst<true>);
+   registry.add("Jobs/ParallelFor", jobsParallelFor);
+
+   registry.add("Log/Submit/Async", logSubmit);
+   registry.add("Log/Submit/StreamBaseline", logSubmitStreamBaseline);
+
+   registry.add("Memory/FrameArrays/FrameAllocator", frameArrays<true>);
+   registry.add("Memory/FrameArrays/HeapBaseline", frameArrays<false>);
+}
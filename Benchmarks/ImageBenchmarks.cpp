@@ -0,0 +1,147 @@
+#include "Benchmark.h"
+
+#include "Resources/DDSImage.h"
+#include "Resources/Image.h"
+#include "Resources/STBImage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace
+{
+   template<typename T>
+   void append(std::vector<uint8_t>& bytes, const T& value)
+   {
+      std::size_t offset = bytes.size();
+      bytes.resize(offset + sizeof(T));
+      std::memcpy(bytes.data() + offset, &value, sizeof(T));
+   }
+
+   // Uncompressed 32-bit TGA with noisy pixels
+   std::vector<uint8_t> createTgaFile(uint16_t width, uint16_t height, Benchmark::Random& random)
+   {
+      std::vector<uint8_t> bytes;
+      append<uint8_t>(bytes, 0); // ID length
+      append<uint8_t>(bytes, 0); // Color map type
+      append<uint8_t>(bytes, 2); // Uncompressed true color
+      bytes.resize(bytes.size() + 5); // Color map specification
+      append<uint16_t>(bytes, 0); // X origin
+      append<uint16_t>(bytes, 0); // Y origin
+      append<uint16_t>(bytes, width);
+      append<uint16_t>(bytes, height);
+      append<uint8_t>(bytes, 32); // Bits per pixel
+      append<uint8_t>(bytes, 0x28); // 8 alpha bits, top left origin
+
+      std::size_t pixelOffset = bytes.size();
+      bytes.resize(pixelOffset + static_cast<std::size_t>(width) * height * 4);
+      for (std::size_t i = pixelOffset; i < bytes.size(); i += 8)
+      {
+         uint64_t value = random.next();
+         std::memcpy(bytes.data() + i, &value, std::min<std::size_t>(8, bytes.size() - i));
+      }
+
+      return bytes;
+   }
+
+   // RGBA8 DDS (with a DX10 header) that has a full mip chain
+   std::vector<uint8_t> createDdsFile(uint32_t size, Benchmark::Random& random)
+   {
+      static const uint32_t kFlags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000; // Caps, height, width, pixel format, mip map count
+      static const uint32_t kFourCCFlag = 0x4;
+      static const uint32_t kDXGIFormatR8G8B8A8Unorm = 28;
+      static const uint32_t kResourceDimensionTexture2D = 3;
+
+      uint32_t mipCount = 1;
+      while ((size >> mipCount) > 0)
+      {
+         ++mipCount;
+      }
+
+      std::vector<uint8_t> bytes;
+      bytes.insert(bytes.end(), { 'D', 'D', 'S', ' ' });
+
+      append<uint32_t>(bytes, 124); // Header size
+      append<uint32_t>(bytes, kFlags);
+      append<uint32_t>(bytes, size); // Height
+      append<uint32_t>(bytes, size); // Width
+      append<uint32_t>(bytes, size * 4); // Pitch
+      append<uint32_t>(bytes, 0); // Depth
+      append<uint32_t>(bytes, mipCount);
+      bytes.resize(bytes.size() + 11 * sizeof(uint32_t)); // Reserved
+
+      append<uint32_t>(bytes, 32); // Pixel format size
+      append<uint32_t>(bytes, kFourCCFlag);
+      bytes.insert(bytes.end(), { 'D', 'X', '1', '0' });
+      bytes.resize(bytes.size() + 5 * sizeof(uint32_t)); // Bit count and masks
+
+      append<uint32_t>(bytes, 0x1000); // Caps (texture)
+      bytes.resize(bytes.size() + 4 * sizeof(uint32_t)); // Caps 2-4 and reserved
+
+      append<uint32_t>(bytes, kDXGIFormatR8G8B8A8Unorm);
+      append<uint32_t>(bytes, kResourceDimensionTexture2D);
+      append<uint32_t>(bytes, 0); // Misc flags
+      append<uint32_t>(bytes, 1); // Array size
+      append<uint32_t>(bytes, 0); // Alpha mode
+
+      for (uint32_t mip = 0; mip < mipCount; ++mip)
+      {
+         uint32_t mipSize = std::max(1u, size >> mip);
+         for (uint32_t i = 0; i < mipSize * mipSize; ++i)
+         {
+            append<uint32_t>(bytes, static_cast<uint32_t>(random.next()));
+         }
+      }
+
+      return bytes;
+   }
+
+   void stbDecodeTga(Benchmark::State& state)
+   {
+      static const uint16_t kImageSize = 1024;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<uint8_t> fileData = createTgaFile(kImageSize, kImageSize, random);
+
+      std::vector<uint8_t> fileDataCopy;
+      bool succeeded = true;
+      state.measure(static_cast<uint64_t>(kImageSize) * kImageSize, [&] { fileDataCopy = fileData; }, [&]
+      {
+         std::unique_ptr<Image> image = STB::loadImage(std::move(fileDataCopy), true);
+         succeeded &= image != nullptr;
+
+         Benchmark::doNotOptimize(image.get());
+      });
+
+      state.setCounter("succeeded", succeeded);
+      state.setCounter("fileBytes", static_cast<double>(fileData.size()));
+   }
+
+   void ddsParse(Benchmark::State& state)
+   {
+      static const uint32_t kImageSize = 2048;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<uint8_t> fileData = createDdsFile(kImageSize, random);
+
+      std::vector<uint8_t> fileDataCopy;
+      uint32_t numMips = 0;
+      state.measure(static_cast<uint64_t>(kImageSize) * kImageSize, [&] { fileDataCopy = fileData; }, [&]
+      {
+         std::unique_ptr<Image> image = DDS::loadImage(std::move(fileDataCopy), false);
+         numMips = image ? static_cast<uint32_t>(image->getTextureData().mips.size()) : 0;
+
+         Benchmark::doNotOptimize(image.get());
+      });
+
+      state.setCounter("mips", numMips);
+      state.setCounter("fileBytes", static_cast<double>(fileData.size()));
+   }
+}
+
+void registerImageBenchmarks(Benchmark::Registry& registry)
+{
+   registry.add("Image/STB/DecodeTGA", stbDecodeTga);
+   registry.add("Image/DDS/Parse", ddsParse);
+}
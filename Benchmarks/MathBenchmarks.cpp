@@ -0,0 +1,480 @@
+#include "Benchmark.h"
+
+#include "Math/BoundingVolumeHierarchy.h"
+#include "Math/Bounds.h"
+#include "Math/Frustum.h"
+#include "Math/FrustumBatch.h"
+#include "Math/FrustumCulling.h"
+#include "Math/OcclusionBuffer.h"
+#include "Math/Transform.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace
+{
+   const float kWorldExtent = 500.0f;
+
+   glm::mat4 createWorldToClip()
+   {
+      glm::mat4 worldToView = glm::lookAt(glm::vec3(0.0f, 0.0f, 20.0f), glm::vec3(100.0f, 100.0f, 0.0f), MathUtils::kUpVector);
+      glm::mat4 viewToClip = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+
+      return viewToClip * worldToView;
+   }
+
+   Frustum createFrustum()
+   {
+      return Frustum(createWorldToClip());
+   }
+
+   std::vector<Bounds> createBounds(uint32_t count, Benchmark::Random& random)
+   {
+      std::vector<Bounds> bounds;
+      bounds.reserve(count);
+      for (uint32_t i = 0; i < count; ++i)
+      {
+         glm::vec3 center(random.nextFloat(-kWorldExtent, kWorldExtent), random.nextFloat(-kWorldExtent, kWorldExtent), random.nextFloat(0.0f, 50.0f));
+         glm::vec3 extent(random.nextFloat(0.1f, 5.0f), random.nextFloat(0.1f, 5.0f), random.nextFloat(0.1f, 5.0f));
+         bounds.emplace_back(center, extent);
+      }
+
+      return bounds;
+   }
+
+   Transform createTransform(Benchmark::Random& random)
+   {
+      glm::vec3 axis = glm::normalize(glm::vec3(random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f), random.nextFloat(0.1f, 1.0f)));
+      glm::quat orientation = glm::angleAxis(random.nextFloat(0.0f, glm::two_pi<float>()), axis);
+      glm::vec3 position(random.nextFloat(-kWorldExtent, kWorldExtent), random.nextFloat(-kWorldExtent, kWorldExtent), random.nextFloat(0.0f, 50.0f));
+
+      return Transform(orientation, position, glm::vec3(random.nextFloat(0.5f, 2.0f)));
+   }
+
+   void frustumCullBounds(Benchmark::State& state)
+   {
+      static const uint32_t kNumBounds = 100'000;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<Bounds> bounds = createBounds(kNumBounds, random);
+      Frustum frustum = createFrustum();
+
+      uint32_t numVisible = 0;
+      state.measure(kNumBounds, [&]
+      {
+         numVisible = 0;
+         for (const Bounds& bound : bounds)
+         {
+            numVisible += !frustum.cull(bound);
+         }
+
+         Benchmark::doNotOptimize(numVisible);
+      });
+
+      state.setCounter("visibleFraction", static_cast<double>(numVisible) / kNumBounds);
+   }
+
+   void frustumCullSpheres(Benchmark::State& state)
+   {
+      static const uint32_t kNumSpheres = 100'000;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<Bounds> bounds = createBounds(kNumSpheres, random);
+      Frustum frustum = createFrustum();
+
+      uint32_t numVisible = 0;
+      state.measure(kNumSpheres, [&]
+      {
+         numVisible = 0;
+         for (const Bounds& bound : bounds)
+         {
+            numVisible += !frustum.cull(bound.getCenter(), bound.getRadius());
+         }
+
+         Benchmark::doNotOptimize(numVisible);
+      });
+
+      state.setCounter("visibleFraction", static_cast<double>(numVisible) / kNumSpheres);
+   }
+
+   enum class CullImplementation
+   {
+      Reference,
+      Scalar,
+      Simd
+   };
+
+   // Culls the same bounds one at a time with Frustum::cull() (Reference), or all at once from a structure of arrays with or without SIMD instructions
+   void frustumCullBoundsSoA(Benchmark::State& state, uint32_t numBounds, CullImplementation implementation)
+   {
+      Benchmark::Random random(state.getSeed());
+      std::vector<Bounds> bounds = createBounds(numBounds, random);
+      Frustum frustum = createFrustum();
+
+      BoundsSoA boundsSoA;
+      boundsSoA.reserve(numBounds);
+      for (const Bounds& bound : bounds)
+      {
+         boundsSoA.add(bound);
+      }
+
+      std::vector<uint8_t> visible(numBounds);
+      std::size_t numVisible = 0;
+      state.measure(numBounds, [&]
+      {
+         if (implementation == CullImplementation::Reference)
+         {
+            numVisible = 0;
+            for (uint32_t i = 0; i < numBounds; ++i)
+            {
+               visible[i] = !frustum.cull(bounds[i]);
+               numVisible += visible[i];
+            }
+         }
+         else if (implementation == CullImplementation::Scalar)
+         {
+            numVisible = FrustumCulling::cullScalar(frustum, boundsSoA, visible);
+         }
+         else
+         {
+            numVisible = FrustumCulling::cull(frustum, boundsSoA, visible);
+         }
+
+         Benchmark::doNotOptimize(visible.data());
+      });
+
+      // Every implementation must agree with Frustum::cull() exactly
+      uint32_t numMismatches = 0;
+      for (uint32_t i = 0; i < numBounds; ++i)
+      {
+         numMismatches += visible[i] != (frustum.cull(bounds[i]) ? 0 : 1);
+      }
+
+      state.setCounter("visibleFraction", static_cast<double>(numVisible) / numBounds);
+      state.setCounter("mismatches", numMismatches);
+      state.setCounter("laneWidth", implementation == CullImplementation::Simd ? FrustumCulling::getLaneWidth() : 1);
+   }
+
+   // Triangle lists of boxes scattered in front of the camera of createWorldToClip(), which hide part of the bounds from createBounds()
+   std::vector<glm::vec3> createOccluderTriangles(uint32_t numOccluders, Benchmark::Random& random)
+   {
+      static const std::array<uint32_t, 36> kBoxIndices = { 0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1, 2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3 };
+
+      std::vector<glm::vec3> triangles;
+      triangles.reserve(numOccluders * kBoxIndices.size());
+      for (uint32_t i = 0; i < numOccluders; ++i)
+      {
+         float distance = random.nextFloat(20.0f, 150.0f);
+         glm::vec3 center = glm::vec3(distance, distance, 0.0f) + glm::vec3(random.nextFloat(-40.0f, 40.0f), random.nextFloat(-40.0f, 40.0f), random.nextFloat(0.0f, 30.0f));
+         glm::vec3 extent(random.nextFloat(2.0f, 15.0f), random.nextFloat(2.0f, 15.0f), random.nextFloat(5.0f, 30.0f));
+
+         for (uint32_t index : kBoxIndices)
+         {
+            triangles.push_back(center + extent * glm::vec3((index & 1) ? 1.0f : -1.0f, (index & 2) ? 1.0f : -1.0f, (index & 4) ? 1.0f : -1.0f));
+         }
+      }
+
+      return triangles;
+   }
+
+   // Rasterizes occluders with or without SIMD instructions, and checks that both produce the exact same depth
+   void occlusionRasterize(Benchmark::State& state, uint32_t numOccluders, bool useSimd)
+   {
+      Benchmark::Random random(state.getSeed());
+      std::vector<glm::vec3> triangles = createOccluderTriangles(numOccluders, random);
+      glm::mat4 worldToClip = createWorldToClip();
+
+      OcclusionBuffer occlusionBuffer(256, 128);
+      state.measure(static_cast<uint32_t>(triangles.size() / 3), [&]
+      {
+         occlusionBuffer.clear();
+         if (useSimd)
+         {
+            occlusionBuffer.rasterize(triangles, worldToClip);
+         }
+         else
+         {
+            occlusionBuffer.rasterizeScalar(triangles, worldToClip);
+         }
+         occlusionBuffer.updateTiles();
+
+         Benchmark::doNotOptimize(occlusionBuffer.getDepth(0, 0));
+      });
+
+      OcclusionBuffer referenceBuffer(256, 128);
+      referenceBuffer.rasterizeScalar(triangles, worldToClip);
+
+      uint32_t numMismatches = 0;
+      uint32_t numCovered = 0;
+      for (uint32_t y = 0; y < occlusionBuffer.getHeight(); ++y)
+      {
+         for (uint32_t x = 0; x < occlusionBuffer.getWidth(); ++x)
+         {
+            numMismatches += occlusionBuffer.getDepth(x, y) != referenceBuffer.getDepth(x, y);
+            numCovered += occlusionBuffer.getDepth(x, y) < 1.0f;
+         }
+      }
+
+      state.setCounter("coveredFraction", static_cast<double>(numCovered) / (occlusionBuffer.getWidth() * occlusionBuffer.getHeight()));
+      state.setCounter("mismatches", numMismatches);
+      state.setCounter("laneWidth", useSimd ? OcclusionBuffer::getLaneWidth() : 1);
+   }
+
+   // Tests the bounds that pass frustum culling against a buffer of occluders, reporting how many of them are hidden
+   void occlusionTest(Benchmark::State& state, uint32_t numOccluders)
+   {
+      static const uint32_t kNumBounds = 100'000;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<glm::vec3> triangles = createOccluderTriangles(numOccluders, random);
+      glm::mat4 worldToClip = createWorldToClip();
+      Frustum frustum(worldToClip);
+
+      std::vector<Bounds> bounds = createBounds(kNumBounds, random);
+      std::erase_if(bounds, [&frustum](const Bounds& bound) { return frustum.cull(bound); });
+
+      OcclusionBuffer occlusionBuffer(256, 128);
+      occlusionBuffer.rasterize(triangles, worldToClip);
+      occlusionBuffer.updateTiles();
+
+      uint32_t numOccluded = 0;
+      state.measure(static_cast<uint32_t>(bounds.size()), [&]
+      {
+         numOccluded = 0;
+         for (const Bounds& bound : bounds)
+         {
+            numOccluded += occlusionBuffer.isOccluded(bound.getMin(), bound.getMax(), worldToClip);
+         }
+
+         Benchmark::doNotOptimize(numOccluded);
+      });
+
+      state.setCounter("visibleFraction", bounds.empty() ? 0.0 : 1.0 - static_cast<double>(numOccluded) / bounds.size());
+      state.setCounter("testedBounds", static_cast<double>(bounds.size()));
+   }
+
+   // Queries a bounding volume hierarchy, or tests every bounds one at a time with the same function that the hierarchy uses for its leaves
+   template<bool kUseHierarchy>
+   void boundingVolumeHierarchyQuery(Benchmark::State& state, uint32_t numBounds)
+   {
+      Benchmark::Random random(state.getSeed());
+      std::vector<Bounds> bounds = createBounds(numBounds, random);
+
+      FrustumBatch frustumBatch;
+      frustumBatch.addFrustum(createFrustum());
+
+      BoundingVolumeHierarchy hierarchy;
+      for (uint32_t i = 0; i < numBounds; ++i)
+      {
+         hierarchy.insert(bounds[i], i);
+      }
+      hierarchy.rebuild();
+
+      std::vector<uint8_t> visible(numBounds);
+      std::size_t numVisible = 0;
+      state.measure(numBounds, [&]
+      {
+         std::fill(visible.begin(), visible.end(), 0);
+         numVisible = 0;
+
+         if constexpr (kUseHierarchy)
+         {
+            hierarchy.query(frustumBatch, frustumBatch.getAllMask(), [&visible, &numVisible](uint64_t userData, FrustumBatch::Mask)
+            {
+               visible[userData] = 1;
+               ++numVisible;
+            });
+         }
+         else
+         {
+            for (uint32_t i = 0; i < numBounds; ++i)
+            {
+               if (frustumBatch.getVisibilityMask(bounds[i], frustumBatch.getAllMask()) != 0)
+               {
+                  visible[i] = 1;
+                  ++numVisible;
+               }
+            }
+         }
+
+         Benchmark::doNotOptimize(visible.data());
+      });
+
+      // The hierarchy must find exactly the same bounds as testing them one at a time
+      uint32_t numMismatches = 0;
+      for (uint32_t i = 0; i < numBounds; ++i)
+      {
+         numMismatches += visible[i] != (frustumBatch.getVisibilityMask(bounds[i], frustumBatch.getAllMask()) != 0 ? 1 : 0);
+      }
+
+      state.setCounter("visibleFraction", static_cast<double>(numVisible) / numBounds);
+      state.setCounter("mismatches", numMismatches);
+      state.setCounter("cost", hierarchy.getCost());
+   }
+
+   void boundingVolumeHierarchyRebuild(Benchmark::State& state)
+   {
+      static const uint32_t kNumBounds = 100'000;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<Bounds> bounds = createBounds(kNumBounds, random);
+
+      BoundingVolumeHierarchy hierarchy;
+      for (uint32_t i = 0; i < kNumBounds; ++i)
+      {
+         hierarchy.insert(bounds[i], i);
+      }
+
+      state.measure(kNumBounds, [&]
+      {
+         hierarchy.rebuild();
+      });
+
+      state.setCounter("cost", hierarchy.getCost());
+   }
+
+   // Moves a fraction of the leaves each frame (which refits their ancestors), letting the hierarchy rebuild itself in the background when it degrades
+   void boundingVolumeHierarchyMove(Benchmark::State& state, float movingFraction)
+   {
+      static const uint32_t kNumBounds = 100'000;
+      static const float kMaxMoveDistance = 2.0f;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<Bounds> bounds = createBounds(kNumBounds, random);
+
+      BoundingVolumeHierarchy hierarchy;
+      std::vector<BoundingVolumeHierarchy::LeafId> leaves;
+      leaves.reserve(kNumBounds);
+      for (uint32_t i = 0; i < kNumBounds; ++i)
+      {
+         leaves.push_back(hierarchy.insert(bounds[i], i));
+      }
+      hierarchy.rebuild();
+
+      uint32_t numMoving = static_cast<uint32_t>(kNumBounds * movingFraction);
+      uint32_t numRebuilds = 0;
+      state.measure(numMoving, [&]
+      {
+         for (uint32_t i = 0; i < numMoving; ++i)
+         {
+            uint32_t index = random.nextIndex(kNumBounds);
+            glm::vec3 offset(random.nextFloat(-kMaxMoveDistance, kMaxMoveDistance), random.nextFloat(-kMaxMoveDistance, kMaxMoveDistance), random.nextFloat(-kMaxMoveDistance, kMaxMoveDistance));
+
+            bounds[index] = Bounds(bounds[index].getCenter() + offset, bounds[index].getExtent());
+            hierarchy.update(leaves[index], bounds[index]);
+         }
+
+         bool wasRebuilding = hierarchy.isRebuilding();
+         hierarchy.maintain();
+         numRebuilds += !wasRebuilding && hierarchy.isRebuilding();
+      });
+
+      state.setCounter("costRatio", hierarchy.getCost() / hierarchy.getBuildCost());
+      state.setCounter("rebuilds", numRebuilds);
+   }
+
+   // Transforms local bounds to world space and culls them, which is the per-section work of scene extraction
+   void transformAndCull(Benchmark::State& state)
+   {
+      static const uint32_t kNumObjects = 100'000;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<Transform> transforms;
+      transforms.reserve(kNumObjects);
+      for (uint32_t i = 0; i < kNumObjects; ++i)
+      {
+         transforms.push_back(createTransform(random));
+      }
+      Bounds localBounds(glm::vec3(0.0f), glm::vec3(1.0f, 2.0f, 1.0f));
+      Frustum frustum = createFrustum();
+
+      uint32_t numVisible = 0;
+      state.measure(kNumObjects, [&]
+      {
+         numVisible = 0;
+         for (const Transform& transform : transforms)
+         {
+            Bounds worldBounds = transform.transformBounds(localBounds);
+            numVisible += !frustum.cull(worldBounds);
+         }
+
+         Benchmark::doNotOptimize(numVisible);
+      });
+
+      state.setCounter("visibleFraction", static_cast<double>(numVisible) / kNumObjects);
+   }
+
+   void transformCompose(Benchmark::State& state)
+   {
+      static const uint32_t kNumTransforms = 1'000'000;
+
+      Benchmark::Random random(state.getSeed());
+      std::vector<Transform> parents;
+      std::vector<Transform> children;
+      parents.reserve(kNumTransforms);
+      children.reserve(kNumTransforms);
+      for (uint32_t i = 0; i < kNumTransforms; ++i)
+      {
+         parents.push_back(createTransform(random));
+         children.push_back(createTransform(random));
+      }
+      std::vector<glm::mat4> matrices(kNumTransforms);
+
+      state.measure(kNumTransforms, [&]
+      {
+         for (uint32_t i = 0; i < kNumTransforms; ++i)
+         {
+            matrices[i] = (parents[i] * children[i]).toMatrix();
+         }
+
+         Benchmark::doNotOptimize(matrices.data());
+      });
+   }
+}
+
+void registerMathBenchmarks(Benchmark::Registry& registry)
+{
+   registry.add("Math/Frustum/CullBounds", frustumCullBounds);
+   registry.add("Math/Frustum/CullSpheres", frustumCullSpheres);
+   registry.add("Math/Frustum/TransformAndCull", transformAndCull);
+   registry.add("Math/Transform/Compose", transformCompose);
+
+   for (uint32_t numBounds : { 100'000u, 250'000u, 1'000'000u })
+   {
+      std::string suffix = "/" + std::to_string(numBounds);
+      registry.add("Math/Frustum/CullBoundsSoA/Reference" + suffix, [numBounds](Benchmark::State& state) { frustumCullBoundsSoA(state, numBounds, CullImplementation::Reference); });
+      registry.add("Math/Frustum/CullBoundsSoA/Scalar" + suffix, [numBounds](Benchmark::State& state) { frustumCullBoundsSoA(state, numBounds, CullImplementation::Scalar); });
+      if (FrustumCulling::getLaneWidth() > 1)
+      {
+         registry.add("Math/Frustum/CullBoundsSoA/" + std::string(FrustumCulling::getInstructionSetName()) + suffix, [numBounds](Benchmark::State& state) { frustumCullBoundsSoA(state, numBounds, CullImplementation::Simd); });
+      }
+   }
+
+   for (uint32_t numBounds : { 100'000u, 1'000'000u })
+   {
+      std::string suffix = "/" + std::to_string(numBounds);
+      registry.add("Math/BVH/Query/Linear" + suffix, [numBounds](Benchmark::State& state) { boundingVolumeHierarchyQuery<false>(state, numBounds); });
+      registry.add("Math/BVH/Query/BVH" + suffix, [numBounds](Benchmark::State& state) { boundingVolumeHierarchyQuery<true>(state, numBounds); });
+   }
+
+   for (uint32_t numOccluders : { 8u, 32u })
+   {
+      std::string suffix = "/" + std::to_string(numOccluders);
+      registry.add("Math/Occlusion/Rasterize/Scalar" + suffix, [numOccluders](Benchmark::State& state) { occlusionRasterize(state, numOccluders, false); });
+      if (OcclusionBuffer::getLaneWidth() > 1)
+      {
+         registry.add("Math/Occlusion/Rasterize/" + std::string(OcclusionBuffer::getInstructionSetName()) + suffix, [numOccluders](Benchmark::State& state) { occlusionRasterize(state, numOccluders, true); });
+      }
+      registry.add("Math/Occlusion/Test" + suffix, [numOccluders](Benchmark::State& state) { occlusionTest(state, numOccluders); });
+   }
+
+   registry.add("Math/BVH/Rebuild", boundingVolumeHierarchyRebuild);
+   registry.add("Math/BVH/Move/1Percent", [](Benchmark::State& state) { boundingVolumeHierarchyMove(state, 0.01f); });
+   registry.add("Math/BVH/Move/10Percent", [](Benchmark::State& state) { boundingVolumeHierarchyMove(state, 0.1f); });
+}
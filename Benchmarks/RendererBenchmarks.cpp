@@ -0,0 +1,381 @@
+#include "Benchmark.h"
+
+#include "Core/Jobs/JobSystem.h"
+#include "Core/Memory/FrameAllocator.h"
+#include "Core/RadixSort.h"
+
+#include "Graphics/BlendMode.h"
+
+#include "Math/Transform.h"
+
+#include "Renderer/DrawList.h"
+#include "Renderer/DrawSortKey.h"
+#include "Renderer/ParallelRecording.h"
+#include "Renderer/SceneExtraction.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+   const uint32_t kNumMaterials = 64;
+   const uint32_t kMaxSectionsPerMesh = 4;
+   const uint32_t kNumPrototypeMeshes = 16;
+
+   struct DrawMaterial
+   {
+      BlendMode blendMode = BlendMode::Opaque;
+      bool twoSided = false;
+   };
+
+   struct DrawMesh
+   {
+      glm::vec3 position = glm::vec3(0.0f);
+      uint32_t firstSection = 0;
+      uint32_t numSections = 0;
+   };
+
+   struct DrawSection
+   {
+      uint32_t material = 0;
+      bool hasValidTexCoords = false;
+   };
+
+   // Same shape as DrawInfo
+   struct Draw
+   {
+      uint64_t sortKey = 0;
+      uint32_t meshIndex = 0;
+      uint32_t section = 0;
+
+      uint32_t firstInstance = 0;
+      uint32_t numInstances = 1;
+   };
+
+   // Sections belong to one mesh asset, which several meshes can share
+   struct DrawScene
+   {
+      std::array<DrawMaterial, kNumMaterials> materials;
+      std::vector<DrawMesh> meshes;
+      std::vector<DrawSection> sections;
+   };
+
+   // Mostly opaque materials, some masked and translucent ones
+   void createDrawMaterials(DrawScene& scene, Benchmark::Random& random)
+   {
+      for (DrawMaterial& material : scene.materials)
+      {
+         float blendModeValue = random.nextFloat();
+         material.blendMode = blendModeValue < 0.8f ? BlendMode::Opaque : blendModeValue < 0.9f ? BlendMode::Masked : BlendMode::Translucent;
+         material.twoSided = random.nextFloat() < 0.2f;
+      }
+   }
+
+   DrawMesh createDrawMesh(DrawScene& scene, Benchmark::Random& random)
+   {
+      DrawMesh mesh;
+      mesh.firstSection = static_cast<uint32_t>(scene.sections.size());
+      mesh.numSections = 1 + random.nextIndex(kMaxSectionsPerMesh);
+
+      for (uint32_t section = 0; section < mesh.numSections; ++section)
+      {
+         scene.sections.push_back(DrawSection{ random.nextIndex(kNumMaterials), random.nextFloat() < 0.9f });
+      }
+
+      return mesh;
+   }
+
+   glm::vec3 createDrawMeshPosition(Benchmark::Random& random)
+   {
+      return glm::vec3(random.nextFloat(-500.0f, 500.0f), random.nextFloat(-500.0f, 500.0f), random.nextFloat(0.0f, 50.0f));
+   }
+
+   // Every mesh is a different asset with a few sections
+   DrawScene createDrawScene(uint32_t numMeshes, Benchmark::Random& random)
+   {
+      DrawScene scene;
+      createDrawMaterials(scene, random);
+
+      scene.meshes.reserve(numMeshes);
+      for (uint32_t i = 0; i < numMeshes; ++i)
+      {
+         glm::vec3 position = createDrawMeshPosition(random);
+         DrawMesh& mesh = scene.meshes.emplace_back(createDrawMesh(scene, random));
+         mesh.position = position;
+      }
+
+      return scene;
+   }
+
+   // Copies of a few mesh assets scattered around (like a field of the same few props)
+   DrawScene createInstancedDrawScene(uint32_t numMeshes, Benchmark::Random& random)
+   {
+      DrawScene scene;
+      createDrawMaterials(scene, random);
+
+      std::array<DrawMesh, kNumPrototypeMeshes> prototypes;
+      for (DrawMesh& prototype : prototypes)
+      {
+         prototype = createDrawMesh(scene, random);
+      }
+
+      scene.meshes.reserve(numMeshes);
+      for (uint32_t i = 0; i < numMeshes; ++i)
+      {
+         DrawMesh& mesh = scene.meshes.emplace_back(prototypes[random.nextIndex(kNumPrototypeMeshes)]);
+         mesh.position = createDrawMeshPosition(random);
+      }
+
+      return scene;
+   }
+
+   struct BindCounts
+   {
+      uint32_t pipelineBinds = 0;
+      uint32_t descriptorSetBinds = 0;
+   };
+
+   // Pipelines depend on the blend mode, whether the material is two sided, and whether the section has texture coordinates (as in the scene render passes)
+   uint32_t getPipeline(const DrawScene& scene, const DrawSection& section)
+   {
+      const DrawMaterial& material = scene.materials[section.material];
+      return static_cast<uint32_t>(material.blendMode) << 2 | (material.twoSided ? 1 : 0) | (section.hasValidTexCoords ? 2 : 0);
+   }
+
+   // Meshes sorted back to front by distance, with each blend mode rendered as a loop over all meshes, and descriptor sets bound for every section
+   BindCounts renderByDistance(const DrawScene& scene, std::vector<uint32_t>& meshOrder, const glm::vec3& viewPosition)
+   {
+      std::sort(meshOrder.begin(), meshOrder.end(), [&scene, &viewPosition](uint32_t first, uint32_t second)
+      {
+         return glm::distance2(scene.meshes[first].position, viewPosition) > glm::distance2(scene.meshes[second].position, viewPosition);
+      });
+
+      BindCounts counts;
+      for (BlendMode blendMode : { BlendMode::Opaque, BlendMode::Masked, BlendMode::Translucent })
+      {
+         uint32_t lastPipeline = ~0u;
+         for (uint32_t meshIndex : meshOrder)
+         {
+            const DrawMesh& mesh = scene.meshes[meshIndex];
+            for (uint32_t section = mesh.firstSection; section < mesh.firstSection + mesh.numSections; ++section)
+            {
+               if (scene.materials[scene.sections[section].material].blendMode == blendMode)
+               {
+                  uint32_t pipeline = getPipeline(scene, scene.sections[section]);
+                  counts.pipelineBinds += pipeline != lastPipeline;
+                  lastPipeline = pipeline;
+
+                  ++counts.descriptorSetBinds;
+               }
+            }
+         }
+      }
+
+      return counts;
+   }
+
+   // One draw per visible mesh section
+   void gatherDraws(const DrawScene& scene, std::vector<Draw>& draws, const glm::vec3& viewPosition)
+   {
+      draws.clear();
+      for (uint32_t meshIndex = 0; meshIndex < scene.meshes.size(); ++meshIndex)
+      {
+         const DrawMesh& mesh = scene.meshes[meshIndex];
+         uint32_t depth = DrawSortKey::quantizeDepth(glm::distance2(mesh.position, viewPosition));
+
+         for (uint32_t section = mesh.firstSection; section < mesh.firstSection + mesh.numSections; ++section)
+         {
+            const DrawSection& drawSection = scene.sections[section];
+            const DrawMaterial& material = scene.materials[drawSection.material];
+            uint32_t pipelineState = (material.twoSided ? 1 : 0) | (drawSection.hasValidTexCoords ? 2 : 0);
+
+            draws.push_back(Draw{ DrawSortKey::create(material.blendMode, pipelineState, drawSection.material, depth), meshIndex, section });
+         }
+      }
+   }
+
+   void sortDraws(std::vector<Draw>& draws, std::vector<Draw>& scratch)
+   {
+      scratch.resize(draws.size());
+      radixSort(std::span<Draw>(draws), std::span<Draw>(scratch), [](const Draw& draw)
+      {
+         return draw.sortKey;
+      });
+   }
+
+   uint32_t getSceneSection(const DrawScene& scene, const Draw& draw)
+   {
+      return draw.section;
+   }
+
+   uint32_t getSceneSection(const DrawScene& scene, const DrawInfo& draw)
+   {
+      return scene.meshes[draw.meshIndex].firstSection + draw.section;
+   }
+
+   // Binds pipelines and descriptor sets only when they change
+   template<typename DrawType>
+   BindCounts countBinds(const DrawScene& scene, std::span<const DrawType> draws)
+   {
+      BindCounts counts;
+      uint32_t lastPipeline = ~0u;
+      uint32_t lastMaterial = ~0u;
+      BlendMode lastBlendMode = BlendMode::Opaque;
+      for (const DrawType& draw : draws)
+      {
+         // Each blend mode is a separate loop in the render passes, which starts with nothing bound
+         BlendMode blendMode = DrawSortKey::getBlendMode(draw.sortKey);
+         if (blendMode != lastBlendMode)
+         {
+            lastPipeline = ~0u;
+            lastMaterial = ~0u;
+            lastBlendMode = blendMode;
+         }
+
+         const DrawSection& drawSection = scene.sections[getSceneSection(scene, draw)];
+         uint32_t pipeline = getPipeline(scene, drawSection);
+         counts.pipelineBinds += pipeline != lastPipeline;
+         counts.descriptorSetBinds += drawSection.material != lastMaterial;
+
+         lastPipeline = pipeline;
+         lastMaterial = drawSection.material;
+      }
+
+      return counts;
+   }
+
+   // Draws sorted by key, binding pipelines and descriptor sets only when they change
+   BindCounts renderBySortKey(const DrawScene& scene, std::vector<Draw>& draws, std::vector<Draw>& scratch, const glm::vec3& viewPosition)
+   {
+      gatherDraws(scene, draws, viewPosition);
+      sortDraws(draws, scratch);
+
+      return countBinds(scene, std::span<const Draw>(draws));
+   }
+
+   // One draw per mesh section in a draw list for the renderer's own sorting, with meshes in the same order as the scene. Sections of a mesh asset always use the same
+   // material, so the first section of a mesh can stand in for its mesh ID and draws don't need a material to be instanced.
+   void gatherDrawList(const DrawScene& scene, DrawList& drawList, const glm::vec3& viewPosition)
+   {
+      for (uint32_t meshIndex = 0; meshIndex < scene.meshes.size(); ++meshIndex)
+      {
+         const DrawMesh& mesh = scene.meshes[meshIndex];
+         uint32_t depth = DrawSortKey::quantizeDepth(glm::distance2(mesh.position, viewPosition));
+
+         drawList.meshes.emplace_back(nullptr, mesh.firstSection, Transform(), glm::mat4(1.0f));
+         for (uint32_t section = 0; section < mesh.numSections; ++section)
+         {
+            const DrawSection& drawSection = scene.sections[mesh.firstSection + section];
+            const DrawMaterial& material = scene.materials[drawSection.material];
+            uint32_t pipelineState = (material.twoSided ? 1 : 0) | (drawSection.hasValidTexCoords ? 2 : 0);
+
+            drawList.draws.push_back(DrawInfo{ DrawSortKey::create(material.blendMode, pipelineState, drawSection.material, depth), meshIndex, section });
+         }
+      }
+   }
+
+   void setBindCounters(Benchmark::State& state, const BindCounts& counts, std::size_t numDraws)
+   {
+      state.setCounter("draws", static_cast<double>(numDraws));
+      state.setCounter("pipelineBinds", counts.pipelineBinds);
+      state.setCounter("descriptorSetBinds", counts.descriptorSetBinds);
+   }
+
+   void drawSortDistance(Benchmark::State& state, uint32_t numMeshes)
+   {
+      Benchmark::Random random(state.getSeed());
+      DrawScene scene = createDrawScene(numMeshes, random);
+      glm::vec3 viewPosition(0.0f, 0.0f, 5.0f);
+
+      std::vector<uint32_t> meshOrder(numMeshes);
+      BindCounts counts;
+      state.measure(numMeshes, [&]
+      {
+         for (uint32_t i = 0; i < numMeshes; ++i)
+         {
+            meshOrder[i] = i;
+         }
+
+         counts = renderByDistance(scene, meshOrder, viewPosition);
+         Benchmark::doNotOptimize(counts);
+      });
+
+      setBindCounters(state, counts, scene.sections.size());
+   }
+
+   void drawSortKey(Benchmark::State& state, uint32_t numMeshes)
+   {
+      Benchmark::Random random(state.getSeed());
+      DrawScene scene = createDrawScene(numMeshes, random);
+      glm::vec3 viewPosition(0.0f, 0.0f, 5.0f);
+
+      std::vector<Draw> draws;
+      std::vector<Draw> scratch;
+      draws.reserve(scene.sections.size());
+
+      BindCounts counts;
+      state.measure(numMeshes, [&]
+      {
+         counts = renderBySortKey(scene, draws, scratch, viewPosition);
+         Benchmark::doNotOptimize(counts);
+      });
+
+      setBindCounters(state, counts, draws.size());
+   }
+
+   // Gathers and sorts the draws of a scene made of copies of a few meshes with the renderer's own sorting, either with a draw per mesh section or with automatic
+   // instancing. Recording needs a device, so its cost is counted as the commands that the scene render passes would record (binds and draw calls) rather than timed,
+   // along with the number of chunks that they would be recorded in parallel in (1 meaning on a single thread).
+   void drawInstancing(Benchmark::State& state, uint32_t numMeshes, bool instanced)
+   {
+      Benchmark::Random random(state.getSeed());
+      DrawScene scene = createInstancedDrawScene(numMeshes, random);
+      glm::vec3 viewPosition(0.0f, 0.0f, 5.0f);
+
+      SceneExtraction::SortSettings sortSettings;
+      sortSettings.automaticInstancing = instanced;
+
+      std::size_t numSections = 0;
+      std::size_t numDraws = 0;
+      std::size_t numInstances = 0;
+      BindCounts counts;
+      state.measure(numMeshes, [&]
+      {
+         FrameAllocatorBase::beginFrame();
+
+         DrawList drawList;
+         gatherDrawList(scene, drawList, viewPosition);
+         numSections = drawList.draws.size();
+         SceneExtraction::sortDraws(drawList, sortSettings);
+
+         counts = countBinds(scene, std::span<const DrawInfo>(drawList.draws));
+         numDraws = drawList.draws.size();
+         numInstances = drawList.instances.size();
+         Benchmark::doNotOptimize(counts);
+      });
+
+      setBindCounters(state, counts, numDraws);
+      state.setCounter("sections", static_cast<double>(numSections));
+      state.setCounter("instances", static_cast<double>(numInstances));
+      state.setCounter("commands", static_cast<double>(counts.pipelineBinds + counts.descriptorSetBinds + numDraws));
+      state.setCounter("recordingChunks", static_cast<double>(ParallelRecording::getNumChunks(numDraws, JobSystem::getNumWorkers() + 1)));
+   }
+}
+
+void registerRendererBenchmarks(Benchmark::Registry& registry)
+{
+   for (uint32_t numMeshes : { 1'000u, 10'000u, 100'000u })
+   {
+      std::string suffix = "/" + std::to_string(numMeshes);
+      registry.add("Renderer/DrawSort/Distance" + suffix, [numMeshes](Benchmark::State& state) { drawSortDistance(state, numMeshes); });
+      registry.add("Renderer/DrawSort/SortKey" + suffix, [numMeshes](Benchmark::State& state) { drawSortKey(state, numMeshes); });
+      registry.add("Renderer/Instancing/Separate" + suffix, [numMeshes](Benchmark::State& state) { drawInstancing(state, numMeshes, false); });
+      registry.add("Renderer/Instancing/Instanced" + suffix, [numMeshes](Benchmark::State& state) { drawInstancing(state, numMeshes, true); });
+   }
+}
@@ -0,0 +1,556 @@
+#include "Benchmark.h"
+
+#include "Core/Containers/FrameVector.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Core/Memory/FrameAllocator.h"
+
+#include "Math/Bounds.h"
+#include "Math/Frustum.h"
+#include "Math/FrustumBatch.h"
+#include "Math/MathUtils.h"
+
+#include "Renderer/DrawList.h"
+#include "Renderer/SceneCulling.h"
+#include "Renderer/SceneExtraction.h"
+
+#include "Scene/Components/OscillatingMovementComponent.h"
+#include "Scene/Components/TransformComponent.h"
+#include "Scene/Entity.h"
+#include "Scene/Scene.h"
+#include "Scene/Systems/OscillatingMovementSystem.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <array>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+   const uint32_t kNumEntities = 100'000;
+   const uint32_t kHierarchyDepth = 10;
+   const float kPointLightRadius = 30.0f;
+   const uint32_t kNumExtractionMeshes = 20'000;
+
+   Transform createTransform(Benchmark::Random& random)
+   {
+      return Transform(glm::angleAxis(random.nextFloat(0.0f, 6.0f), MathUtils::kUpVector), glm::vec3(random.nextFloat(-100.0f, 100.0f), random.nextFloat(-100.0f, 100.0f), random.nextFloat(0.0f, 10.0f)), glm::vec3(1.0f));
+   }
+
+   // Each entity is parented to one of the previously created entities, up to the given depth, which produces a forest of shallow hierarchies
+   std::unique_ptr<Scene> createScene(uint64_t seed, uint32_t maxDepth, bool oscillate)
+   {
+      Benchmark::Random random(seed);
+      std::unique_ptr<Scene> scene = std::make_unique<Scene>();
+
+      std::vector<std::pair<Entity, uint32_t>> entities;
+      entities.reserve(kNumEntities);
+      for (uint32_t i = 0; i < kNumEntities; ++i)
+      {
+         Entity entity = scene->createEntity();
+         TransformComponent& transformComponent = entity.createComponent<TransformComponent>();
+         transformComponent.setRelativeTransform(createTransform(random));
+
+         uint32_t depth = 0;
+         if (!entities.empty() && random.nextIndex(4) != 0)
+         {
+            const std::pair<Entity, uint32_t>& parent = entities[random.nextIndex(static_cast<uint32_t>(entities.size()))];
+            if (parent.second < maxDepth)
+            {
+               transformComponent.setParent(parent.first);
+               depth = parent.second + 1;
+            }
+         }
+
+         if (oscillate)
+         {
+            OscillatingMovementComponent& oscillatingMovementComponent = entity.createComponent<OscillatingMovementComponent>();
+            oscillatingMovementComponent.location.sin.timeScale = glm::vec3(random.nextFloat(0.5f, 2.0f));
+            oscillatingMovementComponent.location.sin.valueScale = glm::vec3(random.nextFloat(0.0f, 1.0f));
+            oscillatingMovementComponent.rotation.cos.timeScale = glm::vec3(random.nextFloat(0.5f, 2.0f));
+            oscillatingMovementComponent.rotation.cos.valueScale = glm::vec3(0.0f, 0.0f, random.nextFloat(0.0f, 45.0f));
+         }
+
+         entities.emplace_back(entity, depth);
+      }
+
+      scene->updateTransforms();
+
+      return scene;
+   }
+
+   void sceneCreateEntities(Benchmark::State& state)
+   {
+      std::unique_ptr<Scene> scene;
+      state.measure(kNumEntities, [&] { scene.reset(); }, [&]
+      {
+         scene = createScene(state.getSeed(), 4, false);
+      });
+   }
+
+   void sceneTickOscillatingMovement(Benchmark::State& state)
+   {
+      std::unique_ptr<Scene> scene = createScene(state.getSeed(), 0, true);
+      scene->createSystem<OscillatingMovementSystem>();
+
+      state.measure(kNumEntities, [&]
+      {
+         scene->tick(1.0f / 60.0f);
+      });
+   }
+
+   // Reads the (cached) world transform of every entity, which is what scene extraction does for each mesh
+   void sceneAbsoluteTransforms(Benchmark::State& state)
+   {
+      std::unique_ptr<Scene> scene = createScene(state.getSeed(), 4, false);
+
+      state.measure(kNumEntities, [&]
+      {
+         glm::vec3 positionSum = glm::vec3(0.0f);
+         scene->forEach<TransformComponent>([&positionSum](const TransformComponent& transformComponent)
+         {
+            positionSum += transformComponent.getAbsoluteTransform().position;
+         });
+
+         Benchmark::doNotOptimize(positionSum);
+      });
+   }
+
+   // Forest of trees that are each kHierarchyDepth levels deep, where every node is parented to a random node on the level above it (within the same tree)
+   std::unique_ptr<Scene> createHierarchyScene(uint64_t seed, std::vector<Entity>& entities)
+   {
+      static const uint32_t kNodesPerLevel = 10;
+      static const uint32_t kNodesPerTree = kHierarchyDepth * kNodesPerLevel;
+
+      Benchmark::Random random(seed);
+      std::unique_ptr<Scene> scene = std::make_unique<Scene>();
+
+      entities.clear();
+      entities.reserve(kNumEntities);
+      for (uint32_t i = 0; i < kNumEntities; ++i)
+      {
+         Entity entity = scene->createEntity();
+         TransformComponent& transformComponent = entity.createComponent<TransformComponent>();
+         transformComponent.setRelativeTransform(Transform(glm::angleAxis(random.nextFloat(0.0f, 6.0f), MathUtils::kUpVector), glm::vec3(random.nextFloat(-1.0f, 1.0f)), glm::vec3(1.0f)));
+
+         uint32_t indexInTree = i % kNodesPerTree;
+         if (indexInTree >= kNodesPerLevel)
+         {
+            uint32_t levelStart = i - indexInTree % kNodesPerLevel - kNodesPerLevel;
+            transformComponent.setParent(entities[levelStart + random.nextIndex(kNodesPerLevel)]);
+         }
+
+         entities.push_back(entity);
+      }
+
+      scene->updateTransforms();
+
+      return scene;
+   }
+
+   // What getAbsoluteTransform() did before world transforms were cached
+   Transform computeUncachedAbsoluteTransform(const TransformComponent& transformComponent)
+   {
+      if (const TransformComponent* parentComponent = transformComponent.getParentComponent())
+      {
+         return computeUncachedAbsoluteTransform(*parentComponent) * transformComponent.getRelativeTransform();
+      }
+
+      return transformComponent.getRelativeTransform();
+   }
+
+   // Reads the world transform of every node once per view (as scene extraction did for each view), either walking up the hierarchy each time or from the cache
+   template<bool kCached>
+   void sceneHierarchyRead(Benchmark::State& state)
+   {
+      static const uint32_t kNumViews = 17;
+
+      std::vector<Entity> entities;
+      std::unique_ptr<Scene> scene = createHierarchyScene(state.getSeed(), entities);
+
+      state.measure(kNumEntities * kNumViews, [&]
+      {
+         glm::vec3 positionSum = glm::vec3(0.0f);
+         for (uint32_t view = 0; view < kNumViews; ++view)
+         {
+            scene->forEach<TransformComponent>([&positionSum](const TransformComponent& transformComponent)
+            {
+               if constexpr (kCached)
+               {
+                  positionSum += transformComponent.getAbsoluteTransform().position;
+               }
+               else
+               {
+                  positionSum += computeUncachedAbsoluteTransform(transformComponent).position;
+               }
+            });
+         }
+
+         Benchmark::doNotOptimize(positionSum);
+      });
+   }
+
+   // Marks a fraction of the nodes as dirty (along with their subtrees), then refreshes the cached world transforms
+   void sceneHierarchyUpdate(Benchmark::State& state, float dirtyFraction)
+   {
+      std::vector<Entity> entities;
+      std::unique_ptr<Scene> scene = createHierarchyScene(state.getSeed(), entities);
+
+      Benchmark::Random random(state.getSeed() + 1);
+      uint32_t numDirty = static_cast<uint32_t>(kNumEntities * dirtyFraction);
+      std::vector<Entity> dirtyEntities = entities;
+      for (uint32_t i = 0; i < numDirty; ++i)
+      {
+         std::swap(dirtyEntities[i], dirtyEntities[i + random.nextIndex(kNumEntities - i)]);
+      }
+      dirtyEntities.resize(numDirty);
+
+      state.measure(kNumEntities, [&]
+      {
+         for (Entity entity : dirtyEntities)
+         {
+            TransformComponent& transformComponent = entity.getComponent<TransformComponent>();
+            Transform transform = transformComponent.getRelativeTransform();
+            transform.translateBy(glm::vec3(0.001f));
+            transformComponent.setRelativeTransform(transform);
+         }
+
+         scene->updateTransforms();
+      });
+
+      state.setCounter("dirtyNodes", numDirty);
+   }
+
+   // Stands in for a mesh component with a single section. Entities with the same mesh ID can be instanced together.
+   struct BoundsComponent
+   {
+      Bounds bounds;
+      uint32_t meshId = 0;
+   };
+
+   struct ExtractionView
+   {
+      glm::mat4 worldToClip;
+      glm::vec3 position;
+   };
+
+   // Meshes are spread out over the same area regardless of their number, so the fraction of them that each view can see stays the same
+   std::unique_ptr<Scene> createExtractionScene(uint64_t seed, uint32_t numMeshes = kNumExtractionMeshes)
+   {
+      static const uint32_t kNumDistinctMeshes = 256;
+
+      Benchmark::Random random(seed);
+      std::unique_ptr<Scene> scene = std::make_unique<Scene>();
+
+      for (uint32_t i = 0; i < numMeshes; ++i)
+      {
+         Entity entity = scene->createEntity();
+         entity.createComponent<TransformComponent>().setRelativeTransform(createTransform(random));
+         BoundsComponent& boundsComponent = entity.createComponent<BoundsComponent>();
+         boundsComponent.bounds = Bounds(glm::vec3(0.0f), glm::vec3(random.nextFloat(0.5f, 3.0f)));
+         boundsComponent.meshId = random.nextIndex(kNumDistinctMeshes);
+      }
+
+      scene->updateTransforms();
+
+      return scene;
+   }
+
+   // One main view, plus six cube face views for each point light (as the renderer creates for point light shadows)
+   std::vector<ExtractionView> createExtractionViews(uint32_t numPointLights, Benchmark::Random& random)
+   {
+      static const std::array<glm::vec3, 6> kCubeFaceDirections = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f) };
+
+      std::vector<ExtractionView> views;
+
+      glm::vec3 cameraPosition(0.0f, 0.0f, 5.0f);
+      ExtractionView& mainView = views.emplace_back();
+      mainView.worldToClip = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 1000.0f) * glm::lookAt(cameraPosition, glm::vec3(50.0f, 50.0f, 0.0f), MathUtils::kUpVector);
+      mainView.position = cameraPosition;
+
+      for (uint32_t light = 0; light < numPointLights; ++light)
+      {
+         glm::vec3 lightPosition(random.nextFloat(-100.0f, 100.0f), random.nextFloat(-100.0f, 100.0f), random.nextFloat(1.0f, 10.0f));
+         for (const glm::vec3& direction : kCubeFaceDirections)
+         {
+            glm::vec3 up = glm::abs(direction.z) > 0.5f ? MathUtils::kForwardVector : MathUtils::kUpVector;
+
+            ExtractionView& faceView = views.emplace_back();
+            faceView.worldToClip = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, kPointLightRadius) * glm::lookAt(lightPosition, lightPosition + direction, up);
+            faceView.position = lightPosition;
+         }
+      }
+
+      return views;
+   }
+
+   // Same view order and grouping as the renderer builds for its shadow views
+   FrustumBatch createExtractionFrustumBatch(const std::vector<ExtractionView>& views)
+   {
+      FrustumBatch frustumBatch;
+      frustumBatch.addFrustum(Frustum(views[0].worldToClip));
+
+      for (std::size_t firstFace = 1; firstFace < views.size(); firstFace += 6)
+      {
+         uint32_t groupIndex = frustumBatch.addGroup(views[firstFace].position, kPointLightRadius);
+         for (std::size_t face = firstFace; face < firstFace + 6; ++face)
+         {
+            frustumBatch.addFrustum(Frustum(views[face].worldToClip), groupIndex);
+         }
+      }
+
+      return frustumBatch;
+   }
+
+   // Every mesh has a single section, and none of them are ever reloaded
+   SceneCulling::MeshSource getMeshSource(const BoundsComponent& boundsComponent)
+   {
+      SceneCulling::MeshSource meshSource;
+      meshSource.meshGeneration = 1;
+      meshSource.meshId = boundsComponent.meshId;
+      meshSource.sectionBounds = std::span<const Bounds>(&boundsComponent.bounds, 1);
+      return meshSource;
+   }
+
+   // Brings the scene culling in sync with the scene, and waits for any hierarchy rebuild that started (as it would have finished within a few frames in the renderer)
+   void updateSceneCulling(const Scene& scene, SceneCulling& sceneCulling)
+   {
+      sceneCulling.update<BoundsComponent>(scene, getMeshSource);
+      while (sceneCulling.getHierarchy().isRebuilding())
+      {
+         std::this_thread::yield();
+         sceneCulling.update<BoundsComponent>(scene, getMeshSource);
+      }
+   }
+
+   // The renderer's scene culling query, either as it runs it (a single walk of the hierarchy for all views, which transforms each section's bounds once and only
+   // visits sections in visible parts of the hierarchy), or once per view for comparison
+   template<bool kSingleQuery>
+   void sceneCullingQuery(Benchmark::State& state, uint32_t numPointLights)
+   {
+      std::unique_ptr<Scene> scene = createExtractionScene(state.getSeed());
+
+      Benchmark::Random random(state.getSeed() + 1);
+      std::vector<ExtractionView> views = createExtractionViews(numPointLights, random);
+      FrustumBatch frustumBatch = createExtractionFrustumBatch(views);
+
+      std::vector<FrustumBatch> viewFrustumBatches(views.size());
+      for (std::size_t i = 0; i < views.size(); ++i)
+      {
+         viewFrustumBatches[i].addFrustum(Frustum(views[i].worldToClip));
+      }
+
+      SceneCulling sceneCulling;
+      updateSceneCulling(*scene, sceneCulling);
+
+      std::size_t numVisibleSections = 0;
+      state.measure(views.size(), [&]
+      {
+         FrameAllocatorBase::beginFrame();
+
+         if constexpr (kSingleQuery)
+         {
+            FrameVector<SceneCulling::VisibleSection> visibleSections;
+            sceneCulling.query(frustumBatch, visibleSections);
+            numVisibleSections = visibleSections.size();
+
+            Benchmark::doNotOptimize(visibleSections.data());
+         }
+         else
+         {
+            numVisibleSections = 0;
+            for (const FrustumBatch& viewFrustumBatch : viewFrustumBatches)
+            {
+               FrameVector<SceneCulling::VisibleSection> visibleSections;
+               sceneCulling.query(viewFrustumBatch, visibleSections);
+               numVisibleSections += visibleSections.size();
+
+               Benchmark::doNotOptimize(visibleSections.data());
+            }
+         }
+      });
+
+      state.setCounter("views", static_cast<double>(views.size()));
+      state.setCounter("visibleSections", static_cast<double>(numVisibleSections));
+      state.setCounter("hierarchyCost", sceneCulling.getHierarchy().getCost());
+   }
+
+   // The renderer's CPU extraction of every view: the scene culling query, then SceneExtraction (the same code the renderer runs, minus material lookups)
+   void sceneExtractDraws(Benchmark::State& state, uint32_t numPointLights, bool automaticInstancing, uint32_t numMeshes = kNumExtractionMeshes)
+   {
+      static const uint32_t kNumMaterials = 32;
+
+      std::unique_ptr<Scene> scene = createExtractionScene(state.getSeed(), numMeshes);
+
+      Benchmark::Random random(state.getSeed() + 1);
+      std::vector<ExtractionView> views = createExtractionViews(numPointLights, random);
+      FrustumBatch frustumBatch = createExtractionFrustumBatch(views);
+
+      SceneCulling sceneCulling;
+      updateSceneCulling(*scene, sceneCulling);
+
+      SceneExtraction::SortSettings sortSettings;
+      sortSettings.automaticInstancing = automaticInstancing;
+
+      auto getSectionDraw = [](const SceneCulling::MeshEntry& entry, uint32_t section, SceneExtraction::SectionDraw& sectionDraw)
+      {
+         sectionDraw.materialIndex = entry.meshId % kNumMaterials;
+         return true;
+      };
+
+      std::size_t numVisibleSections = 0;
+      std::size_t numDraws = 0;
+      std::size_t numInstances = 0;
+      uint64_t numHeapAllocations = 0;
+      state.measure(views.size(), [&]
+      {
+         FrameAllocatorBase::beginFrame();
+
+         // Everything extraction allocates per frame should come from inline storage or the frame allocator, so this should stay at zero once warmed up
+         uint64_t allocationsBefore = Benchmark::getAllocationCount();
+
+         FrameVector<SceneCulling::VisibleSection> visibleSections;
+         sceneCulling.query(frustumBatch, visibleSections);
+
+         FrameVector<DrawList> drawLists(views.size());
+         FrameVector<DrawList*> drawListPointers;
+         for (DrawList& drawList : drawLists)
+         {
+            drawListPointers.push_back(&drawList);
+         }
+
+         SceneExtraction::extractDraws(sceneCulling, visibleSections, views[0].position, getSectionDraw, drawListPointers, sortSettings);
+
+         numHeapAllocations = Benchmark::getAllocationCount() - allocationsBefore;
+         numVisibleSections = visibleSections.size();
+         numDraws = 0;
+         numInstances = 0;
+         for (const DrawList& drawList : drawLists)
+         {
+            numDraws += drawList.draws.size();
+            numInstances += drawList.instances.size();
+         }
+
+         Benchmark::doNotOptimize(drawLists.data());
+      });
+
+      state.setCounter("views", static_cast<double>(views.size()));
+      state.setCounter("visibleSections", static_cast<double>(numVisibleSections));
+      state.setCounter("draws", static_cast<double>(numDraws));
+      state.setCounter("instances", static_cast<double>(numInstances));
+      state.setCounter("workers", JobSystem::getNumWorkers());
+
+      // Of the last frame (the heap allocations include those of the job system's workers)
+      std::size_t frameAllocatorBytes = 0;
+      for (const FrameAllocatorStats& stats : FrameAllocatorBase::getStats())
+      {
+         frameAllocatorBytes += stats.usedBytes;
+      }
+      state.setCounter("heapAllocationsPerFrame", static_cast<double>(numHeapAllocations));
+      state.setCounter("frameAllocatorBytesPerFrame", static_cast<double>(frameAllocatorBytes));
+   }
+
+   // Adds every mesh of a scene to empty scene culling, counting the allocations that adding each mesh takes
+   void sceneCullingInsert(Benchmark::State& state)
+   {
+      std::unique_ptr<Scene> scene = createExtractionScene(state.getSeed());
+
+      std::unique_ptr<SceneCulling> sceneCulling;
+      uint64_t numAllocations = 0;
+      state.measure(kNumExtractionMeshes, [&] { sceneCulling = std::make_unique<SceneCulling>(); }, [&]
+      {
+         uint64_t allocationsBefore = Benchmark::getAllocationCount();
+         sceneCulling->update<BoundsComponent>(*scene, getMeshSource);
+         numAllocations = Benchmark::getAllocationCount() - allocationsBefore;
+      });
+
+      state.setCounter("allocationsPerMesh", static_cast<double>(numAllocations) / kNumExtractionMeshes);
+   }
+
+   // Keeps the scene culling in sync with a scene where a fraction of the meshes move every frame (none of them, for a static scene that only costs a version check per mesh)
+   void sceneCullingUpdate(Benchmark::State& state, float movingFraction)
+   {
+      std::unique_ptr<Scene> scene = createExtractionScene(state.getSeed());
+
+      std::vector<TransformComponent*> transformComponents;
+      scene->forEach<TransformComponent>([&transformComponents](TransformComponent& transformComponent)
+      {
+         transformComponents.push_back(&transformComponent);
+      });
+
+      Benchmark::Random random(state.getSeed() + 1);
+      uint32_t numMeshes = static_cast<uint32_t>(transformComponents.size());
+      uint32_t numMoving = static_cast<uint32_t>(numMeshes * movingFraction);
+      for (uint32_t i = 0; i < numMoving; ++i)
+      {
+         std::swap(transformComponents[i], transformComponents[i + random.nextIndex(numMeshes - i)]);
+      }
+      transformComponents.resize(numMoving);
+
+      SceneCulling sceneCulling;
+      updateSceneCulling(*scene, sceneCulling);
+
+      float offset = 0.01f;
+      state.measure(numMeshes, [&]
+      {
+         for (TransformComponent* transformComponent : transformComponents)
+         {
+            Transform transform = transformComponent->getRelativeTransform();
+            transform.translateBy(glm::vec3(offset));
+            transformComponent->setRelativeTransform(transform);
+         }
+         offset = -offset;
+
+         scene->updateTransforms();
+         sceneCulling.update<BoundsComponent>(*scene, getMeshSource);
+      });
+
+      state.setCounter("movingMeshes", numMoving);
+      state.setCounter("hierarchyCost", sceneCulling.getHierarchy().getCost());
+   }
+}
+
+void registerSceneBenchmarks(Benchmark::Registry& registry)
+{
+   registry.add("Scene/CreateEntities", sceneCreateEntities);
+   registry.add("Scene/TickOscillatingMovement", sceneTickOscillatingMovement);
+   registry.add("Scene/AbsoluteTransforms", sceneAbsoluteTransforms);
+
+   registry.add("Scene/Hierarchy/Read/Uncached", sceneHierarchyRead<false>);
+   registry.add("Scene/Hierarchy/Read/Cached", sceneHierarchyRead<true>);
+   registry.add("Scene/Hierarchy/Update/Clean", [](Benchmark::State& state) { sceneHierarchyUpdate(state, 0.0f); });
+   registry.add("Scene/Hierarchy/Update/Dirty1Percent", [](Benchmark::State& state) { sceneHierarchyUpdate(state, 0.01f); });
+   registry.add("Scene/Hierarchy/Update/Dirty10Percent", [](Benchmark::State& state) { sceneHierarchyUpdate(state, 0.1f); });
+   registry.add("Scene/Hierarchy/Update/DirtyAll", [](Benchmark::State& state) { sceneHierarchyUpdate(state, 1.0f); });
+
+   registry.add("Scene/Culling/Insert", sceneCullingInsert);
+   registry.add("Scene/Culling/Update/Static", [](Benchmark::State& state) { sceneCullingUpdate(state, 0.0f); });
+   registry.add("Scene/Culling/Update/Moving1Percent", [](Benchmark::State& state) { sceneCullingUpdate(state, 0.01f); });
+   registry.add("Scene/Culling/Update/Moving10Percent", [](Benchmark::State& state) { sceneCullingUpdate(state, 0.1f); });
+
+   // Five point lights is as many as fit in a frustum batch (along with the main view)
+   static_assert(1 + 5 * 6 <= FrustumBatch::kMaxFrustums);
+   for (uint32_t numPointLights : { 0u, 1u, 2u, 4u, 5u })
+   {
+      std::string suffix = "/PointLights" + std::to_string(numPointLights);
+      registry.add("Scene/Extract" + suffix, [numPointLights](Benchmark::State& state) { sceneExtractDraws(state, numPointLights, false); });
+      registry.add("Scene/Extract/Instanced" + suffix, [numPointLights](Benchmark::State& state) { sceneExtractDraws(state, numPointLights, true); });
+      registry.add("Scene/Culling/Query" + suffix, [numPointLights](Benchmark::State& state) { sceneCullingQuery<true>(state, numPointLights); });
+      registry.add("Scene/Culling/QueryPerView" + suffix, [numPointLights](Benchmark::State& state) { sceneCullingQuery<false>(state, numPointLights); });
+   }
+
+   // Extraction cost should grow with the number of meshes, but barely with the number of views
+   for (uint32_t numMeshes : { 10'000u, 20'000u, 40'000u, 80'000u })
+   {
+      for (uint32_t numPointLights : { 0u, 4u })
+      {
+         std::string name = "Scene/Extract/Meshes" + std::to_string(numMeshes) + "/PointLights" + std::to_string(numPointLights);
+         registry.add(name, [numMeshes, numPointLights](Benchmark::State& state) { sceneExtractDraws(state, numPointLights, false, numMeshes); });
+      }
+   }
+}
@@ -48,7 +48,7 @@ source_group("Libraries\\imgui" "${IMGUI_DIR}/*")
 
 # EnTT
 add_subdirectory("${LIB_DIR}/entt")
-target_link_libraries(${PROJECT_NAME} PUBLIC EnTT)
+target_link_libraries(${CORE_LIBRARY_NAME} PUBLIC EnTT)
 
 # GLFW
 set(GLFW_BUILD_EXAMPLES OFF CACHE INTERNAL "Build the GLFW example programs")
@@ -63,11 +63,11 @@ target_link_libraries(${PROJECT_NAME} PUBLIC glfw)
 set(GLM_INSTALL_ENABLE OFF CACHE INTERNAL "GLM install")
 set(GLM_TEST_ENABLE OFF CACHE INTERNAL "Build unit tests")
 add_subdirectory("${LIB_DIR}/glm")
-target_compile_definitions(${PROJECT_NAME} PUBLIC GLM_ENABLE_EXPERIMENTAL)
-target_compile_definitions(${PROJECT_NAME} PUBLIC GLM_FORCE_CTOR_INIT)
-target_compile_definitions(${PROJECT_NAME} PUBLIC GLM_FORCE_DEPTH_ZERO_TO_ONE)
-target_compile_definitions(${PROJECT_NAME} PUBLIC GLM_FORCE_RADIANS)
-target_link_libraries(${PROJECT_NAME} PUBLIC glm)
+target_compile_definitions(${CORE_LIBRARY_NAME} PUBLIC GLM_ENABLE_EXPERIMENTAL)
+target_compile_definitions(${CORE_LIBRARY_NAME} PUBLIC GLM_FORCE_CTOR_INIT)
+target_compile_definitions(${CORE_LIBRARY_NAME} PUBLIC GLM_FORCE_DEPTH_ZERO_TO_ONE)
+target_compile_definitions(${CORE_LIBRARY_NAME} PUBLIC GLM_FORCE_RADIANS)
+target_link_libraries(${CORE_LIBRARY_NAME} PUBLIC glm)
 
 # Kontroller
 if(FORGE_WITH_MIDI)
@@ -78,6 +78,7 @@ endif(FORGE_WITH_MIDI)
 # VulkanMemoryAllocator
 add_subdirectory("${LIB_DIR}/VulkanMemoryAllocator")
 target_link_libraries(${PROJECT_NAME} PUBLIC VulkanMemoryAllocator)
+target_include_directories(${CORE_LIBRARY_NAME} PUBLIC "$<TARGET_PROPERTY:VulkanMemoryAllocator,INTERFACE_INCLUDE_DIRECTORIES>") # Graphics/Vulkan.h includes the header, but only the application uses the allocator
 
 # PlatformUtils
 if(NOT TARGET PlatformUtils) # Transitively added by Kontroller (which means we're beholden to its version of it)
@@ -87,31 +88,18 @@ target_link_libraries(${PROJECT_NAME} PUBLIC PlatformUtils)
 
 # PPK_ASSERT
 set(PPK_DIR "${LIB_DIR}/PPK_ASSERT")
-target_sources(${PROJECT_NAME} PRIVATE "${PPK_DIR}/src/ppk_assert.h" "${PPK_DIR}/src/ppk_assert.cpp")
-set_source_files_properties("${PPK_DIR}/src/ppk_assert.cpp" PROPERTIES SKIP_PRECOMPILE_HEADERS ON) # Don't use PCH for ppk_assert.cpp to avoid warnings
-target_include_directories(${PROJECT_NAME} PUBLIC "${PPK_DIR}/src")
+target_sources(${CORE_LIBRARY_NAME} PRIVATE "${PPK_DIR}/src/ppk_assert.h" "${PPK_DIR}/src/ppk_assert.cpp")
+target_include_directories(${CORE_LIBRARY_NAME} PUBLIC "${PPK_DIR}/src")
 source_group("Libraries\\PPK_ASSERT" "${PPK_DIR}/src")
 
 # stb
 set(STB_DIR "${LIB_DIR}/stb")
-target_sources(${PROJECT_NAME} PRIVATE "${STB_DIR}/stb_image.h")
-target_include_directories(${PROJECT_NAME} PUBLIC "${STB_DIR}")
+target_sources(${CORE_LIBRARY_NAME} PRIVATE "${STB_DIR}/stb_image.h")
+target_include_directories(${CORE_LIBRARY_NAME} PUBLIC "${STB_DIR}")
 source_group("Libraries\\stb" "${STB_DIR}")
 
-# templog
-set(TEMPLOG_DIR "${LIB_DIR}/templog")
-target_sources(${PROJECT_NAME} PRIVATE
-   "${TEMPLOG_DIR}/config.h"
-   "${TEMPLOG_DIR}/logging.h"
-   "${TEMPLOG_DIR}/templ_meta.h"
-   "${TEMPLOG_DIR}/tuples.h"
-   "${TEMPLOG_DIR}/type_lists.h"
-   "${TEMPLOG_DIR}/imp/logging.cpp"
-)
-target_include_directories(${PROJECT_NAME} PUBLIC "${TEMPLOG_DIR}")
-source_group("Libraries\\templog" "${TEMPLOG_DIR}")
-
 # Vulkan
 find_package(Vulkan REQUIRED)
+target_link_libraries(${CORE_LIBRARY_NAME} PUBLIC Vulkan::Headers) # The core library only needs the headers (for format enums), it never creates an instance
 target_link_libraries(${PROJECT_NAME} PUBLIC Vulkan::Vulkan)
 file(WRITE "${PROJECT_BINARY_DIR}/va_stdafx.h" "#define VULKAN_HPP_NAMESPACE vk\n") # Help out Visual Assist with the Vulkan-HPP namespace
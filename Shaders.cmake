@@ -4,6 +4,7 @@ set(SHADER_BIN_DIR "${RES_DIR}/Shaders")
 set(SHADER_HEADER_FILES
    "${SHADER_DIR}/Lighting.glsl"
    "${SHADER_DIR}/Masked.glsl"
+   "${SHADER_DIR}/Mesh.glsl"
    "${SHADER_DIR}/View.glsl"
 )
 
@@ -25,7 +26,20 @@ set(SHADER_SOURCE_FILES
    "${SHADER_DIR}/SSAOBlur.frag"
 )
 
+# Held back until there is a headless check that the GPU keeps the same draws as the CPU culling (they have never been compiled or run)
+if(FORGE_WITH_GPU_CULLING)
+   list(APPEND SHADER_SOURCE_FILES
+      "${SHADER_DIR}/Cull.comp"
+      "${SHADER_DIR}/HiZ.comp"
+   )
+endif(FORGE_WITH_GPU_CULLING)
+
+# Only the application needs the shaders, so configuring (and building the CPU-only tests and benchmarks) still works without glslc. Building the shaders fails instead
+# of silently running an empty command, so they can't be skipped by accident.
 find_program(GLSLC glslc)
+if(NOT GLSLC)
+   message(WARNING "glslc not found (it comes with the Vulkan SDK), the application's shaders can't be compiled")
+endif()
 file(MAKE_DIRECTORY ${SHADER_BIN_DIR})
 
 set(SHADER_BINARY_FILES)
@@ -34,14 +48,24 @@ foreach(SHADER_SOURCE_FILE ${SHADER_SOURCE_FILES})
    set(SHADER_BINARY_FILE "${SHADER_BIN_DIR}/${SHADER_SOURCE_FILE_NAME}.spv")
    list(APPEND SHADER_BINARY_FILES ${SHADER_BINARY_FILE})
 
-   add_custom_command(
-      OUTPUT ${SHADER_BINARY_FILE}
-      COMMAND ${GLSLC} -o ${SHADER_BINARY_FILE} ${SHADER_SOURCE_FILE}
-      DEPENDS ${SHADER_SOURCE_FILE} ${SHADER_HEADER_FILES}
-      IMPLICIT_DEPENDS CXX ${SHADER_SOURCE_FILE}
-      COMMENT "Compiling shader ${SHADER_BINARY_FILE} from ${SHADER_SOURCE_FILE}"
-      VERBATIM
-   )
+   if(GLSLC)
+      add_custom_command(
+         OUTPUT ${SHADER_BINARY_FILE}
+         COMMAND ${GLSLC} -o ${SHADER_BINARY_FILE} ${SHADER_SOURCE_FILE}
+         DEPENDS ${SHADER_SOURCE_FILE} ${SHADER_HEADER_FILES}
+         IMPLICIT_DEPENDS CXX ${SHADER_SOURCE_FILE}
+         COMMENT "Compiling shader ${SHADER_BINARY_FILE} from ${SHADER_SOURCE_FILE}"
+         VERBATIM
+      )
+   else()
+      add_custom_command(
+         OUTPUT ${SHADER_BINARY_FILE}
+         COMMAND ${CMAKE_COMMAND} -E false
+         DEPENDS ${SHADER_SOURCE_FILE} ${SHADER_HEADER_FILES}
+         COMMENT "Can't compile shader ${SHADER_BINARY_FILE}, glslc not found"
+         VERBATIM
+      )
+   endif(GLSLC)
 endforeach()
 
 set(SHADERS_TARGET_NAME "${PROJECT_NAME}-Shaders")
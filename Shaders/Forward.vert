@@ -1,15 +1,11 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+#include "Mesh.glsl"
 #include "View.glsl"
 
 layout(constant_id = 0) const bool kWithTextures = false;
 
-layout(push_constant) uniform Mesh
-{
-    mat4 localToWorld;
-} mesh;
-
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec3 inTangent;
@@ -23,7 +19,9 @@ layout(location = 2) out vec2 outTexCoord;
 
 void main()
 {
-   vec4 worldPosition = mesh.localToWorld * vec4(inPosition, 1.0);
+   mat4 localToWorld = getLocalToWorld();
+
+   vec4 worldPosition = localToWorld * vec4(inPosition, 1.0);
    gl_Position = view.worldToClip * worldPosition;
    outPosition = worldPosition.xyz;
 
@@ -0,0 +1,15 @@
+#if !defined(MESH_GLSL)
+#define MESH_GLSL
+
+// Bound alongside the view, with one entry per instance of each draw (gl_InstanceIndex includes the draw's first instance)
+layout(std430, set = 0, binding = 1) readonly buffer Meshes
+{
+   mat4 localToWorld[];
+} meshes;
+
+mat4 getLocalToWorld()
+{
+   return meshes.localToWorld[gl_InstanceIndex];
+}
+
+#endif
@@ -1,15 +1,11 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+#include "Mesh.glsl"
 #include "View.glsl"
 
 layout(constant_id = 0) const bool kWithTextures = false;
 
-layout(push_constant) uniform Mesh
-{
-    mat4 localToWorld;
-} mesh;
-
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec3 inTangent;
@@ -22,16 +18,18 @@ layout(location = 1) out mat3 outTBN;
 
 void main()
 {
-   vec4 worldPosition = mesh.localToWorld * vec4(inPosition, 1.0);
+   mat4 localToWorld = getLocalToWorld();
+
+   vec4 worldPosition = localToWorld * vec4(inPosition, 1.0);
    gl_Position = view.worldToClip * worldPosition;
 
    if (kWithTextures)
    {
       outTexCoord = inTexCoord;
 
-      vec3 t = normalize(vec3(mesh.localToWorld * vec4(inTangent, 0.0)));
-      vec3 b = normalize(vec3(mesh.localToWorld * vec4(inBitangent, 0.0)));
-      vec3 n = normalize(vec3(mesh.localToWorld * vec4(inNormal, 0.0)));
+      vec3 t = normalize(vec3(localToWorld * vec4(inTangent, 0.0)));
+      vec3 b = normalize(vec3(localToWorld * vec4(inBitangent, 0.0)));
+      vec3 n = normalize(vec3(localToWorld * vec4(inNormal, 0.0)));
       outTBN = mat3(t, b, n);
    }
    else
@@ -40,7 +38,7 @@ void main()
 
       vec3 t = vec3(0.0);
       vec3 b = vec3(0.0);
-      vec3 n = normalize(vec3(mesh.localToWorld * vec4(inNormal, 0.0)));
+      vec3 n = normalize(vec3(localToWorld * vec4(inNormal, 0.0)));
       outTBN = mat3(t, b, n);
    }
 }
@@ -1,16 +1,12 @@
 set(SRC_DIR "${PROJECT_SOURCE_DIR}/Source")
 
-target_sources(${PROJECT_NAME} PRIVATE
-   "${SRC_DIR}/ForgeApplication.cpp"
-   "${SRC_DIR}/ForgeApplication.h"
-   "${SRC_DIR}/Main.cpp"
-   "${SRC_DIR}/PCH.h"
-
+target_sources(${CORE_LIBRARY_NAME} PRIVATE
    "${SRC_DIR}/Core/Assert.h"
    "${SRC_DIR}/Core/Containers/FrameVector.h"
    "${SRC_DIR}/Core/Containers/GenerationalArray.h"
    "${SRC_DIR}/Core/Containers/GenerationalArrayHandle.h"
    "${SRC_DIR}/Core/Containers/ReflectedMap.h"
+   "${SRC_DIR}/Core/Containers/SmallVector.h"
    "${SRC_DIR}/Core/Containers/StaticVector.h"
    "${SRC_DIR}/Core/Delegate.h"
    "${SRC_DIR}/Core/DelegateHandle.cpp"
@@ -18,19 +14,94 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Core/Enum.h"
    "${SRC_DIR}/Core/Features.h"
    "${SRC_DIR}/Core/Hash.h"
+   "${SRC_DIR}/Core/InlineFunction.h"
+   "${SRC_DIR}/Core/Jobs/JobSystem.cpp"
+   "${SRC_DIR}/Core/Jobs/JobSystem.h"
+   "${SRC_DIR}/Core/Json.cpp"
+   "${SRC_DIR}/Core/Json.h"
    "${SRC_DIR}/Core/Log.cpp"
    "${SRC_DIR}/Core/Log.h"
    "${SRC_DIR}/Core/Macros.h"
    "${SRC_DIR}/Core/Memory/FrameAllocator.cpp"
    "${SRC_DIR}/Core/Memory/FrameAllocator.h"
+   "${SRC_DIR}/Core/Memory/RangeAllocator.cpp"
+   "${SRC_DIR}/Core/Memory/RangeAllocator.h"
+   "${SRC_DIR}/Core/Profiler.cpp"
+   "${SRC_DIR}/Core/Profiler.h"
+   "${SRC_DIR}/Core/RadixSort.h"
    "${SRC_DIR}/Core/Task.h"
    "${SRC_DIR}/Core/Types.h"
 
    "${SRC_DIR}/Graphics/BlendMode.h"
+   "${SRC_DIR}/Graphics/DescriptorSetLayoutHash.cpp"
+   "${SRC_DIR}/Graphics/DescriptorSetLayoutHash.h"
+   "${SRC_DIR}/Graphics/QueueOwnership.cpp"
+   "${SRC_DIR}/Graphics/QueueOwnership.h"
+   "${SRC_DIR}/Graphics/TextureInfo.cpp"
+   "${SRC_DIR}/Graphics/TextureInfo.h"
+   "${SRC_DIR}/Graphics/Vulkan.h"
+
+   "${SRC_DIR}/Math/BoundingVolumeHierarchy.cpp"
+   "${SRC_DIR}/Math/BoundingVolumeHierarchy.h"
+   "${SRC_DIR}/Math/Bounds.cpp"
+   "${SRC_DIR}/Math/Bounds.h"
+   "${SRC_DIR}/Math/Frustum.cpp"
+   "${SRC_DIR}/Math/Frustum.h"
+   "${SRC_DIR}/Math/FrustumBatch.cpp"
+   "${SRC_DIR}/Math/FrustumBatch.h"
+   "${SRC_DIR}/Math/FrustumCulling.cpp"
+   "${SRC_DIR}/Math/FrustumCulling.h"
+   "${SRC_DIR}/Math/MathUtils.h"
+   "${SRC_DIR}/Math/OcclusionBuffer.cpp"
+   "${SRC_DIR}/Math/OcclusionBuffer.h"
+   "${SRC_DIR}/Math/Transform.cpp"
+   "${SRC_DIR}/Math/Transform.h"
+
+   "${SRC_DIR}/Renderer/DrawList.h"
+   "${SRC_DIR}/Renderer/DrawSortKey.h"
+   "${SRC_DIR}/Renderer/ParallelRecording.h"
+   "${SRC_DIR}/Renderer/SceneCulling.cpp"
+   "${SRC_DIR}/Renderer/SceneCulling.h"
+   "${SRC_DIR}/Renderer/SceneExtraction.cpp"
+   "${SRC_DIR}/Renderer/SceneExtraction.h"
+
+   "${SRC_DIR}/Resources/DDSImage.cpp"
+   "${SRC_DIR}/Resources/DDSImage.h"
+   "${SRC_DIR}/Resources/Image.h"
+   "${SRC_DIR}/Resources/STBImage.cpp"
+   "${SRC_DIR}/Resources/STBImage.h"
+
+   "${SRC_DIR}/Scene/Components/CameraComponent.h"
+   "${SRC_DIR}/Scene/Components/LightComponent.h"
+   "${SRC_DIR}/Scene/Components/NameComponent.h"
+   "${SRC_DIR}/Scene/Components/OscillatingMovementComponent.h"
+   "${SRC_DIR}/Scene/Components/TransformComponent.cpp"
+   "${SRC_DIR}/Scene/Components/TransformComponent.h"
+   "${SRC_DIR}/Scene/Entity.cpp"
+   "${SRC_DIR}/Scene/Entity.h"
+   "${SRC_DIR}/Scene/Scene.cpp"
+   "${SRC_DIR}/Scene/Scene.h"
+   "${SRC_DIR}/Scene/System.h"
+   "${SRC_DIR}/Scene/Systems/OscillatingMovementSystem.cpp"
+   "${SRC_DIR}/Scene/Systems/OscillatingMovementSystem.h"
+)
+
+# The culling kernels only give exactly the same results as Frustum::cull() if the compiler doesn't contract multiplies and adds into FMAs (which GCC does by default
+# wherever the target has them, e.g. on aarch64, and only for some of the expressions)
+if(MSVC)
+   set_source_files_properties("${SRC_DIR}/Math/Frustum.cpp" "${SRC_DIR}/Math/FrustumCulling.cpp" PROPERTIES COMPILE_OPTIONS "/fp:precise")
+else()
+   set_source_files_properties("${SRC_DIR}/Math/Frustum.cpp" "${SRC_DIR}/Math/FrustumCulling.cpp" PROPERTIES COMPILE_OPTIONS "-ffp-contract=off")
+endif(MSVC)
+
+target_sources(${PROJECT_NAME} PRIVATE
+   "${SRC_DIR}/ForgeApplication.cpp"
+   "${SRC_DIR}/ForgeApplication.h"
+   "${SRC_DIR}/Main.cpp"
+   "${SRC_DIR}/PCH.h"
+
    "${SRC_DIR}/Graphics/Buffer.cpp"
    "${SRC_DIR}/Graphics/Buffer.h"
-   "${SRC_DIR}/Graphics/Command.cpp"
-   "${SRC_DIR}/Graphics/Command.h"
    "${SRC_DIR}/Graphics/DebugUtils.cpp"
    "${SRC_DIR}/Graphics/DebugUtils.h"
    "${SRC_DIR}/Graphics/DelayedObjectDestroyer.cpp"
@@ -39,6 +110,7 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Graphics/DescriptorSet.h"
    "${SRC_DIR}/Graphics/DescriptorSetLayoutCache.cpp"
    "${SRC_DIR}/Graphics/DescriptorSetLayoutCache.h"
+   "${SRC_DIR}/Graphics/DynamicBuffer.h"
    "${SRC_DIR}/Graphics/DynamicDescriptorPool.cpp"
    "${SRC_DIR}/Graphics/DynamicDescriptorPool.h"
    "${SRC_DIR}/Graphics/FrameData.h"
@@ -52,31 +124,30 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Graphics/Memory.h"
    "${SRC_DIR}/Graphics/Mesh.cpp"
    "${SRC_DIR}/Graphics/Mesh.h"
+   "${SRC_DIR}/Graphics/MeshArena.cpp"
+   "${SRC_DIR}/Graphics/MeshArena.h"
    "${SRC_DIR}/Graphics/Pipeline.cpp"
    "${SRC_DIR}/Graphics/Pipeline.h"
    "${SRC_DIR}/Graphics/RenderPass.cpp"
    "${SRC_DIR}/Graphics/RenderPass.h"
+   "${SRC_DIR}/Graphics/SecondaryCommandPool.cpp"
+   "${SRC_DIR}/Graphics/SecondaryCommandPool.h"
    "${SRC_DIR}/Graphics/Shader.cpp"
    "${SRC_DIR}/Graphics/Shader.h"
    "${SRC_DIR}/Graphics/ShaderPermutationManager.h"
    "${SRC_DIR}/Graphics/ShaderModule.cpp"
    "${SRC_DIR}/Graphics/ShaderModule.h"
    "${SRC_DIR}/Graphics/SpecializationInfo.h"
+   "${SRC_DIR}/Graphics/StagingRing.cpp"
+   "${SRC_DIR}/Graphics/StagingRing.h"
    "${SRC_DIR}/Graphics/Swapchain.cpp"
    "${SRC_DIR}/Graphics/Swapchain.h"
    "${SRC_DIR}/Graphics/Texture.cpp"
    "${SRC_DIR}/Graphics/Texture.h"
-   "${SRC_DIR}/Graphics/TextureInfo.cpp"
-   "${SRC_DIR}/Graphics/TextureInfo.h"
    "${SRC_DIR}/Graphics/UniformBuffer.h"
+   "${SRC_DIR}/Graphics/UploadQueue.cpp"
+   "${SRC_DIR}/Graphics/UploadQueue.h"
    "${SRC_DIR}/Graphics/Vulkan.cpp"
-   "${SRC_DIR}/Graphics/Vulkan.h"
-
-   "${SRC_DIR}/Math/Bounds.cpp"
-   "${SRC_DIR}/Math/Bounds.h"
-   "${SRC_DIR}/Math/MathUtils.h"
-   "${SRC_DIR}/Math/Transform.cpp"
-   "${SRC_DIR}/Math/Transform.h"
 
    "${SRC_DIR}/Platform/InputManager.cpp"
    "${SRC_DIR}/Platform/InputManager.h"
@@ -84,12 +155,21 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Platform/Window.cpp"
    "${SRC_DIR}/Platform/Window.h"
 
+   "${SRC_DIR}/Renderer/DrawStats.h"
    "${SRC_DIR}/Renderer/ForwardLighting.cpp"
    "${SRC_DIR}/Renderer/ForwardLighting.h"
+   "${SRC_DIR}/Renderer/InstanceBuffer.cpp"
+   "${SRC_DIR}/Renderer/InstanceBuffer.h"
    "${SRC_DIR}/Renderer/Passes/Composite/CompositePass.cpp"
    "${SRC_DIR}/Renderer/Passes/Composite/CompositePass.h"
    "${SRC_DIR}/Renderer/Passes/Composite/CompositeShader.cpp"
    "${SRC_DIR}/Renderer/Passes/Composite/CompositeShader.h"
+   "${SRC_DIR}/Renderer/Passes/Culling/CullingPass.cpp"
+   "${SRC_DIR}/Renderer/Passes/Culling/CullingPass.h"
+   "${SRC_DIR}/Renderer/Passes/Culling/CullShader.cpp"
+   "${SRC_DIR}/Renderer/Passes/Culling/CullShader.h"
+   "${SRC_DIR}/Renderer/Passes/Culling/HiZShader.cpp"
+   "${SRC_DIR}/Renderer/Passes/Culling/HiZShader.h"
    "${SRC_DIR}/Renderer/Passes/Depth/DepthPass.cpp"
    "${SRC_DIR}/Renderer/Passes/Depth/DepthPass.h"
    "${SRC_DIR}/Renderer/Passes/Depth/DepthMaskedShader.cpp"
@@ -138,10 +218,7 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Renderer/ViewInfo.cpp"
    "${SRC_DIR}/Renderer/ViewInfo.h"
 
-   "${SRC_DIR}/Resources/DDSImage.cpp"
-   "${SRC_DIR}/Resources/DDSImage.h"
    "${SRC_DIR}/Resources/ForEachResourceType.inl"
-   "${SRC_DIR}/Resources/Image.h"
    "${SRC_DIR}/Resources/MaterialLoader.cpp"
    "${SRC_DIR}/Resources/MaterialLoader.h"
    "${SRC_DIR}/Resources/MeshLoader.cpp"
@@ -155,28 +232,13 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Resources/ResourceTypes.h"
    "${SRC_DIR}/Resources/ShaderModuleLoader.cpp"
    "${SRC_DIR}/Resources/ShaderModuleLoader.h"
-   "${SRC_DIR}/Resources/STBImage.cpp"
-   "${SRC_DIR}/Resources/STBImage.h"
    "${SRC_DIR}/Resources/TextureLoader.cpp"
    "${SRC_DIR}/Resources/TextureLoader.h"
 
-   "${SRC_DIR}/Scene/Components/CameraComponent.h"
-   "${SRC_DIR}/Scene/Components/LightComponent.h"
    "${SRC_DIR}/Scene/Components/MeshComponent.h"
-   "${SRC_DIR}/Scene/Components/NameComponent.h"
-   "${SRC_DIR}/Scene/Components/OscillatingMovementComponent.h"
    "${SRC_DIR}/Scene/Components/SkyboxComponent.h"
-   "${SRC_DIR}/Scene/Components/TransformComponent.cpp"
-   "${SRC_DIR}/Scene/Components/TransformComponent.h"
-   "${SRC_DIR}/Scene/Entity.cpp"
-   "${SRC_DIR}/Scene/Entity.h"
-   "${SRC_DIR}/Scene/Scene.cpp"
-   "${SRC_DIR}/Scene/Scene.h"
-   "${SRC_DIR}/Scene/System.h"
    "${SRC_DIR}/Scene/Systems/CameraSystem.cpp"
    "${SRC_DIR}/Scene/Systems/CameraSystem.h"
-   "${SRC_DIR}/Scene/Systems/OscillatingMovementSystem.cpp"
-   "${SRC_DIR}/Scene/Systems/OscillatingMovementSystem.h"
 
    "${SRC_DIR}/UI/UI.cpp"
    "${SRC_DIR}/UI/UI.h"
@@ -190,7 +252,10 @@ if(FORGE_WITH_MIDI)
    )
 endif(FORGE_WITH_MIDI)
 
-target_include_directories(${PROJECT_NAME} PUBLIC "${SRC_DIR}")
+target_include_directories(${CORE_LIBRARY_NAME} PUBLIC "${SRC_DIR}")
+
+get_target_property(CORE_SOURCE_FILES ${CORE_LIBRARY_NAME} SOURCES)
+source_group(TREE "${SRC_DIR}" PREFIX Source FILES ${CORE_SOURCE_FILES})
 
 get_target_property(SOURCE_FILES ${PROJECT_NAME} SOURCES)
 source_group(TREE "${SRC_DIR}" PREFIX Source FILES ${SOURCE_FILES})
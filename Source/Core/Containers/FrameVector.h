@@ -1,8 +1,12 @@
 #pragma once
 
+#include "Core/Containers/SmallVector.h"
 #include "Core/Memory/FrameAllocator.h"
 
 #include <vector>
 
 template<typename T>
 using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+template<typename T, std::size_t InlineCapacity>
+using FrameSmallVector = SmallVector<T, InlineCapacity, FrameAllocator<T>>;
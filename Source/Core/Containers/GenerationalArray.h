@@ -4,11 +4,15 @@
 #include "Core/Containers/GenerationalArrayHandle.h"
 #include "Core/Log.h"
 
-#include <optional>
-#include <queue>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
 #include <utility>
 #include <vector>
 
+// Values are stored densely (removal swaps the last value into the hole), with a sparse index -> dense index indirection for handles.
+// Free sparse slots are chained through sparseToDense, so recycling never allocates.
 template<typename T>
 class GenerationalArray
 {
@@ -17,29 +21,26 @@ public:
 
    Handle add(T value)
    {
-      std::size_t index = allocate();
-
-      elements[index].data = std::move(value);
-
-      return createHandle(index);
+      return emplace(std::move(value));
    }
 
    template<typename... Args>
    Handle emplace(Args&&... args)
    {
-      std::size_t index = allocate();
+      uint32_t index = allocate();
 
-      elements[index].data.emplace(std::forward<Args>(args)...);
+      sparseToDense[index] = static_cast<uint32_t>(values.size());
+      values.emplace_back(std::forward<Args>(args)...);
+      denseToSparse.push_back(index);
 
       return createHandle(index);
    }
 
    bool replace(Handle handle, T value)
    {
-      if (Element* element = find(handle))
+      if (T* existingValue = get(handle))
       {
-         ASSERT(element->data.has_value());
-         element->data = std::move(value);
+         *existingValue = std::move(value);
          return true;
       }
 
@@ -49,10 +50,10 @@ public:
    template<typename... Args>
    bool replace(Handle handle, Args&&... args)
    {
-      if (Element* element = find(handle))
+      if (T* existingValue = get(handle))
       {
-         ASSERT(element->data.has_value());
-         element->data.emplace(std::forward<Args>(args)...);
+         std::destroy_at(existingValue);
+         std::construct_at(existingValue, std::forward<Args>(args)...);
          return true;
       }
 
@@ -61,120 +62,157 @@ public:
 
    bool remove(Handle handle)
    {
-      if (Element* element = find(handle))
+      uint32_t denseIndex = findDenseIndex(handle);
+      if (denseIndex == kInvalidIndex)
       {
-         element->data.reset();
-         freeIndices.push(handle.index);
-         return true;
+         return false;
       }
 
-      return false;
+      uint32_t lastDenseIndex = static_cast<uint32_t>(values.size() - 1);
+      if (denseIndex != lastDenseIndex)
+      {
+         uint32_t movedIndex = denseToSparse[lastDenseIndex];
+
+         values[denseIndex] = std::move(values[lastDenseIndex]);
+         denseToSparse[denseIndex] = movedIndex;
+         sparseToDense[movedIndex] = denseIndex;
+      }
+
+      values.pop_back();
+      denseToSparse.pop_back();
+
+      release(handle.index);
+
+      return true;
    }
 
    void removeAll()
    {
-      for (std::size_t i = 0; i < elements.size(); ++i)
+      values.clear();
+
+      for (uint32_t index : denseToSparse)
       {
-         if (elements[i].data.has_value())
-         {
-            elements[i].data.reset();
-            freeIndices.push(i);
-         }
+         release(index);
       }
+      denseToSparse.clear();
    }
 
    T* get(Handle handle)
    {
-      if (Element* element = find(handle))
-      {
-         ASSERT(element->data.has_value());
-         return &element->data.value();
-      }
-
-      return nullptr;
+      uint32_t denseIndex = findDenseIndex(handle);
+      return denseIndex == kInvalidIndex ? nullptr : &values[denseIndex];
    }
 
    const T* get(Handle handle) const
    {
-      if (const Element* element = find(handle))
+      uint32_t denseIndex = findDenseIndex(handle);
+      return denseIndex == kInvalidIndex ? nullptr : &values[denseIndex];
+   }
+
+   std::size_t size() const
+   {
+      return values.size();
+   }
+
+   bool empty() const
+   {
+      return values.empty();
+   }
+
+   // Dense views over all live values, in no particular order. Removing an element invalidates them.
+   std::span<T> getValues()
+   {
+      return values;
+   }
+
+   std::span<const T> getValues() const
+   {
+      return values;
+   }
+
+   template<typename Function>
+   void forEach(Function&& function)
+   {
+      for (std::size_t i = 0; i < values.size(); ++i)
       {
-         ASSERT(element->data.has_value());
-         return &element->data.value();
+         uint32_t index = denseToSparse[i];
+         function(Handle(index, versions[index]), values[i]);
       }
+   }
 
-      return nullptr;
+   template<typename Function>
+   void forEach(Function&& function) const
+   {
+      for (std::size_t i = 0; i < values.size(); ++i)
+      {
+         uint32_t index = denseToSparse[i];
+         function(Handle(index, versions[index]), values[i]);
+      }
    }
 
 private:
-   struct Element
-   {
-      std::optional<T> data;
-      uint16_t version = 0;
-   };
+   static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
 
-   std::size_t allocate()
+   uint32_t allocate()
    {
-      std::size_t index = 0;
+      uint32_t index = firstFreeIndex;
 
-      if (freeIndices.empty())
+      if (index == kInvalidIndex)
       {
-         index = elements.size();
-         elements.emplace_back();
+         ASSERT(versions.size() < kInvalidIndex);
+
+         index = static_cast<uint32_t>(versions.size());
+         versions.push_back(1);
+         sparseToDense.push_back(kInvalidIndex);
       }
       else
       {
-         index = freeIndices.front();
-         freeIndices.pop();
+         firstFreeIndex = sparseToDense[index];
       }
 
       return index;
    }
 
-   Handle createHandle(std::size_t index)
+   void release(uint32_t index)
    {
-      ASSERT(index < elements.size());
-      ASSERT(index < (1 << 16));
-      ASSERT(elements[index].data.has_value());
-
-#if FORGE_WITH_DEBUG_UTILS
-      if (elements[index].version == std::numeric_limits<uint16_t>::max())
+      // Bump the version immediately so that outstanding handles stop resolving
+      uint32_t& version = versions[index];
+      if (version == std::numeric_limits<uint32_t>::max())
       {
+#if FORGE_WITH_DEBUG_UTILS
          LOG_WARNING("Generational array version overflow (index " << index << ")");
-      }
 #endif // FORGE_WITH_DEBUG_UTILS
 
-      uint16_t version = ++elements[index].version;
-      return Handle(static_cast<uint16_t>(index), version);
+         version = 0;
+      }
+      ++version;
+
+      sparseToDense[index] = firstFreeIndex;
+      firstFreeIndex = index;
    }
 
-   Element* find(Handle handle)
+   Handle createHandle(uint32_t index) const
    {
-      if (handle.index < elements.size())
-      {
-         Element& element = elements[handle.index];
-         if (element.data.has_value() && element.version == handle.version)
-         {
-            return &element;
-         }
-      }
+      ASSERT(index < versions.size());
+      ASSERT(sparseToDense[index] < values.size());
 
-      return nullptr;
+      return Handle(index, versions[index]);
    }
 
-   const Element* find(Handle handle) const
+   uint32_t findDenseIndex(Handle handle) const
    {
-      if (handle.index < elements.size())
+      if (handle.isValid() && handle.index < versions.size() && versions[handle.index] == handle.version)
       {
-         const Element& element = elements[handle.index];
-         if (element.data.has_value() && element.version == handle.version)
-         {
-            return &element;
-         }
+         return sparseToDense[handle.index];
       }
 
-      return nullptr;
+      return kInvalidIndex;
    }
 
-   std::vector<Element> elements;
-   std::queue<std::size_t> freeIndices;
+   std::vector<T> values;
+   std::vector<uint32_t> denseToSparse;
+
+   std::vector<uint32_t> versions;
+   std::vector<uint32_t> sparseToDense;
+   uint32_t firstFreeIndex = kInvalidIndex;
 };
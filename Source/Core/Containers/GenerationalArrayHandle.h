@@ -27,25 +27,31 @@ public:
       return isValid();
    }
 
+   // Unique among the valid handles of an array (but reused after a handle is released), which makes it usable as a compact id
+   uint32_t getIndex() const
+   {
+      return index;
+   }
+
    bool operator==(const GenerationalArrayHandle& other) const = default;
 
    std::size_t hash() const
    {
-      return (version << 16) | index;
+      return Hash::of((static_cast<uint64_t>(version) << 32) | index);
    }
 
 private:
    template<typename U>
    friend class GenerationalArray;
 
-   GenerationalArrayHandle(uint16_t indexValue, uint16_t versionValue)
+   GenerationalArrayHandle(uint32_t indexValue, uint32_t versionValue)
       : index(indexValue)
       , version(versionValue)
    {
    }
 
-   uint16_t index = 0;
-   uint16_t version = 0;
+   uint32_t index = 0;
+   uint32_t version = 0;
 };
 
 USE_MEMBER_HASH_FUNCTION_TEMPLATE(typename T, GenerationalArrayHandle<T>);
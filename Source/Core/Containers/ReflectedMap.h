@@ -1,84 +1,217 @@
 #pragma once
 
 #include "Core/Assert.h"
+#include "Core/Hash.h"
 
-#include <unordered_map>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
 
+// Bidirectional map that stores each (A, B) pair once in a dense array, with two open addressing (linear probing) index tables on top.
+// Hashes are computed once on insertion, so large keys are never rehashed when the tables grow.
 template<typename A, typename B>
 class ReflectedMap
 {
 public:
    void add(const A& a, const B& b)
    {
-      aToB[a] = b;
-      bToA[b] = a;
-   }
+      std::size_t hashA = Hash::of(a);
+      std::size_t hashB = Hash::of(b);
 
-   bool remove(const A& a)
-   {
-      auto aLocation = aToB.find(a);
-      if (aLocation != aToB.end())
+      // Keep the mapping one-to-one by dropping any pairs that either value was previously part of
+      removeEntry(findEntry<&Entry::a>(aSlots, a, hashA));
+      removeEntry(findEntry<&Entry::b>(bSlots, b, hashB));
+
+      if ((entries.size() + 1) * kMaxLoadDenominator > aSlots.size() * kMaxLoadNumerator)
       {
-         auto bLocation = bToA.find(aLocation->second);
-         ASSERT(bLocation != bToA.end());
+         rehash(aSlots.empty() ? kMinCapacity : aSlots.size() * 2);
+      }
 
-         bToA.erase(bLocation);
-         aToB.erase(aLocation);
+      uint32_t entryIndex = static_cast<uint32_t>(entries.size());
+      entries.push_back(Entry{ a, b, hashA, hashB });
 
-         return true;
-      }
+      insertSlot(aSlots, entryIndex, hashA);
+      insertSlot(bSlots, entryIndex, hashB);
+   }
 
-      return false;
+   bool remove(const A& a)
+   {
+      return removeEntry(findEntry<&Entry::a>(aSlots, a, Hash::of(a)));
    }
 
    bool remove(const B& b)
    {
-      auto bLocation = bToA.find(b);
-      if (bLocation != bToA.end())
-      {
-         auto aLocation = aToB.find(bLocation->second);
-         ASSERT(aLocation != aToB.end());
-
-         aToB.erase(aLocation);
-         bToA.erase(bLocation);
-
-         return true;
-      }
-
-      return false;
+      return removeEntry(findEntry<&Entry::b>(bSlots, b, Hash::of(b)));
    }
 
    void clear()
    {
-      aToB.clear();
-      bToA.clear();
+      entries.clear();
+      aSlots.clear();
+      bSlots.clear();
+   }
+
+   std::size_t size() const
+   {
+      return entries.size();
    }
 
    B* find(const A& a)
    {
-      auto location = aToB.find(a);
-      return location == aToB.end() ? nullptr : &location->second;
+      uint32_t entryIndex = findEntry<&Entry::a>(aSlots, a, Hash::of(a));
+      return entryIndex == kEmpty ? nullptr : &entries[entryIndex].b;
    }
 
    A* find(const B& b)
    {
-      auto location = bToA.find(b);
-      return location == bToA.end() ? nullptr : &location->second;
+      uint32_t entryIndex = findEntry<&Entry::b>(bSlots, b, Hash::of(b));
+      return entryIndex == kEmpty ? nullptr : &entries[entryIndex].a;
    }
 
    const B* find(const A& a) const
    {
-      auto location = aToB.find(a);
-      return location == aToB.end() ? nullptr : &location->second;
+      uint32_t entryIndex = findEntry<&Entry::a>(aSlots, a, Hash::of(a));
+      return entryIndex == kEmpty ? nullptr : &entries[entryIndex].b;
    }
 
    const A* find(const B& b) const
    {
-      auto location = bToA.find(b);
-      return location == bToA.end() ? nullptr : &location->second;
+      uint32_t entryIndex = findEntry<&Entry::b>(bSlots, b, Hash::of(b));
+      return entryIndex == kEmpty ? nullptr : &entries[entryIndex].a;
    }
 
 private:
-   std::unordered_map<A, B> aToB;
-   std::unordered_map<B, A> bToA;
+   static constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+   static constexpr std::size_t kMinCapacity = 16;
+   static constexpr std::size_t kMaxLoadNumerator = 3;
+   static constexpr std::size_t kMaxLoadDenominator = 4;
+
+   struct Entry
+   {
+      A a;
+      B b;
+      std::size_t hashA = 0;
+      std::size_t hashB = 0;
+   };
+
+   // Slots keep the low bits of the hash so that most mismatches can be rejected without touching the entry
+   struct Slot
+   {
+      uint32_t entryIndex = kEmpty;
+      uint32_t hash = 0;
+   };
+
+   static std::size_t getMask(const std::vector<Slot>& slots)
+   {
+      return slots.size() - 1;
+   }
+
+   template<auto Member, typename Value>
+   uint32_t findEntry(const std::vector<Slot>& slots, const Value& value, std::size_t hash) const
+   {
+      if (slots.empty())
+      {
+         return kEmpty;
+      }
+
+      std::size_t mask = getMask(slots);
+      uint32_t shortHash = static_cast<uint32_t>(hash);
+      for (std::size_t slotIndex = hash & mask; slots[slotIndex].entryIndex != kEmpty; slotIndex = (slotIndex + 1) & mask)
+      {
+         const Slot& slot = slots[slotIndex];
+         if (slot.hash == shortHash && entries[slot.entryIndex].*Member == value)
+         {
+            return slot.entryIndex;
+         }
+      }
+
+      return kEmpty;
+   }
+
+   static std::size_t findSlot(const std::vector<Slot>& slots, uint32_t entryIndex, std::size_t hash)
+   {
+      std::size_t mask = getMask(slots);
+      std::size_t slotIndex = hash & mask;
+      while (slots[slotIndex].entryIndex != entryIndex)
+      {
+         ASSERT(slots[slotIndex].entryIndex != kEmpty);
+         slotIndex = (slotIndex + 1) & mask;
+      }
+
+      return slotIndex;
+   }
+
+   static void insertSlot(std::vector<Slot>& slots, uint32_t entryIndex, std::size_t hash)
+   {
+      std::size_t mask = getMask(slots);
+      std::size_t slotIndex = hash & mask;
+      while (slots[slotIndex].entryIndex != kEmpty)
+      {
+         slotIndex = (slotIndex + 1) & mask;
+      }
+
+      slots[slotIndex] = Slot{ entryIndex, static_cast<uint32_t>(hash) };
+   }
+
+   // Backward shift deletion, which avoids the need for tombstones
+   static void eraseSlot(std::vector<Slot>& slots, std::size_t slotIndex)
+   {
+      std::size_t mask = getMask(slots);
+      std::size_t holeIndex = slotIndex;
+      for (std::size_t nextIndex = (holeIndex + 1) & mask; slots[nextIndex].entryIndex != kEmpty; nextIndex = (nextIndex + 1) & mask)
+      {
+         std::size_t idealIndex = slots[nextIndex].hash & mask;
+         std::size_t distanceToNext = (nextIndex - idealIndex) & mask;
+         std::size_t distanceToHole = (holeIndex - idealIndex) & mask;
+         if (distanceToHole <= distanceToNext)
+         {
+            slots[holeIndex] = slots[nextIndex];
+            holeIndex = nextIndex;
+         }
+      }
+
+      slots[holeIndex] = Slot{};
+   }
+
+   bool removeEntry(uint32_t entryIndex)
+   {
+      if (entryIndex == kEmpty)
+      {
+         return false;
+      }
+
+      eraseSlot(aSlots, findSlot(aSlots, entryIndex, entries[entryIndex].hashA));
+      eraseSlot(bSlots, findSlot(bSlots, entryIndex, entries[entryIndex].hashB));
+
+      uint32_t lastEntryIndex = static_cast<uint32_t>(entries.size() - 1);
+      if (entryIndex != lastEntryIndex)
+      {
+         entries[entryIndex] = std::move(entries[lastEntryIndex]);
+
+         aSlots[findSlot(aSlots, lastEntryIndex, entries[entryIndex].hashA)].entryIndex = entryIndex;
+         bSlots[findSlot(bSlots, lastEntryIndex, entries[entryIndex].hashB)].entryIndex = entryIndex;
+      }
+      entries.pop_back();
+
+      return true;
+   }
+
+   void rehash(std::size_t capacity)
+   {
+      ASSERT((capacity & (capacity - 1)) == 0);
+
+      aSlots.assign(capacity, Slot{});
+      bSlots.assign(capacity, Slot{});
+
+      for (uint32_t entryIndex = 0; entryIndex < entries.size(); ++entryIndex)
+      {
+         insertSlot(aSlots, entryIndex, entries[entryIndex].hashA);
+         insertSlot(bSlots, entryIndex, entries[entryIndex].hashB);
+      }
+   }
+
+   std::vector<Entry> entries;
+   std::vector<Slot> aSlots;
+   std::vector<Slot> bSlots;
 };
@@ -0,0 +1,363 @@
+#pragma once
+
+#include "Core/Assert.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+// Vector that keeps up to InlineCapacity elements inside the object itself, and only allocates (from Allocator) once it grows beyond that
+template<typename T, std::size_t InlineCapacity, typename Allocator = std::allocator<T>>
+class SmallVector : private Allocator
+{
+   static_assert(InlineCapacity > 0, "Use a std::vector if no inline storage is needed");
+   static_assert(std::allocator_traits<Allocator>::is_always_equal::value, "Buffers are moved between vectors without comparing allocators");
+
+   using AllocatorTraits = std::allocator_traits<Allocator>;
+
+public:
+   using value_type = T;
+   using size_type = std::size_t;
+   using iterator = T*;
+   using const_iterator = const T*;
+
+   SmallVector() = default;
+
+   explicit SmallVector(const Allocator& allocator)
+      : Allocator(allocator)
+   {
+   }
+
+   explicit SmallVector(size_type count, const Allocator& allocator = Allocator())
+      : Allocator(allocator)
+   {
+      resize(count);
+   }
+
+   SmallVector(std::initializer_list<T> list, const Allocator& allocator = Allocator())
+      : Allocator(allocator)
+   {
+      reserve(list.size());
+      std::uninitialized_copy(list.begin(), list.end(), elements);
+      used = list.size();
+   }
+
+   SmallVector(const SmallVector& other)
+      : Allocator(AllocatorTraits::select_on_container_copy_construction(other.getAllocator()))
+   {
+      reserve(other.used);
+      std::uninitialized_copy_n(other.elements, other.used, elements);
+      used = other.used;
+   }
+
+   SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+      : Allocator(std::move(other.getAllocator()))
+   {
+      takeElements(std::move(other));
+   }
+
+   ~SmallVector()
+   {
+      std::destroy_n(elements, used);
+      releaseHeapElements();
+   }
+
+   SmallVector& operator=(const SmallVector& other)
+   {
+      if (this != &other)
+      {
+         clear();
+         reserve(other.used);
+         std::uninitialized_copy_n(other.elements, other.used, elements);
+         used = other.used;
+      }
+
+      return *this;
+   }
+
+   SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+   {
+      if (this != &other)
+      {
+         clear();
+         releaseHeapElements();
+         takeElements(std::move(other));
+      }
+
+      return *this;
+   }
+
+   template<typename... Args>
+   T& emplace_back(Args&&... args)
+   {
+      if (used == allocated)
+      {
+         return emplaceBackAndGrow(std::forward<Args>(args)...);
+      }
+
+      T* element = std::construct_at(elements + used, std::forward<Args>(args)...);
+      ++used;
+
+      return *element;
+   }
+
+   void push_back(const T& value)
+   {
+      emplace_back(value);
+   }
+
+   void push_back(T&& value)
+   {
+      emplace_back(std::move(value));
+   }
+
+   void pop_back()
+   {
+      ASSERT(used > 0);
+      std::destroy_at(elements + --used);
+   }
+
+   void clear()
+   {
+      std::destroy_n(elements, used);
+      used = 0;
+   }
+
+   void reserve(size_type newCapacity)
+   {
+      if (newCapacity > allocated)
+      {
+         T* newElements = AllocatorTraits::allocate(getAllocator(), newCapacity);
+         relocateTo(newElements, newCapacity);
+      }
+   }
+
+   void resize(size_type newSize)
+   {
+      if (newSize < used)
+      {
+         std::destroy_n(elements + newSize, used - newSize);
+      }
+      else
+      {
+         reserve(newSize);
+         std::uninitialized_value_construct_n(elements + used, newSize - used);
+      }
+
+      used = newSize;
+   }
+
+   void resize(size_type newSize, const T& value)
+   {
+      if (newSize < used)
+      {
+         std::destroy_n(elements + newSize, used - newSize);
+      }
+      else
+      {
+         reserve(newSize);
+         std::uninitialized_fill_n(elements + used, newSize - used, value);
+      }
+
+      used = newSize;
+   }
+
+   T& operator[](size_type index)
+   {
+      ASSERT(index < used);
+      return elements[index];
+   }
+
+   const T& operator[](size_type index) const
+   {
+      ASSERT(index < used);
+      return elements[index];
+   }
+
+   T& front()
+   {
+      return (*this)[0];
+   }
+
+   const T& front() const
+   {
+      return (*this)[0];
+   }
+
+   T& back()
+   {
+      ASSERT(used > 0);
+      return elements[used - 1];
+   }
+
+   const T& back() const
+   {
+      ASSERT(used > 0);
+      return elements[used - 1];
+   }
+
+   T* data()
+   {
+      return elements;
+   }
+
+   const T* data() const
+   {
+      return elements;
+   }
+
+   iterator begin()
+   {
+      return elements;
+   }
+
+   const_iterator begin() const
+   {
+      return elements;
+   }
+
+   iterator end()
+   {
+      return elements + used;
+   }
+
+   const_iterator end() const
+   {
+      return elements + used;
+   }
+
+   size_type size() const
+   {
+      return used;
+   }
+
+   size_type capacity() const
+   {
+      return allocated;
+   }
+
+   bool empty() const
+   {
+      return used == 0;
+   }
+
+   // Whether the elements have spilled out of the inline storage
+   bool isAllocated() const
+   {
+      return elements != getInlineElements();
+   }
+
+   static constexpr size_type inlineCapacity()
+   {
+      return InlineCapacity;
+   }
+
+   bool operator==(const SmallVector& other) const
+   {
+      return std::equal(begin(), end(), other.begin(), other.end());
+   }
+
+   operator std::span<T>()
+   {
+      return std::span<T>(data(), size());
+   }
+
+   operator std::span<const T>() const
+   {
+      return std::span<const T>(data(), size());
+   }
+
+private:
+   Allocator& getAllocator()
+   {
+      return *this;
+   }
+
+   const Allocator& getAllocator() const
+   {
+      return *this;
+   }
+
+   T* getInlineElements()
+   {
+      return reinterpret_cast<T*>(inlineStorage);
+   }
+
+   const T* getInlineElements() const
+   {
+      return reinterpret_cast<const T*>(inlineStorage);
+   }
+
+   void releaseHeapElements()
+   {
+      if (isAllocated())
+      {
+         AllocatorTraits::deallocate(getAllocator(), elements, allocated);
+         elements = getInlineElements();
+         allocated = InlineCapacity;
+      }
+   }
+
+   // Moves the elements to a new heap buffer (the current elements are destroyed, and the current buffer is released)
+   void relocateTo(T* newElements, size_type newCapacity)
+   {
+      std::uninitialized_move_n(elements, used, newElements);
+      std::destroy_n(elements, used);
+      releaseHeapElements();
+
+      elements = newElements;
+      allocated = newCapacity;
+   }
+
+   // Expects this vector to be empty and using its inline storage
+   void takeElements(SmallVector&& other)
+   {
+      if (other.isAllocated())
+      {
+         elements = other.elements;
+         allocated = other.allocated;
+         used = other.used;
+
+         other.elements = other.getInlineElements();
+         other.allocated = InlineCapacity;
+      }
+      else if constexpr (std::is_trivially_copyable_v<T>)
+      {
+         // Copying the whole (fixed size) inline buffer is cheaper than a loop over a variable number of elements
+         std::memcpy(inlineStorage, other.inlineStorage, sizeof(inlineStorage));
+         used = other.used;
+      }
+      else
+      {
+         std::uninitialized_move_n(other.elements, other.used, elements);
+         std::destroy_n(other.elements, other.used);
+         used = other.used;
+      }
+
+      other.used = 0;
+   }
+
+   template<typename... Args>
+   T& emplaceBackAndGrow(Args&&... args)
+   {
+      size_type newCapacity = std::max<size_type>(allocated * 2, used + 1);
+      T* newElements = AllocatorTraits::allocate(getAllocator(), newCapacity);
+
+      // Construct the new element before moving the existing ones, since the arguments might refer to them
+      T* element = std::construct_at(newElements + used, std::forward<Args>(args)...);
+      relocateTo(newElements, newCapacity);
+      ++used;
+
+      return *element;
+   }
+
+   alignas(T) std::byte inlineStorage[sizeof(T) * InlineCapacity];
+   T* elements = getInlineElements();
+   size_type used = 0;
+   size_type allocated = InlineCapacity;
+};
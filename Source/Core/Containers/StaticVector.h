@@ -105,14 +105,7 @@ public:
 
    std::size_t hash() const
    {
-      std::size_t hashValue = used;
-
-      for (std::size_t i = 0; i < used; ++i)
-      {
-         Hash::combine(hashValue, values[i]);
-      }
-
-      return hashValue;
+      return Hash::of(std::span<const T>(data(), size()));
    }
 
 private:
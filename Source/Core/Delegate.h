@@ -2,23 +2,24 @@
 
 #include "Core/Assert.h"
 #include "Core/DelegateHandle.h"
+#include "Core/InlineFunction.h"
 
 #include <algorithm>
-#include <functional>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
-template<typename RetType, typename... Params>
-class Delegate
+// Bound functions with captures of up to Capacity bytes are stored inline, so binding and executing them never allocates
+template<std::size_t Capacity, typename RetType, typename... Params>
+class BasicDelegate
 {
 public:
    using ReturnType = RetType;
-   using FuncType = std::function<ReturnType(Params...)>;
+   using FuncType = InlineFunction<ReturnType(Params...), Capacity>;
 
-   static Delegate create(FuncType&& func)
+   static BasicDelegate create(FuncType&& func)
    {
-      Delegate delegate;
+      BasicDelegate delegate;
       delegate.bind(std::move(func));
 
       return delegate;
@@ -67,12 +68,12 @@ private:
    DelegateHandle handle;
 };
 
-template<typename RetType, typename... Params>
-class MulticastDelegate
+template<std::size_t Capacity, typename RetType, typename... Params>
+class BasicMulticastDelegate
 {
 public:
    using ReturnType = RetType;
-   using DelegateType = Delegate<ReturnType, Params...>;
+   using DelegateType = BasicDelegate<Capacity, ReturnType, Params...>;
    using FuncType = typename DelegateType::FuncType;
 
    DelegateHandle add(FuncType&& function)
@@ -108,18 +109,22 @@ public:
       }
    }
 
-   std::vector<ReturnType> broadcastWithReturn(Params... params) const
+   // Passes each delegate's return value to the visitor, rather than collecting them into a container
+   template<typename Visitor>
+   void broadcastWithReturn(Visitor&& visitor, Params... params) const requires (!std::is_void_v<RetType>)
    {
-      std::vector<ReturnType> returnValues(delegates.size());
-
-      for (std::size_t i = 0; i < delegates.size(); ++i)
+      for (const DelegateType& delegate : delegates)
       {
-         returnValues[i] = delegates[i].execute(std::forward<Params>(params)...);
+         visitor(delegate.execute(std::forward<Params>(params)...));
       }
-
-      return returnValues;
    }
 
 private:
    std::vector<DelegateType> delegates;
 };
+
+template<typename RetType, typename... Params>
+using Delegate = BasicDelegate<kDefaultInlineFunctionCapacity, RetType, Params...>;
+
+template<typename RetType, typename... Params>
+using MulticastDelegate = BasicMulticastDelegate<kDefaultInlineFunctionCapacity, RetType, Params...>;
@@ -1,5 +1,6 @@
 #pragma once
 
+#define FORGE_WITH_CPU_PROFILING FORGE_WITH_DEBUG_UTILS
 #define FORGE_WITH_GPU_MEMORY_TRACKING FORGE_WITH_DEBUG_UTILS
 #define FORGE_WITH_SHADER_HOT_RELOADING FORGE_WITH_DEBUG_UTILS
 #define FORGE_WITH_VALIDATION_LAYERS FORGE_DEBUG
@@ -2,10 +2,19 @@
 
 #include <glm/glm.hpp>
 
+#include <bit>
+#include <cstdint>
+#include <cstring>
 #include <span>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+#endif
+
 #define USE_MEMBER_HASH_FUNCTION(type_name)\
 template<>\
 struct std::hash<type_name>\
@@ -26,18 +35,160 @@ struct std::hash<type_name>\
    }\
 }
 
+// 64-bit hashing based on wyhash (https://github.com/wangyi-fudan/wyhash, public domain)
 namespace Hash
 {
+   namespace Detail
+   {
+      inline constexpr uint64_t kSecret[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+      inline void multiply(uint64_t& a, uint64_t& b)
+      {
+#if defined(__SIZEOF_INT128__)
+         __uint128_t result = static_cast<__uint128_t>(a) * b;
+         a = static_cast<uint64_t>(result);
+         b = static_cast<uint64_t>(result >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+         a = _umul128(a, b, &b);
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+         uint64_t low = a * b;
+         b = __umulh(a, b);
+         a = low;
+#else
+         uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+         uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32);
+         uint64_t c = t < rl;
+         uint64_t lo = t + (rm1 << 32);
+         c += lo < t;
+         uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+         a = lo;
+         b = hi;
+#endif
+      }
+
+      inline uint64_t mix(uint64_t a, uint64_t b)
+      {
+         multiply(a, b);
+         return a ^ b;
+      }
+
+      inline uint64_t read8(const uint8_t* p)
+      {
+         uint64_t value;
+         std::memcpy(&value, p, sizeof(value));
+         return value;
+      }
+
+      inline uint64_t read4(const uint8_t* p)
+      {
+         uint32_t value;
+         std::memcpy(&value, p, sizeof(value));
+         return value;
+      }
+
+      inline uint64_t read3(const uint8_t* p, std::size_t length)
+      {
+         return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+      }
+   }
+
+   inline uint64_t bytes(const void* data, std::size_t length, uint64_t seed = 0)
+   {
+      using namespace Detail;
+
+      const uint8_t* p = static_cast<const uint8_t*>(data);
+      seed ^= mix(seed ^ kSecret[0], kSecret[1]);
+
+      uint64_t a = 0;
+      uint64_t b = 0;
+      if (length <= 16)
+      {
+         if (length >= 4)
+         {
+            a = (read4(p) << 32) | read4(p + ((length >> 3) << 2));
+            b = (read4(p + length - 4) << 32) | read4(p + length - 4 - ((length >> 3) << 2));
+         }
+         else if (length > 0)
+         {
+            a = read3(p, length);
+         }
+      }
+      else
+      {
+         std::size_t remaining = length;
+         if (remaining >= 48)
+         {
+            // Three independent lanes, which lets the multiplies overlap
+            uint64_t seed1 = seed;
+            uint64_t seed2 = seed;
+            do
+            {
+               seed = mix(read8(p) ^ kSecret[1], read8(p + 8) ^ seed);
+               seed1 = mix(read8(p + 16) ^ kSecret[2], read8(p + 24) ^ seed1);
+               seed2 = mix(read8(p + 32) ^ kSecret[3], read8(p + 40) ^ seed2);
+               p += 48;
+               remaining -= 48;
+            } while (remaining >= 48);
+
+            seed ^= seed1 ^ seed2;
+         }
+
+         while (remaining > 16)
+         {
+            seed = mix(read8(p) ^ kSecret[1], read8(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+         }
+
+         a = read8(p + remaining - 16);
+         b = read8(p + remaining - 8);
+      }
+
+      a ^= kSecret[1];
+      b ^= seed;
+      multiply(a, b);
+
+      return mix(a ^ kSecret[0] ^ length, b ^ kSecret[1]);
+   }
+
+   // True if equal values are guaranteed to have identical bytes, in which case spans of them are hashed in bulk. Other types are hashed one element at a time, since
+   // they may have a hash function (and an equality operator) of their own that ignores some of their bytes. Such types can opt in by specializing this.
+   template<typename T>
+   inline constexpr bool kIsBytewiseHashable = std::is_integral_v<T> || std::is_enum_v<T>;
+
    template<typename T>
    inline std::size_t of(const T& value)
    {
-      return std::hash<T>{}(value);
+      if constexpr (std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>)
+      {
+         // std::hash is the identity function for these on most standard libraries, which clusters badly in power of two tables
+         uint64_t bits = 0;
+         if constexpr (std::is_pointer_v<T>)
+         {
+            bits = reinterpret_cast<uintptr_t>(value);
+         }
+         else
+         {
+            bits = static_cast<uint64_t>(value);
+         }
+
+         return static_cast<std::size_t>(Detail::mix(bits ^ Detail::kSecret[0], Detail::kSecret[1]));
+      }
+      else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+      {
+         std::string_view view = value;
+         return static_cast<std::size_t>(bytes(view.data(), view.size()));
+      }
+      else
+      {
+         return std::hash<T>{}(value);
+      }
    }
 
    template<typename T>
    inline void combine(std::size_t& hash, const T& value)
    {
-      hash ^= Hash::of(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      hash = static_cast<std::size_t>(Detail::mix(hash ^ Detail::kSecret[0], Hash::of(value) ^ Detail::kSecret[1]));
    }
 
    template<typename First, typename... Rest>
@@ -58,14 +209,21 @@ namespace std
    {
       size_t operator()(span<T> values) const
       {
-         size_t hash = values.size();
-
-         for (const auto& value : values)
+         if constexpr (Hash::kIsBytewiseHashable<remove_cv_t<T>>)
          {
-            Hash::combine(hash, value);
+            return static_cast<size_t>(Hash::bytes(values.data(), values.size_bytes(), values.size()));
          }
+         else
+         {
+            size_t hash = values.size();
+
+            for (const auto& value : values)
+            {
+               Hash::combine(hash, value);
+            }
 
-         return hash;
+            return hash;
+         }
       }
    };
 
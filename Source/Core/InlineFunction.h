@@ -0,0 +1,209 @@
+#pragma once
+
+#include "Core/Assert.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+inline constexpr std::size_t kDefaultInlineFunctionCapacity = 4 * sizeof(void*);
+
+// Type-erased callable (like std::function) that stores callables of up to Capacity bytes inline. Larger callables fall back to the heap.
+template<typename Signature, std::size_t Capacity = kDefaultInlineFunctionCapacity>
+class InlineFunction;
+
+template<typename RetType, typename... Params, std::size_t Capacity>
+class InlineFunction<RetType(Params...), Capacity>
+{
+public:
+   template<typename Callable>
+   static constexpr bool kStoredInline = sizeof(Callable) <= Capacity && alignof(Callable) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Callable>;
+
+   InlineFunction() = default;
+
+   InlineFunction(std::nullptr_t)
+   {
+   }
+
+   template<typename Function>
+      requires (!std::is_same_v<std::decay_t<Function>, InlineFunction> && std::is_copy_constructible_v<std::decay_t<Function>> && std::is_invocable_r_v<RetType, std::decay_t<Function>&, Params...>)
+   InlineFunction(Function&& function)
+   {
+      using Callable = std::decay_t<Function>;
+
+      if constexpr (std::is_pointer_v<Callable>)
+      {
+         if (!function)
+         {
+            return;
+         }
+      }
+
+      if constexpr (kStoredInline<Callable>)
+      {
+         new (storage) Callable(std::forward<Function>(function));
+      }
+      else
+      {
+         *reinterpret_cast<Callable**>(storage) = new Callable(std::forward<Function>(function));
+      }
+
+      invoker = &invoke<Callable>;
+      operations = &kOperations<Callable>;
+   }
+
+   InlineFunction(const InlineFunction& other)
+   {
+      if (other.operations)
+      {
+         other.operations->copy(storage, other.storage);
+         invoker = other.invoker;
+         operations = other.operations;
+      }
+   }
+
+   InlineFunction(InlineFunction&& other) noexcept
+   {
+      if (other.operations)
+      {
+         other.operations->move(storage, other.storage);
+         invoker = std::exchange(other.invoker, nullptr);
+         operations = std::exchange(other.operations, nullptr);
+      }
+   }
+
+   ~InlineFunction()
+   {
+      reset();
+   }
+
+   InlineFunction& operator=(const InlineFunction& other)
+   {
+      if (this != &other)
+      {
+         InlineFunction copy(other);
+         *this = std::move(copy);
+      }
+
+      return *this;
+   }
+
+   InlineFunction& operator=(InlineFunction&& other) noexcept
+   {
+      if (this != &other)
+      {
+         reset();
+
+         if (other.operations)
+         {
+            other.operations->move(storage, other.storage);
+            invoker = std::exchange(other.invoker, nullptr);
+            operations = std::exchange(other.operations, nullptr);
+         }
+      }
+
+      return *this;
+   }
+
+   InlineFunction& operator=(std::nullptr_t)
+   {
+      reset();
+      return *this;
+   }
+
+   void reset()
+   {
+      if (operations)
+      {
+         operations->destroy(storage);
+         invoker = nullptr;
+         operations = nullptr;
+      }
+   }
+
+   explicit operator bool() const
+   {
+      return invoker != nullptr;
+   }
+
+   RetType operator()(Params... params) const
+   {
+      ASSERT(invoker);
+      return invoker(storage, std::forward<Params>(params)...);
+   }
+
+private:
+   struct Operations
+   {
+      void (*copy)(void* destination, const void* source);
+      void (*move)(void* destination, void* source);
+      void (*destroy)(void* storage);
+   };
+
+   template<typename Callable>
+   static Callable& get(void* storage)
+   {
+      if constexpr (kStoredInline<Callable>)
+      {
+         return *std::launder(reinterpret_cast<Callable*>(storage));
+      }
+      else
+      {
+         return **reinterpret_cast<Callable**>(storage);
+      }
+   }
+
+   template<typename Callable>
+   static RetType invoke(void* storage, Params&&... params)
+   {
+      return std::invoke(get<Callable>(storage), std::forward<Params>(params)...);
+   }
+
+   template<typename Callable>
+   static constexpr Operations kOperations =
+   {
+      [](void* destination, const void* source)
+      {
+         const Callable& callable = get<Callable>(const_cast<void*>(source));
+         if constexpr (kStoredInline<Callable>)
+         {
+            new (destination) Callable(callable);
+         }
+         else
+         {
+            *reinterpret_cast<Callable**>(destination) = new Callable(callable);
+         }
+      },
+      [](void* destination, void* source)
+      {
+         if constexpr (kStoredInline<Callable>)
+         {
+            Callable& callable = get<Callable>(source);
+            new (destination) Callable(std::move(callable));
+            callable.~Callable();
+         }
+         else
+         {
+            *reinterpret_cast<Callable**>(destination) = std::exchange(*reinterpret_cast<Callable**>(source), nullptr);
+         }
+      },
+      [](void* storage)
+      {
+         if constexpr (kStoredInline<Callable>)
+         {
+            get<Callable>(storage).~Callable();
+         }
+         else
+         {
+            delete *reinterpret_cast<Callable**>(storage);
+         }
+      }
+   };
+
+   RetType (*invoker)(void* storage, Params&&... params) = nullptr;
+   const Operations* operations = nullptr;
+   alignas(std::max_align_t) mutable std::byte storage[Capacity < sizeof(void*) ? sizeof(void*) : Capacity];
+};
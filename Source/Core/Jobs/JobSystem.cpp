@@ -0,0 +1,431 @@
+#include "Core/Jobs/JobSystem.h"
+
+#include "Core/Assert.h"
+#include "Core/Enum.h"
+#include "Core/Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <thread>
+
+struct JobState
+{
+   std::mutex mutex;
+   std::vector<JobFunction> continuations;
+   std::atomic<bool> done = false;
+};
+
+bool JobHandle::isDone() const
+{
+   return state && state->done.load(std::memory_order_acquire);
+}
+
+class JobScheduler
+{
+public:
+   JobScheduler(uint32_t numWorkerThreads);
+   ~JobScheduler();
+
+   uint32_t getNumWorkers() const
+   {
+      return static_cast<uint32_t>(workers.size());
+   }
+
+   static int32_t getCurrentWorkerIndex()
+   {
+      return workerIndex;
+   }
+
+   JobHandle schedule(JobFunction function, JobPriority priority);
+   JobHandle then(const JobHandle& dependency, JobFunction function, JobPriority priority);
+
+   void wait(const JobHandle& handle);
+   void parallelFor(std::size_t count, std::size_t batchSize, const ParallelForFunction& function, JobPriority priority);
+
+private:
+   static constexpr std::size_t kNumPriorities = 3;
+
+   struct Job
+   {
+      JobFunction function;
+      std::shared_ptr<JobState> state;
+      JobPriority priority = JobPriority::Normal;
+   };
+
+   // Owners push and pop from the back, while other threads steal from the front
+   struct WorkQueue
+   {
+      std::mutex mutex;
+      std::array<std::deque<Job>, kNumPriorities> jobs;
+   };
+
+   void push(Job job);
+
+   // Only takes jobs that are at least as urgent as the given priority
+   bool pop(Job& job, JobPriority lowestPriority);
+   bool tryRunJob(JobPriority lowestPriority = JobPriority::Low);
+   void run(Job& job);
+
+   void workerMain(uint32_t index);
+
+   WorkQueue& getInjectionQueue()
+   {
+      return *queues.back();
+   }
+
+   static thread_local int32_t workerIndex;
+
+   std::vector<std::unique_ptr<WorkQueue>> queues;
+   std::vector<std::thread> workers;
+
+   std::mutex sleepMutex;
+   std::condition_variable sleepCondition;
+   std::atomic<uint32_t> numPendingJobs = 0;
+   std::atomic<uint32_t> stealOffset = 0;
+   bool stopping = false;
+};
+
+// static
+thread_local int32_t JobScheduler::workerIndex = -1;
+
+JobScheduler::JobScheduler(uint32_t numWorkerThreads)
+{
+   ASSERT(numWorkerThreads > 0);
+
+   // One queue per worker, plus a shared injection queue for jobs scheduled from non-worker threads
+   queues.reserve(numWorkerThreads + 1);
+   for (uint32_t i = 0; i < numWorkerThreads + 1; ++i)
+   {
+      queues.push_back(std::make_unique<WorkQueue>());
+   }
+
+   workers.reserve(numWorkerThreads);
+   for (uint32_t i = 0; i < numWorkerThreads; ++i)
+   {
+      workers.emplace_back(&JobScheduler::workerMain, this, i);
+   }
+}
+
+JobScheduler::~JobScheduler()
+{
+   {
+      std::lock_guard<std::mutex> lock(sleepMutex);
+      stopping = true;
+   }
+   sleepCondition.notify_all();
+
+   for (std::thread& worker : workers)
+   {
+      worker.join();
+   }
+}
+
+JobHandle JobScheduler::schedule(JobFunction function, JobPriority priority)
+{
+   ASSERT(function);
+
+   std::shared_ptr<JobState> state = std::make_shared<JobState>();
+   push(Job{ std::move(function), state, priority });
+
+   return JobHandle(std::move(state));
+}
+
+JobHandle JobScheduler::then(const JobHandle& dependency, JobFunction function, JobPriority priority)
+{
+   ASSERT(function);
+
+   if (!dependency.isValid())
+   {
+      return schedule(std::move(function), priority);
+   }
+
+   std::shared_ptr<JobState> state = std::make_shared<JobState>();
+   {
+      std::lock_guard<std::mutex> lock(dependency.state->mutex);
+      if (!dependency.state->done.load(std::memory_order_acquire))
+      {
+         // Pushed by whichever thread finishes the dependency
+         dependency.state->continuations.emplace_back([this, function = std::move(function), state, priority]() mutable
+         {
+            push(Job{ std::move(function), std::move(state), priority });
+         });
+
+         return JobHandle(std::move(state));
+      }
+   }
+
+   push(Job{ std::move(function), state, priority });
+   return JobHandle(std::move(state));
+}
+
+void JobScheduler::wait(const JobHandle& handle)
+{
+   if (!handle.isValid())
+   {
+      return;
+   }
+
+   while (!handle.isDone())
+   {
+      if (!tryRunJob())
+      {
+         std::this_thread::yield();
+      }
+   }
+}
+
+void JobScheduler::parallelFor(std::size_t count, std::size_t batchSize, const ParallelForFunction& function, JobPriority priority)
+{
+   batchSize = std::max<std::size_t>(batchSize, 1);
+   std::size_t numBatches = (count + batchSize - 1) / batchSize;
+   if (numBatches <= 1)
+   {
+      if (count > 0)
+      {
+         function(0, count);
+      }
+      return;
+   }
+
+   // Batches that throw still count as finished (their jobs reference this stack frame, so it can't be left until they have all run), and the first exception is
+   // rethrown once everything is done
+   std::atomic<std::size_t> remainingBatches = numBatches - 1;
+   std::mutex exceptionMutex;
+   std::exception_ptr exception;
+   auto runBatch = [&function, &exceptionMutex, &exception](std::size_t begin, std::size_t end)
+   {
+      try
+      {
+         function(begin, end);
+      }
+      catch (...)
+      {
+         std::lock_guard<std::mutex> lock(exceptionMutex);
+         if (!exception)
+         {
+            exception = std::current_exception();
+         }
+      }
+   };
+
+   for (std::size_t batch = 1; batch < numBatches; ++batch)
+   {
+      std::size_t begin = batch * batchSize;
+      std::size_t end = std::min(begin + batchSize, count);
+
+      push(Job{ [&runBatch, &remainingBatches, begin, end]()
+      {
+         runBatch(begin, end);
+         remainingBatches.fetch_sub(1, std::memory_order_acq_rel);
+      }, nullptr, priority });
+   }
+
+   // The calling thread takes the first batch, then helps out until everything has finished. It only helps with jobs that are at least as urgent as its own batches,
+   // so that it can't pick up a long running background job (such as a hierarchy rebuild) and hold up the caller until that finishes.
+   runBatch(0, std::min(batchSize, count));
+
+   while (remainingBatches.load(std::memory_order_acquire) > 0)
+   {
+      if (!tryRunJob(priority))
+      {
+         std::this_thread::yield();
+      }
+   }
+
+   if (exception)
+   {
+      std::rethrow_exception(exception);
+   }
+}
+
+void JobScheduler::push(Job job)
+{
+   // Counted before the job becomes visible, so that popping it can never take the count below zero (at worst, a thread sees the count before the job and retries)
+   {
+      std::lock_guard<std::mutex> lock(sleepMutex);
+      numPendingJobs.fetch_add(1, std::memory_order_release);
+   }
+
+   WorkQueue& queue = workerIndex >= 0 ? *queues[workerIndex] : getInjectionQueue();
+   {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.jobs[Enum::cast(job.priority)].push_back(std::move(job));
+   }
+
+   sleepCondition.notify_one();
+}
+
+bool JobScheduler::pop(Job& job, JobPriority lowestPriority)
+{
+   if (numPendingJobs.load(std::memory_order_acquire) == 0)
+   {
+      return false;
+   }
+
+   std::size_t numQueues = queues.size();
+   std::size_t numPriorities = std::min<std::size_t>(Enum::cast(lowestPriority) + 1, kNumPriorities);
+   for (std::size_t priority = 0; priority < numPriorities; ++priority)
+   {
+      if (workerIndex >= 0)
+      {
+         WorkQueue& ownQueue = *queues[workerIndex];
+         std::lock_guard<std::mutex> lock(ownQueue.mutex);
+         std::deque<Job>& jobs = ownQueue.jobs[priority];
+         if (!jobs.empty())
+         {
+            job = std::move(jobs.back());
+            jobs.pop_back();
+            numPendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+         }
+      }
+
+      // Start from a rotating victim so that thieves don't all hammer the same queue
+      std::size_t offset = stealOffset.fetch_add(1, std::memory_order_relaxed);
+      for (std::size_t i = 0; i < numQueues; ++i)
+      {
+         std::size_t victimIndex = (offset + i) % numQueues;
+         if (static_cast<int32_t>(victimIndex) == workerIndex)
+         {
+            continue;
+         }
+
+         WorkQueue& victimQueue = *queues[victimIndex];
+         std::lock_guard<std::mutex> lock(victimQueue.mutex);
+         std::deque<Job>& jobs = victimQueue.jobs[priority];
+         if (!jobs.empty())
+         {
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            numPendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+         }
+      }
+   }
+
+   return false;
+}
+
+bool JobScheduler::tryRunJob(JobPriority lowestPriority)
+{
+   Job job;
+   if (pop(job, lowestPriority))
+   {
+      run(job);
+      return true;
+   }
+
+   return false;
+}
+
+void JobScheduler::run(Job& job)
+{
+   job.function();
+   job.function = nullptr;
+
+   if (job.state)
+   {
+      std::vector<JobFunction> continuations;
+      {
+         std::lock_guard<std::mutex> lock(job.state->mutex);
+         job.state->done.store(true, std::memory_order_release);
+         continuations = std::move(job.state->continuations);
+      }
+
+      for (JobFunction& continuation : continuations)
+      {
+         continuation();
+      }
+   }
+}
+
+void JobScheduler::workerMain(uint32_t index)
+{
+   workerIndex = static_cast<int32_t>(index);
+   PROFILE_THREAD("Job Worker");
+
+   while (true)
+   {
+      if (tryRunJob())
+      {
+         continue;
+      }
+
+      std::unique_lock<std::mutex> lock(sleepMutex);
+      sleepCondition.wait(lock, [this]() { return stopping || numPendingJobs.load(std::memory_order_acquire) > 0; });
+
+      if (stopping && numPendingJobs.load(std::memory_order_acquire) == 0)
+      {
+         break;
+      }
+   }
+
+   workerIndex = -1;
+}
+
+namespace
+{
+   std::unique_ptr<JobScheduler> scheduler;
+}
+
+namespace JobSystem
+{
+   void initialize(uint32_t numWorkers)
+   {
+      ASSERT(!scheduler);
+
+      if (numWorkers == 0)
+      {
+         numWorkers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+      }
+
+      scheduler = std::make_unique<JobScheduler>(numWorkers);
+   }
+
+   void terminate()
+   {
+      scheduler.reset();
+   }
+
+   bool isInitialized()
+   {
+      return scheduler != nullptr;
+   }
+
+   uint32_t getNumWorkers()
+   {
+      return scheduler ? scheduler->getNumWorkers() : 0;
+   }
+
+   uint32_t getThreadIndex()
+   {
+      return static_cast<uint32_t>(JobScheduler::getCurrentWorkerIndex() + 1);
+   }
+
+   JobHandle schedule(JobFunction function, JobPriority priority)
+   {
+      ASSERT(scheduler, "Job system has not been initialized");
+      return scheduler->schedule(std::move(function), priority);
+   }
+
+   JobHandle then(const JobHandle& dependency, JobFunction function, JobPriority priority)
+   {
+      ASSERT(scheduler, "Job system has not been initialized");
+      return scheduler->then(dependency, std::move(function), priority);
+   }
+
+   void wait(const JobHandle& handle)
+   {
+      ASSERT(scheduler, "Job system has not been initialized");
+      scheduler->wait(handle);
+   }
+
+   void parallelFor(std::size_t count, std::size_t batchSize, const ParallelForFunction& function, JobPriority priority)
+   {
+      ASSERT(scheduler, "Job system has not been initialized");
+      scheduler->parallelFor(count, batchSize, function, priority);
+   }
+}
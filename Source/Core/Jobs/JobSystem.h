@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+enum class JobPriority : uint8_t
+{
+   High,
+   Normal,
+   Low
+};
+
+using JobFunction = std::function<void()>;
+using ParallelForFunction = std::function<void(std::size_t begin, std::size_t end)>;
+
+struct JobState;
+
+class JobHandle
+{
+public:
+   JobHandle() = default;
+
+   bool isValid() const
+   {
+      return state != nullptr;
+   }
+
+   bool isDone() const;
+
+private:
+   friend class JobScheduler;
+
+   JobHandle(std::shared_ptr<JobState> jobState)
+      : state(std::move(jobState))
+   {
+   }
+
+   std::shared_ptr<JobState> state;
+};
+
+namespace JobSystem
+{
+   // Spawns a fixed pool of worker threads (one less than the number of hardware threads by default)
+   void initialize(uint32_t numWorkers = 0);
+
+   // Runs all outstanding jobs to completion, then joins the worker threads
+   void terminate();
+
+   bool isInitialized();
+   uint32_t getNumWorkers();
+
+   // Zero for threads outside of the pool (such as the main thread), otherwise one more than the index of the worker
+   uint32_t getThreadIndex();
+
+   JobHandle schedule(JobFunction function, JobPriority priority = JobPriority::Normal);
+
+   // Schedules a job that will run once the dependency has completed
+   JobHandle then(const JobHandle& dependency, JobFunction function, JobPriority priority = JobPriority::Normal);
+
+   // Blocks until the job has completed, executing other jobs in the meantime
+   void wait(const JobHandle& handle);
+
+   // Splits [0, count) into batches of batchSize and runs them across the workers (and the calling thread), returning once all batches have completed
+   void parallelFor(std::size_t count, std::size_t batchSize, const ParallelForFunction& function, JobPriority priority = JobPriority::High);
+}
@@ -0,0 +1,35 @@
+#include "Core/Json.h"
+
+namespace Json
+{
+   std::string escape(std::string_view value)
+   {
+      static const char* kHexDigits = "0123456789abcdef";
+
+      std::string escaped;
+      escaped.reserve(value.size());
+
+      for (char character : value)
+      {
+         if (character == '"' || character == '\\')
+         {
+            escaped.push_back('\\');
+            escaped.push_back(character);
+         }
+         else if (static_cast<unsigned char>(character) < 0x20)
+         {
+            // Control characters (e.g. newlines in thread names) aren't allowed in JSON strings
+            unsigned char code = static_cast<unsigned char>(character);
+            escaped.append("\\u00");
+            escaped.push_back(kHexDigits[code >> 4]);
+            escaped.push_back(kHexDigits[code & 0xF]);
+         }
+         else
+         {
+            escaped.push_back(character);
+         }
+      }
+
+      return escaped;
+   }
+}
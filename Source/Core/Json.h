@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Helpers for the JSON files written by the profiler and the benchmarks
+namespace Json
+{
+   // Escapes a value for use inside a quoted JSON string
+   std::string escape(std::string_view value);
+}
@@ -1,29 +1,413 @@
 #include "Core/Log.h"
 
+#include "Core/Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <ctime>
 #include <iomanip>
-#include <sstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
 
-namespace Log
+namespace
 {
-   // Used for centering content in the log output
-   std::string center(const std::string& input, int width)
+   struct Slot
+   {
+      static constexpr std::size_t kSize = 128;
+      static constexpr std::size_t kDataSize = kSize - sizeof(std::atomic<uint64_t>);
+
+      std::atomic<uint64_t> sequence = 0;
+      std::array<uint8_t, kDataSize> data;
+   };
+   static_assert(sizeof(Slot) == Slot::kSize);
+   static_assert(sizeof(Log::RecordHeader) <= Slot::kDataSize);
+
+   using RecordBuffer = std::array<uint8_t, Log::Record::kMaxSize>;
+
+   // Bounded multi-producer single-consumer ring of fixed size slots (based on Dmitry Vyukov's bounded queue). A slot's sequence equals its position when it is free for that position, and position + 1 once it holds data.
+   // Records larger than a single slot claim consecutive positions.
+   class RecordRing
    {
-      return std::string((width - input.length()) / 2, ' ') + input + std::string((width - input.length() + 1) / 2, ' ');
+   public:
+      static constexpr uint64_t kCapacity = 1 << 13; // 1 MiB
+
+      RecordRing()
+      {
+         for (uint64_t i = 0; i < kCapacity; ++i)
+         {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+         }
+      }
+
+      bool tryPush(const uint8_t* bytes, std::size_t size)
+      {
+         uint64_t numSlots = (size + Slot::kDataSize - 1) / Slot::kDataSize;
+         uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+         while (true)
+         {
+            // The consumer frees slots in order, so if the last slot is free for this lap, all of the slots before it are too
+            uint64_t lastPosition = position + numSlots - 1;
+            int64_t difference = static_cast<int64_t>(slots[lastPosition % kCapacity].sequence.load(std::memory_order_acquire) - lastPosition);
+
+            if (difference == 0)
+            {
+               if (enqueuePosition.compare_exchange_weak(position, position + numSlots, std::memory_order_relaxed))
+               {
+                  break;
+               }
+            }
+            else if (difference < 0)
+            {
+               return false;
+            }
+            else
+            {
+               position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+         }
+
+         for (uint64_t i = 0; i < numSlots; ++i)
+         {
+            Slot& slot = slots[(position + i) % kCapacity];
+
+            std::size_t offset = i * Slot::kDataSize;
+            std::memcpy(slot.data.data(), bytes + offset, std::min(Slot::kDataSize, size - offset));
+            slot.sequence.store(position + i + 1, std::memory_order_release);
+         }
+
+         return true;
+      }
+
+      bool hasRecord() const
+      {
+         uint64_t position = dequeuePosition.load(std::memory_order_relaxed);
+         return slots[position % kCapacity].sequence.load(std::memory_order_acquire) == position + 1;
+      }
+
+      // Must only be called from one thread at a time
+      bool tryPop(RecordBuffer& buffer)
+      {
+         uint64_t position = dequeuePosition.load(std::memory_order_relaxed);
+
+         Slot& firstSlot = slots[position % kCapacity];
+         if (firstSlot.sequence.load(std::memory_order_acquire) != position + 1)
+         {
+            return false;
+         }
+
+         Log::RecordHeader header;
+         std::memcpy(&header, firstSlot.data.data(), sizeof(header));
+
+         uint64_t numSlots = (header.size + Slot::kDataSize - 1) / Slot::kDataSize;
+         for (uint64_t i = 0; i < numSlots; ++i)
+         {
+            Slot& slot = slots[(position + i) % kCapacity];
+
+            // The producer claimed all of the slots at once, but might still be filling the later ones
+            while (slot.sequence.load(std::memory_order_acquire) != position + i + 1)
+            {
+               std::this_thread::yield();
+            }
+
+            std::size_t offset = i * Slot::kDataSize;
+            std::memcpy(buffer.data() + offset, slot.data.data(), std::min<std::size_t>(Slot::kDataSize, header.size - offset));
+            slot.sequence.store(position + i + kCapacity, std::memory_order_release);
+         }
+
+         dequeuePosition.store(position + numSlots, std::memory_order_release);
+         return true;
+      }
+
+      uint64_t getEnqueuePosition() const
+      {
+         return enqueuePosition.load(std::memory_order_acquire);
+      }
+
+      uint64_t getDequeuePosition() const
+      {
+         return dequeuePosition.load(std::memory_order_acquire);
+      }
+
+   private:
+      std::array<Slot, kCapacity> slots;
+
+      alignas(64) std::atomic<uint64_t> enqueuePosition = 0;
+      alignas(64) std::atomic<uint64_t> dequeuePosition = 0;
+   };
+
+   const char* getSeverityTag(Log::Severity severity)
+   {
+      // Centered to the width of the widest name
+      switch (severity)
+      {
+      case Log::Severity::Debug:
+         return "[  debug  ]";
+      case Log::Severity::Info:
+         return "[  info   ]";
+      case Log::Severity::Message:
+         return "[ message ]";
+      case Log::Severity::Warning:
+         return "[ warning ]";
+      case Log::Severity::Error:
+         return "[  error  ]";
+      case Log::Severity::Fatal:
+         return "[  fatal  ]";
+      default:
+         return "[ unknown ]";
+      }
    }
 
-   // Format time to a string (hh:mm:ss)
-   std::string formatTime(const tm& time)
+   tm getLocalTime(time_t time)
    {
-      std::stringstream ss;
+      tm localTime;
 
-      ss << std::setfill('0')
-         << std::setw(2) << time.tm_hour << ':'
-         << std::setw(2) << time.tm_min << ':'
-         << std::setw(2) << time.tm_sec;
+#if defined(_POSIX_VERSION)
+      localtime_r(&time, &localTime);
+#elif defined(_MSC_VER)
+      localtime_s(&localTime, &time);
+#else
+      localTime = *localtime(&time);
+#endif
 
-      return ss.str();
+      return localTime;
    }
 
+   // Turns binary records into text, reusing its buffers between records
+   class Formatter
+   {
+   public:
+      void write(std::ostream& stream, const RecordBuffer& buffer)
+      {
+         Log::RecordHeader header;
+         std::memcpy(&header, buffer.data(), sizeof(header));
+
+         line.clear();
+         line += header.file;
+         line += '(';
+         appendNumber(header.line);
+         line += "): ";
+         line += getSeverityTag(header.severity);
+         line += " <";
+         appendTime(header.timeNs);
+         line += "> ";
+
+         std::size_t offset = sizeof(header);
+         while (offset < header.size)
+         {
+            offset = appendArgument(buffer, offset);
+         }
+
+         if (header.truncated)
+         {
+            line += " [truncated]";
+         }
+         line += '\n';
+
+         stream.write(line.data(), static_cast<std::streamsize>(line.size()));
+      }
+
+      void writeDropped(std::ostream& stream, uint64_t numDropped)
+      {
+         line.clear();
+         line += "Log: ";
+         line += getSeverityTag(Log::Severity::Warning);
+         line += " Dropped ";
+         appendNumber(numDropped);
+         line += " record(s) because the log queue was full\n";
+
+         stream.write(line.data(), static_cast<std::streamsize>(line.size()));
+      }
+
+   private:
+      template<typename T>
+      void appendNumber(T value, int base = 10)
+      {
+         char characters[32];
+         std::to_chars_result result = std::to_chars(characters, characters + sizeof(characters), value, base);
+         line.append(characters, result.ptr);
+      }
+
+      void appendDouble(double value)
+      {
+         // Matches the default stream formatting
+         char characters[32];
+         std::to_chars_result result = std::to_chars(characters, characters + sizeof(characters), value, std::chars_format::general, 6);
+         line.append(characters, result.ptr);
+      }
+
+      void appendTime(uint64_t timeNs)
+      {
+         // Converting to local time is comparatively slow, so only do it once per second
+         time_t seconds = static_cast<time_t>(timeNs / 1'000'000'000);
+         if (seconds != cachedSeconds)
+         {
+            tm localTime = getLocalTime(seconds);
+
+            char characters[16];
+            std::snprintf(characters, sizeof(characters), "%02d:%02d:%02d", localTime.tm_hour, localTime.tm_min, localTime.tm_sec);
+
+            cachedSeconds = seconds;
+            cachedTime = characters;
+         }
+
+         line += cachedTime;
+      }
+
+      template<typename T>
+      T read(const RecordBuffer& buffer, std::size_t& offset)
+      {
+         T value;
+         std::memcpy(&value, buffer.data() + offset, sizeof(T));
+         offset += sizeof(T);
+
+         return value;
+      }
+
+      std::size_t appendArgument(const RecordBuffer& buffer, std::size_t offset)
+      {
+         using ArgumentType = Log::Record::ArgumentType;
+
+         ArgumentType type = static_cast<ArgumentType>(buffer[offset++]);
+         switch (type)
+         {
+         case ArgumentType::Bool:
+            line += read<uint8_t>(buffer, offset) ? '1' : '0';
+            break;
+         case ArgumentType::Char:
+            line += read<char>(buffer, offset);
+            break;
+         case ArgumentType::Int:
+            appendNumber(read<int64_t>(buffer, offset));
+            break;
+         case ArgumentType::UInt:
+            appendNumber(read<uint64_t>(buffer, offset));
+            break;
+         case ArgumentType::Double:
+            appendDouble(read<double>(buffer, offset));
+            break;
+         case ArgumentType::Pointer:
+            line += "0x";
+            appendNumber(read<uintptr_t>(buffer, offset), 16);
+            break;
+         case ArgumentType::String:
+         {
+            uint16_t length = read<uint16_t>(buffer, offset);
+            line.append(reinterpret_cast<const char*>(buffer.data() + offset), length);
+            offset += length;
+            break;
+         }
+         default:
+            // Corrupt record, skip the rest of it
+            return buffer.size();
+         }
+
+         return offset;
+      }
+
+      std::string line;
+      std::string cachedTime;
+      time_t cachedSeconds = -1;
+   };
+
+   std::atomic<RecordRing*> activeRing = nullptr;
+   RecordRing* ringStorage = nullptr; // Never freed, since other threads might still be submitting records while the program exits
+
+   std::ostream* outputStream = &std::cerr;
+   std::thread writerThread;
+   std::atomic<bool> writerRunning = false;
+   std::atomic<bool> writerWaiting = false;
+   std::atomic<uint32_t> wakeSignal = 0;
+
+   std::atomic<uint64_t> numWritten = 0;
+   std::atomic<uint64_t> numDropped = 0;
+   std::atomic<uint64_t> numTruncated = 0;
+
+   // Used when there is no writer thread
+   std::mutex synchronousMutex;
+   Formatter synchronousFormatter;
+
+   void signalWriter()
+   {
+      wakeSignal.fetch_add(1, std::memory_order_relaxed);
+      wakeSignal.notify_one();
+   }
+
+   // Only signals the writer if it is waiting, so that submitting a record doesn't need a system call while the writer is busy
+   void wakeWriter()
+   {
+      // Pairs with the fence in writerMain, so that either the writer sees the new record, or this sees the writer waiting
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (writerWaiting.load(std::memory_order_relaxed))
+      {
+         signalWriter();
+      }
+   }
+
+   void drain(RecordRing& ring, Formatter& formatter, RecordBuffer& buffer, uint64_t& numReportedDropped)
+   {
+      bool wroteAnything = false;
+      while (ring.tryPop(buffer))
+      {
+         formatter.write(*outputStream, buffer);
+         numWritten.fetch_add(1, std::memory_order_relaxed);
+         wroteAnything = true;
+      }
+
+      uint64_t currentDropped = numDropped.load(std::memory_order_relaxed);
+      if (currentDropped != numReportedDropped)
+      {
+         formatter.writeDropped(*outputStream, currentDropped - numReportedDropped);
+         numReportedDropped = currentDropped;
+         wroteAnything = true;
+      }
+
+      if (wroteAnything)
+      {
+         outputStream->flush();
+      }
+   }
+
+   void writerMain()
+   {
+      PROFILE_THREAD("Log Writer");
+
+      RecordRing& ring = *ringStorage;
+      Formatter formatter;
+      std::unique_ptr<RecordBuffer> buffer = std::make_unique<RecordBuffer>();
+      uint64_t numReportedDropped = numDropped.load(std::memory_order_relaxed);
+
+      while (true)
+      {
+         bool keepRunning = writerRunning.load(std::memory_order_acquire);
+
+         drain(ring, formatter, *buffer, numReportedDropped);
+
+         if (!keepRunning)
+         {
+            break;
+         }
+
+         uint32_t observedSignal = wakeSignal.load(std::memory_order_relaxed);
+         writerWaiting.store(true, std::memory_order_relaxed);
+         std::atomic_thread_fence(std::memory_order_seq_cst);
+
+         if (!ring.hasRecord() && writerRunning.load(std::memory_order_relaxed))
+         {
+            wakeSignal.wait(observedSignal, std::memory_order_relaxed);
+         }
+
+         writerWaiting.store(false, std::memory_order_relaxed);
+      }
+   }
+}
+
+namespace Log
+{
    std::string hex(uint8_t value)
    {
       std::ostringstream stream;
@@ -38,19 +422,133 @@ namespace Log
       return stream.str();
    }
 
-   tm getCurrentTime()
+   void initialize()
    {
-      time_t now(std::time(nullptr));
-      tm time;
+      initialize(std::cerr);
+   }
 
-#if defined(_POSIX_VERSION)
-      localtime_r(&now, &time);
-#elif defined(_MSC_VER)
-      localtime_s(&time, &now);
-#else
-      time = *localtime(&now);
-#endif
+   void initialize(std::ostream& stream)
+   {
+      if (writerRunning.load())
+      {
+         return;
+      }
+
+      if (!ringStorage)
+      {
+         ringStorage = new RecordRing;
+      }
+
+      outputStream = &stream;
+      writerRunning.store(true);
+      writerThread = std::thread(writerMain);
+      activeRing.store(ringStorage, std::memory_order_release);
+   }
+
+   void terminate()
+   {
+      if (!writerRunning.load())
+      {
+         return;
+      }
+
+      // Records submitted while terminating might be written on the next initialization instead
+      activeRing.store(nullptr, std::memory_order_release);
+      writerRunning.store(false, std::memory_order_seq_cst);
+      signalWriter();
+      writerThread.join();
+
+      outputStream = &std::cerr;
+   }
+
+   void flush()
+   {
+      RecordRing* ring = activeRing.load(std::memory_order_acquire);
+      if (!ring)
+      {
+         return;
+      }
+
+      uint64_t target = ring->getEnqueuePosition();
+      while (ring->getDequeuePosition() < target)
+      {
+         wakeWriter();
+         std::this_thread::yield();
+      }
+   }
+
+   Stats getStats()
+   {
+      Stats stats;
+      stats.numWritten = numWritten.load(std::memory_order_relaxed);
+      stats.numDropped = numDropped.load(std::memory_order_relaxed);
+      stats.numTruncated = numTruncated.load(std::memory_order_relaxed);
+
+      return stats;
+   }
+
+   void Record::submit()
+   {
+      header.size = static_cast<uint16_t>(size);
+      if (header.truncated)
+      {
+         numTruncated.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      std::memcpy(bytes.data(), &header, sizeof(header));
+
+      if (RecordRing* ring = activeRing.load(std::memory_order_acquire))
+      {
+         bool pushed = ring->tryPush(bytes.data(), size);
+
+         // Fatal records are followed by an abort, so it's worth waiting for space to make sure they get written
+         while (!pushed && header.severity == Severity::Fatal)
+         {
+            wakeWriter();
+            std::this_thread::yield();
+            pushed = ring->tryPush(bytes.data(), size);
+         }
+
+         if (pushed)
+         {
+            wakeWriter();
+         }
+         else
+         {
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+         }
+      }
+      else
+      {
+         std::lock_guard<std::mutex> lock(synchronousMutex);
+         synchronousFormatter.write(*outputStream, bytes);
+         numWritten.fetch_add(1, std::memory_order_relaxed);
+      }
+   }
+
+   Record& Record::writeString(std::string_view value)
+   {
+      static const std::size_t kArgumentHeaderSize = 1 + sizeof(uint16_t);
+
+      if (header.truncated || size + kArgumentHeaderSize > bytes.size())
+      {
+         header.truncated = true;
+         return *this;
+      }
+
+      std::size_t length = std::min(value.size(), bytes.size() - size - kArgumentHeaderSize);
+      if (length < value.size())
+      {
+         header.truncated = true;
+      }
+
+      uint16_t encodedLength = static_cast<uint16_t>(length);
+      bytes[size++] = static_cast<uint8_t>(ArgumentType::String);
+      std::memcpy(bytes.data() + size, &encodedLength, sizeof(encodedLength));
+      size += sizeof(encodedLength);
+      std::memcpy(bytes.data() + size, value.data(), length);
+      size += length;
 
-      return time;
+      return *this;
    }
 }
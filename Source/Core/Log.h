@@ -1,55 +1,194 @@
 #pragma once
 
-#include <logging.h>
-
+#include <array>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
-#include <ctime>
+#include <filesystem>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace Log
 {
-   std::string center(const std::string& input, int width);
-   std::string formatTime(const tm& time);
+   enum class Severity : uint8_t
+   {
+      Debug,
+      Info,
+      Message,
+      Warning,
+      Error,
+      Fatal
+   };
+
+#if FORGE_WITH_DEBUG_UTILS
+   inline constexpr Severity kMinSeverity = Severity::Debug;
+#else
+   // Logging stays enabled in release builds (it never blocks the calling thread), only debug output is compiled out
+   inline constexpr Severity kMinSeverity = Severity::Info;
+#endif
+
+   struct Stats
+   {
+      uint64_t numWritten = 0;
+      uint64_t numDropped = 0;
+      uint64_t numTruncated = 0;
+   };
+
    std::string hex(uint8_t value);
    std::string hex(uint16_t value);
-   tm getCurrentTime();
 
-   // Text formatting policy
-   class text_formating_policy : public templog::formating_policy_base<text_formating_policy>
+   // Starts the background writer thread. Before initialization (and after termination), records are formatted and written by the logging thread.
+   void initialize();
+   void initialize(std::ostream& outputStream);
+
+   // Writes all pending records and stops the writer thread
+   void terminate();
+
+   // Blocks until every record submitted before the call has been written
+   void flush();
+
+   Stats getStats();
+
+   struct RecordHeader
+   {
+      uint64_t timeNs = 0;
+      const char* file = nullptr;
+      uint32_t line = 0;
+      uint16_t size = 0;
+      Severity severity = Severity::Debug;
+      bool truncated = false;
+   };
+
+   // Captures log arguments as compact tagged binary values, all formatting happens on the writer thread
+   class Record
    {
    public:
-      template<class WritePolicy_, int Sev_, int Aud_, class WriteToken_, class ParamList_>
-      static void write(WriteToken_& token, TEMPLOG_SOURCE_SIGN, const ParamList_& parameters)
-      {
-         // Width of the severity tag in log output (e.g. [ warning ])
-         static const int kSevNameWidth = 9;
-
-         write_obj<WritePolicy_>(token, TEMPLOG_SOURCE_FILE);
-         write_obj<WritePolicy_>(token, "(");
-         write_obj<WritePolicy_>(token, TEMPLOG_SOURCE_LINE);
-         write_obj<WritePolicy_>(token, "): ");
-         write_obj<WritePolicy_>(token, "[");
-         write_obj<WritePolicy_>(token, center(get_name(static_cast<templog::severity>(Sev_)), kSevNameWidth));
-         write_obj<WritePolicy_>(token, "] <");
-         write_obj<WritePolicy_>(token, formatTime(getCurrentTime()));
-         write_obj<WritePolicy_>(token, "> ");
-
-         write_params<WritePolicy_>(token, parameters);
+      static constexpr std::size_t kMaxSize = 2048;
+
+      enum class ArgumentType : uint8_t
+      {
+         Bool,
+         Char,
+         Int,
+         UInt,
+         Double,
+         Pointer,
+         String
+      };
+
+      Record(Severity severity, const char* file, uint32_t line)
+      {
+         header.timeNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+         header.file = file;
+         header.line = line;
+         header.severity = severity;
       }
-   };
 
-#if FORGE_WITH_DEBUG_UTILS
-#  define LOG_CERR_SEV_THRESHOLD templog::sev_debug
-#else
-// Prevent text logging in release builds
-#  define LOG_CERR_SEV_THRESHOLD templog::sev_fatal + 1
-#endif
+      // Records are dropped if the queue is full (fatal records wait for space instead)
+      void submit();
+
+      Record& operator<<(bool value)
+      {
+         return writeArgument(ArgumentType::Bool, static_cast<uint8_t>(value));
+      }
+
+      Record& operator<<(char value)
+      {
+         return writeArgument(ArgumentType::Char, value);
+      }
+
+      // Streams print signed and unsigned chars (including int8_t and uint8_t) as characters rather than numbers, so they are recorded as characters too
+      Record& operator<<(signed char value)
+      {
+         return writeArgument(ArgumentType::Char, static_cast<char>(value));
+      }
+
+      Record& operator<<(unsigned char value)
+      {
+         return writeArgument(ArgumentType::Char, static_cast<char>(value));
+      }
 
-   using cerr_logger = templog::logger<templog::non_filtering_logger<text_formating_policy, templog::std_write_policy>
-                                       , LOG_CERR_SEV_THRESHOLD
-                                       , templog::audience_list<templog::aud_developer>>;
+      template<std::signed_integral T>
+      Record& operator<<(T value)
+      {
+         return writeArgument(ArgumentType::Int, static_cast<int64_t>(value));
+      }
+
+      template<std::unsigned_integral T>
+      Record& operator<<(T value)
+      {
+         return writeArgument(ArgumentType::UInt, static_cast<uint64_t>(value));
+      }
+
+      template<std::floating_point T>
+      Record& operator<<(T value)
+      {
+         return writeArgument(ArgumentType::Double, static_cast<double>(value));
+      }
+
+      Record& operator<<(const void* value)
+      {
+         return writeArgument(ArgumentType::Pointer, reinterpret_cast<uintptr_t>(value));
+      }
+
+      Record& operator<<(const char* value)
+      {
+         return writeString(value ? std::string_view(value) : std::string_view("(null)"));
+      }
+
+      Record& operator<<(std::string_view value)
+      {
+         return writeString(value);
+      }
+
+      Record& operator<<(const std::string& value)
+      {
+         return writeString(value);
+      }
+
+      Record& operator<<(const std::filesystem::path& value)
+      {
+         return writeString(value.string());
+      }
+
+      // Types without a compact encoding are formatted by the logging thread
+      template<typename T>
+      requires (!std::is_arithmetic_v<T> && !std::is_pointer_v<T> && requires(std::ostream& stream, const T& value) { stream << value; })
+      Record& operator<<(const T& value)
+      {
+         std::ostringstream stream;
+         stream << value;
+         return writeString(stream.str());
+      }
+
+   private:
+      template<typename T>
+      Record& writeArgument(ArgumentType type, T value)
+      {
+         if (header.truncated || size + 1 + sizeof(T) > bytes.size())
+         {
+            header.truncated = true;
+            return *this;
+         }
+
+         bytes[size++] = static_cast<uint8_t>(type);
+         std::memcpy(bytes.data() + size, &value, sizeof(T));
+         size += sizeof(T);
 
-#undef LOG_CERR_SEV_THRESHOLD
+         return *this;
+      }
+
+      Record& writeString(std::string_view value);
+
+      // The header is copied to the start of the bytes on submission, so that the record can be pushed with a single copy
+      RecordHeader header;
+      std::size_t size = sizeof(RecordHeader);
+      std::array<uint8_t, kMaxSize> bytes;
+   };
 }
 
 // Simplify logging calls
@@ -61,23 +200,29 @@ namespace Log
 // Error   : For logging errors that do not prevent the program from continuing
 // Fatal   : For logging fatal errors that prevent the program from continuing
 
-#if FORGE_WITH_DEBUG_UTILS
-#  define LOG(log_message, log_severity) do { TEMPLOG_LOG(Log::cerr_logger, log_severity, templog::aud_developer) << log_message; } while (0)
-#else
-#  define LOG(_log_message_, log_severity) do {} while (0)
-#endif
+#define LOG(log_message, log_severity) \
+do \
+{ \
+   if constexpr ((log_severity) >= Log::kMinSeverity) \
+   { \
+      Log::Record logRecord((log_severity), __FILE__, __LINE__); \
+      logRecord << log_message; \
+      logRecord.submit(); \
+   } \
+} while (0)
 
-#define LOG_DEBUG(log_message) LOG(log_message, templog::sev_debug)
-#define LOG_INFO(log_message) LOG(log_message, templog::sev_info)
-#define LOG_MESSAGE(log_message) LOG(log_message, templog::sev_message)
-#define LOG_WARNING(log_message) LOG(log_message, templog::sev_warning)
-#define LOG_ERROR(log_message) LOG(log_message, templog::sev_error)
+#define LOG_DEBUG(log_message) LOG(log_message, Log::Severity::Debug)
+#define LOG_INFO(log_message) LOG(log_message, Log::Severity::Info)
+#define LOG_MESSAGE(log_message) LOG(log_message, Log::Severity::Message)
+#define LOG_WARNING(log_message) LOG(log_message, Log::Severity::Warning)
+#define LOG_ERROR(log_message) LOG(log_message, Log::Severity::Error)
 
 // Fatal errors (kill the program, even in release)
 
 #define LOG_FATAL(log_message) \
 do \
 { \
-   LOG(log_message, templog::sev_fatal); \
+   LOG(log_message, Log::Severity::Fatal); \
+   Log::flush(); \
    abort(); \
 } while(0)
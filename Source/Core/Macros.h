@@ -1,3 +1,6 @@
 #pragma once
 
 #define FORGE_NO_OP do {} while(0)
+
+#define FORGE_CONCAT_IMPL(first, second) first##second
+#define FORGE_CONCAT(first, second) FORGE_CONCAT_IMPL(first, second)
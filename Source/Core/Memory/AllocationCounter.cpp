@@ -0,0 +1,119 @@
+#include "Core/Memory/AllocationCounter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+   std::atomic<uint64_t> allocationCount = 0;
+
+   void* allocate(std::size_t size)
+   {
+      allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+      if (void* pointer = std::malloc(size == 0 ? 1 : size))
+      {
+         return pointer;
+      }
+
+      throw std::bad_alloc();
+   }
+
+   void* allocateAligned(std::size_t size, std::align_val_t alignment)
+   {
+      allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+      std::size_t alignmentValue = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+      void* pointer = _aligned_malloc(size == 0 ? 1 : size, alignmentValue);
+#else
+      void* pointer = std::aligned_alloc(alignmentValue, (std::max<std::size_t>(size, 1) + alignmentValue - 1) / alignmentValue * alignmentValue);
+#endif
+      if (pointer)
+      {
+         return pointer;
+      }
+
+      throw std::bad_alloc();
+   }
+
+   void deallocateAligned(void* pointer)
+   {
+#if defined(_MSC_VER)
+      _aligned_free(pointer);
+#else
+      std::free(pointer);
+#endif
+   }
+}
+
+// Replace the global allocation functions so that tests and benchmarks can check that code doesn't allocate
+void* operator new(std::size_t size)
+{
+   return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+   return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+   return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+   return allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t size) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t size) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept
+{
+   deallocateAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept
+{
+   deallocateAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t size, std::align_val_t alignment) noexcept
+{
+   deallocateAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t size, std::align_val_t alignment) noexcept
+{
+   deallocateAligned(pointer);
+}
+
+namespace AllocationCounter
+{
+   uint64_t getCount()
+   {
+      return allocationCount.load(std::memory_order_relaxed);
+   }
+}
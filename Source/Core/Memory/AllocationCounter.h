@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+// Replaces the global allocation functions with ones that count every allocation. Only compiled into the test and benchmark executables, never into the core library
+// (which the application links against as well).
+namespace AllocationCounter
+{
+   // Number of global operator new calls made so far (by any thread)
+   uint64_t getCount();
+}
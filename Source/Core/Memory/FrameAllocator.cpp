@@ -1,4 +1,144 @@
 #include "Core/Memory/FrameAllocator.h"
 
+#include <algorithm>
+#include <mutex>
+
+#if FORGE_WITH_DEBUG_UTILS
+#  include <cstring>
+#endif // FORGE_WITH_DEBUG_UTILS
+
+namespace
+{
+   // Allows stats to be gathered for every thread that has touched its frame allocator
+   std::mutex registryMutex;
+   std::vector<const FrameAllocatorMemory*> registeredMemory;
+   uint32_t nextThreadIndex = 0;
+}
+
+FrameAllocatorMemory::FrameAllocatorMemory()
+{
+   std::lock_guard<std::mutex> lock(registryMutex);
+   registeredMemory.push_back(this);
+   threadIndex = nextThreadIndex++;
+}
+
+FrameAllocatorMemory::~FrameAllocatorMemory()
+{
+   std::lock_guard<std::mutex> lock(registryMutex);
+   std::erase(registeredMemory, this);
+}
+
+FrameAllocatorStats FrameAllocatorMemory::getStats() const
+{
+   FrameAllocatorStats stats;
+
+   stats.threadIndex = threadIndex;
+   stats.usedBytes = usedBytes.load(std::memory_order_relaxed);
+   stats.peakBytes = peakBytes.load(std::memory_order_relaxed);
+   stats.reservedBytes = reservedBytes.load(std::memory_order_relaxed);
+
+   return stats;
+}
+
+void FrameAllocatorMemory::beginRegion()
+{
+   frameNumber = currentFrameNumber.load(std::memory_order_acquire);
+   regionIndex = frameNumber % kNumRegions;
+
+   resetRegion(regions[regionIndex]);
+   usedBytes.store(0, std::memory_order_relaxed);
+}
+
+void FrameAllocatorMemory::resetRegion(Region& region)
+{
+   // If the region had to grow, replace its chain with a single block big enough to hold everything, so that steady state frames only touch one block
+   if (region.blocks.size() > 1)
+   {
+      std::size_t totalSize = 0;
+      for (const Block& block : region.blocks)
+      {
+         totalSize += block.size;
+      }
+
+      region.blocks.clear();
+      region.blocks.push_back(Block{ std::make_unique_for_overwrite<std::byte[]>(totalSize), totalSize });
+   }
+
+#if FORGE_WITH_DEBUG_UTILS
+   if (!region.blocks.empty())
+   {
+      std::memset(region.blocks[0].data.get(), 0xDE, region.blocks[0].size);
+   }
+#endif // FORGE_WITH_DEBUG_UTILS
+
+   region.blockIndex = 0;
+   region.offset = 0;
+   region.usedBytes = 0;
+}
+
+void* FrameAllocatorMemory::allocateFromNewBlock(std::size_t sizeBytes, std::size_t alignment)
+{
+   Region& region = regions[regionIndex];
+
+   // Skip over any remaining (too small) blocks in the chain
+   while (region.blockIndex + 1 < region.blocks.size())
+   {
+      ++region.blockIndex;
+
+      Block& block = region.blocks[region.blockIndex];
+      void* alignedPointer = block.data.get();
+      std::size_t space = block.size;
+      if (std::align(alignment, sizeBytes, alignedPointer, space))
+      {
+         region.offset = block.size - space + sizeBytes;
+         recordUsage(region.offset);
+
+         return alignedPointer;
+      }
+   }
+
+   std::size_t blockSize = std::max(kDefaultBlockSize, sizeBytes + alignment);
+   region.blocks.push_back(Block{ std::make_unique_for_overwrite<std::byte[]>(blockSize), blockSize });
+   region.blockIndex = region.blocks.size() - 1;
+   reservedBytes.fetch_add(blockSize, std::memory_order_relaxed);
+
+   Block& block = region.blocks.back();
+   void* alignedPointer = block.data.get();
+   std::size_t space = block.size;
+   std::align(alignment, sizeBytes, alignedPointer, space);
+   ASSERT(alignedPointer);
+
+   region.offset = block.size - space + sizeBytes;
+   recordUsage(region.offset);
+
+   return alignedPointer;
+}
+
+// static
+void FrameAllocatorBase::beginFrame()
+{
+   FrameAllocatorMemory::currentFrameNumber.fetch_add(1, std::memory_order_acq_rel);
+}
+
+// static
+std::vector<FrameAllocatorStats> FrameAllocatorBase::getStats()
+{
+   std::lock_guard<std::mutex> lock(registryMutex);
+
+   std::vector<FrameAllocatorStats> stats;
+   stats.reserve(registeredMemory.size());
+   for (const FrameAllocatorMemory* threadMemory : registeredMemory)
+   {
+      stats.push_back(threadMemory->getStats());
+   }
+
+   std::sort(stats.begin(), stats.end(), [](const FrameAllocatorStats& first, const FrameAllocatorStats& second) { return first.threadIndex < second.threadIndex; });
+
+   return stats;
+}
+
+// static
+std::atomic<uint64_t> FrameAllocatorMemory::currentFrameNumber = 0;
+
 // static
-thread_local FrameAllocatorMemory<FrameAllocatorBase::kNumBytes> FrameAllocatorBase::memory;
+thread_local FrameAllocatorMemory FrameAllocatorBase::memory;
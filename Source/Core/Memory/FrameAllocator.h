@@ -3,72 +3,125 @@
 #include "Core/Assert.h"
 
 #include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
 #include <new>
+#include <vector>
 
-#if FORGE_WITH_DEBUG_UTILS
-#  include <cstring>
-#endif // FORGE_WITH_DEBUG_UTILS
+struct FrameAllocatorStats
+{
+   uint32_t threadIndex = 0;
+   std::size_t usedBytes = 0; // Bytes allocated so far in the current frame
+   std::size_t peakBytes = 0; // Most bytes ever allocated in a single frame
+   std::size_t reservedBytes = 0; // Bytes held across all frame regions
+};
 
-template<std::size_t Size>
+// Chained-block arena with one region per frame in flight. Regions grow on demand, and are coalesced into a single block when they are recycled.
 class FrameAllocatorMemory
 {
 public:
+   static constexpr uint32_t kNumRegions = 3;
+   static constexpr std::size_t kDefaultBlockSize = 1024 * 1024;
+
+   FrameAllocatorMemory();
+   ~FrameAllocatorMemory();
+
    template<typename T>
    T* allocate(std::size_t elementCount)
    {
       std::size_t sizeBytes = elementCount * sizeof(T);
       ASSERT(sizeBytes > 0);
 
-      void* alignedPointer = data.data() + offset;
-      std::size_t space = Size - offset;
-      std::align(alignof(T), sizeBytes, alignedPointer, space);
-      ASSERT(alignedPointer, "Not enough space for aligned frame allocation (%lu bytes requested, %lu bytes available, %lu byte alignment)", sizeBytes, space, alignof(T));
+      return std::launder(reinterpret_cast<T*>(allocateBytes(sizeBytes, alignof(T))));
+   }
 
-      if (alignedPointer)
+   void* allocateBytes(std::size_t sizeBytes, std::size_t alignment)
+   {
+      if (frameNumber != currentFrameNumber.load(std::memory_order_acquire))
       {
-         space -= sizeBytes;
-         offset = Size - space;
+         beginRegion();
       }
 
-      return std::launder(reinterpret_cast<T*>(alignedPointer));
+      Region& region = regions[regionIndex];
+      if (region.blockIndex < region.blocks.size())
+      {
+         Block& block = region.blocks[region.blockIndex];
+
+         void* alignedPointer = block.data.get() + region.offset;
+         std::size_t space = block.size - region.offset;
+         if (std::align(alignment, sizeBytes, alignedPointer, space))
+         {
+            std::size_t newOffset = block.size - space + sizeBytes;
+            recordUsage(newOffset - region.offset);
+            region.offset = newOffset;
+
+            return alignedPointer;
+         }
+      }
+
+      return allocateFromNewBlock(sizeBytes, alignment);
    }
 
-#if FORGE_WITH_DEBUG_UTILS
-   FrameAllocatorMemory()
+   FrameAllocatorStats getStats() const;
+
+private:
+   friend class FrameAllocatorBase;
+
+   struct Block
    {
-      reset();
-   }
-#endif // FORGE_WITH_DEBUG_UTILS
+      std::unique_ptr<std::byte[]> data;
+      std::size_t size = 0;
+   };
 
-   void reset()
+   struct Region
    {
-      offset = 0;
+      std::vector<Block> blocks;
+      std::size_t blockIndex = 0;
+      std::size_t offset = 0;
+      std::size_t usedBytes = 0;
+   };
 
-#if FORGE_WITH_DEBUG_UTILS
-      std::memset(data.data(), 0xDE, Size);
-#endif // FORGE_WITH_DEBUG_UTILS
+   void beginRegion();
+   void resetRegion(Region& region);
+   void* allocateFromNewBlock(std::size_t sizeBytes, std::size_t alignment);
+
+   void recordUsage(std::size_t numBytes)
+   {
+      Region& region = regions[regionIndex];
+      region.usedBytes += numBytes;
+
+      usedBytes.store(region.usedBytes, std::memory_order_relaxed);
+      if (region.usedBytes > peakBytes.load(std::memory_order_relaxed))
+      {
+         peakBytes.store(region.usedBytes, std::memory_order_relaxed);
+      }
    }
 
-private:
-   std::size_t offset = 0;
-   std::array<std::byte, Size> data;
+   static std::atomic<uint64_t> currentFrameNumber;
+
+   std::array<Region, kNumRegions> regions;
+   uint32_t regionIndex = 0;
+   uint64_t frameNumber = 0;
+
+   uint32_t threadIndex = 0;
+   std::atomic<std::size_t> usedBytes = 0;
+   std::atomic<std::size_t> peakBytes = 0;
+   std::atomic<std::size_t> reservedBytes = 0;
 };
 
 class FrameAllocatorBase
 {
 public:
-   static void reset()
-   {
-      memory.reset();
-   }
+   // Advances every thread to the next frame region. Memory handed out during a frame stays valid until the same region comes around again, kNumRegions frames later.
+   static void beginFrame();
 
-protected:
-   static constexpr std::size_t kNumBytes = 1024 * 1024;
+   static std::vector<FrameAllocatorStats> getStats();
 
-   static thread_local FrameAllocatorMemory<kNumBytes> memory;
+protected:
+   static thread_local FrameAllocatorMemory memory;
 };
 
 template<typename T>
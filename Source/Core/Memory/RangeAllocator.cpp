@@ -0,0 +1,73 @@
+#include "Core/Memory/RangeAllocator.h"
+
+#include "Core/Assert.h"
+
+#include <algorithm>
+
+RangeAllocator::RangeAllocator(uint32_t rangeCapacity)
+   : capacity(rangeCapacity)
+   , freeSize(rangeCapacity)
+{
+   if (capacity > 0)
+   {
+      freeRanges.push_back(Range{ 0, capacity });
+   }
+}
+
+uint32_t RangeAllocator::allocate(uint32_t size)
+{
+   ASSERT(size > 0);
+
+   auto location = std::find_if(freeRanges.begin(), freeRanges.end(), [size](const Range& range) { return range.size >= size; });
+   if (location == freeRanges.end())
+   {
+      return kInvalidOffset;
+   }
+
+   uint32_t offset = location->offset;
+   if (location->size == size)
+   {
+      freeRanges.erase(location);
+   }
+   else
+   {
+      location->offset += size;
+      location->size -= size;
+   }
+
+   freeSize -= size;
+   return offset;
+}
+
+void RangeAllocator::free(uint32_t offset, uint32_t size)
+{
+   ASSERT(size > 0 && offset + size <= capacity);
+
+   auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), offset, [](const Range& range, uint32_t value) { return range.offset < value; });
+   ASSERT(next == freeRanges.end() || offset + size <= next->offset, "Range overlaps a free range");
+
+   bool mergesWithPrevious = next != freeRanges.begin() && (next - 1)->offset + (next - 1)->size == offset;
+   bool mergesWithNext = next != freeRanges.end() && offset + size == next->offset;
+
+   if (mergesWithPrevious && mergesWithNext)
+   {
+      (next - 1)->size += size + next->size;
+      freeRanges.erase(next);
+   }
+   else if (mergesWithPrevious)
+   {
+      (next - 1)->size += size;
+   }
+   else if (mergesWithNext)
+   {
+      next->offset = offset;
+      next->size += size;
+   }
+   else
+   {
+      ASSERT(next == freeRanges.begin() || (next - 1)->offset + (next - 1)->size <= offset, "Range overlaps a free range");
+      freeRanges.insert(next, Range{ offset, size });
+   }
+
+   freeSize += size;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Suballocates ranges of a fixed size space with a first fit free list. Freed ranges are merged with their free neighbors.
+class RangeAllocator
+{
+public:
+   static constexpr uint32_t kInvalidOffset = ~0u;
+
+   RangeAllocator(uint32_t rangeCapacity);
+
+   // Returns kInvalidOffset if no free range is large enough
+   uint32_t allocate(uint32_t size);
+   void free(uint32_t offset, uint32_t size);
+
+   uint32_t getCapacity() const
+   {
+      return capacity;
+   }
+
+   uint32_t getFreeSize() const
+   {
+      return freeSize;
+   }
+
+private:
+   struct Range
+   {
+      uint32_t offset = 0;
+      uint32_t size = 0;
+   };
+
+   // Sorted by offset
+   std::vector<Range> freeRanges;
+   uint32_t capacity = 0;
+   uint32_t freeSize = 0;
+};
@@ -0,0 +1,188 @@
+#include "Core/Profiler.h"
+
+#if FORGE_WITH_CPU_PROFILING
+
+#include "Core/Json.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace
+{
+   struct ProfileEvent
+   {
+      std::atomic<const char*> name = nullptr;
+      std::atomic<uint64_t> startNs = 0;
+      std::atomic<uint64_t> endNs = 0;
+   };
+
+   // Single producer ring buffer, written only by its owning thread. Readers skip the oldest events, since those are the ones that might be overwritten while being read.
+   struct ThreadBuffer
+   {
+      static constexpr uint64_t kCapacity = 1 << 14;
+      static constexpr uint64_t kReadMargin = 1 << 10;
+
+      std::array<ProfileEvent, kCapacity> events;
+      std::atomic<uint64_t> writeIndex = 0;
+      std::atomic<const char*> threadName = nullptr;
+      uint32_t threadIndex = 0;
+
+      template<typename Function>
+      void forEachEventReversed(Function&& function) const
+      {
+         uint64_t end = writeIndex.load(std::memory_order_acquire);
+         uint64_t begin = end > kCapacity - kReadMargin ? end - (kCapacity - kReadMargin) : 0;
+
+         for (uint64_t i = end; i > begin; --i)
+         {
+            const ProfileEvent& event = events[(i - 1) % kCapacity];
+            if (!function(event.name.load(std::memory_order_relaxed), event.startNs.load(std::memory_order_relaxed), event.endNs.load(std::memory_order_relaxed)))
+            {
+               break;
+            }
+         }
+      }
+   };
+
+   std::mutex registryMutex;
+   std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+   thread_local ThreadBuffer* currentThreadBuffer = nullptr;
+
+   std::atomic<uint64_t> previousFrameStartNs = 0;
+   std::atomic<uint64_t> currentFrameStartNs = 0;
+
+   ThreadBuffer& getThreadBuffer()
+   {
+      if (!currentThreadBuffer)
+      {
+         std::unique_ptr<ThreadBuffer> threadBuffer = std::make_unique<ThreadBuffer>();
+         currentThreadBuffer = threadBuffer.get();
+
+         // Buffers are never freed, so events from threads that have exited can still be exported
+         std::lock_guard<std::mutex> lock(registryMutex);
+         threadBuffer->threadIndex = static_cast<uint32_t>(threadBuffers.size());
+         threadBuffers.push_back(std::move(threadBuffer));
+      }
+
+      return *currentThreadBuffer;
+   }
+}
+
+namespace Profiler
+{
+   void record(const char* name, uint64_t startNs, uint64_t endNs)
+   {
+      ThreadBuffer& threadBuffer = getThreadBuffer();
+
+      uint64_t index = threadBuffer.writeIndex.load(std::memory_order_relaxed);
+      ProfileEvent& event = threadBuffer.events[index % ThreadBuffer::kCapacity];
+      event.name.store(name, std::memory_order_relaxed);
+      event.startNs.store(startNs, std::memory_order_relaxed);
+      event.endNs.store(endNs, std::memory_order_relaxed);
+
+      threadBuffer.writeIndex.store(index + 1, std::memory_order_release);
+   }
+
+   void setThreadName(const char* name)
+   {
+      getThreadBuffer().threadName.store(name, std::memory_order_relaxed);
+   }
+
+   void beginFrame()
+   {
+      previousFrameStartNs.store(currentFrameStartNs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      currentFrameStartNs.store(now(), std::memory_order_relaxed);
+   }
+
+   std::vector<ZoneStats> getZoneStats()
+   {
+      static const double kNanosecondsPerMillisecond = 1'000'000.0;
+
+      uint64_t frameStartNs = previousFrameStartNs.load(std::memory_order_relaxed);
+      uint64_t frameEndNs = currentFrameStartNs.load(std::memory_order_relaxed);
+
+      std::vector<ZoneStats> zoneStats;
+
+      std::lock_guard<std::mutex> lock(registryMutex);
+      for (const std::unique_ptr<ThreadBuffer>& threadBuffer : threadBuffers)
+      {
+         // Events are recorded in order of completion, so walk backwards until reaching the previous frame
+         threadBuffer->forEachEventReversed([&](const char* name, uint64_t startNs, uint64_t endNs)
+         {
+            if (endNs < frameStartNs)
+            {
+               return false;
+            }
+
+            if (name && startNs >= frameStartNs && startNs < frameEndNs)
+            {
+               std::string_view nameView = name;
+               auto location = std::find_if(zoneStats.begin(), zoneStats.end(), [nameView](const ZoneStats& stats) { return stats.name == nameView; });
+               if (location == zoneStats.end())
+               {
+                  location = zoneStats.insert(zoneStats.end(), ZoneStats{ nameView });
+               }
+
+               double durationMs = (endNs - startNs) / kNanosecondsPerMillisecond;
+               ++location->calls;
+               location->totalMs += durationMs;
+               location->maxMs = std::max(location->maxMs, durationMs);
+            }
+
+            return true;
+         });
+      }
+
+      std::sort(zoneStats.begin(), zoneStats.end(), [](const ZoneStats& first, const ZoneStats& second) { return first.totalMs > second.totalMs; });
+
+      return zoneStats;
+   }
+
+   bool exportChromeTrace(const std::filesystem::path& path)
+   {
+      static const double kNanosecondsPerMicrosecond = 1'000.0;
+
+      std::ofstream file(path);
+      if (!file)
+      {
+         return false;
+      }
+
+      file << std::fixed << std::setprecision(3);
+      file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+      bool first = true;
+      std::lock_guard<std::mutex> lock(registryMutex);
+      for (const std::unique_ptr<ThreadBuffer>& threadBuffer : threadBuffers)
+      {
+         if (const char* threadName = threadBuffer->threadName.load(std::memory_order_relaxed))
+         {
+            file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadBuffer->threadIndex << ",\"args\":{\"name\":\"" << Json::escape(threadName) << "\"}}";
+            first = false;
+         }
+
+         threadBuffer->forEachEventReversed([&](const char* name, uint64_t startNs, uint64_t endNs)
+         {
+            if (name)
+            {
+               file << (first ? "" : ",") << "\n{\"name\":\"" << Json::escape(name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadBuffer->threadIndex << ",\"ts\":" << startNs / kNanosecondsPerMicrosecond << ",\"dur\":" << (endNs - startNs) / kNanosecondsPerMicrosecond << "}";
+               first = false;
+            }
+
+            return true;
+         });
+      }
+
+      file << "\n]}\n";
+
+      return file.good();
+   }
+}
+
+#endif // FORGE_WITH_CPU_PROFILING
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Core/Features.h"
+#include "Core/Macros.h"
+
+#if FORGE_WITH_CPU_PROFILING
+
+#  include <chrono>
+#  include <cstdint>
+#  include <filesystem>
+#  include <string_view>
+#  include <vector>
+
+namespace Profiler
+{
+   struct ZoneStats
+   {
+      std::string_view name;
+      uint32_t calls = 0;
+      double totalMs = 0.0;
+      double maxMs = 0.0;
+   };
+
+   inline uint64_t now()
+   {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+   }
+
+   // Zone names must have static storage duration (string literals), since only the pointer is recorded
+   void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+   void setThreadName(const char* name);
+
+   // Marks a frame boundary, which is what getZoneStats() aggregates over
+   void beginFrame();
+
+   // Per-zone timings (across all threads) for the last complete frame, sorted by total time
+   std::vector<ZoneStats> getZoneStats();
+
+   // Writes every event still held in the ring buffers as Chrome trace event JSON (loadable in Perfetto or chrome://tracing)
+   bool exportChromeTrace(const std::filesystem::path& path);
+
+   class Scope
+   {
+   public:
+      Scope(const char* zoneName)
+         : name(zoneName)
+         , startNs(now())
+      {
+      }
+
+      ~Scope()
+      {
+         record(name, startNs, now());
+      }
+
+   private:
+      const char* name = nullptr;
+      uint64_t startNs = 0;
+   };
+}
+
+#  define PROFILE_SCOPE(zone_name) Profiler::Scope FORGE_CONCAT(profileScope, __LINE__)(zone_name)
+#  define PROFILE_THREAD(thread_name) Profiler::setThreadName(thread_name)
+
+#else
+
+#  define PROFILE_SCOPE(zone_name) FORGE_NO_OP
+#  define PROFILE_THREAD(thread_name) FORGE_NO_OP
+
+#endif // FORGE_WITH_CPU_PROFILING
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Core/Assert.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+
+// Stable least significant digit radix sort by a 64-bit key (one byte per pass). Passes over bytes that are the same for every key are skipped, so keys that only use some
+// of their bits cost fewer passes. The scratch span must be at least as large as the values span.
+template<typename T, typename KeyFunction>
+void radixSort(std::span<T> values, std::span<T> scratch, KeyFunction&& getKey)
+{
+   static constexpr uint32_t kBitsPerPass = 8;
+   static constexpr uint32_t kNumPasses = 64 / kBitsPerPass;
+   static constexpr uint32_t kNumBuckets = 1 << kBitsPerPass;
+   static constexpr uint64_t kBucketMask = kNumBuckets - 1;
+
+   ASSERT(scratch.size() >= values.size());
+   ASSERT(values.size() <= std::numeric_limits<uint32_t>::max());
+
+   uint32_t count = static_cast<uint32_t>(values.size());
+   if (count < 2)
+   {
+      return;
+   }
+
+   // Histograms for every pass are built with a single read of the keys
+   std::array<std::array<uint32_t, kNumBuckets>, kNumPasses> histograms = {};
+   for (const T& value : values)
+   {
+      uint64_t key = getKey(value);
+      for (uint32_t pass = 0; pass < kNumPasses; ++pass)
+      {
+         ++histograms[pass][(key >> (pass * kBitsPerPass)) & kBucketMask];
+      }
+   }
+
+   T* source = values.data();
+   T* destination = scratch.data();
+   uint64_t firstKey = getKey(values[0]);
+
+   for (uint32_t pass = 0; pass < kNumPasses; ++pass)
+   {
+      uint32_t shift = pass * kBitsPerPass;
+      std::array<uint32_t, kNumBuckets>& histogram = histograms[pass];
+      if (histogram[(firstKey >> shift) & kBucketMask] == count)
+      {
+         continue;
+      }
+
+      uint32_t offset = 0;
+      for (uint32_t& bucket : histogram)
+      {
+         uint32_t bucketCount = bucket;
+         bucket = offset;
+         offset += bucketCount;
+      }
+
+      for (uint32_t i = 0; i < count; ++i)
+      {
+         destination[histogram[(getKey(source[i]) >> shift) & kBucketMask]++] = std::move(source[i]);
+      }
+
+      std::swap(source, destination);
+   }
+
+   if (source != values.data())
+   {
+      std::move(source, source + count, values.data());
+   }
+}
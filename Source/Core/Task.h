@@ -1,17 +1,38 @@
 #pragma once
 
-#include "Core/Hash.h"
+#include "Core/Jobs/JobSystem.h"
 
 #include <chrono>
+#include <functional>
 #include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 template<typename T>
 class Task
 {
 public:
-   template<typename... Args>
-   Task(Args&&... args)
-      : future(std::async(std::launch::async, std::forward<Args>(args)...))
+   template<typename Function, typename... Args>
+   Task(JobPriority priority, Function&& function, Args&&... args)
+   {
+      // packaged_task is move-only, but jobs need to be copyable
+      std::shared_ptr<std::packaged_task<T()>> packagedTask = std::make_shared<std::packaged_task<T()>>([function = std::forward<Function>(function), ...args = std::forward<Args>(args)]() mutable
+      {
+         return std::invoke(std::move(function), std::move(args)...);
+      });
+
+      future = packagedTask->get_future();
+      jobHandle = JobSystem::schedule([packagedTask]()
+      {
+         (*packagedTask)();
+      }, priority);
+   }
+
+   template<typename Function, typename... Args>
+      requires (!std::is_same_v<std::decay_t<Function>, Task> && !std::is_same_v<std::decay_t<Function>, JobPriority>)
+   Task(Function&& function, Args&&... args)
+      : Task(JobPriority::Normal, std::forward<Function>(function), std::forward<Args>(args)...)
    {
    }
 
@@ -30,6 +51,12 @@ public:
       return future.get();
    }
 
+   const JobHandle& getJobHandle() const
+   {
+      return jobHandle;
+   }
+
 private:
    std::future<T> future;
+   JobHandle jobHandle;
 };
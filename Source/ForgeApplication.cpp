@@ -1,11 +1,15 @@
 #include "ForgeApplication.h"
 
 #include "Core/Assert.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Core/Log.h"
+#include "Core/Profiler.h"
 
 #include "Graphics/DebugUtils.h"
 #include "Graphics/GraphicsContext.h"
 #include "Graphics/Mesh.h"
 #include "Graphics/Swapchain.h"
+#include "Graphics/UploadQueue.h"
 
 #if FORGE_WITH_MIDI
 #  include "Platform/Midi.h"
@@ -33,8 +37,10 @@
 
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <array>
 #include <stdexcept>
+#include <string>
 
 namespace
 {
@@ -54,8 +60,12 @@ namespace
    }
 }
 
-ForgeApplication::ForgeApplication()
+ForgeApplication::ForgeApplication(uint32_t initialStressGridSize)
+   : stressGridSize(initialStressGridSize)
 {
+   Log::initialize();
+   JobSystem::initialize();
+
 #if FORGE_WITH_MIDI
    Midi::initialize();
 #endif // FORGE_WITH_MIDI
@@ -86,6 +96,9 @@ ForgeApplication::~ForgeApplication()
 #if FORGE_WITH_MIDI
    Midi::terminate();
 #endif // FORGE_WITH_MIDI
+
+   JobSystem::terminate();
+   Log::terminate();
 }
 
 void ForgeApplication::run()
@@ -93,9 +106,15 @@ void ForgeApplication::run()
    static const double kMaxDeltaTime = 0.2;
    static const double kFrameRateReportInterval = 0.25;
 
+   PROFILE_THREAD("Main");
+
    double lastTime = glfwGetTime();
    while (!window->shouldClose())
    {
+#if FORGE_WITH_CPU_PROFILING
+      Profiler::beginFrame();
+#endif // FORGE_WITH_CPU_PROFILING
+
 #if FORGE_WITH_MIDI
       Midi::update();
 #endif // FORGE_WITH_MIDI
@@ -104,6 +123,7 @@ void ForgeApplication::run()
 
       double time = glfwGetTime();
       double dt = time - lastTime;
+      updateStreamingStats(dt);
       if (dt > kMaxDeltaTime)
       {
          dt = 0.0;
@@ -125,10 +145,54 @@ void ForgeApplication::run()
    context->getDevice().waitIdle();
 }
 
+// Logs how smooth frames were while resources streamed in, once everything has finished loading (frame time spikes from uploads show up as frames much longer than the
+// median), along with how long the main thread spent finalizing loads and how much of the staging ring they needed
+void ForgeApplication::updateStreamingStats(double frameTime)
+{
+   if (resourceManager->isStreaming())
+   {
+      streamingFrameTimes.push_back(frameTime);
+      streamingFinalizeTime += resourceManager->getFinalizeStats().milliseconds;
+      return;
+   }
+
+   if (!streamingFrameTimes.empty())
+   {
+      static const double kBytesPerMegabyte = 1024.0 * 1024.0;
+      static const double kMillisecondsPerSecond = 1000.0;
+      static const double kSpikeFactor = 2.0;
+
+      double totalTime = 0.0;
+      for (double streamingFrameTime : streamingFrameTimes)
+      {
+         totalTime += streamingFrameTime;
+      }
+
+      std::sort(streamingFrameTimes.begin(), streamingFrameTimes.end());
+      double medianFrameTime = streamingFrameTimes[streamingFrameTimes.size() / 2];
+      double p99FrameTime = streamingFrameTimes[streamingFrameTimes.size() * 99 / 100];
+      std::size_t numSpikes = streamingFrameTimes.end() - std::upper_bound(streamingFrameTimes.begin(), streamingFrameTimes.end(), medianFrameTime * kSpikeFactor);
+
+      const StagingRingStats& ringStats = context->getUploadQueue().getStats().stagingRing;
+      LOG_INFO("Streamed resources over " << streamingFrameTimes.size() << " frames (" << totalTime << " s): median frame " << medianFrameTime * kMillisecondsPerSecond
+         << " ms, 99th percentile " << p99FrameTime * kMillisecondsPerSecond << " ms, longest " << streamingFrameTimes.back() * kMillisecondsPerSecond << " ms, "
+         << numSpikes << " frames over " << kSpikeFactor << "x the median, " << streamingFinalizeTime << " ms finalizing on the main thread, staging ring peak "
+         << ringStats.peakBytesInUse / kBytesPerMegabyte << " / " << ringStats.capacity / kBytesPerMegabyte << " MB (" << ringStats.numWaits << " waits for space)");
+
+      streamingFrameTimes.clear();
+      streamingFinalizeTime = 0.0;
+   }
+}
+
 void ForgeApplication::render()
 {
+   PROFILE_SCOPE("ForgeApplication::render");
+
    RenderSettings newRenderSettings = renderSettings;
-   ui->render(*context, *scene, renderCapabilities, newRenderSettings, *resourceManager);
+   ui->render(*context, *scene, renderCapabilities, renderer->getDrawStats(), newRenderSettings, *resourceManager);
+
+   // The UI can edit transforms after the scene has ticked
+   scene->updateTransforms();
 
    updateRenderSettings(newRenderSettings);
 
@@ -205,6 +269,9 @@ void ForgeApplication::render()
       .setCommandBuffers(commandBuffer)
       .setSignalSemaphores(signalSemaphores);
 
+   // Uploads recorded while loading resources and building the frame have to execute before anything in the frame can use them
+   context->getUploadQueue().submit();
+
    device.resetFences({ frameFences[frameIndex] });
    context->getGraphicsQueue().submit({ submitInfo }, frameFences[frameIndex]);
 
@@ -548,9 +615,10 @@ void ForgeApplication::loadScene()
 
       cameraEntity.createComponent<NameComponent>().name = "Camera";
       cameraEntity.createComponent<CameraComponent>();
-      Transform& transform = cameraEntity.createComponent<TransformComponent>().transform;
+      Transform transform;
       transform.orientation = glm::quat(glm::radians(glm::vec3(-10.0f, 0.0f, -70.0f)));
       transform.position = glm::vec3(-6.0f, -0.8f, 2.0f);
+      cameraEntity.createComponent<TransformComponent>().setRelativeTransform(transform);
    }
 
    {
@@ -576,9 +644,10 @@ void ForgeApplication::loadScene()
    {
       Entity bunnyEntity = scene->createEntity();
       bunnyEntity.createComponent<NameComponent>().name = "Bunny";
-      TransformComponent& transformComponent = bunnyEntity.createComponent<TransformComponent>();
-      transformComponent.transform.position = glm::vec3(0.0f, 1.0f, 0.0f);
-      transformComponent.transform.scaleBy(glm::vec3(5.0f));
+      Transform transform;
+      transform.position = glm::vec3(0.0f, 1.0f, 0.0f);
+      transform.scaleBy(glm::vec3(5.0f));
+      bunnyEntity.createComponent<TransformComponent>().setRelativeTransform(transform);
 
       MeshComponent& meshComponent = bunnyEntity.createComponent<MeshComponent>();
       meshComponent.meshHandle = resourceManager->loadMesh("Resources/Meshes/Bunny.obj", MeshLoadOptions{}, MeshLoader::LoadDelegate::create([this](MeshHandle meshHandle)
@@ -604,7 +673,9 @@ void ForgeApplication::loadScene()
       Entity directionalLightEntity = scene->createEntity();
 
       directionalLightEntity.createComponent<NameComponent>().name = "Directional Light";
-      directionalLightEntity.createComponent<TransformComponent>().transform.orientation = glm::quat(glm::radians(glm::vec3(-90.0f, 0.0f, 0.0f)));
+      Transform transform;
+      transform.orientation = glm::quat(glm::radians(glm::vec3(-90.0f, 0.0f, 0.0f)));
+      directionalLightEntity.createComponent<TransformComponent>().setRelativeTransform(transform);
 
       DirectionalLightComponent& directionalLightComponent = directionalLightEntity.createComponent<DirectionalLightComponent>();
       directionalLightComponent.setBrightness(3.0f);
@@ -624,8 +695,9 @@ void ForgeApplication::loadScene()
       Entity pointLightEntity = scene->createEntity();
 
       pointLightEntity.createComponent<NameComponent>().name = "Point Light";
-      TransformComponent& transformComponent = pointLightEntity.createComponent<TransformComponent>();
-      transformComponent.transform.position = glm::vec3(0.0f, 0.0f, 4.0f);
+      Transform transform;
+      transform.position = glm::vec3(0.0f, 0.0f, 4.0f);
+      pointLightEntity.createComponent<TransformComponent>().setRelativeTransform(transform);
 
       PointLightComponent& pointLightComponent = pointLightEntity.createComponent<PointLightComponent>();
       pointLightComponent.setColor(glm::vec3(0.1f, 0.3f, 0.8f));
@@ -642,7 +714,9 @@ void ForgeApplication::loadScene()
       Entity spotLightEntity = scene->createEntity();
 
       spotLightEntity.createComponent<NameComponent>().name = "Spot Light";
-      spotLightEntity.createComponent<TransformComponent>().transform.position = glm::vec3(8.0f, -3.5f, 2.0f);
+      Transform transform;
+      transform.position = glm::vec3(8.0f, -3.5f, 2.0f);
+      spotLightEntity.createComponent<TransformComponent>().setRelativeTransform(transform);
 
       SpotLightComponent& spotLightComponent = spotLightEntity.createComponent<SpotLightComponent>();
       spotLightComponent.setColor(glm::vec3(0.8f, 0.1f, 0.3f));
@@ -655,9 +729,44 @@ void ForgeApplication::loadScene()
       oscillatingMovementComponent.location.cos.timeScale = glm::vec3(0.6f, 0.0f, 1.3f);
       oscillatingMovementComponent.location.cos.valueScale = glm::vec3(8.0f, 0.0f, 1.0f);
    }
+
+   if (stressGridSize > 0)
+   {
+      createStressGrid();
+   }
 }
 
 void ForgeApplication::unloadScene()
 {
    scene.reset();
 }
+
+// Fills the floor with copies of the same mesh, so that the draws they produce can be instanced (the counts show up in the Draw Stats table)
+void ForgeApplication::createStressGrid()
+{
+   static const float kSpacing = 0.5f;
+
+   Entity gridEntity = scene->createEntity();
+   gridEntity.createComponent<NameComponent>().name = "Stress Grid";
+   gridEntity.createComponent<TransformComponent>();
+
+   MeshHandle meshHandle = resourceManager->loadMesh("Resources/Meshes/Bunny.obj");
+   float offset = (stressGridSize - 1) * kSpacing * 0.5f;
+   for (uint32_t x = 0; x < stressGridSize; ++x)
+   {
+      for (uint32_t y = 0; y < stressGridSize; ++y)
+      {
+         Entity bunnyEntity = scene->createEntity();
+         bunnyEntity.createComponent<NameComponent>().name = "Stress Bunny " + std::to_string(x * stressGridSize + y);
+
+         Transform transform;
+         transform.position = glm::vec3(x * kSpacing - offset, y * kSpacing - offset, -1.0f);
+         transform.scaleBy(glm::vec3(2.0f));
+         TransformComponent& transformComponent = bunnyEntity.createComponent<TransformComponent>();
+         transformComponent.setParent(gridEntity);
+         transformComponent.setRelativeTransform(transform);
+
+         bunnyEntity.createComponent<MeshComponent>().meshHandle = meshHandle;
+      }
+   }
+}
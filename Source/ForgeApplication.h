@@ -7,6 +7,7 @@
 #include "UI/UI.h"
 
 #include <memory>
+#include <vector>
 
 class GraphicsContext;
 class Renderer;
@@ -19,7 +20,7 @@ class Window;
 class ForgeApplication
 {
 public:
-   ForgeApplication();
+   ForgeApplication(uint32_t initialStressGridSize = 0);
    ~ForgeApplication();
 
    void run();
@@ -55,6 +56,10 @@ private:
    void loadScene();
    void unloadScene();
 
+   void createStressGrid();
+
+   void updateStreamingStats(double frameTime);
+
    RenderCapabilities renderCapabilities;
    RenderSettings renderSettings;
 
@@ -77,5 +82,10 @@ private:
    std::vector<vk::Fence> swapchainFences;
    uint32_t frameIndex = 0;
 
+   uint32_t stressGridSize = 0;
+
+   std::vector<double> streamingFrameTimes; // Raw frame times (in seconds) while resources are streaming in
+   double streamingFinalizeTime = 0.0; // Total milliseconds the main thread spent finalizing loads while resources are streaming in
+
    bool framebufferSizeChanged = false;
 };
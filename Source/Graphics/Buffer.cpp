@@ -1,7 +1,7 @@
 #include "Graphics/Buffer.h"
 
-#include "Graphics/Command.h"
 #include "Graphics/Memory.h"
+#include "Graphics/UploadQueue.h"
 
 namespace Buffer
 {
@@ -31,18 +31,33 @@ namespace Buffer
       }
    }
 
-   void copy(const GraphicsContext& context, std::span<const CopyInfo> copyInfo)
+   void copy(const GraphicsContext& context, std::span<const CopyInfo> copyInfo, vk::AccessFlags dstAccessMask, vk::PipelineStageFlags dstStageMask)
    {
-      Command::executeSingle(context, [copyInfo](vk::CommandBuffer commandBuffer)
+      UploadQueue& uploadQueue = context.getUploadQueue();
+
+      vk::CommandBuffer commandBuffer = uploadQueue.getTransferCommandBuffer();
+      for (const CopyInfo& info : copyInfo)
+      {
+         vk::BufferCopy copyRegion = vk::BufferCopy()
+            .setSrcOffset(info.srcOffset)
+            .setDstOffset(info.dstOffset)
+            .setSize(info.size);
+         commandBuffer.copyBuffer(info.srcBuffer, info.dstBuffer, { copyRegion });
+      }
+
+      // On a single queue, one barrier makes every copy visible to its uses (nothing else orders them, since uploads don't wait for the queue to go idle)
+      if (!uploadQueue.hasDedicatedTransferQueue())
       {
-         for (const CopyInfo& info : copyInfo)
-         {
-            vk::BufferCopy copyRegion = vk::BufferCopy()
-               .setSrcOffset(info.srcOffset)
-               .setDstOffset(info.dstOffset)
-               .setSize(info.size);
-            commandBuffer.copyBuffer(info.srcBuffer, info.dstBuffer, { copyRegion });
-         }
-      });
+         vk::MemoryBarrier barrier = vk::MemoryBarrier()
+            .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+            .setDstAccessMask(dstAccessMask);
+         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, dstStageMask, vk::DependencyFlags(), { barrier }, nullptr, nullptr);
+         return;
+      }
+
+      for (const CopyInfo& info : copyInfo)
+      {
+         uploadQueue.transferBufferOwnership(info.dstBuffer, info.dstOffset, info.size, dstAccessMask, dstStageMask);
+      }
    }
 }
@@ -18,5 +18,7 @@ namespace Buffer
    };
 
    void create(const GraphicsContext& context, vk::DeviceSize size, vk::BufferUsageFlags usage, VmaAllocationCreateFlags flags, vk::Buffer& buffer, VmaAllocation& allocation, void** mappedData = nullptr);
-   void copy(const GraphicsContext& context, std::span<const CopyInfo> copyInfo);
+   // Recorded with the uploads of the current frame (see UploadQueue), so the source buffers need to stay alive until those complete. The destination ranges are made
+   // visible to (and handed over to the graphics queue for) the given uses.
+   void copy(const GraphicsContext& context, std::span<const CopyInfo> copyInfo, vk::AccessFlags dstAccessMask, vk::PipelineStageFlags dstStageMask);
 }
@@ -328,19 +328,18 @@ namespace DebugUtils
 
    const std::string& toString(uint64_t n)
    {
-      static std::array<std::string, 150> lookupTable;
-      static std::array<std::string, 10> dynamic;
-      static std::size_t dynamicIndex = 0;
-      static bool initialized = false;
-
-      if (!initialized)
+      // Labels can be recorded from multiple threads at once
+      static const std::array<std::string, 150> lookupTable = []()
       {
-         for (uint64_t i = 0; i < lookupTable.size(); ++i)
+         std::array<std::string, 150> table;
+         for (uint64_t i = 0; i < table.size(); ++i)
          {
-            lookupTable[i] = std::to_string(i);
+            table[i] = std::to_string(i);
          }
-         initialized = true;
-      }
+         return table;
+      }();
+      thread_local std::array<std::string, 10> dynamic;
+      thread_local std::size_t dynamicIndex = 0;
 
       if (n < lookupTable.size())
       {
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Graphics/Vulkan.h"
+
+#include <cstddef>
+
+// Keys of the descriptor set layout cache (in the core library, so that the benchmarks can hash them without a device)
+namespace std
+{
+   template<>
+   struct hash<vk::DescriptorSetLayoutBinding>
+   {
+      size_t operator()(const vk::DescriptorSetLayoutBinding& value) const;
+   };
+
+   template<>
+   struct hash<vk::DescriptorSetLayoutCreateInfo>
+   {
+      size_t operator()(const vk::DescriptorSetLayoutCreateInfo& value) const;
+   };
+}
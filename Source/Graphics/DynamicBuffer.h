@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Core/Assert.h"
+
+#include "Graphics/Buffer.h"
+#include "Graphics/DebugUtils.h"
+#include "Graphics/GraphicsContext.h"
+
+#include <array>
+#include <bit>
+#include <span>
+#include <utility>
+
+// An array of elements with a separate buffer for each frame in flight, which grows as needed. Host visible buffers are persistently mapped and meant to be written
+// from the CPU every frame, device local buffers are written by the GPU.
+template<typename T>
+class DynamicBuffer : public GraphicsResource
+{
+public:
+   DynamicBuffer(const GraphicsContext& graphicsContext, vk::BufferUsageFlags bufferUsage, bool isHostVisible, uint32_t minCapacity = 1024);
+   ~DynamicBuffer();
+
+   // Makes sure the buffer of the current frame can hold the given number of elements. Growing replaces the buffer, so any descriptors referencing it need to be updated.
+   void reserve(uint32_t numElements);
+
+   // Returns the data for the current frame, which can be written from any thread until the frame is submitted
+   std::span<T> map(uint32_t numElements);
+
+   vk::Buffer getCurrentBuffer() const
+   {
+      return frameBuffers[context.getFrameIndex()].buffer;
+   }
+
+   // Covers the whole buffer of the current frame
+   vk::DescriptorBufferInfo getDescriptorBufferInfo() const
+   {
+      return vk::DescriptorBufferInfo()
+         .setBuffer(getCurrentBuffer())
+         .setOffset(0)
+         .setRange(VK_WHOLE_SIZE);
+   }
+
+private:
+   struct FrameBuffer
+   {
+      vk::Buffer buffer;
+      VmaAllocation allocation = nullptr;
+      void* mappedMemory = nullptr;
+      uint32_t capacity = 0;
+   };
+
+   void allocate(uint32_t frameIndex, uint32_t capacity);
+
+   vk::BufferUsageFlags usage;
+   bool hostVisible = false;
+
+   std::array<FrameBuffer, GraphicsContext::kMaxFramesInFlight> frameBuffers;
+};
+
+template<typename T>
+inline DynamicBuffer<T>::DynamicBuffer(const GraphicsContext& graphicsContext, vk::BufferUsageFlags bufferUsage, bool isHostVisible, uint32_t minCapacity)
+   : GraphicsResource(graphicsContext)
+   , usage(bufferUsage)
+   , hostVisible(isHostVisible)
+{
+   for (uint32_t frameIndex = 0; frameIndex < frameBuffers.size(); ++frameIndex)
+   {
+      allocate(frameIndex, minCapacity);
+   }
+}
+
+template<typename T>
+inline DynamicBuffer<T>::~DynamicBuffer()
+{
+   for (FrameBuffer& frameBuffer : frameBuffers)
+   {
+      ASSERT(frameBuffer.buffer && frameBuffer.allocation);
+      context.delayedDestroy(std::move(frameBuffer.buffer), std::move(frameBuffer.allocation));
+   }
+}
+
+template<typename T>
+inline void DynamicBuffer<T>::reserve(uint32_t numElements)
+{
+   uint32_t frameIndex = context.getFrameIndex();
+   if (numElements > frameBuffers[frameIndex].capacity)
+   {
+      allocate(frameIndex, std::bit_ceil(numElements));
+   }
+}
+
+template<typename T>
+inline std::span<T> DynamicBuffer<T>::map(uint32_t numElements)
+{
+   ASSERT(hostVisible);
+
+   reserve(numElements);
+
+   return std::span<T>(static_cast<T*>(frameBuffers[context.getFrameIndex()].mappedMemory), numElements);
+}
+
+template<typename T>
+inline void DynamicBuffer<T>::allocate(uint32_t frameIndex, uint32_t capacity)
+{
+   FrameBuffer& frameBuffer = frameBuffers[frameIndex];
+
+   // The frame that last used the buffer has finished, but it is still referenced by descriptor sets (or recorded indirect draws) until they are updated
+   if (frameBuffer.buffer)
+   {
+      ASSERT(frameBuffer.allocation);
+      context.delayedDestroy(std::move(frameBuffer.buffer), std::move(frameBuffer.allocation));
+   }
+
+   VmaAllocationCreateFlags allocationFlags = hostVisible ? VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT : 0;
+   vk::DeviceSize bufferSize = static_cast<vk::DeviceSize>(capacity) * sizeof(T);
+   Buffer::create(context, bufferSize, usage, allocationFlags, frameBuffer.buffer, frameBuffer.allocation, hostVisible ? &frameBuffer.mappedMemory : nullptr);
+   NAME_CHILD(frameBuffer.buffer, "Frame " + DebugUtils::toString(frameIndex) + " Buffer");
+
+   frameBuffer.capacity = capacity;
+}
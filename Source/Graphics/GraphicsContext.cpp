@@ -5,7 +5,10 @@
 #include "Graphics/DebugUtils.h"
 #include "Graphics/DescriptorSetLayoutCache.h"
 #include "Graphics/DelayedObjectDestroyer.h"
+#include "Graphics/MeshArena.h"
+#include "Graphics/QueueOwnership.h"
 #include "Graphics/Swapchain.h"
+#include "Graphics/UploadQueue.h"
 
 #include "Platform/Window.h"
 
@@ -523,9 +526,16 @@ GraphicsContext::GraphicsContext(Window& window)
       throw std::runtime_error("Failed to get queue family indices");
    }
 
+#if FORGE_WITH_DEDICATED_TRANSFER_QUEUE
+   std::vector<vk::QueueFamilyProperties> queueFamilyProperties = physicalDevice.getQueueFamilyProperties();
+   transferFamilyIndex = QueueOwnership::selectTransferFamily(queueFamilyProperties, graphicsFamilyIndex);
+#else
+   transferFamilyIndex = graphicsFamilyIndex;
+#endif // FORGE_WITH_DEDICATED_TRANSFER_QUEUE
+
    float queuePriority = 1.0f;
    std::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos;
-   for (uint32_t queueFamilyIndex : std::set<uint32_t>{ graphicsFamilyIndex, presentFamilyIndex })
+   for (uint32_t queueFamilyIndex : std::set<uint32_t>{ graphicsFamilyIndex, presentFamilyIndex, transferFamilyIndex })
    {
       deviceQueueCreateInfos.push_back(vk::DeviceQueueCreateInfo()
          .setQueueFamilyIndex(queueFamilyIndex)
@@ -539,6 +549,8 @@ GraphicsContext::GraphicsContext(Window& window)
    deviceFeatures.setSampleRateShading(true);
    deviceFeatures.setImageCubeArray(true);
    deviceFeatures.setDepthBiasClamp(true);
+   deviceFeatures.setMultiDrawIndirect(physicalDeviceFeatures.multiDrawIndirect);
+   deviceFeatures.setDrawIndirectFirstInstance(physicalDeviceFeatures.drawIndirectFirstInstance);
 
    void* portabilityFeaturesPointer = nullptr;
    vk::PhysicalDevicePortabilitySubsetFeaturesKHR portabilityFeatures;
@@ -551,9 +563,29 @@ GraphicsContext::GraphicsContext(Window& window)
       portabilityFeaturesPointer = &portabilityFeatures;
    }
 
+   void* vulkan12FeaturesPointer = portabilityFeaturesPointer;
+   vk::PhysicalDeviceVulkan12Features vulkan12Features;
+   if (physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2)
+   {
+      vk::PhysicalDeviceFeatures2 physicalDeviceFeatures2;
+      vk::PhysicalDeviceVulkan12Features supportedVulkan12Features;
+      physicalDeviceFeatures2.setPNext(&supportedVulkan12Features);
+      physicalDevice.getFeatures2(&physicalDeviceFeatures2);
+
+      drawIndirectCountSupported = supportedVulkan12Features.drawIndirectCount;
+      timelineSemaphoresSupported = supportedVulkan12Features.timelineSemaphore;
+      if (drawIndirectCountSupported || timelineSemaphoresSupported)
+      {
+         vulkan12Features.setDrawIndirectCount(drawIndirectCountSupported);
+         vulkan12Features.setTimelineSemaphore(timelineSemaphoresSupported);
+         vulkan12Features.setPNext(portabilityFeaturesPointer);
+         vulkan12FeaturesPointer = &vulkan12Features;
+      }
+   }
+
    vk::PhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures = vk::PhysicalDeviceDynamicRenderingFeatures()
       .setDynamicRendering(true)
-      .setPNext(portabilityFeaturesPointer);
+      .setPNext(vulkan12FeaturesPointer);
 
    vk::DeviceCreateInfo deviceCreateInfo = vk::DeviceCreateInfo()
       .setQueueCreateInfos(deviceQueueCreateInfos)
@@ -566,12 +598,7 @@ GraphicsContext::GraphicsContext(Window& window)
 
    graphicsQueue = device.getQueue(graphicsFamilyIndex, 0);
    presentQueue = device.getQueue(presentFamilyIndex, 0);
-
-   vk::CommandPoolCreateInfo commandPoolCreateInfo = vk::CommandPoolCreateInfo()
-      .setQueueFamilyIndex(graphicsFamilyIndex)
-      .setFlags(vk::CommandPoolCreateFlagBits::eTransient);
-
-   transientCommandPool = device.createCommandPool(commandPoolCreateInfo);
+   transferQueue = device.getQueue(transferFamilyIndex, 0);
 
    std::optional<std::vector<uint8_t>> pipelineCacheData;
    if (std::optional<std::filesystem::path> pipelineCachePath = getPipelineCachePath())
@@ -616,10 +643,16 @@ GraphicsContext::GraphicsContext(Window& window)
 
    delayedObjectDestroyer = std::make_unique<DelayedObjectDestroyer>(*this);
    layoutCache = std::make_unique<DescriptorSetLayoutCache>(*this);
+   meshArena = std::make_unique<MeshArena>(*this);
+   NAME_POINTER(device, meshArena, "Mesh Arena");
+   uploadQueue = std::make_unique<UploadQueue>(*this);
+   NAME_POINTER(device, uploadQueue, "Upload Queue");
 }
 
 GraphicsContext::~GraphicsContext()
 {
+   uploadQueue = nullptr;
+   meshArena = nullptr;
    layoutCache = nullptr;
    delayedObjectDestroyer = nullptr;
 
@@ -637,7 +670,6 @@ GraphicsContext::~GraphicsContext()
    }
 
    device.destroyPipelineCache(pipelineCache);
-   device.destroyCommandPool(transientCommandPool);
 
    device.destroy();
 
@@ -667,6 +699,12 @@ void GraphicsContext::setFrameIndex(uint32_t index)
 
    ASSERT(delayedObjectDestroyer);
    delayedObjectDestroyer->onFrameIndexUpdate();
+
+   ASSERT(meshArena);
+   meshArena->onFrameIndexUpdate();
+
+   ASSERT(uploadQueue);
+   uploadQueue->onFrameIndexUpdate();
 }
 
 SwapchainCapabilities GraphicsContext::determineSwapchainCapabilities() const
@@ -9,7 +9,9 @@
 
 class DescriptorSetLayoutCache;
 class DelayedObjectDestroyer;
+class MeshArena;
 class Swapchain;
+class UploadQueue;
 class Window;
 
 struct SwapchainCapabilities
@@ -66,6 +68,12 @@ public:
       return presentQueue;
    }
 
+   // The same as the graphics queue when the device has no other family that can do transfers
+   vk::Queue getTransferQueue() const
+   {
+      return transferQueue;
+   }
+
    uint32_t getGraphicsFamilyIndex() const
    {
       return graphicsFamilyIndex;
@@ -76,6 +84,16 @@ public:
       return presentFamilyIndex;
    }
 
+   uint32_t getTransferFamilyIndex() const
+   {
+      return transferFamilyIndex;
+   }
+
+   bool hasDedicatedTransferQueue() const
+   {
+      return transferFamilyIndex != graphicsFamilyIndex;
+   }
+
    const vk::PhysicalDeviceProperties& getPhysicalDeviceProperties() const
    {
       return physicalDeviceProperties;
@@ -86,14 +104,20 @@ public:
       return physicalDeviceFeatures;
    }
 
-   uint32_t getVulkanVersion() const
+   // Whether draw counts can come from a buffer (vkCmdDrawIndexedIndirectCount)
+   bool supportsDrawIndirectCount() const
    {
-      return physicalDeviceProperties.apiVersion;
+      return drawIndirectCountSupported;
    }
 
-   vk::CommandPool getTransientCommandPool() const
+   bool supportsTimelineSemaphores() const
    {
-      return transientCommandPool;
+      return timelineSemaphoresSupported;
+   }
+
+   uint32_t getVulkanVersion() const
+   {
+      return physicalDeviceProperties.apiVersion;
    }
 
    vk::PipelineCache getPipelineCache() const
@@ -136,6 +160,18 @@ public:
 
    vk::DescriptorSetLayout getDescriptorSetLayout(const vk::DescriptorSetLayoutCreateInfo& createInfo) const;
 
+   MeshArena& getMeshArena() const
+   {
+      ASSERT(meshArena);
+      return *meshArena;
+   }
+
+   UploadQueue& getUploadQueue() const
+   {
+      ASSERT(uploadQueue);
+      return *uploadQueue;
+   }
+
    template<typename T>
    void delayedDestroy(T&& object) const
    {
@@ -179,14 +215,17 @@ private:
 
    uint32_t graphicsFamilyIndex = 0;
    uint32_t presentFamilyIndex = 0;
+   uint32_t transferFamilyIndex = 0;
 
    vk::Queue graphicsQueue;
    vk::Queue presentQueue;
+   vk::Queue transferQueue;
 
    vk::PhysicalDeviceProperties physicalDeviceProperties;
    vk::PhysicalDeviceFeatures physicalDeviceFeatures;
+   bool drawIndirectCountSupported = false;
+   bool timelineSemaphoresSupported = false;
 
-   vk::CommandPool transientCommandPool;
    vk::PipelineCache pipelineCache;
 
    VmaAllocator vmaAllocator = nullptr;
@@ -198,6 +237,8 @@ private:
 
    std::unique_ptr<DelayedObjectDestroyer> delayedObjectDestroyer;
    std::unique_ptr<DescriptorSetLayoutCache> layoutCache;
+   std::unique_ptr<MeshArena> meshArena;
+   std::unique_ptr<UploadQueue> uploadQueue;
 
 #if FORGE_WITH_VALIDATION_LAYERS
    VkDebugUtilsMessengerEXT debugMessenger = nullptr;
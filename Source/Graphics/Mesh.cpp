@@ -6,11 +6,73 @@
 #include "Graphics/DebugUtils.h"
 #include "Graphics/Material.h"
 #include "Graphics/Memory.h"
+#include "Graphics/UploadQueue.h"
 
 #include <array>
+#include <atomic>
+#include <cstring>
 #include <limits>
+#include <optional>
 #include <utility>
 
+namespace
+{
+   std::atomic<uint64_t> nextMeshUniqueId = 1;
+
+   struct StagingDataLayout
+   {
+      std::size_t numVertices = 0;
+      std::size_t numIndices = 0;
+
+      std::size_t vertexDataSize = 0;
+      std::size_t positionOnlyVertexDataSize = 0;
+      std::size_t indexDataSize = 0;
+
+      StagingDataLayout(std::span<const MeshSectionSourceData> sourceData)
+      {
+         for (const MeshSectionSourceData& sectionData : sourceData)
+         {
+            numVertices += sectionData.getNumVertices();
+            numIndices += sectionData.getNumIndices();
+         }
+
+         vertexDataSize = numVertices * sizeof(Vertex);
+         positionOnlyVertexDataSize = numVertices * sizeof(glm::vec3);
+         indexDataSize = numIndices * sizeof(uint32_t);
+      }
+
+      std::size_t getPositionOnlyVertexDataOffset() const
+      {
+         return vertexDataSize;
+      }
+
+      std::size_t getIndexDataOffset() const
+      {
+         return vertexDataSize + positionOnlyVertexDataSize;
+      }
+
+      std::size_t getSize() const
+      {
+         return vertexDataSize + positionOnlyVertexDataSize + indexDataSize;
+      }
+   };
+
+   std::vector<glm::vec3> createOccluderTriangles(const MeshSectionSourceData& sectionData)
+   {
+      std::vector<glm::vec3> occluderTriangles;
+      if (sectionData.indices.size() <= Mesh::kMaxOccluderTriangles * 3)
+      {
+         occluderTriangles.reserve(sectionData.indices.size());
+         for (uint32_t index : sectionData.indices)
+         {
+            occluderTriangles.push_back(sectionData.vertices[index].position);
+         }
+      }
+
+      return occluderTriangles;
+   }
+}
+
 // static
 const std::vector<vk::VertexInputBindingDescription>& Vertex::getBindingDescriptions(bool positionOnly)
 {
@@ -96,93 +158,118 @@ const std::vector<vk::VertexInputAttributeDescription>& Vertex::getAttributeDesc
    }
 }
 
-Mesh::Mesh(const GraphicsContext& graphicsContext, std::span<const MeshSectionSourceData> sourceData)
-   : GraphicsResource(graphicsContext)
+// static
+std::size_t Mesh::getStagingDataSize(std::span<const MeshSectionSourceData> sourceData)
 {
-   if (sourceData.empty())
-   {
-      return;
-   }
+   return StagingDataLayout(sourceData).getSize();
+}
 
-   vk::DeviceSize bufferSize = 0;
+// static
+void Mesh::writeStagingData(std::span<const MeshSectionSourceData> sourceData, std::span<uint8_t> stagingData)
+{
+   StagingDataLayout layout(sourceData);
+   ASSERT(stagingData.size() >= layout.getSize());
+
+   uint8_t* vertexData = stagingData.data();
+   uint8_t* positionOnlyVertexData = vertexData + layout.getPositionOnlyVertexDataOffset();
+   uint8_t* indexData = vertexData + layout.getIndexDataOffset();
+
+   std::size_t sectionFirstVertex = 0;
+   std::size_t sectionFirstIndex = 0;
    for (const MeshSectionSourceData& sectionData : sourceData)
    {
-      bufferSize += sectionData.vertices.size() * sizeof(Vertex);
-      bufferSize += sectionData.vertices.size() * sizeof(glm::vec3);
-      bufferSize += sectionData.indices.size() * sizeof(uint32_t);
+      ASSERT(!sectionData.vertexDataReleased);
+
+      std::memcpy(vertexData + sectionFirstVertex * sizeof(Vertex), sectionData.vertices.data(), sectionData.vertices.size() * sizeof(Vertex));
+      for (std::size_t i = 0; i < sectionData.vertices.size(); ++i)
+      {
+         std::memcpy(positionOnlyVertexData + (sectionFirstVertex + i) * sizeof(glm::vec3), &sectionData.vertices[i].position, sizeof(glm::vec3));
+      }
+      std::memcpy(indexData + sectionFirstIndex * sizeof(uint32_t), sectionData.indices.data(), sectionData.indices.size() * sizeof(uint32_t));
+
+      sectionFirstVertex += sectionData.vertices.size();
+      sectionFirstIndex += sectionData.indices.size();
    }
+}
 
-   // Create the buffer
+// static
+void Mesh::releaseVertexData(std::span<MeshSectionSourceData> sourceData)
+{
+   for (MeshSectionSourceData& sectionData : sourceData)
+   {
+      if (sectionData.vertexDataReleased)
+      {
+         continue;
+      }
 
-   vk::BufferCreateInfo bufferCreateInfo = vk::BufferCreateInfo()
-      .setSize(bufferSize)
-      .setUsage(vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer)
-      .setSharingMode(vk::SharingMode::eExclusive);
+      sectionData.releasedOccluderTriangles = createOccluderTriangles(sectionData);
+      sectionData.numReleasedVertices = sectionData.vertices.size();
+      sectionData.numReleasedIndices = sectionData.indices.size();
+      sectionData.vertexDataReleased = true;
 
-   VmaAllocationCreateInfo bufferAllocationCreateInfo{};
-   bufferAllocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+      sectionData.vertices = {};
+      sectionData.indices = {};
+   }
+}
 
-   VkBuffer vkBuffer = nullptr;
-   VkResult bufferCreateResult = vmaCreateBuffer(context.getVmaAllocator(), &static_cast<VkBufferCreateInfo&>(bufferCreateInfo), &bufferAllocationCreateInfo, &vkBuffer, &bufferAllocation, nullptr);
-   if (bufferCreateResult != VK_SUCCESS)
+Mesh::Mesh(const GraphicsContext& graphicsContext, std::span<const MeshSectionSourceData> sourceData, std::span<const uint8_t> stagingData)
+   : GraphicsResource(graphicsContext)
+   , uniqueId(nextMeshUniqueId.fetch_add(1, std::memory_order_relaxed))
+{
+   StagingDataLayout layout(sourceData);
+   if (layout.numVertices == 0 || layout.numIndices == 0)
    {
-      throw new std::runtime_error("Failed to create mesh buffer");
+      return;
    }
-   buffer = vkBuffer;
-   NAME_CHILD(buffer, "Mesh Buffer");
 
-   // Create staging buffer, and use it to copy over data
+   ASSERT(layout.numVertices <= std::numeric_limits<uint32_t>::max() && layout.numIndices <= std::numeric_limits<uint32_t>::max());
 
-   vk::BufferCreateInfo stagingBufferCreateInfo = vk::BufferCreateInfo()
-      .setSize(bufferCreateInfo.size)
-      .setUsage(vk::BufferUsageFlagBits::eTransferSrc)
-      .setSharingMode(vk::SharingMode::eExclusive);
+   MeshArena& meshArena = context.getMeshArena();
+   arenaAllocation = meshArena.allocate(static_cast<uint32_t>(layout.numVertices), static_cast<uint32_t>(layout.numIndices));
+   hasArenaAllocation = true;
 
-   VmaAllocationCreateInfo stagingBufferAllocationCreateInfo{};
-   stagingBufferAllocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
-   stagingBufferAllocationCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+   // Copy over the staging data (laid out the same as in the arena, so that each part is a single copy), creating a staging buffer for it if it isn't in the staging ring
 
-   VkBuffer stagingBuffer = nullptr;
+   UploadQueue& uploadQueue = context.getUploadQueue();
+   StagingRing& stagingRing = uploadQueue.getStagingRing();
+
+   vk::Buffer stagingBuffer;
    VmaAllocation stagingBufferAllocation = nullptr;
-   VmaAllocationInfo stagingBufferAllocationInfo{};
-   VkResult stagingBufferCreateResult = vmaCreateBuffer(context.getVmaAllocator(), &static_cast<VkBufferCreateInfo&>(stagingBufferCreateInfo), &stagingBufferAllocationCreateInfo, &stagingBuffer, &stagingBufferAllocation, &stagingBufferAllocationInfo);
-   if (stagingBufferCreateResult != VK_SUCCESS)
+   vk::DeviceSize stagingOffset = 0;
+   if (std::optional<vk::DeviceSize> stagingRingOffset = stagingRing.findOffset(stagingData))
+   {
+      ASSERT(stagingData.size() >= layout.getSize());
+
+      stagingBuffer = stagingRing.getBuffer();
+      stagingOffset = *stagingRingOffset;
+   }
+   else
    {
-      throw new std::runtime_error("Failed to allocate mesh staging buffer");
+      void* mappedMemory = nullptr;
+      Buffer::create(context, layout.getSize(), vk::BufferUsageFlagBits::eTransferSrc, VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT, stagingBuffer, stagingBufferAllocation, &mappedMemory);
+
+      writeStagingData(sourceData, std::span<uint8_t>(static_cast<uint8_t*>(mappedMemory), layout.getSize()));
    }
 
-   uint8_t* mappedData = static_cast<uint8_t*>(stagingBufferAllocationInfo.pMappedData);
-   std::size_t mappedDataOffset = 0;
+   uint32_t sectionFirstVertex = 0;
+   uint32_t sectionFirstIndex = 0;
    sections.reserve(sourceData.size());
+   sectionBounds.reserve(sourceData.size());
    for (const MeshSectionSourceData& sectionData : sourceData)
    {
       MeshSection meshSection;
 
-      ASSERT(sectionData.indices.size() <= std::numeric_limits<uint32_t>::max());
-      meshSection.numIndices = static_cast<uint32_t>(sectionData.indices.size());
-
+      meshSection.numIndices = static_cast<uint32_t>(sectionData.getNumIndices());
       meshSection.hasValidTexCoords = sectionData.hasValidTexCoords;
 
-      std::size_t vertexDataSize = sectionData.vertices.size() * sizeof(Vertex);
-      std::size_t positionOnlyVertexDataSize = sectionData.vertices.size() * sizeof(glm::vec3);
-      std::size_t indexDataSize = sectionData.indices.size() * sizeof(uint32_t);
+      // Indices stay relative to the section, the draw adds the section's first vertex to them
+      meshSection.firstVertex = arenaAllocation.firstVertex + sectionFirstVertex;
+      meshSection.firstIndex = arenaAllocation.firstIndex + sectionFirstIndex;
 
-      meshSection.vertexOffset = mappedDataOffset;
-      std::memcpy(mappedData + mappedDataOffset, sectionData.vertices.data(), vertexDataSize);
-      mappedDataOffset += vertexDataSize;
+      sectionFirstVertex += static_cast<uint32_t>(sectionData.getNumVertices());
+      sectionFirstIndex += meshSection.numIndices;
 
-      meshSection.positionOnlyVertexOffset = mappedDataOffset;
-      for (std::size_t i = 0; i < sectionData.vertices.size(); ++i)
-      {
-         std::memcpy(mappedData + mappedDataOffset + i * sizeof(glm::vec3), &sectionData.vertices[i], sizeof(glm::vec3));
-      }
-      mappedDataOffset += positionOnlyVertexDataSize;
-
-      meshSection.indexOffset = mappedDataOffset;
-      std::memcpy(mappedData + mappedDataOffset, sectionData.indices.data(), indexDataSize);
-      mappedDataOffset += indexDataSize;
-
-      meshSection.bounds = sectionData.bounds;
+      sectionBounds.push_back(sectionData.bounds);
       meshSection.materialHandle = sectionData.materialHandle;
 
       if (const Material* material = meshSection.materialHandle.getResource())
@@ -190,42 +277,72 @@ Mesh::Mesh(const GraphicsContext& graphicsContext, std::span<const MeshSectionSo
          materialTypeMask |= material->getTypeFlag();
       }
 
-      sections.push_back(meshSection);
-   }
-   mappedData = nullptr;
+      meshSection.occluderTriangles = sectionData.vertexDataReleased ? sectionData.releasedOccluderTriangles : createOccluderTriangles(sectionData);
 
-   std::array<Buffer::CopyInfo, 1> copyInfo;
-   copyInfo[0].srcBuffer = stagingBuffer;
-   copyInfo[0].dstBuffer = buffer;
-   copyInfo[0].size = bufferSize;
+      sections.push_back(std::move(meshSection));
+   }
 
-   Buffer::copy(context, copyInfo);
+   vk::Buffer arenaBuffer = meshArena.getBuffer(arenaAllocation.block);
+   std::array<Buffer::CopyInfo, 3> copyInfo;
 
-   vmaDestroyBuffer(context.getVmaAllocator(), stagingBuffer, stagingBufferAllocation);
-   stagingBuffer = nullptr;
-   stagingBufferAllocation = nullptr;
+   copyInfo[0].srcBuffer = stagingBuffer;
+   copyInfo[0].dstBuffer = arenaBuffer;
+   copyInfo[0].srcOffset = stagingOffset;
+   copyInfo[0].dstOffset = meshArena.getVertexDataOffset(arenaAllocation);
+   copyInfo[0].size = layout.vertexDataSize;
+
+   copyInfo[1].srcBuffer = stagingBuffer;
+   copyInfo[1].dstBuffer = arenaBuffer;
+   copyInfo[1].srcOffset = stagingOffset + layout.getPositionOnlyVertexDataOffset();
+   copyInfo[1].dstOffset = meshArena.getPositionDataOffset(arenaAllocation);
+   copyInfo[1].size = layout.positionOnlyVertexDataSize;
+
+   copyInfo[2].srcBuffer = stagingBuffer;
+   copyInfo[2].dstBuffer = arenaBuffer;
+   copyInfo[2].srcOffset = stagingOffset + layout.getIndexDataOffset();
+   copyInfo[2].dstOffset = meshArena.getIndexDataOffset(arenaAllocation);
+   copyInfo[2].size = layout.indexDataSize;
+
+   Buffer::copy(context, copyInfo, vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead, vk::PipelineStageFlagBits::eVertexInput);
+
+   if (stagingBufferAllocation)
+   {
+      uploadQueue.releaseStagingBuffer(stagingBuffer, stagingBufferAllocation, layout.getSize());
+   }
 }
 
 Mesh::~Mesh()
 {
-   if (buffer)
+   if (hasArenaAllocation)
    {
-      ASSERT(bufferAllocation);
-      context.delayedDestroy(std::move(buffer), std::move(bufferAllocation));
+      context.getMeshArena().free(arenaAllocation);
    }
 }
 
-void Mesh::bindBuffers(vk::CommandBuffer commandBuffer, uint32_t section, bool positionOnly) const
+void Mesh::bindBuffers(vk::CommandBuffer commandBuffer, bool positionOnly) const
+{
+   ASSERT(hasArenaAllocation);
+
+   context.getMeshArena().bindBuffers(commandBuffer, arenaAllocation.block, positionOnly);
+}
+
+void Mesh::draw(vk::CommandBuffer commandBuffer, uint32_t section, uint32_t numInstances, uint32_t firstInstance) const
 {
    ASSERT(section < sections.size());
 
-   commandBuffer.bindVertexBuffers(0, { buffer }, { positionOnly ? sections[section].positionOnlyVertexOffset : sections[section].vertexOffset });
-   commandBuffer.bindIndexBuffer(buffer, sections[section].indexOffset, vk::IndexType::eUint32);
+   const MeshSection& meshSection = sections[section];
+   commandBuffer.drawIndexed(meshSection.numIndices, numInstances, meshSection.firstIndex, static_cast<int32_t>(meshSection.firstVertex), firstInstance);
 }
 
-void Mesh::draw(vk::CommandBuffer commandBuffer, uint32_t section) const
+vk::DrawIndexedIndirectCommand Mesh::getDrawCommand(uint32_t section, uint32_t numInstances, uint32_t firstInstance) const
 {
    ASSERT(section < sections.size());
 
-   commandBuffer.drawIndexed(sections[section].numIndices, 1, 0, 0, 0);
+   const MeshSection& meshSection = sections[section];
+   return vk::DrawIndexedIndirectCommand()
+      .setIndexCount(meshSection.numIndices)
+      .setInstanceCount(numInstances)
+      .setFirstIndex(meshSection.firstIndex)
+      .setVertexOffset(static_cast<int32_t>(meshSection.firstVertex))
+      .setFirstInstance(firstInstance);
 }
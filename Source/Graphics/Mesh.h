@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Graphics/GraphicsResource.h"
+#include "Graphics/MeshArena.h"
 
 #include "Math/Bounds.h"
 
@@ -32,23 +33,51 @@ struct MeshSectionSourceData
    bool hasValidTexCoords = false;
    Bounds bounds;
    StrongMaterialHandle materialHandle;
+
+   // Set once the vertices and indices have been written to the staging ring and released (see Mesh::releaseVertexData()), which only keeps what the mesh still needs
+   bool vertexDataReleased = false;
+   std::size_t numReleasedVertices = 0;
+   std::size_t numReleasedIndices = 0;
+   std::vector<glm::vec3> releasedOccluderTriangles;
+
+   std::size_t getNumVertices() const
+   {
+      return vertexDataReleased ? numReleasedVertices : vertices.size();
+   }
+
+   std::size_t getNumIndices() const
+   {
+      return vertexDataReleased ? numReleasedIndices : indices.size();
+   }
 };
 
+// Vertices and indices are in the mesh arena block of the mesh (bounds are kept separately by the mesh, see Mesh::getSectionBounds())
 struct MeshSection
 {
-   vk::DeviceSize vertexOffset = 0;
-   vk::DeviceSize positionOnlyVertexOffset = 0;
-   vk::DeviceSize indexOffset = 0;
+   uint32_t firstVertex = 0;
+   uint32_t firstIndex = 0;
    uint32_t numIndices = 0;
    bool hasValidTexCoords = false;
-   Bounds bounds;
    StrongMaterialHandle materialHandle;
+
+   // Unindexed copy of the positions of small sections (three per triangle), for rasterizing on the CPU as an occluder. Empty for sections with too many triangles.
+   std::vector<glm::vec3> occluderTriangles;
 };
 
 class Mesh : public GraphicsResource
 {
 public:
-   Mesh(const GraphicsContext& graphicsContext, std::span<const MeshSectionSourceData> sourceData);
+   static constexpr uint32_t kMaxOccluderTriangles = 256;
+
+   // Vertex and index data of all sections, laid out the same as in the mesh arena (full vertices, then position only vertices, then indices)
+   static std::size_t getStagingDataSize(std::span<const MeshSectionSourceData> sourceData);
+   static void writeStagingData(std::span<const MeshSectionSourceData> sourceData, std::span<uint8_t> stagingData);
+
+   // Frees the vertices and indices of sections whose staging data has been written to the staging ring (a mesh created from them has to use that staging data)
+   static void releaseVertexData(std::span<MeshSectionSourceData> sourceData);
+
+   // The staging data can be written ahead of time (to the upload queue's staging ring), otherwise the mesh creates a staging buffer of its own
+   Mesh(const GraphicsContext& graphicsContext, std::span<const MeshSectionSourceData> sourceData, std::span<const uint8_t> stagingData = {});
    ~Mesh();
 
    uint32_t getNumSections() const
@@ -66,18 +95,39 @@ public:
       return sections[index];
    }
 
+   // Local space bounds of each section, in section order
+   std::span<const Bounds> getSectionBounds() const
+   {
+      return sectionBounds;
+   }
+
    uint32_t getMaterialTypeMask() const
    {
       return materialTypeMask;
    }
 
-   void bindBuffers(vk::CommandBuffer commandBuffer, uint32_t section, bool positionOnly) const;
-   void draw(vk::CommandBuffer commandBuffer, uint32_t section) const;
+   // Never reused by another mesh, unlike the mesh's address or handle (which stay the same when a mesh is reloaded in place)
+   uint64_t getUniqueId() const
+   {
+      return uniqueId;
+   }
+
+   // Meshes in the same block can be drawn without binding buffers in between
+   uint32_t getArenaBlock() const
+   {
+      return arenaAllocation.block;
+   }
+
+   void bindBuffers(vk::CommandBuffer commandBuffer, bool positionOnly) const;
+   void draw(vk::CommandBuffer commandBuffer, uint32_t section, uint32_t numInstances = 1, uint32_t firstInstance = 0) const;
+   vk::DrawIndexedIndirectCommand getDrawCommand(uint32_t section, uint32_t numInstances = 1, uint32_t firstInstance = 0) const;
 
 private:
-   vk::Buffer buffer;
-   VmaAllocation bufferAllocation = nullptr;
+   MeshArena::Allocation arenaAllocation;
+   bool hasArenaAllocation = false;
 
    std::vector<MeshSection> sections;
+   std::vector<Bounds> sectionBounds;
    uint32_t materialTypeMask = 0;
+   uint64_t uniqueId = 0;
 };
@@ -0,0 +1,165 @@
+#include "Graphics/MeshArena.h"
+
+#include "Graphics/Buffer.h"
+#include "Graphics/DebugUtils.h"
+#include "Graphics/Mesh.h"
+
+#include <algorithm>
+#include <utility>
+
+MeshArena::MeshArena(const GraphicsContext& graphicsContext)
+   : GraphicsResource(graphicsContext)
+{
+}
+
+MeshArena::~MeshArena()
+{
+   for (Block& block : blocks)
+   {
+      if (block.buffer)
+      {
+         context.delayedDestroy(std::move(block.buffer), std::move(block.allocation));
+      }
+   }
+}
+
+void MeshArena::onFrameIndexUpdate()
+{
+   std::vector<Allocation>& frees = pendingFrees[context.getFrameIndex()];
+   for (const Allocation& allocation : frees)
+   {
+      Block& block = blocks[allocation.block];
+
+      if (allocation.numVertices > 0)
+      {
+         block.vertexRanges.free(allocation.firstVertex, allocation.numVertices);
+      }
+      if (allocation.numIndices > 0)
+      {
+         block.indexRanges.free(allocation.firstIndex, allocation.numIndices);
+      }
+
+      // The first block is kept even when it's empty, so that streaming a single mesh in and out doesn't keep recreating it
+      if (allocation.block > 0 && block.buffer && block.vertexRanges.getFreeSize() == block.vertexRanges.getCapacity() && block.indexRanges.getFreeSize() == block.indexRanges.getCapacity())
+      {
+         releaseBlock(allocation.block);
+      }
+   }
+
+   frees.clear();
+}
+
+MeshArena::Allocation MeshArena::allocate(uint32_t numVertices, uint32_t numIndices)
+{
+   ASSERT(numVertices > 0 && numIndices > 0);
+
+   for (uint32_t blockIndex = 0; blockIndex < blocks.size(); ++blockIndex)
+   {
+      Block& block = blocks[blockIndex];
+      if (block.vertexRanges.getFreeSize() < numVertices || block.indexRanges.getFreeSize() < numIndices)
+      {
+         continue;
+      }
+
+      uint32_t firstVertex = block.vertexRanges.allocate(numVertices);
+      if (firstVertex == RangeAllocator::kInvalidOffset)
+      {
+         continue;
+      }
+
+      uint32_t firstIndex = block.indexRanges.allocate(numIndices);
+      if (firstIndex == RangeAllocator::kInvalidOffset)
+      {
+         block.vertexRanges.free(firstVertex, numVertices);
+         continue;
+      }
+
+      return Allocation{ blockIndex, firstVertex, numVertices, firstIndex, numIndices };
+   }
+
+   uint32_t blockIndex = addBlock(std::max(numVertices, kVerticesPerBlock), std::max(numIndices, kIndicesPerBlock));
+   Block& block = blocks[blockIndex];
+
+   uint32_t firstVertex = block.vertexRanges.allocate(numVertices);
+   uint32_t firstIndex = block.indexRanges.allocate(numIndices);
+   ASSERT(firstVertex != RangeAllocator::kInvalidOffset && firstIndex != RangeAllocator::kInvalidOffset);
+
+   return Allocation{ blockIndex, firstVertex, numVertices, firstIndex, numIndices };
+}
+
+void MeshArena::free(const Allocation& allocation)
+{
+   ASSERT(allocation.block < blocks.size());
+
+   pendingFrees[context.getFrameIndex()].push_back(allocation);
+}
+
+void MeshArena::bindBuffers(vk::CommandBuffer commandBuffer, uint32_t block, bool positionOnly) const
+{
+   ASSERT(block < blocks.size());
+
+   const Block& arenaBlock = blocks[block];
+   commandBuffer.bindVertexBuffers(0, { arenaBlock.buffer }, { positionOnly ? getPositionDataStart(arenaBlock) : 0 });
+   commandBuffer.bindIndexBuffer(arenaBlock.buffer, getIndexDataStart(arenaBlock), vk::IndexType::eUint32);
+}
+
+vk::DeviceSize MeshArena::getVertexDataOffset(const Allocation& allocation) const
+{
+   return static_cast<vk::DeviceSize>(allocation.firstVertex) * sizeof(Vertex);
+}
+
+vk::DeviceSize MeshArena::getPositionDataOffset(const Allocation& allocation) const
+{
+   return getPositionDataStart(blocks[allocation.block]) + static_cast<vk::DeviceSize>(allocation.firstVertex) * sizeof(glm::vec3);
+}
+
+vk::DeviceSize MeshArena::getIndexDataOffset(const Allocation& allocation) const
+{
+   return getIndexDataStart(blocks[allocation.block]) + static_cast<vk::DeviceSize>(allocation.firstIndex) * sizeof(uint32_t);
+}
+
+// static
+vk::DeviceSize MeshArena::getPositionDataStart(const Block& block)
+{
+   return static_cast<vk::DeviceSize>(block.vertexRanges.getCapacity()) * sizeof(Vertex);
+}
+
+// static
+vk::DeviceSize MeshArena::getIndexDataStart(const Block& block)
+{
+   return static_cast<vk::DeviceSize>(block.vertexRanges.getCapacity()) * (sizeof(Vertex) + sizeof(glm::vec3));
+}
+
+uint32_t MeshArena::addBlock(uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+   // Allocations refer to blocks by index, so released blocks leave an empty slot behind to be reused
+   auto emptySlot = std::find_if(blocks.begin(), blocks.end(), [](const Block& block) { return !block.buffer; });
+   uint32_t blockIndex = static_cast<uint32_t>(emptySlot - blocks.begin());
+   if (emptySlot == blocks.end())
+   {
+      blocks.emplace_back(vertexCapacity, indexCapacity);
+   }
+   else
+   {
+      *emptySlot = Block(vertexCapacity, indexCapacity);
+   }
+   Block& block = blocks[blockIndex];
+
+   vk::DeviceSize bufferSize = static_cast<vk::DeviceSize>(vertexCapacity) * (sizeof(Vertex) + sizeof(glm::vec3)) + static_cast<vk::DeviceSize>(indexCapacity) * sizeof(uint32_t);
+   vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer;
+   Buffer::create(context, bufferSize, usage, 0, block.buffer, block.allocation);
+   NAME_CHILD(block.buffer, "Block " + DebugUtils::toString(blockIndex));
+
+   return blockIndex;
+}
+
+void MeshArena::releaseBlock(uint32_t blockIndex)
+{
+   Block& block = blocks[blockIndex];
+   ASSERT(block.buffer && block.allocation);
+
+   context.delayedDestroy(std::move(block.buffer), std::move(block.allocation));
+
+   // An empty block has no free space, so allocations skip it
+   block = Block(0, 0);
+}
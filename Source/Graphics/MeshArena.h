@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Core/Memory/RangeAllocator.h"
+
+#include "Graphics/GraphicsResource.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Vertex and index data of all meshes, suballocated from a few large blocks so that draws of different meshes can share the same buffer bindings (and be submitted
+// together with indirect draws). Each block is a single buffer holding full vertices, position only vertices and indices. Both vertex formats are stored at the same
+// index, so the same vertex offset works for either.
+class MeshArena : public GraphicsResource
+{
+public:
+   static constexpr uint32_t kVerticesPerBlock = 1 << 19;
+   static constexpr uint32_t kIndicesPerBlock = 1 << 21;
+
+   struct Allocation
+   {
+      uint32_t block = 0;
+      uint32_t firstVertex = 0;
+      uint32_t numVertices = 0;
+      uint32_t firstIndex = 0;
+      uint32_t numIndices = 0;
+   };
+
+   MeshArena(const GraphicsContext& graphicsContext);
+   ~MeshArena();
+
+   void onFrameIndexUpdate();
+
+   // Adds a block if none of the existing ones have enough space (allocations larger than a block get a block of their own)
+   Allocation allocate(uint32_t numVertices, uint32_t numIndices);
+
+   // The ranges are only reused once no frame in flight can still be reading them. Blocks (other than the first) are released once nothing is left in them.
+   void free(const Allocation& allocation);
+
+   void bindBuffers(vk::CommandBuffer commandBuffer, uint32_t block, bool positionOnly) const;
+
+   vk::Buffer getBuffer(uint32_t block) const
+   {
+      return blocks[block].buffer;
+   }
+
+   // Byte offsets of the allocation's data in its block's buffer
+   vk::DeviceSize getVertexDataOffset(const Allocation& allocation) const;
+   vk::DeviceSize getPositionDataOffset(const Allocation& allocation) const;
+   vk::DeviceSize getIndexDataOffset(const Allocation& allocation) const;
+
+private:
+   struct Block
+   {
+      vk::Buffer buffer;
+      VmaAllocation allocation = nullptr;
+
+      RangeAllocator vertexRanges;
+      RangeAllocator indexRanges;
+
+      Block(uint32_t vertexCapacity, uint32_t indexCapacity)
+         : vertexRanges(vertexCapacity)
+         , indexRanges(indexCapacity)
+      {
+      }
+   };
+
+   // Full vertices start at the beginning of the buffer, followed by position only vertices, followed by indices
+   static vk::DeviceSize getPositionDataStart(const Block& block);
+   static vk::DeviceSize getIndexDataStart(const Block& block);
+
+   uint32_t addBlock(uint32_t vertexCapacity, uint32_t indexCapacity);
+   void releaseBlock(uint32_t blockIndex);
+
+   std::vector<Block> blocks;
+   std::array<std::vector<Allocation>, GraphicsContext::kMaxFramesInFlight> pendingFrees;
+};
@@ -1,5 +1,6 @@
 #include "Graphics/Pipeline.h"
 
+#include "Core/Assert.h"
 #include "Core/Containers/StaticVector.h"
 
 #include "Graphics/DebugUtils.h"
@@ -11,8 +12,26 @@
 
 namespace
 {
+   vk::Pipeline createComputePipeline(const GraphicsContext& context, const PipelineData& data)
+   {
+      ASSERT(data.shaderStages.size() == 1);
+
+      vk::ComputePipelineCreateInfo computePipelineCreateInfo = vk::ComputePipelineCreateInfo()
+         .setStage(data.shaderStages[0])
+         .setLayout(data.layout)
+         .setBasePipelineHandle(nullptr)
+         .setBasePipelineIndex(-1);
+
+      return context.getDevice().createComputePipeline(context.getPipelineCache(), computePipelineCreateInfo).value;
+   }
+
    vk::Pipeline createPipeline(const GraphicsContext& context, const PipelineInfo& info, const PipelineData& data)
    {
+      if (info.passType == PipelinePassType::Compute)
+      {
+         return createComputePipeline(context, data);
+      }
+
       vk::Viewport viewport = vk::Viewport()
          .setX(0.0f)
          .setY(0.0f)
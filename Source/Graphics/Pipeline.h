@@ -10,7 +10,8 @@ struct AttachmentFormats;
 enum class PipelinePassType
 {
    Mesh,
-   Screen
+   Screen,
+   Compute
 };
 
 struct PipelineInfo
@@ -26,6 +27,7 @@ struct PipelineInfo
    bool swapFrontFace = false;
 };
 
+// Compute pipelines only use the layout and the shader stage
 struct PipelineData
 {
    vk::PipelineLayout layout;
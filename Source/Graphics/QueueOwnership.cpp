@@ -0,0 +1,87 @@
+#include "Graphics/QueueOwnership.h"
+
+namespace QueueOwnership
+{
+   uint32_t selectTransferFamily(std::span<const vk::QueueFamilyProperties> queueFamilies, uint32_t graphicsFamilyIndex)
+   {
+      uint32_t transferFamilyIndex = graphicsFamilyIndex;
+      bool foundComputeFamily = false;
+
+      for (uint32_t index = 0; index < static_cast<uint32_t>(queueFamilies.size()); ++index)
+      {
+         const vk::QueueFamilyProperties& queueFamily = queueFamilies[index];
+
+         // Graphics and compute families support transfers even if they don't report it
+         bool supportsGraphics = static_cast<bool>(queueFamily.queueFlags & vk::QueueFlagBits::eGraphics);
+         bool supportsCompute = static_cast<bool>(queueFamily.queueFlags & vk::QueueFlagBits::eCompute);
+         bool supportsTransfer = supportsGraphics || supportsCompute || (queueFamily.queueFlags & vk::QueueFlagBits::eTransfer);
+
+         if (supportsTransfer && !supportsGraphics && queueFamily.queueCount > 0)
+         {
+            if (!supportsCompute)
+            {
+               return index;
+            }
+
+            if (!foundComputeFamily)
+            {
+               foundComputeFamily = true;
+               transferFamilyIndex = index;
+            }
+         }
+      }
+
+      return transferFamilyIndex;
+   }
+
+   Transfer<vk::BufferMemoryBarrier> createBufferTransfer(uint32_t transferFamilyIndex, uint32_t graphicsFamilyIndex, vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size, vk::AccessFlags dstAccessMask)
+   {
+      ASSERT(transferFamilyIndex != graphicsFamilyIndex);
+
+      vk::BufferMemoryBarrier barrier = vk::BufferMemoryBarrier()
+         .setSrcQueueFamilyIndex(transferFamilyIndex)
+         .setDstQueueFamilyIndex(graphicsFamilyIndex)
+         .setBuffer(buffer)
+         .setOffset(offset)
+         .setSize(size);
+
+      Transfer<vk::BufferMemoryBarrier> transfer;
+
+      // The release ignores the destination access (the semaphore between the queues makes the writes available), and the acquire ignores the source access
+      transfer.release = barrier;
+      transfer.release.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+      transfer.release.setDstAccessMask(vk::AccessFlags());
+
+      transfer.acquire = barrier;
+      transfer.acquire.setSrcAccessMask(vk::AccessFlags());
+      transfer.acquire.setDstAccessMask(dstAccessMask);
+
+      return transfer;
+   }
+
+   Transfer<vk::ImageMemoryBarrier> createImageTransfer(uint32_t transferFamilyIndex, uint32_t graphicsFamilyIndex, vk::Image image, const vk::ImageSubresourceRange& subresourceRange, vk::ImageLayout layout)
+   {
+      ASSERT(transferFamilyIndex != graphicsFamilyIndex);
+
+      // The layouts have to match in both barriers, and keeping them the same means no transition happens along with the transfer
+      vk::ImageMemoryBarrier barrier = vk::ImageMemoryBarrier()
+         .setOldLayout(layout)
+         .setNewLayout(layout)
+         .setSrcQueueFamilyIndex(transferFamilyIndex)
+         .setDstQueueFamilyIndex(graphicsFamilyIndex)
+         .setImage(image)
+         .setSubresourceRange(subresourceRange);
+
+      Transfer<vk::ImageMemoryBarrier> transfer;
+
+      transfer.release = barrier;
+      transfer.release.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+      transfer.release.setDstAccessMask(vk::AccessFlags());
+
+      transfer.acquire = barrier;
+      transfer.acquire.setSrcAccessMask(vk::AccessFlags());
+      transfer.acquire.setDstAccessMask(vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite);
+
+      return transfer;
+   }
+}
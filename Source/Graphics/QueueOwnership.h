@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Graphics/Vulkan.h"
+
+#include <cstdint>
+#include <span>
+
+// Picks the queue family that uploads go through, and builds the barriers that hand what it wrote over to the graphics queue family. None of this touches the device.
+namespace QueueOwnership
+{
+   // Prefers a family that only does transfers (usually backed by a DMA engine), then an async compute family, and otherwise falls back to the graphics family (e.g. on
+   // lavapipe, which only exposes one family)
+   uint32_t selectTransferFamily(std::span<const vk::QueueFamilyProperties> queueFamilies, uint32_t graphicsFamilyIndex);
+
+   // The release barrier is recorded on the transfer queue after the writes, and the acquire barrier on the graphics queue, after waiting for the transfer queue
+   template<typename Barrier>
+   struct Transfer
+   {
+      Barrier release;
+      Barrier acquire;
+   };
+
+   Transfer<vk::BufferMemoryBarrier> createBufferTransfer(uint32_t transferFamilyIndex, uint32_t graphicsFamilyIndex, vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size, vk::AccessFlags dstAccessMask);
+
+   // The image stays in the given layout, and is ready for more transfer commands on the graphics queue afterwards (e.g. generating mips, or a transition to its final
+   // layout)
+   Transfer<vk::ImageMemoryBarrier> createImageTransfer(uint32_t transferFamilyIndex, uint32_t graphicsFamilyIndex, vk::Image image, const vk::ImageSubresourceRange& subresourceRange, vk::ImageLayout layout);
+}
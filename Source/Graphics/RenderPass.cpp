@@ -1,6 +1,7 @@
 #include "Graphics/RenderPass.h"
 
 #include "Graphics/DebugUtils.h"
+#include "Graphics/SecondaryCommandPool.h"
 #include "Graphics/Swapchain.h"
 #include "Graphics/Texture.h"
 
@@ -150,7 +151,7 @@ RenderPass::RenderPass(const GraphicsContext& graphicsContext)
 {
 }
 
-void RenderPass::setViewport(vk::CommandBuffer commandBuffer, const vk::Rect2D& rect)
+void RenderPass::setViewport(vk::CommandBuffer commandBuffer, const vk::Rect2D& rect) const
 {
    SCOPED_LABEL("Set viewport");
 
@@ -166,7 +167,7 @@ void RenderPass::setViewport(vk::CommandBuffer commandBuffer, const vk::Rect2D&
    commandBuffer.setScissor(0, rect);
 }
 
-void RenderPass::beginRenderPass(vk::CommandBuffer commandBuffer, std::span<const AttachmentInfo> colorAttachments, const AttachmentInfo* depthStencilAttachment)
+void RenderPass::beginRenderPass(vk::CommandBuffer commandBuffer, std::span<const AttachmentInfo> colorAttachments, const AttachmentInfo* depthStencilAttachment, vk::RenderingFlags renderingFlags)
 {
    ASSERT(!attachmentFormats.has_value(), "Beginning a render pass, but another render pass is already in progress");
    attachmentFormats = AttachmentFormats(colorAttachments, depthStencilAttachment);
@@ -184,9 +185,10 @@ void RenderPass::beginRenderPass(vk::CommandBuffer commandBuffer, std::span<cons
    }
 
    vk::Extent2D extent = getAttachmentExtent(colorAttachments, depthStencilAttachment);
-   vk::Rect2D renderArea(vk::Offset2D(0, 0), extent);
+   renderArea = vk::Rect2D(vk::Offset2D(0, 0), extent);
 
    vk::RenderingInfo renderingInfo = vk::RenderingInfo()
+      .setFlags(renderingFlags)
       .setRenderArea(renderArea)
       .setLayerCount(1)
       .setPDepthAttachment(depthStencilAttachment ? &depthStencilRenderingAttachmentInfo : nullptr)
@@ -195,7 +197,11 @@ void RenderPass::beginRenderPass(vk::CommandBuffer commandBuffer, std::span<cons
 
    commandBuffer.beginRenderingKHR(renderingInfo, GraphicsContext::GetDynamicLoader());
 
-   setViewport(commandBuffer, renderArea);
+   // Dynamic state isn't inherited by secondary command buffers, so they set the viewport themselves
+   if (!(renderingFlags & vk::RenderingFlagBits::eContentsSecondaryCommandBuffers))
+   {
+      setViewport(commandBuffer, renderArea);
+   }
 
    onRenderPassBegin();
 }
@@ -209,3 +215,28 @@ void RenderPass::endRenderPass(vk::CommandBuffer commandBuffer)
 
    onRenderPassEnd();
 }
+
+vk::CommandBuffer RenderPass::beginSecondaryCommandBuffer(SecondaryCommandPool& secondaryCommandPool) const
+{
+   const AttachmentFormats& formats = getAttachmentFormats();
+
+   vk::CommandBufferInheritanceRenderingInfo inheritanceRenderingInfo = vk::CommandBufferInheritanceRenderingInfo()
+      .setColorAttachmentFormats(formats.colorFormats)
+      .setDepthAttachmentFormat(formats.depthStencilFormat)
+      .setStencilAttachmentFormat(formats.depthStencilFormat)
+      .setRasterizationSamples(formats.sampleCount);
+
+   vk::CommandBufferInheritanceInfo inheritanceInfo = vk::CommandBufferInheritanceInfo()
+      .setPNext(&inheritanceRenderingInfo);
+
+   vk::CommandBufferBeginInfo beginInfo = vk::CommandBufferBeginInfo()
+      .setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue)
+      .setPInheritanceInfo(&inheritanceInfo);
+
+   vk::CommandBuffer commandBuffer = secondaryCommandPool.obtain();
+   commandBuffer.begin(beginInfo);
+
+   setViewport(commandBuffer, renderArea);
+
+   return commandBuffer;
+}
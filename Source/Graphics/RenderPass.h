@@ -10,6 +10,8 @@
 #include <optional>
 #include <span>
 
+class SecondaryCommandPool;
+
 constexpr std::size_t kMaxColorAttachments = 4;
 
 struct AttachmentInfo
@@ -139,7 +141,14 @@ protected:
       }
    }
 
-   void setViewport(vk::CommandBuffer commandBuffer, const vk::Rect2D& rect);
+   // Passing vk::RenderingFlagBits::eContentsSecondaryCommandBuffers means everything within the pass must be recorded into secondary command buffers
+   void beginRenderPass(vk::CommandBuffer commandBuffer, std::span<const AttachmentInfo> colorAttachments, const AttachmentInfo* depthStencilAttachment, vk::RenderingFlags renderingFlags = {});
+   void endRenderPass(vk::CommandBuffer commandBuffer);
+
+   // Begins a secondary command buffer that continues the current render pass (with the viewport already set). Can be called from any job system thread.
+   vk::CommandBuffer beginSecondaryCommandBuffer(SecondaryCommandPool& secondaryCommandPool) const;
+
+   void setViewport(vk::CommandBuffer commandBuffer, const vk::Rect2D& rect) const;
 
    const AttachmentFormats& getAttachmentFormats() const
    {
@@ -148,8 +157,6 @@ protected:
    }
 
 private:
-   void beginRenderPass(vk::CommandBuffer commandBuffer, std::span<const AttachmentInfo> colorAttachments, const AttachmentInfo* depthStencilAttachment);
-   void endRenderPass(vk::CommandBuffer commandBuffer);
-
    std::optional<AttachmentFormats> attachmentFormats;
+   vk::Rect2D renderArea;
 };
@@ -0,0 +1,78 @@
+#include "Graphics/SecondaryCommandPool.h"
+
+#include "Core/Assert.h"
+#include "Core/Jobs/JobSystem.h"
+
+#include "Graphics/DebugUtils.h"
+
+#include <utility>
+
+SecondaryCommandPool::SecondaryCommandPool(const GraphicsContext& graphicsContext)
+   : GraphicsResource(graphicsContext)
+{
+   // Pools are created up front, since objects can only be named from one thread at a time
+   uint32_t numThreads = JobSystem::getNumWorkers() + 1;
+   for (uint32_t frameIndex = 0; frameIndex < framePools.size(); ++frameIndex)
+   {
+      std::vector<ThreadPool>& threadPools = framePools[frameIndex];
+      threadPools.resize(numThreads);
+
+      for (uint32_t threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+      {
+         vk::CommandPoolCreateInfo createInfo = vk::CommandPoolCreateInfo()
+            .setQueueFamilyIndex(context.getGraphicsFamilyIndex())
+            .setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+
+         threadPools[threadIndex].pool = device.createCommandPool(createInfo);
+         NAME_CHILD(threadPools[threadIndex].pool, "Frame " + DebugUtils::toString(frameIndex) + " Thread " + DebugUtils::toString(threadIndex));
+      }
+   }
+}
+
+SecondaryCommandPool::~SecondaryCommandPool()
+{
+   for (std::vector<ThreadPool>& threadPools : framePools)
+   {
+      for (ThreadPool& threadPool : threadPools)
+      {
+         // Command buffers get cleaned up with the pool
+         context.delayedDestroy(std::move(threadPool.pool));
+      }
+   }
+}
+
+void SecondaryCommandPool::beginFrame()
+{
+   for (ThreadPool& threadPool : framePools[context.getFrameIndex()])
+   {
+      if (threadPool.numUsed > 0)
+      {
+         device.resetCommandPool(threadPool.pool);
+         threadPool.numUsed = 0;
+      }
+   }
+}
+
+vk::CommandBuffer SecondaryCommandPool::obtain()
+{
+   std::vector<ThreadPool>& threadPools = framePools[context.getFrameIndex()];
+
+   uint32_t threadIndex = JobSystem::getThreadIndex();
+   ASSERT(threadIndex < threadPools.size());
+
+   // Only ever accessed from this thread
+   ThreadPool& threadPool = threadPools[threadIndex];
+   if (threadPool.numUsed == threadPool.commandBuffers.size())
+   {
+      vk::CommandBufferAllocateInfo allocateInfo = vk::CommandBufferAllocateInfo()
+         .setCommandPool(threadPool.pool)
+         .setLevel(vk::CommandBufferLevel::eSecondary)
+         .setCommandBufferCount(1);
+
+      std::vector<vk::CommandBuffer> commandBuffers = device.allocateCommandBuffers(allocateInfo);
+      ASSERT(commandBuffers.size() == 1);
+      threadPool.commandBuffers.push_back(commandBuffers[0]);
+   }
+
+   return threadPool.commandBuffers[threadPool.numUsed++];
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Graphics/GraphicsResource.h"
+
+#include <array>
+#include <vector>
+
+// Hands out secondary command buffers from a separate command pool for each job system thread (and each frame in flight), so that they can be recorded in parallel
+class SecondaryCommandPool : public GraphicsResource
+{
+public:
+   SecondaryCommandPool(const GraphicsContext& graphicsContext);
+   ~SecondaryCommandPool();
+
+   // Recycles the command buffers of the current frame, which must no longer be in use by the GPU
+   void beginFrame();
+
+   // Can be called from any job system thread
+   vk::CommandBuffer obtain();
+
+private:
+   struct ThreadPool
+   {
+      vk::CommandPool pool;
+      std::vector<vk::CommandBuffer> commandBuffers;
+      uint32_t numUsed = 0;
+   };
+
+   std::array<std::vector<ThreadPool>, GraphicsContext::kMaxFramesInFlight> framePools;
+};
@@ -33,6 +33,7 @@ Shader::Shader(const GraphicsContext& graphicsContext, ResourceManager& resource
    , moduleInfo(info)
    , vertShaderModuleHandle(loadShaderModule(resourceManager, info.vertName, "vert"))
    , fragShaderModuleHandle(loadShaderModule(resourceManager, info.fragName, "frag"))
+   , compShaderModuleHandle(loadShaderModule(resourceManager, info.compName, "comp"))
 {
    if (!delayInitialization)
    {
@@ -42,7 +43,7 @@ Shader::Shader(const GraphicsContext& graphicsContext, ResourceManager& resource
 #if FORGE_WITH_SHADER_HOT_RELOADING
    hotReloadDelegateHandle = resourceManager.addShaderModuleHotReloadDelegate([this](ShaderModuleHandle hotReloadedShaderModuleHandle)
    {
-      if (hotReloadedShaderModuleHandle == vertShaderModuleHandle || hotReloadedShaderModuleHandle == fragShaderModuleHandle)
+      if (hotReloadedShaderModuleHandle == vertShaderModuleHandle || hotReloadedShaderModuleHandle == fragShaderModuleHandle || hotReloadedShaderModuleHandle == compShaderModuleHandle)
       {
          initializeStageCreateInfo();
       }
@@ -58,6 +59,10 @@ Shader::~Shader()
    {
       resourceManager = fragShaderModuleHandle.getResourceManager();
    }
+   if (!resourceManager)
+   {
+      resourceManager = compShaderModuleHandle.getResourceManager();
+   }
 
    if (resourceManager)
    {
@@ -89,7 +94,7 @@ void Shader::setSpecializationInfo(std::span<const vk::SpecializationInfo> speci
 std::vector<vk::PipelineShaderStageCreateInfo> Shader::getStagesForPermutation(uint32_t permutationIndex) const
 {
    std::vector<vk::PipelineShaderStageCreateInfo> stages;
-   stages.reserve((vertStageCreateInfo.empty() ? 0 : 1) + (fragStageCreateInfo.empty() ? 0 : 1));
+   stages.reserve((vertStageCreateInfo.empty() ? 0 : 1) + (fragStageCreateInfo.empty() ? 0 : 1) + (compStageCreateInfo.empty() ? 0 : 1));
 
    if (permutationIndex < vertStageCreateInfo.size())
    {
@@ -99,55 +104,44 @@ std::vector<vk::PipelineShaderStageCreateInfo> Shader::getStagesForPermutation(u
    {
       stages.push_back(fragStageCreateInfo[permutationIndex]);
    }
+   if (permutationIndex < compStageCreateInfo.size())
+   {
+      stages.push_back(compStageCreateInfo[permutationIndex]);
+   }
 
    return stages;
 }
 
 void Shader::initializeStageCreateInfo()
 {
-   vertStageCreateInfo.clear();
-   if (const ShaderModule* vertShaderModule = vertShaderModuleHandle.getResource())
-   {
-      vk::PipelineShaderStageCreateInfo vertCreateInfo = vk::PipelineShaderStageCreateInfo()
-         .setStage(vk::ShaderStageFlagBits::eVertex)
-         .setModule(vertShaderModule->getShaderModule())
-         .setPName(moduleInfo.vertEntryPoint.c_str());
+   initializeStageCreateInfo(vertShaderModuleHandle, vk::ShaderStageFlagBits::eVertex, moduleInfo.vertEntryPoint, vertStageCreateInfo);
+   initializeStageCreateInfo(fragShaderModuleHandle, vk::ShaderStageFlagBits::eFragment, moduleInfo.fragEntryPoint, fragStageCreateInfo);
+   initializeStageCreateInfo(compShaderModuleHandle, vk::ShaderStageFlagBits::eCompute, moduleInfo.compEntryPoint, compStageCreateInfo);
 
-      if (specializationInfo.empty())
-      {
-         vertStageCreateInfo.push_back(vertCreateInfo);
-      }
-      else
-      {
-         vertStageCreateInfo.resize(specializationInfo.size());
-         for (std::size_t i = 0; i < specializationInfo.size(); ++i)
-         {
-            vertStageCreateInfo[i] = vertCreateInfo.setPSpecializationInfo(&specializationInfo[i]);
-         }
-      }
-   }
+   onInitialize.broadcast();
+}
 
-   fragStageCreateInfo.clear();
-   if (const ShaderModule* fragShaderModule = fragShaderModuleHandle.getResource())
+void Shader::initializeStageCreateInfo(const StrongShaderModuleHandle& moduleHandle, vk::ShaderStageFlagBits stage, const std::string& entryPoint, std::vector<vk::PipelineShaderStageCreateInfo>& stageCreateInfo)
+{
+   stageCreateInfo.clear();
+   if (const ShaderModule* shaderModule = moduleHandle.getResource())
    {
-      vk::PipelineShaderStageCreateInfo fragCreateInfo = vk::PipelineShaderStageCreateInfo()
-         .setStage(vk::ShaderStageFlagBits::eFragment)
-         .setModule(fragShaderModule->getShaderModule())
-         .setPName(moduleInfo.fragEntryPoint.c_str());
+      vk::PipelineShaderStageCreateInfo createInfo = vk::PipelineShaderStageCreateInfo()
+         .setStage(stage)
+         .setModule(shaderModule->getShaderModule())
+         .setPName(entryPoint.c_str());
 
       if (specializationInfo.empty())
       {
-         fragStageCreateInfo.push_back(fragCreateInfo);
+         stageCreateInfo.push_back(createInfo);
       }
       else
       {
-         fragStageCreateInfo.resize(specializationInfo.size());
+         stageCreateInfo.resize(specializationInfo.size());
          for (std::size_t i = 0; i < specializationInfo.size(); ++i)
          {
-            fragStageCreateInfo[i] = fragCreateInfo.setPSpecializationInfo(&specializationInfo[i]);
+            stageCreateInfo[i] = createInfo.setPSpecializationInfo(&specializationInfo[i]);
          }
       }
    }
-
-   onInitialize.broadcast();
 }
@@ -29,11 +29,21 @@ public:
       {
       }
 
+      // Compute shaders don't have any other stages
+      static ModuleInfo compute(const char* compName_)
+      {
+         ModuleInfo info;
+         info.compName = compName_;
+         return info;
+      }
+
       std::string vertName;
       std::string fragName;
+      std::string compName;
 
       std::string vertEntryPoint = "main";
       std::string fragEntryPoint = "main";
+      std::string compEntryPoint = "main";
    };
 
    Shader(const GraphicsContext& graphicsContext, ResourceManager& resourceManager, const ModuleInfo& info, bool delayInitialization = false);
@@ -48,8 +58,14 @@ protected:
    void setSpecializationInfo(std::span<const vk::SpecializationInfo> specializations);
    std::vector<vk::PipelineShaderStageCreateInfo> getStagesForPermutation(uint32_t permutationIndex) const;
 
+   vk::PipelineBindPoint getBindPoint() const
+   {
+      return moduleInfo.compName.empty() ? vk::PipelineBindPoint::eGraphics : vk::PipelineBindPoint::eCompute;
+   }
+
 private:
    void initializeStageCreateInfo();
+   void initializeStageCreateInfo(const StrongShaderModuleHandle& moduleHandle, vk::ShaderStageFlagBits stage, const std::string& entryPoint, std::vector<vk::PipelineShaderStageCreateInfo>& stageCreateInfo);
 
    InitializeDelegate onInitialize;
 
@@ -58,9 +74,11 @@ private:
 
    StrongShaderModuleHandle vertShaderModuleHandle;
    StrongShaderModuleHandle fragShaderModuleHandle;
+   StrongShaderModuleHandle compShaderModuleHandle;
 
    std::vector<vk::PipelineShaderStageCreateInfo> vertStageCreateInfo;
    std::vector<vk::PipelineShaderStageCreateInfo> fragStageCreateInfo;
+   std::vector<vk::PipelineShaderStageCreateInfo> compStageCreateInfo;
 
 #if FORGE_WITH_SHADER_HOT_RELOADING
    DelegateHandle hotReloadDelegateHandle;
@@ -104,7 +122,7 @@ public:
 
    void bindDescriptorSets(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, const DescriptorTypes&... descriptors)
    {
-      commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 0, { descriptors.getCurrentSet()... }, {});
+      commandBuffer.bindDescriptorSets(getBindPoint(), pipelineLayout, 0, { descriptors.getCurrentSet()... }, {});
    }
 
 private:
@@ -0,0 +1,150 @@
+#include "Graphics/StagingRing.h"
+
+#include "Core/Assert.h"
+#include "Core/Jobs/JobSystem.h"
+
+#include "Graphics/Buffer.h"
+#include "Graphics/DebugUtils.h"
+
+#include <algorithm>
+
+StagingRing::StagingRing(const GraphicsContext& graphicsContext)
+   : GraphicsResource(graphicsContext)
+{
+   void* mappedMemory = nullptr;
+   Buffer::create(context, kCapacity, vk::BufferUsageFlagBits::eTransferSrc, VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT, buffer, allocation, &mappedMemory);
+   NAME_CHILD(buffer, "Buffer");
+
+   mappedData = static_cast<uint8_t*>(mappedMemory);
+}
+
+StagingRing::~StagingRing()
+{
+   ASSERT(ranges.empty());
+
+   vmaDestroyBuffer(context.getVmaAllocator(), buffer, allocation);
+}
+
+StagingRing::Allocation StagingRing::reserve(vk::DeviceSize size, vk::DeviceSize alignment)
+{
+   ASSERT(alignment > 0);
+
+   if (size == 0 || size > kCapacity)
+   {
+      return Allocation();
+   }
+
+   std::unique_lock<std::mutex> lock(mutex);
+
+   uint64_t begin = 0;
+   bool waited = false;
+   while (true)
+   {
+      if (closed)
+      {
+         return Allocation();
+      }
+
+      uint64_t wrapStart = head - head % kCapacity;
+      uint64_t alignedOffset = (head % kCapacity + alignment - 1) / alignment * alignment;
+      begin = alignedOffset + size <= kCapacity ? wrapStart + alignedOffset : wrapStart + kCapacity;
+
+      if (begin + size - tail <= kCapacity)
+      {
+         break;
+      }
+
+      // Threads outside of the job system's pool include the one that frees space (which can end up running load tasks while it waits for other jobs)
+      if (JobSystem::getThreadIndex() == 0)
+      {
+         return Allocation();
+      }
+
+      waited = true;
+      spaceFreed.wait(lock);
+   }
+
+   ranges.push_back(Range{ begin, begin + size });
+   head = begin + size;
+
+   peakBytesInUse = std::max(peakBytesInUse, head - tail);
+   if (waited)
+   {
+      ++numWaits;
+   }
+
+   Allocation result;
+   result.offset = begin % kCapacity;
+   result.size = size;
+   result.data = mappedData + result.offset;
+   return result;
+}
+
+void StagingRing::free(const Allocation& allocationToFree)
+{
+   ASSERT(allocationToFree);
+
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      // Live ranges never overlap, so their offsets in the buffer are unique
+      auto location = std::find_if(ranges.begin(), ranges.end(), [&allocationToFree](const Range& range) { return range.begin % kCapacity == allocationToFree.offset && !range.freed; });
+      ASSERT(location != ranges.end());
+      location->freed = true;
+
+      while (!ranges.empty() && ranges.front().freed)
+      {
+         ranges.pop_front();
+      }
+
+      if (ranges.empty())
+      {
+         // Nothing is in use, so start over at the beginning of the buffer
+         head = 0;
+         tail = 0;
+      }
+      else
+      {
+         tail = ranges.front().begin;
+      }
+   }
+
+   spaceFreed.notify_all();
+}
+
+void StagingRing::flush(const Allocation& allocationToFlush)
+{
+   vmaFlushAllocation(context.getVmaAllocator(), allocation, allocationToFlush.offset, allocationToFlush.size);
+}
+
+void StagingRing::close()
+{
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      closed = true;
+   }
+
+   spaceFreed.notify_all();
+}
+
+std::optional<vk::DeviceSize> StagingRing::findOffset(std::span<const uint8_t> bytes) const
+{
+   if (bytes.data() >= mappedData && bytes.data() + bytes.size() <= mappedData + kCapacity)
+   {
+      return static_cast<vk::DeviceSize>(bytes.data() - mappedData);
+   }
+
+   return std::nullopt;
+}
+
+StagingRingStats StagingRing::getStats() const
+{
+   std::lock_guard<std::mutex> lock(mutex);
+
+   StagingRingStats stats;
+   stats.capacity = kCapacity;
+   stats.bytesInUse = head - tail;
+   stats.peakBytesInUse = peakBytesInUse;
+   stats.numWaits = numWaits;
+   return stats;
+}
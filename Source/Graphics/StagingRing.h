@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Graphics/GraphicsResource.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
+
+struct StagingRingStats
+{
+   vk::DeviceSize capacity = 0;
+   vk::DeviceSize bytesInUse = 0;
+   vk::DeviceSize peakBytesInUse = 0;
+   uint32_t numWaits = 0; // Reservations that had to wait for space to be freed
+};
+
+// Large persistently mapped staging buffer that load tasks reserve space in and write their data to directly, instead of the main thread creating (and copying into)
+// a staging buffer for each resource. Space is handed out in order and can be freed in any order, but is only reused once everything reserved before it has also been
+// freed. Reserving is thread safe, and job system workers wait while the ring is full (space is freed as uploads complete on the GPU).
+class StagingRing : public GraphicsResource
+{
+public:
+   static constexpr vk::DeviceSize kCapacity = 64 * 1024 * 1024;
+
+   struct Allocation
+   {
+      vk::DeviceSize offset = 0;
+      vk::DeviceSize size = 0;
+      uint8_t* data = nullptr;
+
+      explicit operator bool() const
+      {
+         return data != nullptr;
+      }
+
+      std::span<uint8_t> getBytes() const
+      {
+         return std::span<uint8_t>(data, size);
+      }
+   };
+
+   StagingRing(const GraphicsContext& graphicsContext);
+   ~StagingRing();
+
+   // Returns an empty allocation if the size is larger than the whole ring, if the ring has been closed, or if the ring is full and the calling thread isn't a job system
+   // worker (the data then needs a staging buffer of its own)
+   Allocation reserve(vk::DeviceSize size, vk::DeviceSize alignment = 16);
+
+   // Called once nothing will read from the allocation anymore
+   void free(const Allocation& allocation);
+
+   // Makes the written data visible to the device (needed when the memory is not host coherent)
+   void flush(const Allocation& allocation);
+
+   // Fails all current and future reservations, so that load tasks waiting for space can finish during shutdown
+   void close();
+
+   vk::Buffer getBuffer() const
+   {
+      return buffer;
+   }
+
+   // Offset of the data in the ring's buffer, if it is in the ring at all
+   std::optional<vk::DeviceSize> findOffset(std::span<const uint8_t> bytes) const;
+
+   StagingRingStats getStats() const;
+
+private:
+   struct Range
+   {
+      uint64_t begin = 0;
+      uint64_t end = 0;
+      bool freed = false;
+   };
+
+   vk::Buffer buffer;
+   VmaAllocation allocation = nullptr;
+   uint8_t* mappedData = nullptr;
+
+   mutable std::mutex mutex;
+   std::condition_variable spaceFreed;
+
+   // Positions keep increasing, and wrap around the buffer (ranges never straddle the end of the buffer)
+   std::deque<Range> ranges;
+   uint64_t head = 0;
+   uint64_t tail = 0;
+   bool closed = false;
+
+   vk::DeviceSize peakBytesInUse = 0;
+   uint32_t numWaits = 0;
+};
@@ -3,9 +3,9 @@
 #include "Core/Assert.h"
 
 #include "Graphics/Buffer.h"
-#include "Graphics/Command.h"
 #include "Graphics/DebugUtils.h"
 #include "Graphics/Memory.h"
+#include "Graphics/UploadQueue.h"
 
 #include <cmath>
 #include <utility>
@@ -151,6 +151,10 @@ Texture::Texture(const GraphicsContext& graphicsContext, const ImageProperties&
          textureProperties.usage |= vk::ImageUsageFlagBits::eTransferSrc;
       }
    }
+   else if (textureProperties.allocateMipMaps)
+   {
+      mipLevels = calcMipLevels(imageProperties);
+   }
 
    createImage();
    createDefaultView();
@@ -210,6 +214,24 @@ vk::ImageView Texture::getOrCreateView(vk::ImageViewType viewType, uint32_t base
    desc.layerCount = layerCount;
    desc.aspectFlags = aspectFlags.value_or(textureProperties.aspects);
 
+   return getOrCreateView(desc, created);
+}
+
+vk::ImageView Texture::getOrCreateMipView(uint32_t mipLevel)
+{
+   ASSERT(mipLevel < mipLevels);
+
+   ImageViewDesc desc;
+   desc.viewType = vk::ImageViewType::e2D;
+   desc.baseMipLevel = mipLevel;
+   desc.mipLevelCount = 1;
+   desc.aspectFlags = textureProperties.aspects;
+
+   return getOrCreateView(desc, nullptr);
+}
+
+vk::ImageView Texture::getOrCreateView(const ImageViewDesc& desc, bool* created)
+{
    auto location = viewMap.find(desc);
    if (location != viewMap.end())
    {
@@ -221,15 +243,15 @@ vk::ImageView Texture::getOrCreateView(vk::ImageViewType viewType, uint32_t base
    }
 
    vk::ImageSubresourceRange subresourceRange = vk::ImageSubresourceRange()
-      .setAspectMask(aspectFlags.value_or(textureProperties.aspects))
-      .setBaseMipLevel(0)
-      .setLevelCount(mipLevels)
-      .setBaseArrayLayer(baseLayer)
-      .setLayerCount(layerCount);
+      .setAspectMask(desc.aspectFlags)
+      .setBaseMipLevel(desc.baseMipLevel)
+      .setLevelCount(desc.mipLevelCount)
+      .setBaseArrayLayer(desc.baseLayer)
+      .setLayerCount(desc.layerCount);
 
    vk::ImageViewCreateInfo createInfo = vk::ImageViewCreateInfo()
       .setImage(image)
-      .setViewType(viewType)
+      .setViewType(desc.viewType)
       .setFormat(imageProperties.format)
       .setSubresourceRange(subresourceRange);
 
@@ -266,20 +288,14 @@ void Texture::transitionLayout(vk::CommandBuffer commandBuffer, vk::ImageLayout
          .setSrcAccessMask(srcMemoryBarrierFlags.accessMask)
          .setDstAccessMask(dstMemoryBarrierFlags.accessMask);
 
-      bool singleCommandBuffer = false;
+      // Without a command buffer, the transition goes along with the uploads, which are submitted ahead of the frame
       if (!commandBuffer)
       {
-         singleCommandBuffer = true;
-         commandBuffer = Command::beginSingle(context);
+         commandBuffer = context.getUploadQueue().getCommandBuffer();
       }
 
       commandBuffer.pipelineBarrier(srcMemoryBarrierFlags.stageMask, dstMemoryBarrierFlags.stageMask, vk::DependencyFlags(), nullptr, nullptr, { barrier });
 
-      if (singleCommandBuffer)
-      {
-         Command::endSingle(context, commandBuffer);
-      }
-
       layout = newLayout;
    }
 }
@@ -338,9 +354,10 @@ void Texture::createDefaultView()
    NAME_CHILD(defaultView, "Default View");
 }
 
-void Texture::copyBufferToImage(vk::Buffer buffer, const TextureData& textureData)
+void Texture::copyBufferToImage(vk::Buffer buffer, vk::DeviceSize bufferOffset, const TextureData& textureData)
 {
-   vk::CommandBuffer commandBuffer = Command::beginSingle(context);
+   UploadQueue& uploadQueue = context.getUploadQueue();
+   vk::CommandBuffer commandBuffer = uploadQueue.getTransferCommandBuffer();
 
    std::vector<vk::BufferImageCopy> regions;
    regions.reserve(textureData.mips.size());
@@ -361,7 +378,7 @@ void Texture::copyBufferToImage(vk::Buffer buffer, const TextureData& textureDat
             .setLayerCount(1);
 
          vk::BufferImageCopy region = vk::BufferImageCopy()
-            .setBufferOffset(mipInfo.bufferOffset)
+            .setBufferOffset(bufferOffset + mipInfo.bufferOffset)
             .setBufferRowLength(0)
             .setBufferImageHeight(0)
             .setImageSubresource(imageSubresource)
@@ -372,15 +389,33 @@ void Texture::copyBufferToImage(vk::Buffer buffer, const TextureData& textureDat
       }
    }
 
+   // Every region is a whole mip, which is always allowed by the transfer queue's image transfer granularity
    layout = vk::ImageLayout::eTransferDstOptimal;
    commandBuffer.copyBufferToImage(buffer, image, layout, regions);
 
-   Command::endSingle(context, commandBuffer);
+   vk::ImageSubresourceRange subresourceRange = vk::ImageSubresourceRange()
+      .setAspectMask(textureProperties.aspects)
+      .setBaseMipLevel(0)
+      .setLevelCount(mipLevels)
+      .setBaseArrayLayer(0)
+      .setLayerCount(imageProperties.layers);
+
+   uploadQueue.transferImageOwnership(image, subresourceRange, layout);
 }
 
 void Texture::stageAndCopyImage(const TextureData& textureData)
 {
-   transitionLayout(nullptr, vk::ImageLayout::eTransferDstOptimal, TextureMemoryBarrierFlags(vk::AccessFlags(), vk::PipelineStageFlagBits::eTopOfPipe), TextureMemoryBarrierFlags(vk::AccessFlagBits::eTransferWrite, vk::PipelineStageFlagBits::eTransfer));
+   UploadQueue& uploadQueue = context.getUploadQueue();
+
+   transitionLayout(uploadQueue.getTransferCommandBuffer(), vk::ImageLayout::eTransferDstOptimal, TextureMemoryBarrierFlags(vk::AccessFlags(), vk::PipelineStageFlagBits::eTopOfPipe), TextureMemoryBarrierFlags(vk::AccessFlagBits::eTransferWrite, vk::PipelineStageFlagBits::eTransfer));
+
+   // Data that a load task wrote to the staging ring is copied from there directly (the loader frees it)
+   StagingRing& stagingRing = uploadQueue.getStagingRing();
+   if (std::optional<vk::DeviceSize> stagingRingOffset = stagingRing.findOffset(textureData.bytes))
+   {
+      copyBufferToImage(stagingRing.getBuffer(), *stagingRingOffset, textureData);
+      return;
+   }
 
    vk::Buffer stagingBuffer;
    VmaAllocation stagingBufferAllocation = nullptr;
@@ -390,9 +425,9 @@ void Texture::stageAndCopyImage(const TextureData& textureData)
    std::memcpy(mappedMemory, textureData.bytes.data(), textureData.bytes.size_bytes());
    mappedMemory = nullptr;
 
-   copyBufferToImage(stagingBuffer, textureData);
+   copyBufferToImage(stagingBuffer, 0, textureData);
 
-   vmaDestroyBuffer(context.getVmaAllocator(), stagingBuffer, stagingBufferAllocation);
+   uploadQueue.releaseStagingBuffer(stagingBuffer, stagingBufferAllocation, textureData.bytes.size_bytes());
 }
 
 void Texture::generateMipmaps(vk::ImageLayout finalLayout, const TextureMemoryBarrierFlags& dstMemoryBarrierFlags)
@@ -403,7 +438,7 @@ void Texture::generateMipmaps(vk::ImageLayout finalLayout, const TextureMemoryBa
       throw std::runtime_error("Image format " + to_string(imageProperties.format) + " does not support linear blitting");
    }
 
-   vk::CommandBuffer commandBuffer = Command::beginSingle(context);
+   vk::CommandBuffer commandBuffer = context.getUploadQueue().getCommandBuffer();
 
    vk::ImageSubresourceRange subresourceRange = vk::ImageSubresourceRange()
       .setAspectMask(textureProperties.aspects)
@@ -495,7 +530,5 @@ void Texture::generateMipmaps(vk::ImageLayout finalLayout, const TextureMemoryBa
 
    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, dstMemoryBarrierFlags.stageMask, vk::DependencyFlags(), nullptr, nullptr, { barrier });
 
-   Command::endSingle(context, commandBuffer);
-
    layout = finalLayout;
 }
@@ -32,13 +32,15 @@ struct ImageViewDesc
    vk::ImageViewType viewType = vk::ImageViewType::e2D;
    uint32_t baseLayer = 0;
    uint32_t layerCount = 1;
+   uint32_t baseMipLevel = 0;
+   uint32_t mipLevelCount = VK_REMAINING_MIP_LEVELS;
    vk::ImageAspectFlags aspectFlags = vk::ImageAspectFlagBits::eNone;
 
    bool operator==(const ImageViewDesc& other) const = default;
 
    std::size_t hash() const
    {
-      return Hash::of(viewType, baseLayer, layerCount, static_cast<VkImageAspectFlags>(aspectFlags));
+      return Hash::of(viewType, baseLayer, layerCount, baseMipLevel, mipLevelCount, static_cast<VkImageAspectFlags>(aspectFlags));
    }
 };
 
@@ -61,6 +63,10 @@ public:
    ~Texture();
 
    vk::ImageView getOrCreateView(vk::ImageViewType viewType, uint32_t baseLayer = 0, uint32_t layerCount = 1, std::optional<vk::ImageAspectFlags> aspectFlags = {}, bool* created = nullptr);
+
+   // 2D view of a single mip level (e.g. for writing to it as a storage image)
+   vk::ImageView getOrCreateMipView(uint32_t mipLevel);
+
    void transitionLayout(vk::CommandBuffer commandBuffer, vk::ImageLayout newLayout, const TextureMemoryBarrierFlags& srcMemoryBarrierFlags, const TextureMemoryBarrierFlags& dstMemoryBarrierFlags);
    void transitionLayout(vk::CommandBuffer commandBuffer, TextureLayoutType layoutType);
 
@@ -95,9 +101,11 @@ public:
    }
 
 private:
+   vk::ImageView getOrCreateView(const ImageViewDesc& desc, bool* created);
+
    void createImage();
    void createDefaultView();
-   void copyBufferToImage(vk::Buffer buffer, const TextureData& textureData);
+   void copyBufferToImage(vk::Buffer buffer, vk::DeviceSize bufferOffset, const TextureData& textureData);
    void stageAndCopyImage(const TextureData& textureData);
    void generateMipmaps(vk::ImageLayout finalLayout, const TextureMemoryBarrierFlags& dstMemoryBarrierFlags);
 
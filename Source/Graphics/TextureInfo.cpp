@@ -1,7 +1,5 @@
 #include "Graphics/TextureInfo.h"
 
-#include "Graphics/Texture.h"
-
 namespace FormatHelpers
 {
    bool isDepthStencil(vk::Format format)
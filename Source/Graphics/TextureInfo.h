@@ -26,6 +26,7 @@ struct TextureProperties
    vk::ImageAspectFlags aspects = vk::ImageAspectFlagBits::eColor;
 
    bool generateMipMaps = false;
+   bool allocateMipMaps = false; // Allocates the full mip chain of a texture without any initial data, to be filled in later
 };
 
 struct MipInfo
@@ -0,0 +1,357 @@
+#include "Graphics/UploadQueue.h"
+
+#include "Core/Assert.h"
+
+#include "Graphics/DebugUtils.h"
+#include "Graphics/QueueOwnership.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+UploadQueue::UploadQueue(const GraphicsContext& graphicsContext)
+   : GraphicsResource(graphicsContext)
+   , stagingRing(graphicsContext)
+{
+   vk::CommandPoolCreateInfo commandPoolCreateInfo = vk::CommandPoolCreateInfo()
+      .setQueueFamilyIndex(context.getGraphicsFamilyIndex())
+      .setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+
+   commandPool = device.createCommandPool(commandPoolCreateInfo);
+   NAME_CHILD(commandPool, "Command Pool");
+
+   if (context.hasDedicatedTransferQueue())
+   {
+      vk::CommandPoolCreateInfo transferCommandPoolCreateInfo = vk::CommandPoolCreateInfo()
+         .setQueueFamilyIndex(context.getTransferFamilyIndex())
+         .setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+
+      transferCommandPool = device.createCommandPool(transferCommandPoolCreateInfo);
+      NAME_CHILD(transferCommandPool, "Transfer Command Pool");
+   }
+
+   if (context.supportsTimelineSemaphores())
+   {
+      vk::SemaphoreTypeCreateInfo semaphoreTypeCreateInfo = vk::SemaphoreTypeCreateInfo()
+         .setSemaphoreType(vk::SemaphoreType::eTimeline)
+         .setInitialValue(0);
+
+      vk::SemaphoreCreateInfo semaphoreCreateInfo = vk::SemaphoreCreateInfo()
+         .setPNext(&semaphoreTypeCreateInfo);
+
+      timelineSemaphore = device.createSemaphore(semaphoreCreateInfo);
+      NAME_CHILD(timelineSemaphore, "Timeline Semaphore");
+   }
+}
+
+UploadQueue::~UploadQueue()
+{
+   flush();
+   ASSERT(submittedBatches.empty());
+
+   for (vk::Fence fence : freeFences)
+   {
+      device.destroyFence(fence);
+   }
+
+   for (vk::Semaphore semaphore : freeTransferSemaphores)
+   {
+      device.destroySemaphore(semaphore);
+   }
+
+   if (timelineSemaphore)
+   {
+      device.destroySemaphore(timelineSemaphore);
+   }
+
+   if (transferCommandPool)
+   {
+      device.destroyCommandPool(transferCommandPool);
+   }
+   device.destroyCommandPool(commandPool);
+}
+
+void UploadQueue::onFrameIndexUpdate()
+{
+   retireCompletedBatches();
+
+   stats = UploadStats();
+   stats.dedicatedTransferQueue = context.hasDedicatedTransferQueue();
+   stats.pendingBatches = static_cast<uint32_t>(submittedBatches.size());
+   stats.stagingRing = stagingRing.getStats();
+}
+
+vk::CommandBuffer UploadQueue::getCommandBuffer()
+{
+   if (!recordingBatch.commandBuffer)
+   {
+      recordingBatch.commandBuffer = beginCommandBuffer(commandPool);
+      recordingBatch.value = ++lastValue;
+   }
+
+   return recordingBatch.commandBuffer;
+}
+
+vk::CommandBuffer UploadQueue::getTransferCommandBuffer()
+{
+   if (!transferCommandPool)
+   {
+      return getCommandBuffer();
+   }
+
+   if (!recordingBatch.transferCommandBuffer)
+   {
+      // Every batch ends on the graphics queue, which acquires what was transferred and signals completion
+      getCommandBuffer();
+
+      recordingBatch.transferCommandBuffer = beginCommandBuffer(transferCommandPool);
+   }
+
+   return recordingBatch.transferCommandBuffer;
+}
+
+void UploadQueue::transferBufferOwnership(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size, vk::AccessFlags dstAccessMask, vk::PipelineStageFlags dstStageMask)
+{
+   ASSERT(transferCommandPool);
+
+   QueueOwnership::Transfer<vk::BufferMemoryBarrier> transfer = QueueOwnership::createBufferTransfer(context.getTransferFamilyIndex(), context.getGraphicsFamilyIndex(), buffer, offset, size, dstAccessMask);
+   getTransferCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, vk::DependencyFlags(), nullptr, { transfer.release }, nullptr);
+   getCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, dstStageMask, vk::DependencyFlags(), nullptr, { transfer.acquire }, nullptr);
+
+   ++stats.ownershipTransfers;
+}
+
+void UploadQueue::transferImageOwnership(vk::Image image, const vk::ImageSubresourceRange& subresourceRange, vk::ImageLayout layout)
+{
+   // Both queues are the same, and the commands that follow already synchronize with the copies
+   if (!transferCommandPool)
+   {
+      return;
+   }
+
+   QueueOwnership::Transfer<vk::ImageMemoryBarrier> transfer = QueueOwnership::createImageTransfer(context.getTransferFamilyIndex(), context.getGraphicsFamilyIndex(), image, subresourceRange, layout);
+   getTransferCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, vk::DependencyFlags(), nullptr, nullptr, { transfer.release });
+   getCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, { transfer.acquire });
+
+   ++stats.ownershipTransfers;
+}
+
+void UploadQueue::releaseStagingBuffer(vk::Buffer buffer, VmaAllocation allocation, vk::DeviceSize size)
+{
+   // Staging buffers are only used by commands in the batch that is being recorded
+   ASSERT(recordingBatch.commandBuffer);
+
+   recordingBatch.stagingBuffers.push_back(StagingBuffer{ buffer, allocation });
+
+   ++stats.stagingBuffers;
+   stats.stagingBytes += size;
+}
+
+void UploadQueue::releaseStagingAllocation(const StagingRing::Allocation& allocation)
+{
+   ASSERT(allocation);
+
+   if (!recordingBatch.commandBuffer)
+   {
+      // Nothing has been recorded that could read from it
+      stagingRing.free(allocation);
+      return;
+   }
+
+   // The data was written by a load task, so this is the first point at which it is known to be complete
+   stagingRing.flush(allocation);
+   recordingBatch.stagingRingAllocations.push_back(allocation);
+
+   ++stats.stagingRingAllocations;
+   stats.stagingBytes += allocation.size;
+}
+
+bool UploadQueue::isComplete(uint64_t value)
+{
+   if (value > completedValue)
+   {
+      completedValue = queryCompletedValue();
+   }
+
+   return value <= completedValue;
+}
+
+void UploadQueue::submit()
+{
+   if (!recordingBatch.commandBuffer)
+   {
+      return;
+   }
+
+   if (recordingBatch.transferCommandBuffer)
+   {
+      recordingBatch.transferCommandBuffer.end();
+
+      if (freeTransferSemaphores.empty())
+      {
+         recordingBatch.transferSemaphore = device.createSemaphore(vk::SemaphoreCreateInfo());
+         NAME_CHILD(recordingBatch.transferSemaphore, "Transfer Semaphore");
+      }
+      else
+      {
+         recordingBatch.transferSemaphore = freeTransferSemaphores.back();
+         freeTransferSemaphores.pop_back();
+      }
+
+      vk::SubmitInfo transferSubmitInfo = vk::SubmitInfo()
+         .setCommandBuffers(recordingBatch.transferCommandBuffer)
+         .setSignalSemaphores(recordingBatch.transferSemaphore);
+
+      context.getTransferQueue().submit({ transferSubmitInfo });
+   }
+
+   recordingBatch.commandBuffer.end();
+
+   vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo = vk::TimelineSemaphoreSubmitInfo()
+      .setSignalSemaphoreValues(recordingBatch.value);
+
+   vk::PipelineStageFlags transferWaitStageMask = vk::PipelineStageFlagBits::eAllCommands;
+   vk::SubmitInfo submitInfo = vk::SubmitInfo()
+      .setCommandBuffers(recordingBatch.commandBuffer);
+
+   if (recordingBatch.transferSemaphore)
+   {
+      submitInfo.setWaitSemaphores(recordingBatch.transferSemaphore);
+      submitInfo.setWaitDstStageMask(transferWaitStageMask);
+   }
+
+   if (timelineSemaphore)
+   {
+      submitInfo.setSignalSemaphores(timelineSemaphore);
+      submitInfo.setPNext(&timelineSubmitInfo);
+   }
+   else
+   {
+      if (freeFences.empty())
+      {
+         recordingBatch.fence = device.createFence(vk::FenceCreateInfo());
+         NAME_CHILD(recordingBatch.fence, "Fence");
+      }
+      else
+      {
+         recordingBatch.fence = freeFences.back();
+         freeFences.pop_back();
+      }
+   }
+
+   context.getGraphicsQueue().submit({ submitInfo }, recordingBatch.fence);
+
+   submittedBatches.push_back(std::move(recordingBatch));
+   recordingBatch = Batch();
+
+   ++stats.submittedBatches;
+   stats.pendingBatches = static_cast<uint32_t>(submittedBatches.size());
+}
+
+void UploadQueue::flush()
+{
+   submit();
+
+   if (timelineSemaphore)
+   {
+      vk::SemaphoreWaitInfo waitInfo = vk::SemaphoreWaitInfo()
+         .setSemaphores(timelineSemaphore)
+         .setValues(lastValue);
+
+      if (device.waitSemaphores(waitInfo, UINT64_MAX, GraphicsContext::GetDynamicLoader()) != vk::Result::eSuccess)
+      {
+         throw std::runtime_error("Failed to wait for upload semaphore");
+      }
+   }
+   else
+   {
+      for (const Batch& batch : submittedBatches)
+      {
+         if (device.waitForFences({ batch.fence }, true, UINT64_MAX) != vk::Result::eSuccess)
+         {
+            throw std::runtime_error("Failed to wait for upload fence");
+         }
+      }
+   }
+
+   retireCompletedBatches();
+}
+
+vk::CommandBuffer UploadQueue::beginCommandBuffer(vk::CommandPool pool)
+{
+   vk::CommandBufferAllocateInfo allocateInfo = vk::CommandBufferAllocateInfo()
+      .setCommandPool(pool)
+      .setLevel(vk::CommandBufferLevel::ePrimary)
+      .setCommandBufferCount(1);
+
+   std::vector<vk::CommandBuffer> commandBuffers = device.allocateCommandBuffers(allocateInfo);
+   ASSERT(commandBuffers.size() == 1);
+
+   vk::CommandBufferBeginInfo beginInfo = vk::CommandBufferBeginInfo()
+      .setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+   commandBuffers[0].begin(beginInfo);
+
+   return commandBuffers[0];
+}
+
+uint64_t UploadQueue::queryCompletedValue()
+{
+   if (timelineSemaphore)
+   {
+      return device.getSemaphoreCounterValue(timelineSemaphore, GraphicsContext::GetDynamicLoader());
+   }
+
+   // Batches are submitted to the same queue, so they complete in order
+   uint64_t value = completedValue;
+   for (const Batch& batch : submittedBatches)
+   {
+      if (device.getFenceStatus(batch.fence) != vk::Result::eSuccess)
+      {
+         break;
+      }
+
+      value = batch.value;
+   }
+
+   return value;
+}
+
+void UploadQueue::retireCompletedBatches()
+{
+   completedValue = queryCompletedValue();
+
+   auto firstPending = std::find_if(submittedBatches.begin(), submittedBatches.end(), [this](const Batch& batch) { return batch.value > completedValue; });
+   for (auto batch = submittedBatches.begin(); batch != firstPending; ++batch)
+   {
+      for (StagingBuffer& stagingBuffer : batch->stagingBuffers)
+      {
+         vmaDestroyBuffer(context.getVmaAllocator(), stagingBuffer.buffer, stagingBuffer.allocation);
+      }
+
+      for (const StagingRing::Allocation& allocation : batch->stagingRingAllocations)
+      {
+         stagingRing.free(allocation);
+      }
+
+      device.freeCommandBuffers(commandPool, batch->commandBuffer);
+
+      if (batch->transferCommandBuffer)
+      {
+         device.freeCommandBuffers(transferCommandPool, batch->transferCommandBuffer);
+      }
+
+      // The graphics queue's wait has completed, which leaves the semaphore unsignalled and ready to be reused
+      if (batch->transferSemaphore)
+      {
+         freeTransferSemaphores.push_back(batch->transferSemaphore);
+      }
+
+      if (batch->fence)
+      {
+         device.resetFences({ batch->fence });
+         freeFences.push_back(batch->fence);
+      }
+   }
+
+   submittedBatches.erase(submittedBatches.begin(), firstPending);
+}
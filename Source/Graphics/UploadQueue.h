@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Graphics/GraphicsResource.h"
+#include "Graphics/StagingRing.h"
+
+#include <cstdint>
+#include <vector>
+
+// Uploads recorded since the previous frame
+struct UploadStats
+{
+   bool dedicatedTransferQueue = false;
+   uint32_t submittedBatches = 0;
+   uint32_t ownershipTransfers = 0;
+   uint32_t stagingBuffers = 0; // Data that didn't fit in the staging ring (larger than the ring, or the ring was full on a thread that can't wait for space)
+   uint32_t stagingRingAllocations = 0;
+   uint64_t stagingBytes = 0;
+   uint32_t pendingBatches = 0; // Submitted, but not yet complete
+   StagingRingStats stagingRing; // As of the start of the frame
+};
+
+// Records resource uploads (staging copies, layout transitions, and mip generation) into a command buffer that is submitted once per frame ahead of the frame's own
+// commands, instead of submitting and waiting for the queue to go idle for each one. Completion is tracked with a timeline semaphore (or a fence per batch on devices
+// without timeline semaphores), so that loaders can hold on to resources until their data has actually arrived.
+// When the device has a dedicated transfer queue, copies are recorded into a separate command buffer that is submitted to it, and the graphics queue's part of the
+// batch waits for it (taking ownership of everything that was written). Otherwise both command buffers are the same.
+class UploadQueue : public GraphicsResource
+{
+public:
+   UploadQueue(const GraphicsContext& graphicsContext);
+   ~UploadQueue();
+
+   void onFrameIndexUpdate();
+
+   // Starts a new batch if nothing has been recorded since the last submit. Commands that need the graphics queue (blits and layout transitions for rendering) go here.
+   vk::CommandBuffer getCommandBuffer();
+
+   // Copies go here, and need their destination handed over to the graphics queue with one of the ownership transfers below before the batch is submitted
+   vk::CommandBuffer getTransferCommandBuffer();
+
+   // Whether copies go to a separate command buffer for a dedicated transfer queue (see getTransferCommandBuffer())
+   bool hasDedicatedTransferQueue() const
+   {
+      return static_cast<bool>(transferCommandPool);
+   }
+
+   // Releases a range written by the transfer command buffer from the transfer queue family, and acquires it for the given uses on the graphics queue family. Only
+   // valid with a dedicated transfer queue.
+   void transferBufferOwnership(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size, vk::AccessFlags dstAccessMask, vk::PipelineStageFlags dstStageMask);
+
+   // Same as above for an image, which needs to stay in the given layout across the transfer. Afterwards, the image is ready for more transfer commands on the graphics
+   // queue (e.g. generating mips, or a transition to its final layout).
+   void transferImageOwnership(vk::Image image, const vk::ImageSubresourceRange& subresourceRange, vk::ImageLayout layout);
+
+   // Destroys the staging buffer once the commands recorded so far have completed
+   void releaseStagingBuffer(vk::Buffer buffer, VmaAllocation allocation, vk::DeviceSize size);
+
+   // Frees the staging ring space once the commands recorded so far have completed
+   void releaseStagingAllocation(const StagingRing::Allocation& allocation);
+
+   StagingRing& getStagingRing()
+   {
+      return stagingRing;
+   }
+
+   // Value of the most recent batch, which is complete once everything recorded so far has executed
+   uint64_t getPendingValue() const
+   {
+      return lastValue;
+   }
+
+   bool isComplete(uint64_t value);
+
+   // Submits the current batch (to the transfer queue, then to the graphics queue). Must be called before submitting anything that uses the uploaded resources.
+   void submit();
+
+   // Submits the current batch, and waits for every batch to complete
+   void flush();
+
+   const UploadStats& getStats() const
+   {
+      return stats;
+   }
+
+private:
+   struct StagingBuffer
+   {
+      vk::Buffer buffer;
+      VmaAllocation allocation = nullptr;
+   };
+
+   struct Batch
+   {
+      vk::CommandBuffer commandBuffer;
+      vk::CommandBuffer transferCommandBuffer; // Only used with a dedicated transfer queue
+      vk::Semaphore transferSemaphore; // Signalled by the transfer queue, waited on by the graphics queue
+      vk::Fence fence; // Only used without timeline semaphores
+      uint64_t value = 0;
+      std::vector<StagingBuffer> stagingBuffers;
+      std::vector<StagingRing::Allocation> stagingRingAllocations;
+   };
+
+   vk::CommandBuffer beginCommandBuffer(vk::CommandPool pool);
+   uint64_t queryCompletedValue();
+   void retireCompletedBatches();
+
+   vk::CommandPool commandPool;
+   vk::CommandPool transferCommandPool;
+   vk::Semaphore timelineSemaphore;
+   std::vector<vk::Fence> freeFences;
+   std::vector<vk::Semaphore> freeTransferSemaphores;
+
+   StagingRing stagingRing;
+
+   Batch recordingBatch;
+   std::vector<Batch> submittedBatches;
+
+   uint64_t lastValue = 0;
+   uint64_t completedValue = 0;
+
+   UploadStats stats;
+};
@@ -8,13 +8,24 @@
 
 #include <boxer/boxer.h>
 
+#include <cstdlib>
 #include <exception>
+#include <string_view>
 
 int main(int argc, char* argv[])
 {
+   uint32_t stressGridSize = 0;
+   for (int i = 1; i + 1 < argc; ++i)
+   {
+      if (std::string_view(argv[i]) == "--stress-grid")
+      {
+         stressGridSize = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+      }
+   }
+
    try
    {
-      ForgeApplication application;
+      ForgeApplication application(stressGridSize);
       application.run();
    }
    catch (const std::exception& e)
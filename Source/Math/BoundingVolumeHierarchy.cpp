@@ -0,0 +1,636 @@
+#include "Math/BoundingVolumeHierarchy.h"
+
+#include "Core/Assert.h"
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+   float surfaceArea(const glm::vec3& min, const glm::vec3& max)
+   {
+      glm::vec3 size = max - min;
+      return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+   }
+}
+
+struct BoundingVolumeHierarchy::BuildResult
+{
+   struct Item
+   {
+      glm::vec3 min = glm::vec3(0.0f);
+      glm::vec3 max = glm::vec3(0.0f);
+      glm::vec3 centroid = glm::vec3(0.0f);
+      LeafId leaf = kInvalidLeaf;
+   };
+
+   std::vector<Item> items;
+
+   std::vector<Node> nodes;
+   uint32_t root = kInvalidNode;
+   double internalSurfaceArea = 0.0;
+
+   void build();
+   std::size_t split(std::size_t begin, std::size_t end, const glm::vec3& centroidMin, const glm::vec3& centroidMax);
+};
+
+void BoundingVolumeHierarchy::BuildResult::build()
+{
+   if (items.empty())
+   {
+      return;
+   }
+
+   struct Task
+   {
+      std::size_t begin = 0;
+      std::size_t end = 0;
+      uint32_t node = kInvalidNode;
+   };
+
+   // A binary tree with one leaf per leaf node
+   nodes.reserve(items.size() * 2 - 1);
+   root = 0;
+   nodes.emplace_back();
+
+   std::vector<Task> tasks;
+   tasks.push_back(Task{ 0, items.size(), root });
+
+   while (!tasks.empty())
+   {
+      Task task = tasks.back();
+      tasks.pop_back();
+
+      glm::vec3 min = items[task.begin].min;
+      glm::vec3 max = items[task.begin].max;
+      glm::vec3 centroidMin = items[task.begin].centroid;
+      glm::vec3 centroidMax = items[task.begin].centroid;
+      for (std::size_t i = task.begin + 1; i < task.end; ++i)
+      {
+         min = glm::min(min, items[i].min);
+         max = glm::max(max, items[i].max);
+         centroidMin = glm::min(centroidMin, items[i].centroid);
+         centroidMax = glm::max(centroidMax, items[i].centroid);
+      }
+
+      nodes[task.node].min = min;
+      nodes[task.node].max = max;
+
+      if (task.end - task.begin == 1)
+      {
+         nodes[task.node].leaf = items[task.begin].leaf;
+         continue;
+      }
+
+      internalSurfaceArea += surfaceArea(min, max);
+
+      std::size_t middle = split(task.begin, task.end, centroidMin, centroidMax);
+
+      uint32_t left = static_cast<uint32_t>(nodes.size());
+      uint32_t right = left + 1;
+      nodes.emplace_back().parent = task.node;
+      nodes.emplace_back().parent = task.node;
+      nodes[task.node].left = left;
+      nodes[task.node].right = right;
+
+      tasks.push_back(Task{ task.begin, middle, left });
+      tasks.push_back(Task{ middle, task.end, right });
+   }
+}
+
+// Bins the items by centroid along the axis with the largest centroid extent, and partitions them at the bin boundary with the lowest surface area heuristic cost
+std::size_t BoundingVolumeHierarchy::BuildResult::split(std::size_t begin, std::size_t end, const glm::vec3& centroidMin, const glm::vec3& centroidMax)
+{
+   static const uint32_t kNumBins = 16;
+
+   struct Bin
+   {
+      glm::vec3 min = glm::vec3(0.0f);
+      glm::vec3 max = glm::vec3(0.0f);
+      uint32_t count = 0;
+   };
+
+   glm::vec3 centroidExtent = centroidMax - centroidMin;
+   int axis = centroidExtent.x >= centroidExtent.y && centroidExtent.x >= centroidExtent.z ? 0 : (centroidExtent.y >= centroidExtent.z ? 1 : 2);
+
+   std::size_t middle = begin + (end - begin) / 2;
+   if (centroidExtent[axis] <= 0.0f)
+   {
+      // All centroids are in the same place, so any split is as good as any other
+      return middle;
+   }
+
+   float axisMin = centroidMin[axis];
+   float binScale = kNumBins / centroidExtent[axis];
+   auto getBinIndex = [axis, axisMin, binScale](const Item& item)
+   {
+      return std::min(static_cast<uint32_t>((item.centroid[axis] - axisMin) * binScale), kNumBins - 1);
+   };
+
+   std::array<Bin, kNumBins> bins;
+   for (std::size_t i = begin; i < end; ++i)
+   {
+      Bin& bin = bins[getBinIndex(items[i])];
+      bin.min = bin.count == 0 ? items[i].min : glm::min(bin.min, items[i].min);
+      bin.max = bin.count == 0 ? items[i].max : glm::max(bin.max, items[i].max);
+      ++bin.count;
+   }
+
+   // Cost of everything to the right of each split, accumulated from the right
+   std::array<float, kNumBins - 1> rightCosts = {};
+   {
+      Bin accumulated;
+      for (uint32_t split = kNumBins - 1; split > 0; --split)
+      {
+         const Bin& bin = bins[split];
+         if (bin.count > 0)
+         {
+            accumulated.min = accumulated.count == 0 ? bin.min : glm::min(accumulated.min, bin.min);
+            accumulated.max = accumulated.count == 0 ? bin.max : glm::max(accumulated.max, bin.max);
+            accumulated.count += bin.count;
+         }
+
+         rightCosts[split - 1] = accumulated.count > 0 ? surfaceArea(accumulated.min, accumulated.max) * accumulated.count : 0.0f;
+      }
+   }
+
+   uint32_t bestSplit = kNumBins;
+   float bestCost = 0.0f;
+   {
+      Bin accumulated;
+      for (uint32_t split = 0; split < kNumBins - 1; ++split)
+      {
+         const Bin& bin = bins[split];
+         if (bin.count > 0)
+         {
+            accumulated.min = accumulated.count == 0 ? bin.min : glm::min(accumulated.min, bin.min);
+            accumulated.max = accumulated.count == 0 ? bin.max : glm::max(accumulated.max, bin.max);
+            accumulated.count += bin.count;
+         }
+
+         if (accumulated.count > 0 && accumulated.count < end - begin)
+         {
+            float cost = surfaceArea(accumulated.min, accumulated.max) * accumulated.count + rightCosts[split];
+            if (bestSplit == kNumBins || cost < bestCost)
+            {
+               bestSplit = split;
+               bestCost = cost;
+            }
+         }
+      }
+   }
+
+   if (bestSplit == kNumBins)
+   {
+      return middle;
+   }
+
+   auto location = std::partition(items.begin() + begin, items.begin() + end, [&getBinIndex, bestSplit](const Item& item)
+   {
+      return getBinIndex(item) <= bestSplit;
+   });
+
+   return static_cast<std::size_t>(location - items.begin());
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy()
+{
+   if (pendingRebuild)
+   {
+      JobSystem::wait(pendingRebuildHandle);
+   }
+}
+
+BoundingVolumeHierarchy::LeafId BoundingVolumeHierarchy::insert(const Bounds& bounds, uint64_t userData)
+{
+   LeafId leafId = kInvalidLeaf;
+   if (freeLeaves.empty())
+   {
+      leafId = static_cast<LeafId>(leaves.size());
+      leaves.emplace_back();
+   }
+   else
+   {
+      leafId = freeLeaves.back();
+      freeLeaves.pop_back();
+   }
+
+   uint32_t node = allocateNode();
+   nodes[node].min = bounds.getMin();
+   nodes[node].max = bounds.getMax();
+   nodes[node].leaf = leafId;
+
+   Leaf& leaf = leaves[leafId];
+   leaf.bounds = bounds;
+   leaf.userData = userData;
+   leaf.node = node;
+
+   unlinkedNodes.push_back(node);
+
+   ++numLeaves;
+   ++numChangesSinceBuild;
+
+   if (pendingRebuild)
+   {
+      pendingChanges.push_back(Change{ leafId, ChangeType::Insert });
+      leaf.hasPendingChange = true;
+   }
+
+   return leafId;
+}
+
+void BoundingVolumeHierarchy::remove(LeafId leafId)
+{
+   ASSERT(leafId < leaves.size() && leaves[leafId].node != kInvalidNode);
+
+   uint32_t node = leaves[leafId].node;
+   detachNode(node);
+   freeNode(node);
+
+   leaves[leafId] = Leaf{};
+   freeLeaves.push_back(leafId);
+
+   --numLeaves;
+   ++numChangesSinceBuild;
+
+   if (pendingRebuild)
+   {
+      pendingChanges.push_back(Change{ leafId, ChangeType::Remove });
+   }
+}
+
+void BoundingVolumeHierarchy::update(LeafId leafId, const Bounds& bounds)
+{
+   ASSERT(leafId < leaves.size() && leaves[leafId].node != kInvalidNode);
+
+   Leaf& leaf = leaves[leafId];
+   leaf.bounds = bounds;
+
+   Node& node = nodes[leaf.node];
+   node.min = bounds.getMin();
+   node.max = bounds.getMax();
+   if (isLinked(leaf.node))
+   {
+      refitAncestors(node.parent);
+   }
+
+   ++numChangesSinceBuild;
+
+   if (pendingRebuild && !leaf.hasPendingChange)
+   {
+      pendingChanges.push_back(Change{ leafId, ChangeType::Update });
+      leaf.hasPendingChange = true;
+   }
+}
+
+void BoundingVolumeHierarchy::maintain()
+{
+   if (pendingRebuild)
+   {
+      if (pendingRebuildHandle.isDone())
+      {
+         finishRebuild();
+      }
+
+      return;
+   }
+
+   // Nothing to link or rebuild (and an empty tree would otherwise never count as inserting individually, starting a rebuild every time)
+   if (numLeaves == 0 && unlinkedNodes.empty())
+   {
+      return;
+   }
+
+   bool insertIndividually = unlinkedNodes.size() < numLeaves * kRebuildInsertFraction;
+   if (insertIndividually)
+   {
+      for (uint32_t unlinkedNode : unlinkedNodes)
+      {
+         insertNode(unlinkedNode);
+      }
+      unlinkedNodes.clear();
+   }
+
+   if (!insertIndividually || (numChangesSinceBuild > 0 && getCost() > buildCost * kRebuildCostRatio))
+   {
+      if (!JobSystem::isInitialized())
+      {
+         rebuild();
+         return;
+      }
+
+      pendingRebuild = startBuild();
+      pendingRebuildHandle = JobSystem::schedule([result = pendingRebuild]()
+      {
+         result->build();
+      }, JobPriority::Low);
+   }
+}
+
+void BoundingVolumeHierarchy::rebuild()
+{
+   finishRebuild();
+
+   std::shared_ptr<BuildResult> result = startBuild();
+   result->build();
+   applyBuild(*result);
+}
+
+float BoundingVolumeHierarchy::getCost() const
+{
+   if (root == kInvalidNode)
+   {
+      return 0.0f;
+   }
+
+   float rootSurfaceArea = surfaceArea(nodes[root].min, nodes[root].max);
+   return rootSurfaceArea > 0.0f ? static_cast<float>(internalSurfaceArea / rootSurfaceArea) : 0.0f;
+}
+
+uint32_t BoundingVolumeHierarchy::allocateNode()
+{
+   if (freeNodes.empty())
+   {
+      nodes.emplace_back();
+      return static_cast<uint32_t>(nodes.size() - 1);
+   }
+
+   uint32_t node = freeNodes.back();
+   freeNodes.pop_back();
+
+   return node;
+}
+
+void BoundingVolumeHierarchy::freeNode(uint32_t node)
+{
+   if (nodes[node].leaf == kInvalidLeaf)
+   {
+      internalSurfaceArea -= surfaceArea(nodes[node].min, nodes[node].max);
+   }
+
+   nodes[node] = Node{};
+   freeNodes.push_back(node);
+}
+
+// Finds the best sibling for the new leaf by descending from the root, only continuing while the cost of pushing the leaf further down could beat pairing it with
+// the current node (the branch and bound approach used by Box2D's dynamic tree)
+void BoundingVolumeHierarchy::insertNode(uint32_t leafNode)
+{
+   if (root == kInvalidNode)
+   {
+      root = leafNode;
+      nodes[leafNode].parent = kInvalidNode;
+      return;
+   }
+
+   glm::vec3 leafMin = nodes[leafNode].min;
+   glm::vec3 leafMax = nodes[leafNode].max;
+
+   auto getDescendCost = [this, &leafMin, &leafMax](uint32_t child)
+   {
+      const Node& childNode = nodes[child];
+      float combinedArea = surfaceArea(glm::min(childNode.min, leafMin), glm::max(childNode.max, leafMax));
+
+      return childNode.leaf != kInvalidLeaf ? combinedArea : combinedArea - surfaceArea(childNode.min, childNode.max);
+   };
+
+   uint32_t sibling = root;
+   while (nodes[sibling].leaf == kInvalidLeaf)
+   {
+      const Node& node = nodes[sibling];
+
+      float area = surfaceArea(node.min, node.max);
+      float combinedArea = surfaceArea(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+      float cost = 2.0f * combinedArea;
+      float inheritanceCost = 2.0f * (combinedArea - area);
+      float leftCost = getDescendCost(node.left) + inheritanceCost;
+      float rightCost = getDescendCost(node.right) + inheritanceCost;
+
+      if (cost < leftCost && cost < rightCost)
+      {
+         break;
+      }
+
+      sibling = leftCost < rightCost ? node.left : node.right;
+   }
+
+   uint32_t oldParent = nodes[sibling].parent;
+   uint32_t newParent = allocateNode();
+
+   nodes[newParent].parent = oldParent;
+   nodes[newParent].left = sibling;
+   nodes[newParent].right = leafNode;
+   setInternalBox(newParent, glm::min(nodes[sibling].min, leafMin), glm::max(nodes[sibling].max, leafMax));
+
+   nodes[sibling].parent = newParent;
+   nodes[leafNode].parent = newParent;
+
+   if (oldParent == kInvalidNode)
+   {
+      root = newParent;
+   }
+   else
+   {
+      if (nodes[oldParent].left == sibling)
+      {
+         nodes[oldParent].left = newParent;
+      }
+      else
+      {
+         nodes[oldParent].right = newParent;
+      }
+
+      refitAncestors(oldParent);
+   }
+}
+
+// Takes the leaf's node out of the tree, or out of the unlinked nodes if it hasn't been linked into the tree yet
+void BoundingVolumeHierarchy::detachNode(uint32_t leafNode)
+{
+   if (isLinked(leafNode))
+   {
+      removeNode(leafNode);
+   }
+   else
+   {
+      auto location = std::find(unlinkedNodes.begin(), unlinkedNodes.end(), leafNode);
+      ASSERT(location != unlinkedNodes.end());
+
+      *location = unlinkedNodes.back();
+      unlinkedNodes.pop_back();
+   }
+}
+
+// Replaces the leaf's parent with its sibling
+void BoundingVolumeHierarchy::removeNode(uint32_t leafNode)
+{
+   if (leafNode == root)
+   {
+      root = kInvalidNode;
+      return;
+   }
+
+   uint32_t parent = nodes[leafNode].parent;
+   uint32_t grandParent = nodes[parent].parent;
+   uint32_t sibling = nodes[parent].left == leafNode ? nodes[parent].right : nodes[parent].left;
+
+   nodes[sibling].parent = grandParent;
+   freeNode(parent);
+
+   if (grandParent == kInvalidNode)
+   {
+      root = sibling;
+   }
+   else
+   {
+      if (nodes[grandParent].left == parent)
+      {
+         nodes[grandParent].left = sibling;
+      }
+      else
+      {
+         nodes[grandParent].right = sibling;
+      }
+
+      refitAncestors(grandParent);
+   }
+
+   nodes[leafNode].parent = kInvalidNode;
+}
+
+void BoundingVolumeHierarchy::refitAncestors(uint32_t node)
+{
+   while (node != kInvalidNode)
+   {
+      const Node& left = nodes[nodes[node].left];
+      const Node& right = nodes[nodes[node].right];
+
+      glm::vec3 min = glm::min(left.min, right.min);
+      glm::vec3 max = glm::max(left.max, right.max);
+      if (min == nodes[node].min && max == nodes[node].max)
+      {
+         // Nothing above this node can change either
+         break;
+      }
+
+      setInternalBox(node, min, max);
+      node = nodes[node].parent;
+   }
+}
+
+void BoundingVolumeHierarchy::setInternalBox(uint32_t node, const glm::vec3& min, const glm::vec3& max)
+{
+   internalSurfaceArea += surfaceArea(min, max) - surfaceArea(nodes[node].min, nodes[node].max);
+
+   nodes[node].min = min;
+   nodes[node].max = max;
+}
+
+std::shared_ptr<BoundingVolumeHierarchy::BuildResult> BoundingVolumeHierarchy::startBuild() const
+{
+   std::shared_ptr<BuildResult> result = std::make_shared<BuildResult>();
+
+   result->items.reserve(numLeaves);
+   for (LeafId leafId = 0; leafId < leaves.size(); ++leafId)
+   {
+      const Leaf& leaf = leaves[leafId];
+      if (leaf.node != kInvalidNode)
+      {
+         BuildResult::Item& item = result->items.emplace_back();
+         item.min = leaf.bounds.getMin();
+         item.max = leaf.bounds.getMax();
+         item.centroid = leaf.bounds.getCenter();
+         item.leaf = leafId;
+      }
+   }
+
+   return result;
+}
+
+void BoundingVolumeHierarchy::finishRebuild()
+{
+   if (pendingRebuild)
+   {
+      JobSystem::wait(pendingRebuildHandle);
+      applyBuild(*pendingRebuild);
+
+      pendingRebuild = nullptr;
+      pendingRebuildHandle = JobHandle();
+   }
+}
+
+// The build contains the leaves as they were when it started, so the changes made since then are replayed onto it
+void BoundingVolumeHierarchy::applyBuild(BuildResult& result)
+{
+   nodes = std::move(result.nodes);
+   freeNodes.clear();
+   unlinkedNodes.clear();
+   root = result.root;
+   internalSurfaceArea = result.internalSurfaceArea;
+
+   for (uint32_t node = 0; node < nodes.size(); ++node)
+   {
+      if (nodes[node].leaf != kInvalidLeaf)
+      {
+         leaves[nodes[node].leaf].node = node;
+      }
+   }
+
+   buildCost = getCost();
+   numChangesSinceBuild = static_cast<uint32_t>(pendingChanges.size());
+
+   if (!pendingChanges.empty())
+   {
+      for (const Change& change : pendingChanges)
+      {
+         replayChange(change);
+      }
+      pendingChanges.clear();
+
+      refitInternalNodes();
+   }
+}
+
+// Leaves always hold their current bounds, so replaying a change only has to bring the leaf's node in the rebuilt tree up to date with them. A removed leaf
+// can be reused by a later insert, which is fine since the changes are replayed in order. Internal nodes are refit afterwards, all at once.
+void BoundingVolumeHierarchy::replayChange(const Change& change)
+{
+   Leaf& leaf = leaves[change.leaf];
+   leaf.hasPendingChange = false;
+
+   if (change.type == ChangeType::Remove)
+   {
+      detachNode(leaf.node);
+      freeNode(leaf.node);
+      leaf.node = kInvalidNode;
+      return;
+   }
+
+   if (change.type == ChangeType::Insert)
+   {
+      leaf.node = allocateNode();
+      nodes[leaf.node].leaf = change.leaf;
+      unlinkedNodes.push_back(leaf.node);
+   }
+
+   nodes[leaf.node].min = leaf.bounds.getMin();
+   nodes[leaf.node].max = leaf.bounds.getMax();
+}
+
+// Relies on every child coming after its parent, which is true of a freshly built tree, and stays true when leaves are removed from it (since a removed leaf's
+// sibling takes the place of their parent)
+void BoundingVolumeHierarchy::refitInternalNodes()
+{
+   internalSurfaceArea = 0.0;
+   for (uint32_t node = static_cast<uint32_t>(nodes.size()); node-- > 0;)
+   {
+      Node& internalNode = nodes[node];
+      if (internalNode.leaf == kInvalidLeaf && internalNode.left != kInvalidNode)
+      {
+         internalNode.min = glm::min(nodes[internalNode.left].min, nodes[internalNode.right].min);
+         internalNode.max = glm::max(nodes[internalNode.left].max, nodes[internalNode.right].max);
+         internalSurfaceArea += surfaceArea(internalNode.min, internalNode.max);
+      }
+   }
+}
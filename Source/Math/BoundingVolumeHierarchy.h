@@ -0,0 +1,240 @@
+#pragma once
+
+#include "Core/Containers/SmallVector.h"
+#include "Core/Jobs/JobSystem.h"
+
+#include "Math/Bounds.h"
+#include "Math/FrustumBatch.h"
+#include "Math/FrustumCulling.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Dynamic AABB tree over leaf bounds. Leaves can be inserted, removed, and moved at any time (which refits their ancestors), and once those changes have degraded the
+// quality of the tree too much, it is rebuilt from scratch (with a binned SAH split) on a worker thread.
+// New leaves are only linked into the tree by maintain() (until then, queries test them one by one), so that adding many leaves at once results in a single rebuild.
+class BoundingVolumeHierarchy
+{
+public:
+   using LeafId = uint32_t;
+
+   static constexpr LeafId kInvalidLeaf = ~0u;
+
+   // Rebuild once the surface area cost of the tree has grown by this factor since it was last built
+   static constexpr float kRebuildCostRatio = 1.5f;
+
+   // Rebuild instead of inserting new leaves one at a time if they make up at least this fraction of all leaves
+   static constexpr float kRebuildInsertFraction = 0.25f;
+
+   BoundingVolumeHierarchy() = default;
+   BoundingVolumeHierarchy(const BoundingVolumeHierarchy& other) = delete;
+   BoundingVolumeHierarchy(BoundingVolumeHierarchy&& other) = delete;
+   ~BoundingVolumeHierarchy();
+
+   BoundingVolumeHierarchy& operator=(const BoundingVolumeHierarchy& other) = delete;
+   BoundingVolumeHierarchy& operator=(BoundingVolumeHierarchy&& other) = delete;
+
+   // Changes made while a rebuild is in progress are applied to the current tree right away, and replayed onto the rebuilt tree once it is swapped in
+   LeafId insert(const Bounds& bounds, uint64_t userData);
+   void remove(LeafId leaf);
+   void update(LeafId leaf, const Bounds& bounds);
+
+   // Swaps in the result of a completed rebuild, links any new leaves into the tree, and starts a new rebuild in the background if the tree has degraded. Should be
+   // called once per frame, after modifying the tree. Never waits for a rebuild in progress.
+   void maintain();
+
+   // Rebuilds the tree immediately, on the calling thread (after waiting for any rebuild in progress)
+   void rebuild();
+
+   uint32_t getNumLeaves() const
+   {
+      return numLeaves;
+   }
+
+   const Bounds& getLeafBounds(LeafId leaf) const
+   {
+      return leaves[leaf].bounds;
+   }
+
+   // Sum of the surface areas of the internal nodes relative to the surface area of the root (the expected number of internal nodes a random ray would visit)
+   float getCost() const;
+
+   float getBuildCost() const
+   {
+      return buildCost;
+   }
+
+   bool isRebuilding() const
+   {
+      return pendingRebuild != nullptr;
+   }
+
+   // Calls function(userData, visibleMask) for each leaf that is visible to at least one of the candidate frustums, only descending into nodes that are visible
+   // Leaves are reported in no particular order
+   template<typename Function>
+   void query(const FrustumBatch& frustumBatch, FrustumBatch::Mask candidates, Function&& function) const
+   {
+      struct StackEntry
+      {
+         uint32_t node = kInvalidNode;
+         FrustumBatch::Mask candidates = 0;
+      };
+
+      candidates &= frustumBatch.getAllMask();
+      if (candidates == 0)
+      {
+         return;
+      }
+
+      // Leaves are gathered into blocks that are tested several at a time against each frustum, with the same results as testing them one by one with
+      // FrustumBatch::getVisibilityMask() (so the results match a linear scan)
+      BoundsSoA leafBounds;
+      std::array<uint64_t, BoundsSoA::kInlineCapacity> leafUserData;
+      std::array<FrustumBatch::Mask, BoundsSoA::kInlineCapacity> leafMasks;
+
+      auto testLeaves = [&frustumBatch, &function, &leafBounds, &leafUserData, &leafMasks]()
+      {
+         frustumBatch.getVisibilityMasks(leafBounds, std::span<FrustumBatch::Mask>(leafMasks.data(), leafBounds.size()));
+         for (std::size_t i = 0; i < leafBounds.size(); ++i)
+         {
+            if (leafMasks[i] != 0)
+            {
+               function(leafUserData[i], leafMasks[i]);
+            }
+         }
+
+         leafBounds.clear();
+      };
+
+      auto queryLeaf = [this, &leafBounds, &leafUserData, &leafMasks, &testLeaves](LeafId leafId, FrustumBatch::Mask leafCandidates)
+      {
+         const Leaf& leaf = leaves[leafId];
+
+         std::size_t index = leafBounds.size();
+         leafBounds.add(leaf.bounds);
+         leafUserData[index] = leaf.userData;
+         leafMasks[index] = leafCandidates;
+
+         if (leafBounds.size() == BoundsSoA::kInlineCapacity)
+         {
+            testLeaves();
+         }
+      };
+
+      for (uint32_t unlinkedNode : unlinkedNodes)
+      {
+         queryLeaf(nodes[unlinkedNode].leaf, candidates);
+      }
+
+      if (root != kInvalidNode)
+      {
+         SmallVector<StackEntry, 64> stack;
+         stack.push_back(StackEntry{ root, candidates });
+
+         while (!stack.empty())
+         {
+            StackEntry entry = stack.back();
+            stack.pop_back();
+
+            const Node& node = nodes[entry.node];
+            if (node.leaf != kInvalidLeaf)
+            {
+               queryLeaf(node.leaf, entry.candidates);
+            }
+            else if (FrustumBatch::Mask visible = frustumBatch.getBoxVisibilityMask(node.min, node.max, entry.candidates))
+            {
+               stack.push_back(StackEntry{ node.right, visible });
+               stack.push_back(StackEntry{ node.left, visible });
+            }
+         }
+      }
+
+      if (!leafBounds.empty())
+      {
+         testLeaves();
+      }
+   }
+
+private:
+   static constexpr uint32_t kInvalidNode = ~0u;
+
+   struct Node
+   {
+      glm::vec3 min = glm::vec3(0.0f);
+      glm::vec3 max = glm::vec3(0.0f);
+      uint32_t parent = kInvalidNode;
+      uint32_t left = kInvalidNode;
+      uint32_t right = kInvalidNode;
+      LeafId leaf = kInvalidLeaf;
+   };
+
+   struct Leaf
+   {
+      Bounds bounds;
+      uint64_t userData = 0;
+      uint32_t node = kInvalidNode;
+
+      // Whether there is already an insert or update for this leaf in pendingChanges (which would bring it up to date with any further moves)
+      bool hasPendingChange = false;
+   };
+
+   struct BuildResult;
+
+   enum class ChangeType : uint8_t
+   {
+      Insert,
+      Remove,
+      Update
+   };
+
+   struct Change
+   {
+      LeafId leaf = kInvalidLeaf;
+      ChangeType type = ChangeType::Update;
+   };
+
+   uint32_t allocateNode();
+   void freeNode(uint32_t node);
+
+   bool isLinked(uint32_t node) const
+   {
+      return node == root || nodes[node].parent != kInvalidNode;
+   }
+
+   void insertNode(uint32_t leafNode);
+   void removeNode(uint32_t leafNode);
+   void detachNode(uint32_t leafNode);
+   void refitAncestors(uint32_t node);
+
+   void setInternalBox(uint32_t node, const glm::vec3& min, const glm::vec3& max);
+
+   std::shared_ptr<BuildResult> startBuild() const;
+   void finishRebuild();
+   void applyBuild(BuildResult& result);
+   void replayChange(const Change& change);
+   void refitInternalNodes();
+
+   std::vector<Node> nodes;
+   std::vector<uint32_t> freeNodes;
+   std::vector<uint32_t> unlinkedNodes;
+   uint32_t root = kInvalidNode;
+
+   std::vector<Leaf> leaves;
+   std::vector<LeafId> freeLeaves;
+   uint32_t numLeaves = 0;
+
+   // Kept up to date incrementally, so that checking the quality of the tree doesn't need to visit every node
+   double internalSurfaceArea = 0.0;
+   float buildCost = 0.0f;
+   uint32_t numChangesSinceBuild = 0;
+
+   std::shared_ptr<BuildResult> pendingRebuild;
+   JobHandle pendingRebuildHandle;
+
+   // Changes made since the pending rebuild started, which it doesn't know about
+   std::vector<Change> pendingChanges;
+};
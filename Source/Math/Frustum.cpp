@@ -0,0 +1,112 @@
+#include "Math/Frustum.h"
+
+#include "Math/Bounds.h"
+
+namespace
+{
+   float signedPlaneDist(const glm::vec3& point, const glm::vec4& plane)
+   {
+      return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+   }
+
+   bool outside(std::span<const glm::vec3> points, const glm::vec4& plane)
+   {
+      for (const glm::vec3& point : points)
+      {
+         if (signedPlaneDist(point, plane) >= 0.0f)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+}
+
+Frustum::Frustum(const glm::mat4& worldToClip)
+{
+   for (int i = 0; i < planes.size(); ++i)
+   {
+      glm::vec4& plane = planes[i];
+
+      int row = i / 2;
+      int sign = (i % 2) == 0 ? 1 : -1;
+
+      plane.x = worldToClip[0][3] + sign * worldToClip[0][row];
+      plane.y = worldToClip[1][3] + sign * worldToClip[1][row];
+      plane.z = worldToClip[2][3] + sign * worldToClip[2][row];
+      plane.w = worldToClip[3][3] + sign * worldToClip[3][row];
+
+      plane /= glm::length(glm::vec3(plane.x, plane.y, plane.z));
+   }
+}
+
+bool Frustum::cull(const glm::vec3& position, float radius) const
+{
+   for (const glm::vec4& plane : planes)
+   {
+      if (signedPlaneDist(position, plane) < -radius)
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+bool Frustum::cull(std::span<const glm::vec3> points) const
+{
+   for (const glm::vec4& plane : planes)
+   {
+      if (outside(points, plane))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+bool Frustum::cullBox(const glm::vec3& min, const glm::vec3& max) const
+{
+   for (const glm::vec4& plane : planes)
+   {
+      float distance = glm::max(plane.x * min.x, plane.x * max.x) + glm::max(plane.y * min.y, plane.y * max.y) + glm::max(plane.z * min.z, plane.z * max.z) + plane.w;
+      if (distance < 0.0f)
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+bool Frustum::cull(const Bounds& bounds) const
+{
+   // First check the bounding sphere
+   if (cull(bounds.getCenter(), bounds.getRadius()))
+   {
+      return true;
+   }
+
+   // Next, check the bounding box
+   glm::vec3 min = bounds.getMin();
+   glm::vec3 max = bounds.getMax();
+   std::array<glm::vec3, 8> corners =
+   {
+      glm::vec3(min.x, min.y, min.z),
+      glm::vec3(min.x, min.y, max.z),
+      glm::vec3(min.x, max.y, min.z),
+      glm::vec3(min.x, max.y, max.z),
+      glm::vec3(max.x, min.y, min.z),
+      glm::vec3(max.x, min.y, max.z),
+      glm::vec3(max.x, max.y, min.z),
+      glm::vec3(max.x, max.y, max.z)
+   };
+   if (cull(corners))
+   {
+      return true;
+   }
+
+   return false;
+}
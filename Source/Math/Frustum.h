@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <span>
+
+class Bounds;
+
+class Frustum
+{
+public:
+   Frustum() = default;
+   Frustum(const glm::mat4& worldToClip);
+
+   const std::array<glm::vec4, 6>& getPlanes() const
+   {
+      return planes;
+   }
+
+   // Conservative tests: they return true only if the shape is entirely outside of the frustum
+   bool cull(const glm::vec3& position, float radius) const;
+   bool cull(std::span<const glm::vec3> points) const;
+   bool cull(const Bounds& bounds) const;
+
+   // Only tests the corner furthest along each plane's normal, which gives the same result as testing all eight corners (since rounding is monotonic)
+   bool cullBox(const glm::vec3& min, const glm::vec3& max) const;
+
+private:
+   std::array<glm::vec4, 6> planes;
+};
@@ -0,0 +1,120 @@
+#include "Math/FrustumBatch.h"
+
+#include "Core/Assert.h"
+
+#include "Math/Bounds.h"
+#include "Math/FrustumCulling.h"
+
+#include <bit>
+
+uint32_t FrustumBatch::addGroup(const glm::vec3& center, float radius)
+{
+   Group& group = groups.emplace_back();
+   group.center = center;
+   group.radius = radius;
+
+   return static_cast<uint32_t>(groups.size() - 1);
+}
+
+uint32_t FrustumBatch::addFrustum(const Frustum& frustum)
+{
+   ASSERT(frustums.size() < kMaxFrustums);
+
+   frustums.push_back(frustum);
+   return getNumFrustums() - 1;
+}
+
+uint32_t FrustumBatch::addFrustum(const Frustum& frustum, uint32_t groupIndex)
+{
+   ASSERT(groupIndex < groups.size());
+
+   uint32_t frustumIndex = addFrustum(frustum);
+   groups[groupIndex].members |= bit(frustumIndex);
+
+   return frustumIndex;
+}
+
+FrustumBatch::Mask FrustumBatch::getVisibilityMask(const Bounds& bounds, Mask candidates) const
+{
+   candidates = cullGroups(bounds.getCenter(), bounds.getRadius(), candidates & getAllMask());
+
+   Mask visible = 0;
+   while (candidates != 0)
+   {
+      uint32_t frustumIndex = static_cast<uint32_t>(std::countr_zero(candidates));
+      candidates &= candidates - 1;
+
+      if (!frustums[frustumIndex].cull(bounds))
+      {
+         visible |= bit(frustumIndex);
+      }
+   }
+
+   return visible;
+}
+
+void FrustumBatch::getVisibilityMasks(const BoundsSoA& bounds, std::span<Mask> masks) const
+{
+   ASSERT(masks.size() >= bounds.size());
+
+   Mask allCandidates = 0;
+   for (std::size_t i = 0; i < bounds.size(); ++i)
+   {
+      masks[i] = cullGroups(glm::vec3(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]), bounds.radius[i], masks[i] & getAllMask());
+      allCandidates |= masks[i];
+   }
+
+   // Every frustum that any of the bounds are a candidate for tests all of them, which is cheaper than picking out the candidates
+   SmallVector<uint8_t, BoundsSoA::kInlineCapacity> visible(bounds.size());
+   while (allCandidates != 0)
+   {
+      uint32_t frustumIndex = static_cast<uint32_t>(std::countr_zero(allCandidates));
+      allCandidates &= allCandidates - 1;
+
+      FrustumCulling::cull(frustums[frustumIndex], bounds, visible);
+      for (std::size_t i = 0; i < bounds.size(); ++i)
+      {
+         if (!visible[i])
+         {
+            masks[i] &= ~bit(frustumIndex);
+         }
+      }
+   }
+}
+
+FrustumBatch::Mask FrustumBatch::getBoxVisibilityMask(const glm::vec3& min, const glm::vec3& max, Mask candidates) const
+{
+   candidates &= getAllMask();
+
+   Mask visible = 0;
+   while (candidates != 0)
+   {
+      uint32_t frustumIndex = static_cast<uint32_t>(std::countr_zero(candidates));
+      candidates &= candidates - 1;
+
+      if (!frustums[frustumIndex].cullBox(min, max))
+      {
+         visible |= bit(frustumIndex);
+      }
+   }
+
+   return visible;
+}
+
+FrustumBatch::Mask FrustumBatch::cullGroups(const glm::vec3& center, float radius, Mask candidates) const
+{
+   for (const Group& group : groups)
+   {
+      if (candidates & group.members)
+      {
+         glm::vec3 offset = center - group.center;
+         float maxDistance = radius + group.radius;
+         if (glm::dot(offset, offset) > maxDistance * maxDistance)
+         {
+            candidates &= ~group.members;
+         }
+      }
+   }
+
+   return candidates;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Math/Frustum.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class Bounds;
+struct BoundsSoA;
+
+// Tests bounds against many frustums at once, producing a mask of the frustums that might see them
+// Frustums can be grouped under a bounding sphere (e.g. the six cube faces of a point light), which is tested once before any of the group's frustums
+class FrustumBatch
+{
+public:
+   using Mask = uint32_t;
+
+   static constexpr uint32_t kMaxFrustums = 32;
+
+   static constexpr Mask bit(uint32_t frustumIndex)
+   {
+      return Mask(1) << frustumIndex;
+   }
+
+   uint32_t addGroup(const glm::vec3& center, float radius);
+   uint32_t addFrustum(const Frustum& frustum);
+   uint32_t addFrustum(const Frustum& frustum, uint32_t groupIndex);
+
+   uint32_t getNumFrustums() const
+   {
+      return static_cast<uint32_t>(frustums.size());
+   }
+
+   Mask getAllMask() const
+   {
+      return frustums.size() == kMaxFrustums ? ~Mask(0) : bit(getNumFrustums()) - 1;
+   }
+
+   // Only the frustums in the candidate mask are tested
+   Mask getVisibilityMask(const Bounds& bounds, Mask candidates) const;
+
+   // Replaces each mask (the candidates of the bounds at the same index) with the same mask that getVisibilityMask() would return, testing the bounds against each
+   // frustum several at a time with FrustumCulling::cull()
+   void getVisibilityMasks(const BoundsSoA& bounds, std::span<Mask> masks) const;
+
+   // Box test only (no group spheres), so a frustum that culls the box also culls any bounds inside of it
+   Mask getBoxVisibilityMask(const glm::vec3& min, const glm::vec3& max, Mask candidates) const;
+
+private:
+   // Removes the members of any group whose bounding sphere the sphere doesn't touch
+   Mask cullGroups(const glm::vec3& center, float radius, Mask candidates) const;
+
+   struct Group
+   {
+      glm::vec3 center = glm::vec3(0.0f);
+      float radius = 0.0f;
+      Mask members = 0;
+   };
+
+   std::vector<Frustum> frustums;
+   std::vector<Group> groups;
+};
@@ -0,0 +1,264 @@
+#include "Math/FrustumCulling.h"
+
+#include "Core/Assert.h"
+
+#include "Math/Bounds.h"
+#include "Math/Frustum.h"
+
+#include <algorithm>
+#include <bit>
+
+// AVX2 is only available when the build requires it (FORGE_ENABLE_AVX2), otherwise x64 falls back to SSE2, which every x64 CPU has
+#if defined(__AVX2__)
+#  define FRUSTUM_CULLING_AVX2 1
+#  include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define FRUSTUM_CULLING_SSE2 1
+#  include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define FRUSTUM_CULLING_NEON 1
+#  include <arm_neon.h>
+#endif
+
+namespace
+{
+#if FRUSTUM_CULLING_AVX2
+   struct Simd
+   {
+      using Float = __m256;
+      using Mask = __m256;
+
+      static constexpr uint32_t kWidth = 8;
+      static constexpr const char* kName = "AVX2";
+
+      static Float load(const float* values) { return _mm256_loadu_ps(values); }
+      static Float splat(float value) { return _mm256_set1_ps(value); }
+      static Float add(Float first, Float second) { return _mm256_add_ps(first, second); }
+      static Float sub(Float first, Float second) { return _mm256_sub_ps(first, second); }
+      static Float mul(Float first, Float second) { return _mm256_mul_ps(first, second); }
+      static Float max(Float first, Float second) { return _mm256_max_ps(first, second); }
+
+      static Mask none() { return _mm256_setzero_ps(); }
+      static Mask less(Float first, Float second) { return _mm256_cmp_ps(first, second, _CMP_LT_OQ); }
+      static Mask either(Mask first, Mask second) { return _mm256_or_ps(first, second); }
+      static uint32_t toBits(Mask mask) { return static_cast<uint32_t>(_mm256_movemask_ps(mask)); }
+   };
+#elif FRUSTUM_CULLING_SSE2
+   struct Simd
+   {
+      using Float = __m128;
+      using Mask = __m128;
+
+      static constexpr uint32_t kWidth = 4;
+      static constexpr const char* kName = "SSE2";
+
+      static Float load(const float* values) { return _mm_loadu_ps(values); }
+      static Float splat(float value) { return _mm_set1_ps(value); }
+      static Float add(Float first, Float second) { return _mm_add_ps(first, second); }
+      static Float sub(Float first, Float second) { return _mm_sub_ps(first, second); }
+      static Float mul(Float first, Float second) { return _mm_mul_ps(first, second); }
+      static Float max(Float first, Float second) { return _mm_max_ps(first, second); }
+
+      static Mask none() { return _mm_setzero_ps(); }
+      static Mask less(Float first, Float second) { return _mm_cmplt_ps(first, second); }
+      static Mask either(Mask first, Mask second) { return _mm_or_ps(first, second); }
+      static uint32_t toBits(Mask mask) { return static_cast<uint32_t>(_mm_movemask_ps(mask)); }
+   };
+#elif FRUSTUM_CULLING_NEON
+   struct Simd
+   {
+      using Float = float32x4_t;
+      using Mask = uint32x4_t;
+
+      static constexpr uint32_t kWidth = 4;
+      static constexpr const char* kName = "NEON";
+
+      static Float load(const float* values) { return vld1q_f32(values); }
+      static Float splat(float value) { return vdupq_n_f32(value); }
+      static Float add(Float first, Float second) { return vaddq_f32(first, second); }
+      static Float sub(Float first, Float second) { return vsubq_f32(first, second); }
+      static Float mul(Float first, Float second) { return vmulq_f32(first, second); }
+      static Float max(Float first, Float second) { return vmaxq_f32(first, second); }
+
+      static Mask none() { return vdupq_n_u32(0); }
+      static Mask less(Float first, Float second) { return vcltq_f32(first, second); }
+      static Mask either(Mask first, Mask second) { return vorrq_u32(first, second); }
+
+      static uint32_t toBits(Mask mask)
+      {
+         static const uint32_t kLaneBits[kWidth] = { 1, 2, 4, 8 };
+         return vaddvq_u32(vandq_u32(mask, vld1q_u32(kLaneBits)));
+      }
+   };
+#endif
+
+   // Frustum::cull() tests the bounding sphere, then all eight box corners against each plane. Instead of the eight corners, this tests the corner that is furthest along
+   // the plane's normal. Since rounding is monotonic, its distance is exactly the largest of the corner distances, so a box is culled in the same cases.
+   std::size_t cullRange(const Frustum& frustum, const BoundsSoA& bounds, std::span<uint8_t> visible, std::size_t begin)
+   {
+      const std::array<glm::vec4, 6>& planes = frustum.getPlanes();
+
+      std::size_t numVisible = 0;
+      for (std::size_t i = begin; i < bounds.size(); ++i)
+      {
+         float centerX = bounds.centerX[i];
+         float centerY = bounds.centerY[i];
+         float centerZ = bounds.centerZ[i];
+
+         float minX = centerX - bounds.extentX[i];
+         float minY = centerY - bounds.extentY[i];
+         float minZ = centerZ - bounds.extentZ[i];
+         float maxX = centerX + bounds.extentX[i];
+         float maxY = centerY + bounds.extentY[i];
+         float maxZ = centerZ + bounds.extentZ[i];
+
+         bool culled = false;
+         for (const glm::vec4& plane : planes)
+         {
+            float sphereDistance = plane.x * centerX + plane.y * centerY + plane.z * centerZ + plane.w;
+            float boxDistance = std::max(plane.x * minX, plane.x * maxX) + std::max(plane.y * minY, plane.y * maxY) + std::max(plane.z * minZ, plane.z * maxZ) + plane.w;
+
+            if (sphereDistance < -bounds.radius[i] || boxDistance < 0.0f)
+            {
+               culled = true;
+               break;
+            }
+         }
+
+         visible[i] = culled ? 0 : 1;
+         numVisible += culled ? 0 : 1;
+      }
+
+      return numVisible;
+   }
+
+#if FRUSTUM_CULLING_AVX2 || FRUSTUM_CULLING_SSE2 || FRUSTUM_CULLING_NEON
+   // Same tests as cullRange(), for Simd::kWidth bounds at a time (with the operations in the same order, so that the results match exactly)
+   // Returns the number of bounds that were processed, which leaves any remainder for cullRange()
+   std::size_t cullVectors(const Frustum& frustum, const BoundsSoA& bounds, std::span<uint8_t> visible, std::size_t& numVisible)
+   {
+      const std::array<glm::vec4, 6>& planes = frustum.getPlanes();
+      std::size_t count = bounds.size() - bounds.size() % Simd::kWidth;
+
+      Simd::Float zero = Simd::splat(0.0f);
+      for (std::size_t i = 0; i < count; i += Simd::kWidth)
+      {
+         Simd::Float centerX = Simd::load(bounds.centerX.data() + i);
+         Simd::Float centerY = Simd::load(bounds.centerY.data() + i);
+         Simd::Float centerZ = Simd::load(bounds.centerZ.data() + i);
+         Simd::Float extentX = Simd::load(bounds.extentX.data() + i);
+         Simd::Float extentY = Simd::load(bounds.extentY.data() + i);
+         Simd::Float extentZ = Simd::load(bounds.extentZ.data() + i);
+         Simd::Float negativeRadius = Simd::sub(zero, Simd::load(bounds.radius.data() + i));
+
+         Simd::Float minX = Simd::sub(centerX, extentX);
+         Simd::Float minY = Simd::sub(centerY, extentY);
+         Simd::Float minZ = Simd::sub(centerZ, extentZ);
+         Simd::Float maxX = Simd::add(centerX, extentX);
+         Simd::Float maxY = Simd::add(centerY, extentY);
+         Simd::Float maxZ = Simd::add(centerZ, extentZ);
+
+         Simd::Mask culled = Simd::none();
+         for (const glm::vec4& plane : planes)
+         {
+            Simd::Float planeX = Simd::splat(plane.x);
+            Simd::Float planeY = Simd::splat(plane.y);
+            Simd::Float planeZ = Simd::splat(plane.z);
+            Simd::Float planeW = Simd::splat(plane.w);
+
+            Simd::Float sphereDistance = Simd::add(Simd::add(Simd::add(Simd::mul(planeX, centerX), Simd::mul(planeY, centerY)), Simd::mul(planeZ, centerZ)), planeW);
+            Simd::Float furthestX = Simd::max(Simd::mul(planeX, minX), Simd::mul(planeX, maxX));
+            Simd::Float furthestY = Simd::max(Simd::mul(planeY, minY), Simd::mul(planeY, maxY));
+            Simd::Float furthestZ = Simd::max(Simd::mul(planeZ, minZ), Simd::mul(planeZ, maxZ));
+            Simd::Float boxDistance = Simd::add(Simd::add(Simd::add(furthestX, furthestY), furthestZ), planeW);
+
+            culled = Simd::either(culled, Simd::either(Simd::less(sphereDistance, negativeRadius), Simd::less(boxDistance, zero)));
+         }
+
+         uint32_t culledBits = Simd::toBits(culled);
+         for (uint32_t lane = 0; lane < Simd::kWidth; ++lane)
+         {
+            visible[i + lane] = ((culledBits >> lane) & 1) ^ 1;
+         }
+         numVisible += Simd::kWidth - std::popcount(culledBits);
+      }
+
+      return count;
+   }
+#endif
+}
+
+void BoundsSoA::clear()
+{
+   centerX.clear();
+   centerY.clear();
+   centerZ.clear();
+   extentX.clear();
+   extentY.clear();
+   extentZ.clear();
+   radius.clear();
+}
+
+void BoundsSoA::reserve(std::size_t capacity)
+{
+   centerX.reserve(capacity);
+   centerY.reserve(capacity);
+   centerZ.reserve(capacity);
+   extentX.reserve(capacity);
+   extentY.reserve(capacity);
+   extentZ.reserve(capacity);
+   radius.reserve(capacity);
+}
+
+void BoundsSoA::add(const Bounds& bounds)
+{
+   centerX.push_back(bounds.getCenter().x);
+   centerY.push_back(bounds.getCenter().y);
+   centerZ.push_back(bounds.getCenter().z);
+   extentX.push_back(bounds.getExtent().x);
+   extentY.push_back(bounds.getExtent().y);
+   extentZ.push_back(bounds.getExtent().z);
+   radius.push_back(bounds.getRadius());
+}
+
+namespace FrustumCulling
+{
+   const char* getInstructionSetName()
+   {
+#if FRUSTUM_CULLING_AVX2 || FRUSTUM_CULLING_SSE2 || FRUSTUM_CULLING_NEON
+      return Simd::kName;
+#else
+      return "Scalar";
+#endif
+   }
+
+   uint32_t getLaneWidth()
+   {
+#if FRUSTUM_CULLING_AVX2 || FRUSTUM_CULLING_SSE2 || FRUSTUM_CULLING_NEON
+      return Simd::kWidth;
+#else
+      return 1;
+#endif
+   }
+
+   std::size_t cull(const Frustum& frustum, const BoundsSoA& bounds, std::span<uint8_t> visible)
+   {
+      ASSERT(visible.size() >= bounds.size());
+
+#if FRUSTUM_CULLING_AVX2 || FRUSTUM_CULLING_SSE2 || FRUSTUM_CULLING_NEON
+      std::size_t numVisible = 0;
+      std::size_t numProcessed = cullVectors(frustum, bounds, visible, numVisible);
+
+      return numVisible + cullRange(frustum, bounds, visible, numProcessed);
+#else
+      return cullRange(frustum, bounds, visible, 0);
+#endif
+   }
+
+   std::size_t cullScalar(const Frustum& frustum, const BoundsSoA& bounds, std::span<uint8_t> visible)
+   {
+      ASSERT(visible.size() >= bounds.size());
+
+      return cullRange(frustum, bounds, visible, 0);
+   }
+}
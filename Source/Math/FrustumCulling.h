@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Core/Containers/SmallVector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+class Bounds;
+class Frustum;
+
+// Bounds stored as a structure of arrays (one array per component), so that several of them can be tested with each SIMD instruction
+// Up to kInlineCapacity bounds are stored inline, which is as many as a bounding volume hierarchy query tests at once
+struct BoundsSoA
+{
+   static constexpr std::size_t kInlineCapacity = 32;
+
+   SmallVector<float, kInlineCapacity> centerX;
+   SmallVector<float, kInlineCapacity> centerY;
+   SmallVector<float, kInlineCapacity> centerZ;
+   SmallVector<float, kInlineCapacity> extentX;
+   SmallVector<float, kInlineCapacity> extentY;
+   SmallVector<float, kInlineCapacity> extentZ;
+   SmallVector<float, kInlineCapacity> radius;
+
+   std::size_t size() const
+   {
+      return centerX.size();
+   }
+
+   bool empty() const
+   {
+      return centerX.empty();
+   }
+
+   void clear();
+   void reserve(std::size_t capacity);
+   void add(const Bounds& bounds);
+};
+
+namespace FrustumCulling
+{
+   // Instruction set that the culling kernel was compiled for (AVX2, SSE2, NEON, or Scalar), and the number of bounds it tests at once
+   const char* getInstructionSetName();
+   uint32_t getLaneWidth();
+
+   // Writes 1 for each visible bounds and 0 for each culled one, and returns the number of visible bounds
+   // The results are exactly the same as !Frustum::cull(const Bounds&), since both are compiled without contracting multiplies and adds into FMAs (see Source.cmake)
+   std::size_t cull(const Frustum& frustum, const BoundsSoA& bounds, std::span<uint8_t> visible);
+
+   // Same as cull(), without SIMD instructions
+   std::size_t cullScalar(const Frustum& frustum, const BoundsSoA& bounds, std::span<uint8_t> visible);
+}
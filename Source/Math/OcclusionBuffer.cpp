@@ -0,0 +1,423 @@
+#include "Math/OcclusionBuffer.h"
+
+#include "Core/Assert.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+// AVX2 is only available when the build requires it (FORGE_ENABLE_AVX2), otherwise x64 falls back to SSE2, which every x64 CPU has
+#if defined(__AVX2__)
+#  define OCCLUSION_BUFFER_AVX2 1
+#  include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define OCCLUSION_BUFFER_SSE2 1
+#  include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define OCCLUSION_BUFFER_NEON 1
+#  include <arm_neon.h>
+#endif
+
+namespace
+{
+#if OCCLUSION_BUFFER_AVX2
+   struct Simd
+   {
+      using Float = __m256;
+      using Mask = __m256;
+
+      static constexpr uint32_t kWidth = 8;
+      static constexpr const char* kName = "AVX2";
+
+      static Float load(const float* values) { return _mm256_loadu_ps(values); }
+      static void store(float* destination, Float values) { _mm256_storeu_ps(destination, values); }
+      static Float splat(float value) { return _mm256_set1_ps(value); }
+      static Float add(Float first, Float second) { return _mm256_add_ps(first, second); }
+      static Float mul(Float first, Float second) { return _mm256_mul_ps(first, second); }
+      static Float min(Float first, Float second) { return _mm256_min_ps(first, second); }
+
+      static Mask greaterEqual(Float first, Float second) { return _mm256_cmp_ps(first, second, _CMP_GE_OQ); }
+      static Mask both(Mask first, Mask second) { return _mm256_and_ps(first, second); }
+      static Float select(Mask mask, Float ifSet, Float ifClear) { return _mm256_blendv_ps(ifClear, ifSet, mask); }
+   };
+#elif OCCLUSION_BUFFER_SSE2
+   struct Simd
+   {
+      using Float = __m128;
+      using Mask = __m128;
+
+      static constexpr uint32_t kWidth = 4;
+      static constexpr const char* kName = "SSE2";
+
+      static Float load(const float* values) { return _mm_loadu_ps(values); }
+      static void store(float* destination, Float values) { _mm_storeu_ps(destination, values); }
+      static Float splat(float value) { return _mm_set1_ps(value); }
+      static Float add(Float first, Float second) { return _mm_add_ps(first, second); }
+      static Float mul(Float first, Float second) { return _mm_mul_ps(first, second); }
+      static Float min(Float first, Float second) { return _mm_min_ps(first, second); }
+
+      static Mask greaterEqual(Float first, Float second) { return _mm_cmpge_ps(first, second); }
+      static Mask both(Mask first, Mask second) { return _mm_and_ps(first, second); }
+      static Float select(Mask mask, Float ifSet, Float ifClear) { return _mm_or_ps(_mm_and_ps(mask, ifSet), _mm_andnot_ps(mask, ifClear)); }
+   };
+#elif OCCLUSION_BUFFER_NEON
+   struct Simd
+   {
+      using Float = float32x4_t;
+      using Mask = uint32x4_t;
+
+      static constexpr uint32_t kWidth = 4;
+      static constexpr const char* kName = "NEON";
+
+      static Float load(const float* values) { return vld1q_f32(values); }
+      static void store(float* destination, Float values) { vst1q_f32(destination, values); }
+      static Float splat(float value) { return vdupq_n_f32(value); }
+      static Float add(Float first, Float second) { return vaddq_f32(first, second); }
+      static Float mul(Float first, Float second) { return vmulq_f32(first, second); }
+      static Float min(Float first, Float second) { return vminq_f32(first, second); }
+
+      static Mask greaterEqual(Float first, Float second) { return vcgeq_f32(first, second); }
+      static Mask both(Mask first, Mask second) { return vandq_u32(first, second); }
+      static Float select(Mask mask, Float ifSet, Float ifClear) { return vbslq_f32(mask, ifSet, ifClear); }
+   };
+#endif
+
+#if OCCLUSION_BUFFER_AVX2 || OCCLUSION_BUFFER_SSE2 || OCCLUSION_BUFFER_NEON
+   static_assert(OcclusionBuffer::kTileWidth % Simd::kWidth == 0, "Rows of tiles must be made up of whole vectors");
+#endif
+
+   // Pixel centers, relative to the first pixel of a vector
+   const std::array<float, 8> kLaneOffsets = { 0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f };
+
+   uint32_t roundUp(uint32_t value, uint32_t multiple)
+   {
+      return ((value + multiple - 1) / multiple) * multiple;
+   }
+}
+
+// Edge functions and depth are planes in screen space (value = x * dx + y * dy + c), which are positive inside of the triangle
+struct OcclusionBuffer::Triangle
+{
+   std::array<float, 3> edgeDx;
+   std::array<float, 3> edgeDy;
+   std::array<float, 3> edgeC;
+
+   float depthDx = 0.0f;
+   float depthDy = 0.0f;
+   float depthC = 0.0f;
+
+   uint32_t minX = 0;
+   uint32_t maxX = 0;
+   uint32_t minY = 0;
+   uint32_t maxY = 0;
+};
+
+// static
+const char* OcclusionBuffer::getInstructionSetName()
+{
+#if OCCLUSION_BUFFER_AVX2 || OCCLUSION_BUFFER_SSE2 || OCCLUSION_BUFFER_NEON
+   return Simd::kName;
+#else
+   return "Scalar";
+#endif
+}
+
+// static
+uint32_t OcclusionBuffer::getLaneWidth()
+{
+#if OCCLUSION_BUFFER_AVX2 || OCCLUSION_BUFFER_SSE2 || OCCLUSION_BUFFER_NEON
+   return Simd::kWidth;
+#else
+   return 1;
+#endif
+}
+
+OcclusionBuffer::OcclusionBuffer(uint32_t bufferWidth, uint32_t bufferHeight)
+   : width(roundUp(std::max(bufferWidth, 1u), kTileWidth))
+   , height(roundUp(std::max(bufferHeight, 1u), kTileHeight))
+   , tilesPerRow(width / kTileWidth)
+   , depth(width * height)
+   , scratchDepth(width * height)
+   , tileMaxDepth(tilesPerRow * (height / kTileHeight))
+{
+   clear();
+}
+
+void OcclusionBuffer::clear()
+{
+   std::fill(depth.begin(), depth.end(), 1.0f);
+   std::fill(tileMaxDepth.begin(), tileMaxDepth.end(), 1.0f);
+}
+
+void OcclusionBuffer::rasterize(std::span<const glm::vec3> triangles, const glm::mat4& localToClip)
+{
+   ASSERT(triangles.size() % 3 == 0);
+
+   for (std::size_t i = 0; i + 2 < triangles.size(); i += 3)
+   {
+      Triangle triangle;
+      if (setUpTriangle(localToClip * glm::vec4(triangles[i], 1.0f), localToClip * glm::vec4(triangles[i + 1], 1.0f), localToClip * glm::vec4(triangles[i + 2], 1.0f), triangle))
+      {
+         rasterizeTriangle(triangle);
+      }
+   }
+}
+
+void OcclusionBuffer::rasterizeScalar(std::span<const glm::vec3> triangles, const glm::mat4& localToClip)
+{
+   ASSERT(triangles.size() % 3 == 0);
+
+   for (std::size_t i = 0; i + 2 < triangles.size(); i += 3)
+   {
+      Triangle triangle;
+      if (setUpTriangle(localToClip * glm::vec4(triangles[i], 1.0f), localToClip * glm::vec4(triangles[i + 1], 1.0f), localToClip * glm::vec4(triangles[i + 2], 1.0f), triangle))
+      {
+         rasterizeTriangleScalar(triangle);
+      }
+   }
+}
+
+// Occluders only cover the pixels whose centers they cover, with the depth at the center, so a box could be visible in the rest of a covered pixel. Taking the
+// maximum of the neighboring centers (which surround the pixel) covers that, with the pixels at the edge of the buffer treating the occluders as continuing past it.
+void OcclusionBuffer::updateTiles()
+{
+   for (uint32_t y = 0; y < height; ++y)
+   {
+      const float* row = depth.data() + y * width;
+      float* scratchRow = scratchDepth.data() + y * width;
+      for (uint32_t x = 0; x < width; ++x)
+      {
+         scratchRow[x] = std::max({ row[x > 0 ? x - 1 : x], row[x], row[x + 1 < width ? x + 1 : x] });
+      }
+   }
+
+   for (uint32_t y = 0; y < height; ++y)
+   {
+      const float* previousRow = scratchDepth.data() + (y > 0 ? y - 1 : y) * width;
+      const float* row = scratchDepth.data() + y * width;
+      const float* nextRow = scratchDepth.data() + (y + 1 < height ? y + 1 : y) * width;
+      float* depthRow = depth.data() + y * width;
+      for (uint32_t x = 0; x < width; ++x)
+      {
+         depthRow[x] = std::max({ previousRow[x], row[x], nextRow[x] });
+      }
+   }
+
+   for (uint32_t tileY = 0; tileY < height / kTileHeight; ++tileY)
+   {
+      for (uint32_t tileX = 0; tileX < tilesPerRow; ++tileX)
+      {
+         float maxDepth = 0.0f;
+         for (uint32_t y = tileY * kTileHeight; y < (tileY + 1) * kTileHeight; ++y)
+         {
+            const float* row = depth.data() + y * width + tileX * kTileWidth;
+            maxDepth = std::max(maxDepth, *std::max_element(row, row + kTileWidth));
+         }
+
+         tileMaxDepth[tileY * tilesPerRow + tileX] = maxDepth;
+      }
+   }
+}
+
+bool OcclusionBuffer::isOccluded(const glm::vec3& min, const glm::vec3& max, const glm::mat4& worldToClip) const
+{
+   glm::vec2 minScreen(std::numeric_limits<float>::max());
+   glm::vec2 maxScreen(std::numeric_limits<float>::lowest());
+   float minDepth = 1.0f;
+
+   for (uint32_t corner = 0; corner < 8; ++corner)
+   {
+      glm::vec3 position((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z);
+      glm::vec4 clipPosition = worldToClip * glm::vec4(position, 1.0f);
+      if (clipPosition.w <= 0.0f || clipPosition.z < 0.0f)
+      {
+         return false;
+      }
+
+      glm::vec3 ndcPosition = glm::vec3(clipPosition) / clipPosition.w;
+      glm::vec2 screenPosition = (glm::vec2(ndcPosition) * 0.5f + 0.5f) * glm::vec2(width, height);
+
+      minScreen = glm::min(minScreen, screenPosition);
+      maxScreen = glm::max(maxScreen, screenPosition);
+      minDepth = std::min(minDepth, ndcPosition.z);
+   }
+
+   // Boxes that are entirely off screen are left for frustum culling to deal with
+   if (maxScreen.x < 0.0f || maxScreen.y < 0.0f || minScreen.x >= width || minScreen.y >= height)
+   {
+      return false;
+   }
+
+   // Every pixel that the box's screen rectangle touches
+   uint32_t minX = static_cast<uint32_t>(std::max(minScreen.x, 0.0f));
+   uint32_t minY = static_cast<uint32_t>(std::max(minScreen.y, 0.0f));
+   uint32_t maxX = static_cast<uint32_t>(std::min(maxScreen.x, static_cast<float>(width - 1)));
+   uint32_t maxY = static_cast<uint32_t>(std::min(maxScreen.y, static_cast<float>(height - 1)));
+
+   for (uint32_t tileY = minY / kTileHeight; tileY <= maxY / kTileHeight; ++tileY)
+   {
+      for (uint32_t tileX = minX / kTileWidth; tileX <= maxX / kTileWidth; ++tileX)
+      {
+         if (minDepth > tileMaxDepth[tileY * tilesPerRow + tileX])
+         {
+            continue;
+         }
+
+         uint32_t beginY = std::max(tileY * kTileHeight, minY);
+         uint32_t endY = std::min((tileY + 1) * kTileHeight - 1, maxY);
+         uint32_t beginX = std::max(tileX * kTileWidth, minX);
+         uint32_t endX = std::min((tileX + 1) * kTileWidth - 1, maxX);
+         for (uint32_t y = beginY; y <= endY; ++y)
+         {
+            for (uint32_t x = beginX; x <= endX; ++x)
+            {
+               if (minDepth <= depth[y * width + x])
+               {
+                  return false;
+               }
+            }
+         }
+      }
+   }
+
+   return true;
+}
+
+bool OcclusionBuffer::setUpTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2, Triangle& triangle) const
+{
+   // Depth is 0 at the near plane, so anything in front of the camera has a non-negative z
+   std::array<glm::vec4, 3> clipPositions = { clip0, clip1, clip2 };
+   std::array<glm::vec3, 3> screenPositions;
+   for (uint32_t i = 0; i < 3; ++i)
+   {
+      const glm::vec4& clipPosition = clipPositions[i];
+      if (clipPosition.w <= 0.0f || clipPosition.z < 0.0f)
+      {
+         return false;
+      }
+
+      glm::vec3 ndcPosition = glm::vec3(clipPosition) / clipPosition.w;
+      screenPositions[i] = glm::vec3((glm::vec2(ndcPosition) * 0.5f + 0.5f) * glm::vec2(width, height), ndcPosition.z);
+   }
+
+   // Occluders are rasterized from both sides, with the winding flipped so that the inside of every edge is positive
+   const glm::vec3* v0 = &screenPositions[0];
+   const glm::vec3* v1 = &screenPositions[1];
+   const glm::vec3* v2 = &screenPositions[2];
+   float area = (v1->x - v0->x) * (v2->y - v0->y) - (v1->y - v0->y) * (v2->x - v0->x);
+   if (!(std::abs(area) > 0.0f) || !std::isfinite(area))
+   {
+      return false;
+   }
+   if (area < 0.0f)
+   {
+      std::swap(v1, v2);
+      area = -area;
+   }
+
+   glm::vec2 minScreen = glm::min(glm::vec2(*v0), glm::min(glm::vec2(*v1), glm::vec2(*v2)));
+   glm::vec2 maxScreen = glm::max(glm::vec2(*v0), glm::max(glm::vec2(*v1), glm::vec2(*v2)));
+   if (maxScreen.x < 0.0f || maxScreen.y < 0.0f || minScreen.x >= width || minScreen.y >= height)
+   {
+      return false;
+   }
+
+   triangle.minX = static_cast<uint32_t>(std::max(minScreen.x, 0.0f));
+   triangle.minY = static_cast<uint32_t>(std::max(minScreen.y, 0.0f));
+   triangle.maxX = static_cast<uint32_t>(std::min(maxScreen.x, static_cast<float>(width - 1)));
+   triangle.maxY = static_cast<uint32_t>(std::min(maxScreen.y, static_cast<float>(height - 1)));
+
+   // Edge i is opposite of vertex i, and is its (unnormalized) barycentric weight
+   std::array<const glm::vec3*, 3> vertices = { v0, v1, v2 };
+   for (uint32_t i = 0; i < 3; ++i)
+   {
+      const glm::vec3& start = *vertices[(i + 1) % 3];
+      const glm::vec3& end = *vertices[(i + 2) % 3];
+
+      triangle.edgeDx[i] = start.y - end.y;
+      triangle.edgeDy[i] = end.x - start.x;
+      triangle.edgeC[i] = -(triangle.edgeDx[i] * start.x + triangle.edgeDy[i] * start.y);
+   }
+
+   float inverseArea = 1.0f / area;
+   triangle.depthDx = (triangle.edgeDx[0] * v0->z + triangle.edgeDx[1] * v1->z + triangle.edgeDx[2] * v2->z) * inverseArea;
+   triangle.depthDy = (triangle.edgeDy[0] * v0->z + triangle.edgeDy[1] * v1->z + triangle.edgeDy[2] * v2->z) * inverseArea;
+   triangle.depthC = (triangle.edgeC[0] * v0->z + triangle.edgeC[1] * v1->z + triangle.edgeC[2] * v2->z) * inverseArea;
+
+   return true;
+}
+
+void OcclusionBuffer::rasterizeTriangleScalar(const Triangle& triangle)
+{
+   for (uint32_t y = triangle.minY; y <= triangle.maxY; ++y)
+   {
+      float pixelY = static_cast<float>(y) + 0.5f;
+      float rowEdge0 = triangle.edgeDy[0] * pixelY + triangle.edgeC[0];
+      float rowEdge1 = triangle.edgeDy[1] * pixelY + triangle.edgeC[1];
+      float rowEdge2 = triangle.edgeDy[2] * pixelY + triangle.edgeC[2];
+      float rowDepth = triangle.depthDy * pixelY + triangle.depthC;
+
+      float* row = depth.data() + y * width;
+      for (uint32_t x = triangle.minX; x <= triangle.maxX; ++x)
+      {
+         float pixelX = static_cast<float>(x) + 0.5f;
+         float edge0 = triangle.edgeDx[0] * pixelX + rowEdge0;
+         float edge1 = triangle.edgeDx[1] * pixelX + rowEdge1;
+         float edge2 = triangle.edgeDx[2] * pixelX + rowEdge2;
+
+         if (edge0 >= 0.0f && edge1 >= 0.0f && edge2 >= 0.0f)
+         {
+            float pixelDepth = triangle.depthDx * pixelX + rowDepth;
+            row[x] = pixelDepth < row[x] ? pixelDepth : row[x];
+         }
+      }
+   }
+}
+
+// Same as rasterizeTriangleScalar() (with the operations in the same order, so that the results match exactly), for Simd::kWidth pixels of a row at a time. Rows are
+// read and written in whole vectors starting at a multiple of the vector width, with pixels outside of the triangle's bounding box masked out.
+void OcclusionBuffer::rasterizeTriangle(const Triangle& triangle)
+{
+#if OCCLUSION_BUFFER_AVX2 || OCCLUSION_BUFFER_SSE2 || OCCLUSION_BUFFER_NEON
+   Simd::Float zero = Simd::splat(0.0f);
+   Simd::Float laneOffsets = Simd::load(kLaneOffsets.data());
+   Simd::Float minPixelX = Simd::splat(static_cast<float>(triangle.minX) + 0.5f);
+   Simd::Float maxPixelX = Simd::splat(static_cast<float>(triangle.maxX) + 0.5f);
+
+   Simd::Float edgeDx0 = Simd::splat(triangle.edgeDx[0]);
+   Simd::Float edgeDx1 = Simd::splat(triangle.edgeDx[1]);
+   Simd::Float edgeDx2 = Simd::splat(triangle.edgeDx[2]);
+   Simd::Float depthDx = Simd::splat(triangle.depthDx);
+
+   uint32_t beginX = triangle.minX - triangle.minX % Simd::kWidth;
+   for (uint32_t y = triangle.minY; y <= triangle.maxY; ++y)
+   {
+      float pixelY = static_cast<float>(y) + 0.5f;
+      Simd::Float rowEdge0 = Simd::splat(triangle.edgeDy[0] * pixelY + triangle.edgeC[0]);
+      Simd::Float rowEdge1 = Simd::splat(triangle.edgeDy[1] * pixelY + triangle.edgeC[1]);
+      Simd::Float rowEdge2 = Simd::splat(triangle.edgeDy[2] * pixelY + triangle.edgeC[2]);
+      Simd::Float rowDepth = Simd::splat(triangle.depthDy * pixelY + triangle.depthC);
+
+      float* row = depth.data() + y * width;
+      for (uint32_t x = beginX; x <= triangle.maxX; x += Simd::kWidth)
+      {
+         // Pixel centers are whole numbers plus a half, which are exact, so adding the lane offsets matches the scalar conversion
+         Simd::Float pixelX = Simd::add(Simd::splat(static_cast<float>(x)), laneOffsets);
+         Simd::Float edge0 = Simd::add(Simd::mul(edgeDx0, pixelX), rowEdge0);
+         Simd::Float edge1 = Simd::add(Simd::mul(edgeDx1, pixelX), rowEdge1);
+         Simd::Float edge2 = Simd::add(Simd::mul(edgeDx2, pixelX), rowEdge2);
+
+         Simd::Mask inBounds = Simd::both(Simd::greaterEqual(pixelX, minPixelX), Simd::greaterEqual(maxPixelX, pixelX));
+         Simd::Mask inside = Simd::both(inBounds, Simd::both(Simd::greaterEqual(edge0, zero), Simd::both(Simd::greaterEqual(edge1, zero), Simd::greaterEqual(edge2, zero))));
+
+         Simd::Float pixelDepth = Simd::add(Simd::mul(depthDx, pixelX), rowDepth);
+         Simd::Float rowValues = Simd::load(row + x);
+         Simd::store(row + x, Simd::select(inside, Simd::min(pixelDepth, rowValues), rowValues));
+      }
+   }
+#else
+   rasterizeTriangleScalar(triangle);
+#endif
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Low resolution depth buffer that occluder triangles are rasterized into on the CPU, used to find bounds that are entirely hidden behind them. Depth is in the same
+// range as the renderer's (0 at the near plane, 1 at the far plane). Occluders are rasterized at pixel centers, and updateTiles() then makes each pixel hold a depth
+// that they are in front of across all of it (see updateTiles()), so that tests can treat every pixel that a box touches as hidden.
+// Pixels are grouped into tiles that also store the furthest depth of their pixels, so that most tests only need to read one value per tile.
+class OcclusionBuffer
+{
+public:
+   static constexpr uint32_t kTileWidth = 8;
+   static constexpr uint32_t kTileHeight = 4;
+
+   // Instruction set that the rasterizer was compiled for (AVX2, SSE2, NEON, or Scalar), and the number of pixels it shades at once
+   static const char* getInstructionSetName();
+   static uint32_t getLaneWidth();
+
+   // The size is rounded up to a whole number of tiles
+   OcclusionBuffer(uint32_t bufferWidth, uint32_t bufferHeight);
+
+   uint32_t getWidth() const
+   {
+      return width;
+   }
+
+   uint32_t getHeight() const
+   {
+      return height;
+   }
+
+   float getDepth(uint32_t x, uint32_t y) const
+   {
+      return depth[y * width + x];
+   }
+
+   // Resets every pixel to the far plane
+   void clear();
+
+   // Rasterizes a triangle list (three positions per triangle). Triangles that reach behind the near plane are skipped, which can only make the buffer less effective.
+   // Pixels hold the nearest depth at their centers until updateTiles() is called.
+   void rasterize(std::span<const glm::vec3> triangles, const glm::mat4& localToClip);
+
+   // Same as rasterize(), without SIMD instructions (the results are exactly the same)
+   void rasterizeScalar(std::span<const glm::vec3> triangles, const glm::mat4& localToClip);
+
+   // Gives each pixel the furthest depth of itself and its neighbors, which covers everything between their centers (as long as the occluders have no holes or bumps
+   // smaller than a pixel), then updates the tile depths. Must be called after rasterizing and before testing.
+   void updateTiles();
+
+   // Returns true only if every pixel that the box covers on screen has an occluder in front of all of the box (boxes that reach behind the near plane are never
+   // occluded)
+   bool isOccluded(const glm::vec3& min, const glm::vec3& max, const glm::mat4& worldToClip) const;
+
+private:
+   struct Triangle;
+
+   bool setUpTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2, Triangle& triangle) const;
+   void rasterizeTriangleScalar(const Triangle& triangle);
+   void rasterizeTriangle(const Triangle& triangle);
+
+   uint32_t width = 0;
+   uint32_t height = 0;
+   uint32_t tilesPerRow = 0;
+
+   std::vector<float> depth;
+   std::vector<float> scratchDepth;
+   std::vector<float> tileMaxDepth;
+};
@@ -1,5 +1,16 @@
 #include "Math/Transform.h"
 
+#include "Math/Bounds.h"
+
+Bounds Transform::transformBounds(const Bounds& bounds) const
+{
+   // Each world axis gets the extent of the box projected onto it, which is what the absolute value of the rotation matrix computes
+   glm::mat3 rotation = glm::mat3_cast(orientation);
+   glm::mat3 absRotation(glm::abs(rotation[0]), glm::abs(rotation[1]), glm::abs(rotation[2]));
+
+   return Bounds(transformPosition(bounds.getCenter()), absRotation * glm::abs(scale * bounds.getExtent()));
+}
+
 Transform Transform::inverse() const
 {
    glm::quat inverseOrientation = glm::inverse(orientation);
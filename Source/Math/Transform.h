@@ -7,6 +7,8 @@
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/transform.hpp>
 
+class Bounds;
+
 struct Transform
 {
    glm::quat orientation = glm::identity<glm::quat>();
@@ -42,6 +44,9 @@ struct Transform
       return orientation * (scale * vector);
    }
 
+   // Axis-aligned bounds that contain the transformed box (which is rotated, and possibly mirrored)
+   Bounds transformBounds(const Bounds& bounds) const;
+
    glm::vec3 rotateVector(const glm::vec3& vector) const
    {
       return orientation * vector;
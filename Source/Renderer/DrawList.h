@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Core/Containers/FrameVector.h"
+
+#include "Math/Transform.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+class Material;
+class Mesh;
+
+struct MeshRenderInfo
+{
+   Transform transform;
+   glm::mat4 localToWorld;
+   const Mesh* mesh = nullptr;
+   uint32_t meshId = 0; // Same for every mesh component that uses the mesh
+
+   MeshRenderInfo(const Mesh* m, uint32_t id, const Transform& t, const glm::mat4& localToWorldMatrix)
+      : transform(t)
+      , localToWorld(localToWorldMatrix)
+      , mesh(m)
+      , meshId(id)
+   {
+   }
+};
+
+// One visible mesh section, drawn once for each of its instances (the mesh index is that of the first instance)
+struct DrawInfo
+{
+   uint64_t sortKey = 0;
+   uint32_t meshIndex = 0;
+   uint32_t section = 0;
+   const Material* material = nullptr;
+
+   uint32_t firstInstance = 0;
+   uint32_t numInstances = 1;
+};
+
+// Everything that one view draws, as extracted from the scene
+struct DrawList
+{
+   FrameVector<MeshRenderInfo> meshes;
+
+   // Sorted by key (see DrawSortKey), with mesh indices referring to the meshes above
+   FrameVector<DrawInfo> draws;
+
+   // The mesh index of each instance, which draws refer to with their first instance
+   FrameVector<uint32_t> instances;
+};
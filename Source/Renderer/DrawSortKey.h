@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Graphics/BlendMode.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+// 64-bit keys that order draws to reduce state changes and overdraw. The blend mode is in the top bits, so the draws of each blend mode form a contiguous range (opaque,
+// then masked, then translucent).
+// Opaque and masked: [61:32] pipeline state and material, [23:0] depth (front to back)
+// Translucent: [61:38] inverted depth (back to front, which blending requires), [37:8] pipeline state and material
+// Instance keys replace the depth of opaque and masked keys with the mesh and section, which groups the draws that can be instanced together
+namespace DrawSortKey
+{
+   inline constexpr uint32_t kBlendModeShift = 62;
+   inline constexpr uint32_t kPipelineStateBits = 6;
+   inline constexpr uint32_t kMaterialBits = 24;
+   inline constexpr uint32_t kDepthBits = 24;
+   inline constexpr uint32_t kMeshBits = 24;
+   inline constexpr uint32_t kSectionBits = 8;
+
+   inline constexpr uint64_t kStateMask = (1ull << (kPipelineStateBits + kMaterialBits)) - 1;
+   inline constexpr uint32_t kDepthMask = (1u << kDepthBits) - 1;
+
+   // The bit pattern of a non-negative float increases with its value, so dropping the low mantissa bits quantizes it without changing the order
+   inline uint32_t quantizeDepth(float squaredDistance)
+   {
+      return std::bit_cast<uint32_t>(std::max(squaredDistance, 0.0f)) >> (32 - kDepthBits);
+   }
+
+   inline uint64_t create(BlendMode blendMode, uint32_t pipelineState, uint32_t material, uint32_t depth)
+   {
+      uint64_t state = ((static_cast<uint64_t>(pipelineState) << kMaterialBits) | (material & ((1u << kMaterialBits) - 1))) & kStateMask;
+      uint64_t key = static_cast<uint64_t>(blendMode) << kBlendModeShift;
+
+      if (blendMode == BlendMode::Translucent)
+      {
+         key |= (static_cast<uint64_t>(kDepthMask - (depth & kDepthMask)) << 38) | (state << 8);
+      }
+      else
+      {
+         key |= (state << 32) | (depth & kDepthMask);
+      }
+
+      return key;
+   }
+
+   inline BlendMode getBlendMode(uint64_t key)
+   {
+      return static_cast<BlendMode>(key >> kBlendModeShift);
+   }
+
+   // The blend mode and pipeline state, without the material or depth
+   inline uint32_t getPipelineKey(uint64_t key)
+   {
+      BlendMode blendMode = getBlendMode(key);
+      uint32_t stateShift = (blendMode == BlendMode::Translucent ? 8 : 32) + kMaterialBits;
+      uint32_t pipelineState = static_cast<uint32_t>(key >> stateShift) & ((1u << kPipelineStateBits) - 1);
+
+      return (static_cast<uint32_t>(blendMode) << kPipelineStateBits) | pipelineState;
+   }
+
+   // Moves the depth of opaque and masked keys above the pipeline state and material, so that sorting orders each blend mode by depth alone (as draws were ordered
+   // before they had sort keys, which is only useful for comparing how many state changes sorting by key saves)
+   inline uint64_t getDepthFirstKey(uint64_t key)
+   {
+      if (getBlendMode(key) == BlendMode::Translucent)
+      {
+         return key;
+      }
+
+      uint64_t state = (key >> 32) & kStateMask;
+      uint64_t depth = key & kDepthMask;
+      return (key & (~0ull << kBlendModeShift)) | (depth << (kPipelineStateBits + kMaterialBits)) | state;
+   }
+
+   // Translucent keys are returned as is, since those draws have to stay in depth order. Mesh IDs and sections that don't fit are truncated, which can only keep some
+   // draws from being grouped.
+   inline uint64_t getInstanceKey(uint64_t key, uint32_t meshId, uint32_t section)
+   {
+      if (getBlendMode(key) == BlendMode::Translucent)
+      {
+         return key;
+      }
+
+      return (key & ~0xFFFFFFFFull) | (static_cast<uint64_t>(meshId & ((1u << kMeshBits) - 1)) << kSectionBits) | (section & ((1u << kSectionBits) - 1));
+   }
+}
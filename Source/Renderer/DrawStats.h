@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// Commands recorded by a scene render pass
+struct PassDrawStats
+{
+   uint32_t draws = 0;
+   uint32_t instances = 0;
+   uint32_t drawCalls = 0; // Each indirect draw counts once, however many draws it submits
+   uint32_t pipelineBinds = 0;
+   uint32_t descriptorSetBinds = 0;
+   uint32_t bufferBinds = 0;
+   uint32_t secondaryCommandBuffers = 0; // Zero when the pass was recorded on a single thread
+
+   // CPU time spent recording the pass (including waiting for parallel recording to finish)
+   double recordMilliseconds = 0.0;
+};
+
+// Software occlusion culling of the main view's sections
+struct OcclusionStats
+{
+   uint32_t occluders = 0;
+   uint32_t occluderTriangles = 0;
+   uint32_t testedSections = 0;
+   uint32_t occludedSections = 0;
+
+   // CPU time spent selecting and rasterizing occluders, and testing sections against them
+   double milliseconds = 0.0;
+};
+
+// Totals from the last rendered frame
+struct DrawStats
+{
+   PassDrawStats normal;
+   PassDrawStats shadow;
+   PassDrawStats forward;
+   OcclusionStats occlusion;
+};
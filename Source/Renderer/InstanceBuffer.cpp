@@ -0,0 +1,14 @@
+#include "Renderer/InstanceBuffer.h"
+
+#include "Graphics/DebugUtils.h"
+
+InstanceBuffer::InstanceBuffer(const GraphicsContext& graphicsContext)
+   : GraphicsResource(graphicsContext)
+   , instances(graphicsContext, vk::BufferUsageFlagBits::eStorageBuffer, true)
+   , drawCommands(graphicsContext, vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer, true)
+   , bounds(graphicsContext, vk::BufferUsageFlagBits::eStorageBuffer, true)
+{
+   NAME_CHILD(instances, "Instances");
+   NAME_CHILD(drawCommands, "Draw Commands");
+   NAME_CHILD(bounds, "Bounds");
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Graphics/DynamicBuffer.h"
+#include "Graphics/GraphicsResource.h"
+
+#include "Renderer/UniformData.h"
+
+#include <cstdint>
+#include <span>
+
+// Per-instance mesh data and indirect draw commands for all views, written from the CPU each frame. Each frame in flight has its own buffers, which grow as needed.
+class InstanceBuffer : public GraphicsResource
+{
+public:
+   InstanceBuffer(const GraphicsContext& graphicsContext);
+
+   // Returns the data for the current frame, which can be written from any thread until the frame is submitted
+   std::span<MeshUniformData> map(uint32_t numInstances)
+   {
+      return instances.map(numInstances);
+   }
+
+   // Covers the whole buffer of the current frame
+   vk::DescriptorBufferInfo getDescriptorBufferInfo() const
+   {
+      return instances.getDescriptorBufferInfo();
+   }
+
+   // Same as map(), but for the draw commands
+   std::span<vk::DrawIndexedIndirectCommand> mapDrawCommands(uint32_t numDraws)
+   {
+      return drawCommands.map(numDraws);
+   }
+
+   vk::Buffer getDrawCommandBuffer() const
+   {
+      return drawCommands.getCurrentBuffer();
+   }
+
+   vk::DescriptorBufferInfo getDrawCommandDescriptorBufferInfo() const
+   {
+      return drawCommands.getDescriptorBufferInfo();
+   }
+
+   // World space bounds of each instance, only needed by views that are culled on the GPU (indexed the same as the instance data)
+   std::span<InstanceBoundsData> mapBounds(uint32_t numInstances)
+   {
+      return bounds.map(numInstances);
+   }
+
+   vk::DescriptorBufferInfo getBoundsDescriptorBufferInfo() const
+   {
+      return bounds.getDescriptorBufferInfo();
+   }
+
+private:
+   DynamicBuffer<MeshUniformData> instances;
+   DynamicBuffer<vk::DrawIndexedIndirectCommand> drawCommands;
+   DynamicBuffer<InstanceBoundsData> bounds;
+};
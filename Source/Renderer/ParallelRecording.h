@@ -0,0 +1,22 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// How the scene render passes split their draws into chunks that are recorded in parallel into secondary command buffers
+namespace ParallelRecording
+{
+   // Each chunk costs a secondary command buffer (and the state it has to set up again), so small passes are recorded directly into the primary command buffer
+   inline constexpr std::size_t kMinDrawsPerChunk = 128;
+
+   // More chunks than threads, so that threads that finish early can pick up the remaining ones
+   inline constexpr uint32_t kChunksPerThread = 2;
+
+   // Returns 1 when the draws should be recorded on the calling thread alone
+   inline std::size_t getNumChunks(std::size_t numDraws, uint32_t numThreads)
+   {
+      std::size_t numChunks = std::min<std::size_t>((numDraws + kMinDrawsPerChunk - 1) / kMinDrawsPerChunk, static_cast<std::size_t>(numThreads) * kChunksPerThread);
+      return numThreads > 1 && numChunks > 1 ? numChunks : 1;
+   }
+}
@@ -0,0 +1,49 @@
+#include "Renderer/Passes/Culling/CullShader.h"
+
+// static
+std::vector<vk::DescriptorSetLayoutBinding> CullDescriptorSet::getBindings()
+{
+   return
+   {
+      vk::DescriptorSetLayoutBinding()
+         .setBinding(0)
+         .setDescriptorType(vk::DescriptorType::eUniformBuffer)
+         .setDescriptorCount(1)
+         .setStageFlags(vk::ShaderStageFlagBits::eCompute),
+      vk::DescriptorSetLayoutBinding()
+         .setBinding(1)
+         .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+         .setDescriptorCount(1)
+         .setStageFlags(vk::ShaderStageFlagBits::eCompute),
+      vk::DescriptorSetLayoutBinding()
+         .setBinding(2)
+         .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+         .setDescriptorCount(1)
+         .setStageFlags(vk::ShaderStageFlagBits::eCompute),
+      vk::DescriptorSetLayoutBinding()
+         .setBinding(3)
+         .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+         .setDescriptorCount(1)
+         .setStageFlags(vk::ShaderStageFlagBits::eCompute),
+      vk::DescriptorSetLayoutBinding()
+         .setBinding(4)
+         .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+         .setDescriptorCount(1)
+         .setStageFlags(vk::ShaderStageFlagBits::eCompute),
+      vk::DescriptorSetLayoutBinding()
+         .setBinding(5)
+         .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+         .setDescriptorCount(1)
+         .setStageFlags(vk::ShaderStageFlagBits::eCompute),
+      vk::DescriptorSetLayoutBinding()
+         .setBinding(6)
+         .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+         .setDescriptorCount(1)
+         .setStageFlags(vk::ShaderStageFlagBits::eCompute)
+   };
+}
+
+CullShader::CullShader(const GraphicsContext& graphicsContext, ResourceManager& resourceManager)
+   : ParameterizedShader(graphicsContext, resourceManager, Shader::ModuleInfo::compute("Cull"))
+{
+}
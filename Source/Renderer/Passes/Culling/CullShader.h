@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Graphics/DescriptorSet.h"
+#include "Graphics/Shader.h"
+
+#include <vector>
+
+class CullDescriptorSet : public TypedDescriptorSet<CullDescriptorSet>
+{
+public:
+   static std::vector<vk::DescriptorSetLayoutBinding> getBindings();
+
+   using TypedDescriptorSet::TypedDescriptorSet;
+};
+
+class CullShader : public ParameterizedShader<void, CullDescriptorSet>
+{
+public:
+   CullShader(const GraphicsContext& graphicsContext, ResourceManager& resourceManager);
+};
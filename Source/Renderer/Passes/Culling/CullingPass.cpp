@@ -0,0 +1,357 @@
+#include "Renderer/Passes/Culling/CullingPass.h"
+
+#include "Core/Assert.h"
+#include "Core/Features.h"
+
+#include "Graphics/DebugUtils.h"
+#include "Graphics/Pipeline.h"
+#include "Graphics/Texture.h"
+
+#include "Math/Frustum.h"
+
+#include "Renderer/InstanceBuffer.h"
+#include "Renderer/SceneRenderInfo.h"
+#include "Renderer/View.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+   const uint32_t kCullGroupSize = 64;
+   const uint32_t kHiZGroupSize = 8;
+
+   uint32_t getGroupCount(uint32_t size, uint32_t groupSize)
+   {
+      return (size + groupSize - 1) / groupSize;
+   }
+
+   std::unique_ptr<Texture> createHiZTexture(const GraphicsContext& context, vk::Extent2D depthExtent)
+   {
+      // The first level is half the size of the depth buffer, since the cull shader can always read a full resolution texel's level 0 texel instead
+      ImageProperties imageProperties;
+      imageProperties.format = vk::Format::eR32Sfloat;
+      imageProperties.width = std::max(depthExtent.width / 2, 1u);
+      imageProperties.height = std::max(depthExtent.height / 2, 1u);
+
+      TextureProperties textureProperties;
+      textureProperties.usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled;
+      textureProperties.aspects = vk::ImageAspectFlagBits::eColor;
+      textureProperties.allocateMipMaps = true;
+
+      // Written and read by compute shaders only, so the layout never changes
+      TextureInitialLayout initialLayout;
+      initialLayout.layout = vk::ImageLayout::eGeneral;
+      initialLayout.memoryBarrierFlags = TextureMemoryBarrierFlags(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite, vk::PipelineStageFlagBits::eComputeShader);
+
+      return std::make_unique<Texture>(context, imageProperties, textureProperties, initialLayout);
+   }
+
+   void computeBarrier(vk::CommandBuffer commandBuffer, vk::PipelineStageFlags srcStageMask, vk::AccessFlags srcAccessMask, vk::PipelineStageFlags dstStageMask, vk::AccessFlags dstAccessMask)
+   {
+      vk::MemoryBarrier memoryBarrier = vk::MemoryBarrier()
+         .setSrcAccessMask(srcAccessMask)
+         .setDstAccessMask(dstAccessMask);
+
+      commandBuffer.pipelineBarrier(srcStageMask, dstStageMask, vk::DependencyFlags(), { memoryBarrier }, nullptr, nullptr);
+   }
+}
+
+CullingPass::CullingPass(const GraphicsContext& graphicsContext, DynamicDescriptorPool& dynamicDescriptorPool, ResourceManager& resourceManager)
+   : GraphicsResource(graphicsContext)
+   , cullDescriptorSet(graphicsContext, dynamicDescriptorPool)
+   , uniformBuffer(graphicsContext)
+   , draws(graphicsContext, vk::BufferUsageFlagBits::eStorageBuffer, true)
+   , culledDrawCommands(graphicsContext, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer, false)
+   , drawCounts(graphicsContext, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst, false)
+{
+   NAME_CHILD(cullDescriptorSet, "Cull");
+   NAME_CHILD(uniformBuffer, "");
+   NAME_CHILD(draws, "Draws");
+   NAME_CHILD(culledDrawCommands, "Culled Draw Commands");
+   NAME_CHILD(drawCounts, "Draw Counts");
+
+   cullShader = std::make_unique<CullShader>(context, resourceManager);
+   hiZShader = std::make_unique<HiZShader>(context, resourceManager);
+
+#if FORGE_WITH_SHADER_HOT_RELOADING
+   cullShader->addOnInitialize([this]()
+   {
+      cullPipeline = nullptr;
+   });
+   hiZShader->addOnInitialize([this]()
+   {
+      hiZPipeline = nullptr;
+   });
+#endif // FORGE_WITH_SHADER_HOT_RELOADING
+
+   {
+      std::array descriptorSetLayouts = cullShader->getDescriptorSetLayouts();
+      vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo = vk::PipelineLayoutCreateInfo()
+         .setSetLayouts(descriptorSetLayouts);
+      cullPipelineLayout = device.createPipelineLayout(pipelineLayoutCreateInfo);
+      NAME_CHILD(cullPipelineLayout, "Cull Pipeline Layout");
+   }
+
+   {
+      std::array descriptorSetLayouts = hiZShader->getDescriptorSetLayouts();
+      vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo = vk::PipelineLayoutCreateInfo()
+         .setSetLayouts(descriptorSetLayouts);
+      hiZPipelineLayout = device.createPipelineLayout(pipelineLayoutCreateInfo);
+      NAME_CHILD(hiZPipelineLayout, "Hi-Z Pipeline Layout");
+   }
+
+   hiZDescriptorSets.reserve(kMaxHiZLevels);
+   for (uint32_t level = 0; level < kMaxHiZLevels; ++level)
+   {
+      hiZDescriptorSets.emplace_back(context, dynamicDescriptorPool);
+      NAME_CHILD(hiZDescriptorSets.back(), "Hi-Z Level " + DebugUtils::toString(level));
+   }
+
+   // Only ever read with texelFetch()
+   vk::SamplerCreateInfo samplerCreateInfo = vk::SamplerCreateInfo()
+      .setMagFilter(vk::Filter::eNearest)
+      .setMinFilter(vk::Filter::eNearest)
+      .setAddressModeU(vk::SamplerAddressMode::eClampToEdge)
+      .setAddressModeV(vk::SamplerAddressMode::eClampToEdge)
+      .setAddressModeW(vk::SamplerAddressMode::eClampToEdge)
+      .setAnisotropyEnable(false)
+      .setMaxAnisotropy(1.0f)
+      .setUnnormalizedCoordinates(false)
+      .setCompareEnable(false)
+      .setCompareOp(vk::CompareOp::eAlways)
+      .setMipmapMode(vk::SamplerMipmapMode::eNearest)
+      .setMipLodBias(0.0f)
+      .setMinLod(0.0f)
+      .setMaxLod(static_cast<float>(kMaxHiZLevels));
+   sampler = device.createSampler(samplerCreateInfo);
+   NAME_CHILD(sampler, "Sampler");
+
+   for (uint32_t frameIndex = 0; frameIndex < GraphicsContext::kMaxFramesInFlight; ++frameIndex)
+   {
+      vk::DescriptorBufferInfo bufferInfo = uniformBuffer.getDescriptorBufferInfo(frameIndex);
+
+      vk::WriteDescriptorSet bufferDescriptorWrite = vk::WriteDescriptorSet()
+         .setDstSet(cullDescriptorSet.getSet(frameIndex))
+         .setDstBinding(0)
+         .setDstArrayElement(0)
+         .setDescriptorType(vk::DescriptorType::eUniformBuffer)
+         .setDescriptorCount(1)
+         .setPBufferInfo(&bufferInfo);
+
+      device.updateDescriptorSets({ bufferDescriptorWrite }, {});
+   }
+}
+
+CullingPass::~CullingPass()
+{
+   context.delayedDestroy(std::move(sampler));
+
+   context.delayedDestroy(std::move(cullPipelineLayout));
+   context.delayedDestroy(std::move(hiZPipelineLayout));
+}
+
+std::span<glm::uvec2> CullingPass::mapDraws(uint32_t numDraws, uint32_t numBatchesThisFrame)
+{
+   numBatches = numBatchesThisFrame;
+
+   culledDrawCommands.reserve(numDraws);
+   drawCounts.reserve(numBatches);
+
+   return draws.map(numDraws);
+}
+
+void CullingPass::cull(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, const InstanceBuffer& instanceBuffer)
+{
+   // The Hi-Z is only used by the frame right after the one that built it, since it is only built by frames that cull on the GPU
+   bool useHiZ = hiZValid;
+   hiZValid = false;
+
+   uint32_t numDraws = sceneRenderInfo.numGPUCulledDraws;
+   if (numDraws == 0)
+   {
+      return;
+   }
+
+   SCOPED_LABEL(getName());
+   ASSERT(numBatches == sceneRenderInfo.cullBatches.size());
+
+   CullUniformData uniformData;
+   uniformData.frustumPlanes = Frustum(sceneRenderInfo.view.getMatrices().worldToClip).getPlanes();
+   uniformData.hiZWorldToClip = hiZWorldToClip;
+   uniformData.depthSize = depthSize;
+   uniformData.drawCommandOffset = sceneRenderInfo.drawCommandOffset;
+   uniformData.numDraws = numDraws;
+   uniformData.hiZLevels = useHiZ ? std::min(hiZTexture->getMipLevels(), kMaxHiZLevels) : 0;
+   uniformBuffer.update(uniformData);
+
+   {
+      std::array<vk::DescriptorBufferInfo, 5> bufferInfo =
+      {
+         instanceBuffer.getDrawCommandDescriptorBufferInfo(),
+         instanceBuffer.getBoundsDescriptorBufferInfo(),
+         draws.getDescriptorBufferInfo(),
+         culledDrawCommands.getDescriptorBufferInfo(),
+         drawCounts.getDescriptorBufferInfo()
+      };
+      vk::WriteDescriptorSet bufferDescriptorWrite = vk::WriteDescriptorSet()
+         .setDstSet(cullDescriptorSet.getCurrentSet())
+         .setDstBinding(1)
+         .setDstArrayElement(0)
+         .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+         .setBufferInfo(bufferInfo);
+
+      vk::DescriptorImageInfo hiZImageInfo = vk::DescriptorImageInfo()
+         .setImageLayout(hiZTexture->getLayout())
+         .setImageView(hiZTexture->getDefaultView())
+         .setSampler(sampler);
+      vk::WriteDescriptorSet hiZDescriptorWrite = vk::WriteDescriptorSet()
+         .setDstSet(cullDescriptorSet.getCurrentSet())
+         .setDstBinding(6)
+         .setDstArrayElement(0)
+         .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+         .setDescriptorCount(1)
+         .setPImageInfo(&hiZImageInfo);
+
+      device.updateDescriptorSets({ bufferDescriptorWrite, hiZDescriptorWrite }, {});
+   }
+
+   // Every batch starts out empty, and the Hi-Z built at the end of the last frame needs to be visible
+   commandBuffer.fillBuffer(drawCounts.getCurrentBuffer(), 0, static_cast<vk::DeviceSize>(numBatches) * sizeof(uint32_t), 0);
+   computeBarrier(commandBuffer, vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderWrite,
+      vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+
+   commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, getCullPipeline().getVkPipeline());
+   cullShader->bindDescriptorSets(commandBuffer, cullPipelineLayout, cullDescriptorSet);
+   commandBuffer.dispatch(getGroupCount(numDraws, kCullGroupSize), 1, 1);
+
+   computeBarrier(commandBuffer, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite, vk::PipelineStageFlagBits::eDrawIndirect, vk::AccessFlagBits::eIndirectCommandRead);
+}
+
+void CullingPass::buildHiZ(vk::CommandBuffer commandBuffer, Texture& depthTexture, const glm::mat4& worldToClip)
+{
+   if (!hiZTexture || depthSize == glm::uvec2(0))
+   {
+      hiZValid = false;
+      return;
+   }
+
+   SCOPED_LABEL("Hi-Z");
+
+   ASSERT(depthTexture.getExtent() == vk::Extent2D(depthSize.x, depthSize.y));
+   ASSERT(depthTexture.getLayout() == vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+   // The cull shader of this frame has to finish reading the Hi-Z before it is overwritten
+   computeBarrier(commandBuffer, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite);
+   depthTexture.transitionLayout(commandBuffer, vk::ImageLayout::eShaderReadOnlyOptimal, TextureMemoryBarrierFlags(vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::PipelineStageFlagBits::eLateFragmentTests),
+      TextureMemoryBarrierFlags(vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eComputeShader));
+
+   commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, getHiZPipeline().getVkPipeline());
+
+   uint32_t numLevels = std::min(hiZTexture->getMipLevels(), kMaxHiZLevels);
+   for (uint32_t level = 0; level < numLevels; ++level)
+   {
+      const HiZDescriptorSet& descriptorSet = hiZDescriptorSets[level];
+
+      vk::DescriptorImageInfo inputImageInfo = vk::DescriptorImageInfo()
+         .setImageLayout(level == 0 ? depthTexture.getLayout() : hiZTexture->getLayout())
+         .setImageView(level == 0 ? getDepthView(depthTexture) : hiZTexture->getOrCreateMipView(level - 1))
+         .setSampler(sampler);
+      vk::WriteDescriptorSet inputDescriptorWrite = vk::WriteDescriptorSet()
+         .setDstSet(descriptorSet.getCurrentSet())
+         .setDstBinding(0)
+         .setDstArrayElement(0)
+         .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+         .setDescriptorCount(1)
+         .setPImageInfo(&inputImageInfo);
+      vk::DescriptorImageInfo outputImageInfo = vk::DescriptorImageInfo()
+         .setImageLayout(hiZTexture->getLayout())
+         .setImageView(hiZTexture->getOrCreateMipView(level));
+      vk::WriteDescriptorSet outputDescriptorWrite = vk::WriteDescriptorSet()
+         .setDstSet(descriptorSet.getCurrentSet())
+         .setDstBinding(1)
+         .setDstArrayElement(0)
+         .setDescriptorType(vk::DescriptorType::eStorageImage)
+         .setDescriptorCount(1)
+         .setPImageInfo(&outputImageInfo);
+      device.updateDescriptorSets({ inputDescriptorWrite, outputDescriptorWrite }, {});
+
+      if (level > 0)
+      {
+         computeBarrier(commandBuffer, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderRead);
+      }
+
+      uint32_t levelWidth = std::max(hiZTexture->getImageProperties().width >> level, 1u);
+      uint32_t levelHeight = std::max(hiZTexture->getImageProperties().height >> level, 1u);
+
+      hiZShader->bindDescriptorSets(commandBuffer, hiZPipelineLayout, descriptorSet);
+      commandBuffer.dispatch(getGroupCount(levelWidth, kHiZGroupSize), getGroupCount(levelHeight, kHiZGroupSize), 1);
+   }
+
+   // Depth is expected to be left as an attachment, and transitioning it to a shader read layout again later would only wait on fragment shaders
+   depthTexture.transitionLayout(commandBuffer, vk::ImageLayout::eDepthStencilAttachmentOptimal, TextureMemoryBarrierFlags(vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eComputeShader),
+      TextureMemoryBarrierFlags(vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::PipelineStageFlagBits::eEarlyFragmentTests));
+
+   hiZWorldToClip = worldToClip;
+   hiZValid = true;
+}
+
+void CullingPass::recreateTextures(vk::Extent2D depthExtent, vk::SampleCountFlagBits depthSampleCount)
+{
+   hiZValid = false;
+
+   // Always created, since the cull shader needs something bound even when it only tests the frustum
+   hiZTexture = createHiZTexture(context, depthExtent);
+   NAME_CHILD_POINTER(hiZTexture, "Hi-Z Texture");
+
+   depthSize = depthSampleCount == vk::SampleCountFlagBits::e1 ? glm::uvec2(depthExtent.width, depthExtent.height) : glm::uvec2(0);
+}
+
+const Pipeline& CullingPass::getCullPipeline()
+{
+   if (!cullPipeline)
+   {
+      PipelineInfo pipelineInfo;
+      pipelineInfo.passType = PipelinePassType::Compute;
+
+      PipelineData pipelineData;
+      pipelineData.layout = cullPipelineLayout;
+      pipelineData.shaderStages = cullShader->getStages();
+
+      cullPipeline = std::make_unique<Pipeline>(context, pipelineInfo, pipelineData);
+      NAME_CHILD_POINTER(cullPipeline, "Cull");
+   }
+
+   return *cullPipeline;
+}
+
+const Pipeline& CullingPass::getHiZPipeline()
+{
+   if (!hiZPipeline)
+   {
+      PipelineInfo pipelineInfo;
+      pipelineInfo.passType = PipelinePassType::Compute;
+
+      PipelineData pipelineData;
+      pipelineData.layout = hiZPipelineLayout;
+      pipelineData.shaderStages = hiZShader->getStages();
+
+      hiZPipeline = std::make_unique<Pipeline>(context, pipelineInfo, pipelineData);
+      NAME_CHILD_POINTER(hiZPipeline, "Hi-Z");
+   }
+
+   return *hiZPipeline;
+}
+
+vk::ImageView CullingPass::getDepthView(Texture& depthTexture)
+{
+   bool depthViewCreated = false;
+   vk::ImageView depthView = depthTexture.getOrCreateView(vk::ImageViewType::e2D, 0, 1, vk::ImageAspectFlagBits::eDepth, &depthViewCreated);
+
+   if (depthViewCreated)
+   {
+      NAME_CHILD(depthView, "Depth View");
+   }
+
+   return depthView;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Graphics/DynamicBuffer.h"
+#include "Graphics/GraphicsResource.h"
+#include "Graphics/UniformBuffer.h"
+
+#include "Renderer/Passes/Culling/CullShader.h"
+#include "Renderer/Passes/Culling/HiZShader.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <memory>
+#include <span>
+#include <vector>
+
+class DynamicDescriptorPool;
+class InstanceBuffer;
+class Pipeline;
+class ResourceManager;
+class Texture;
+struct SceneRenderInfo;
+
+struct CullUniformData
+{
+   alignas(16) std::array<glm::vec4, 6> frustumPlanes;
+   alignas(16) glm::mat4 hiZWorldToClip;
+   alignas(8) glm::uvec2 depthSize;
+   alignas(4) uint32_t drawCommandOffset = 0;
+   alignas(4) uint32_t numDraws = 0;
+   alignas(4) uint32_t hiZLevels = 0; // Zero when there is no valid Hi-Z, which only leaves the frustum test
+};
+
+// Culls the opaque and masked draws of the main view on the GPU, against the frustum and a Hi-Z pyramid (the furthest depth of each texel, at every mip level) built from
+// the previous frame's depth. The draws that pass are compacted into a range for each batch of draws that can be submitted with one indirect draw.
+class CullingPass : public GraphicsResource
+{
+public:
+   static constexpr uint32_t kMaxHiZLevels = 16;
+
+   CullingPass(const GraphicsContext& graphicsContext, DynamicDescriptorPool& dynamicDescriptorPool, ResourceManager& resourceManager);
+   ~CullingPass();
+
+   // Makes room for the draws and batches of the current frame, and returns the batch data of each draw to be filled in (the batch index, and the first draw of the batch)
+   std::span<glm::uvec2> mapDraws(uint32_t numDraws, uint32_t numBatches);
+
+   vk::Buffer getCulledDrawCommandBuffer() const
+   {
+      return culledDrawCommands.getCurrentBuffer();
+   }
+
+   vk::Buffer getDrawCountBuffer() const
+   {
+      return drawCounts.getCurrentBuffer();
+   }
+
+   // Called every frame (even when nothing is culled on the GPU), before the draws are recorded
+   void cull(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, const InstanceBuffer& instanceBuffer);
+
+   // Called after the depth buffer has been fully written, to be used for occlusion culling in the next frame
+   void buildHiZ(vk::CommandBuffer commandBuffer, Texture& depthTexture, const glm::mat4& worldToClip);
+
+   // Occlusion culling is only supported with single sampled depth
+   void recreateTextures(vk::Extent2D depthExtent, vk::SampleCountFlagBits depthSampleCount);
+
+private:
+   const Pipeline& getCullPipeline();
+   const Pipeline& getHiZPipeline();
+
+   vk::ImageView getDepthView(Texture& depthTexture);
+
+   std::unique_ptr<CullShader> cullShader;
+   std::unique_ptr<HiZShader> hiZShader;
+
+   vk::PipelineLayout cullPipelineLayout;
+   vk::PipelineLayout hiZPipelineLayout;
+
+   // Created when first used, and again after the shaders are reloaded
+   std::unique_ptr<Pipeline> cullPipeline;
+   std::unique_ptr<Pipeline> hiZPipeline;
+
+   CullDescriptorSet cullDescriptorSet;
+   std::vector<HiZDescriptorSet> hiZDescriptorSets;
+   vk::Sampler sampler;
+
+   UniformBuffer<CullUniformData> uniformBuffer;
+
+   DynamicBuffer<glm::uvec2> draws;
+   DynamicBuffer<vk::DrawIndexedIndirectCommand> culledDrawCommands;
+   DynamicBuffer<uint32_t> drawCounts;
+   uint32_t numBatches = 0;
+
+   std::unique_ptr<Texture> hiZTexture;
+   glm::uvec2 depthSize = glm::uvec2(0);
+   glm::mat4 hiZWorldToClip = glm::mat4(1.0f);
+   bool hiZValid = false;
+};
@@ -0,0 +1,24 @@
+#include "Renderer/Passes/Culling/HiZShader.h"
+
+// static
+std::vector<vk::DescriptorSetLayoutBinding> HiZDescriptorSet::getBindings()
+{
+   return
+   {
+      vk::DescriptorSetLayoutBinding()
+         .setBinding(0)
+         .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+         .setDescriptorCount(1)
+         .setStageFlags(vk::ShaderStageFlagBits::eCompute),
+      vk::DescriptorSetLayoutBinding()
+         .setBinding(1)
+         .setDescriptorType(vk::DescriptorType::eStorageImage)
+         .setDescriptorCount(1)
+         .setStageFlags(vk::ShaderStageFlagBits::eCompute)
+   };
+}
+
+HiZShader::HiZShader(const GraphicsContext& graphicsContext, ResourceManager& resourceManager)
+   : ParameterizedShader(graphicsContext, resourceManager, Shader::ModuleInfo::compute("HiZ"))
+{
+}
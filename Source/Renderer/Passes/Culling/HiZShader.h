@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Graphics/DescriptorSet.h"
+#include "Graphics/Shader.h"
+
+#include <vector>
+
+class HiZDescriptorSet : public TypedDescriptorSet<HiZDescriptorSet>
+{
+public:
+   static std::vector<vk::DescriptorSetLayoutBinding> getBindings();
+
+   using TypedDescriptorSet::TypedDescriptorSet;
+};
+
+class HiZShader : public ParameterizedShader<void, HiZDescriptorSet>
+{
+public:
+   HiZShader(const GraphicsContext& graphicsContext, ResourceManager& resourceManager);
+};
@@ -21,20 +21,16 @@ DepthPass::DepthPass(const GraphicsContext& graphicsContext, ResourceManager& re
 
    {
       std::array descriptorSetLayouts = depthShader->getDescriptorSetLayouts();
-      std::vector<vk::PushConstantRange> pushConstantRanges = depthShader->getPushConstantRanges();
       vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo = vk::PipelineLayoutCreateInfo()
-         .setSetLayouts(descriptorSetLayouts)
-         .setPushConstantRanges(pushConstantRanges);
+         .setSetLayouts(descriptorSetLayouts);
       opaquePipelineLayout = device.createPipelineLayout(pipelineLayoutCreateInfo);
       NAME_CHILD(opaquePipelineLayout, "Opaque Pipeline Layout");
    }
 
    {
       std::array descriptorSetLayouts = depthMaskedShader->getDescriptorSetLayouts();
-      std::vector<vk::PushConstantRange> pushConstantRanges = depthMaskedShader->getPushConstantRanges();
       vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo = vk::PipelineLayoutCreateInfo()
-         .setSetLayouts(descriptorSetLayouts)
-         .setPushConstantRanges(pushConstantRanges);
+         .setSetLayouts(descriptorSetLayouts);
       maskedPipelineLayout = device.createPipelineLayout(pipelineLayoutCreateInfo);
       NAME_CHILD(maskedPipelineLayout, "Masked Pipeline Layout");
    }
@@ -57,27 +53,7 @@ void DepthPass::render(vk::CommandBuffer commandBuffer, const SceneRenderInfo& s
       .setLoadOp(vk::AttachmentLoadOp::eClear)
       .setClearValue(vk::ClearDepthStencilValue(1.0f, 0));
 
-   executePass(commandBuffer, nullptr, &depthStencilAttachmentInfo, [this, &sceneRenderInfo](vk::CommandBuffer commandBuffer)
-   {
-      if (isShadowPass)
-      {
-         const ViewInfo& viewInfo = sceneRenderInfo.view.getInfo();
-         commandBuffer.setDepthBias(viewInfo.depthBiasConstantFactor, viewInfo.depthBiasClamp, viewInfo.depthBiasSlopeFactor);
-      }
-
-      {
-         SCOPED_LABEL("Opaque");
-
-         depthShader->bindDescriptorSets(commandBuffer, opaquePipelineLayout, sceneRenderInfo.view.getDescriptorSet());
-         renderMeshes<BlendMode::Opaque>(commandBuffer, sceneRenderInfo);
-      }
-
-      {
-         SCOPED_LABEL("Masked");
-
-         renderMeshes<BlendMode::Masked>(commandBuffer, sceneRenderInfo);
-      }
-   });
+   executeScenePass(commandBuffer, {}, &depthStencilAttachmentInfo, sceneRenderInfo, BlendMode::Masked);
 }
 
 bool DepthPass::supportsMaterialType(uint32_t typeMask) const
@@ -85,15 +61,32 @@ bool DepthPass::supportsMaterialType(uint32_t typeMask) const
    return (typeMask & PhysicallyBasedMaterial::kTypeFlag) != 0;
 }
 
-void DepthPass::renderMesh(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Mesh& mesh, uint32_t section, const Material& material)
+void DepthPass::setPassState(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, BlendMode blendMode) const
+{
+   if (isShadowPass)
+   {
+      const ViewInfo& viewInfo = sceneRenderInfo.view.getInfo();
+      commandBuffer.setDepthBias(viewInfo.depthBiasConstantFactor, viewInfo.depthBiasClamp, viewInfo.depthBiasSlopeFactor);
+   }
+
+   if (blendMode == BlendMode::Opaque)
+   {
+      depthShader->bindDescriptorSets(commandBuffer, opaquePipelineLayout, sceneRenderInfo.view.getDescriptorSet());
+   }
+}
+
+bool DepthPass::bindMaterialDescriptorSets(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Material& material) const
 {
-   if (pipeline.getLayout() == maskedPipelineLayout)
+   // Opaque draws only need the view, which is bound in setPassState()
+   if (pipeline.getLayout() != maskedPipelineLayout)
    {
-      const PhysicallyBasedMaterial& pbrMaterial = *Types::checked_cast<const PhysicallyBasedMaterial*>(&material);
-      depthMaskedShader->bindDescriptorSets(commandBuffer, pipeline.getLayout(), view.getDescriptorSet(), pbrMaterial.getDescriptorSet());
+      return false;
    }
 
-   SceneRenderPass::renderMesh(commandBuffer, pipeline, view, mesh, section, material);
+   const PhysicallyBasedMaterial& pbrMaterial = *Types::checked_cast<const PhysicallyBasedMaterial*>(&material);
+   depthMaskedShader->bindDescriptorSets(commandBuffer, pipeline.getLayout(), view.getDescriptorSet(), pbrMaterial.getDescriptorSet());
+
+   return true;
 }
 
 vk::PipelineLayout DepthPass::selectPipelineLayout(BlendMode blendMode) const
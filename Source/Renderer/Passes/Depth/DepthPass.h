@@ -43,7 +43,9 @@ protected:
 
    bool supportsMaterialType(uint32_t typeMask) const;
 
-   void renderMesh(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Mesh& mesh, uint32_t section, const Material& material);
+   void setPassState(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, BlendMode blendMode) const;
+
+   bool bindMaterialDescriptorSets(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Material& material) const;
    vk::PipelineLayout selectPipelineLayout(BlendMode blendMode) const;
 
    PipelineDescription<DepthPass> getPipelineDescription(const View& view, const MeshSection& meshSection, const Material& material) const;
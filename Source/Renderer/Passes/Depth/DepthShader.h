@@ -4,12 +4,8 @@
 
 #include "Renderer/View.h"
 
-#include <vector>
-
 class DepthShader : public ParameterizedShader<void, ViewDescriptorSet>
 {
 public:
    DepthShader(const GraphicsContext& graphicsContext, ResourceManager& resourceManager);
-
-   std::vector<vk::PushConstantRange> getPushConstantRanges() const;
 };
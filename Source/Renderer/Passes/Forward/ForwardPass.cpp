@@ -27,10 +27,8 @@ ForwardPass::ForwardPass(const GraphicsContext& graphicsContext, DynamicDescript
 
    {
       std::array descriptorSetLayouts = forwardShader->getDescriptorSetLayouts();
-      std::vector<vk::PushConstantRange> pushConstantRanges = forwardShader->getPushConstantRanges();
       vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo = vk::PipelineLayoutCreateInfo()
-         .setSetLayouts(descriptorSetLayouts)
-         .setPushConstantRanges(pushConstantRanges);
+         .setSetLayouts(descriptorSetLayouts);
       forwardPipelineLayout = device.createPipelineLayout(pipelineLayoutCreateInfo);
       NAME_CHILD(forwardPipelineLayout, "Forward Pipeline Layout");
    }
@@ -121,50 +119,35 @@ void ForwardPass::render(vk::CommandBuffer commandBuffer, const SceneRenderInfo&
 
    AttachmentInfo depthStencilAttachmentInfo(depthTexture);
 
-   executePass(commandBuffer, colorAttachmentInfo, &depthStencilAttachmentInfo, [this, &sceneRenderInfo, &normalTexture, &ssaoTexture, skyboxTexture](vk::CommandBuffer commandBuffer)
+   vk::DescriptorImageInfo normalBufferImageInfo = vk::DescriptorImageInfo()
+      .setImageLayout(normalTexture.getLayout())
+      .setImageView(normalTexture.getDefaultView())
+      .setSampler(normalSampler);
+   vk::DescriptorImageInfo ssaoBufferImageInfo = vk::DescriptorImageInfo()
+      .setImageLayout(ssaoTexture.getLayout())
+      .setImageView(ssaoTexture.getDefaultView())
+      .setSampler(normalSampler);
+   std::array<vk::WriteDescriptorSet, 2> descriptorWrites =
+   {
+      vk::WriteDescriptorSet()
+         .setDstSet(forwardDescriptorSet.getCurrentSet())
+         .setDstBinding(0)
+         .setDstArrayElement(0)
+         .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+         .setDescriptorCount(1)
+         .setPImageInfo(&normalBufferImageInfo),
+      vk::WriteDescriptorSet()
+         .setDstSet(forwardDescriptorSet.getCurrentSet())
+         .setDstBinding(1)
+         .setDstArrayElement(0)
+         .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+         .setDescriptorCount(1)
+         .setPImageInfo(&ssaoBufferImageInfo)
+   };
+   device.updateDescriptorSets(descriptorWrites, {});
+
+   executeScenePass(commandBuffer, colorAttachmentInfo, &depthStencilAttachmentInfo, sceneRenderInfo, BlendMode::Translucent, [this, &sceneRenderInfo, skyboxTexture](vk::CommandBuffer commandBuffer)
    {
-      vk::DescriptorImageInfo normalBufferImageInfo = vk::DescriptorImageInfo()
-         .setImageLayout(normalTexture.getLayout())
-         .setImageView(normalTexture.getDefaultView())
-         .setSampler(normalSampler);
-      vk::DescriptorImageInfo ssaoBufferImageInfo = vk::DescriptorImageInfo()
-         .setImageLayout(ssaoTexture.getLayout())
-         .setImageView(ssaoTexture.getDefaultView())
-         .setSampler(normalSampler);
-      std::array<vk::WriteDescriptorSet, 2> descriptorWrites =
-      {
-         vk::WriteDescriptorSet()
-            .setDstSet(forwardDescriptorSet.getCurrentSet())
-            .setDstBinding(0)
-            .setDstArrayElement(0)
-            .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
-            .setDescriptorCount(1)
-            .setPImageInfo(&normalBufferImageInfo),
-         vk::WriteDescriptorSet()
-            .setDstSet(forwardDescriptorSet.getCurrentSet())
-            .setDstBinding(1)
-            .setDstArrayElement(0)
-            .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
-            .setDescriptorCount(1)
-            .setPImageInfo(&ssaoBufferImageInfo)
-      };
-      device.updateDescriptorSets(descriptorWrites, {});
-
-      {
-         SCOPED_LABEL("Opaque");
-         renderMeshes<BlendMode::Opaque>(commandBuffer, sceneRenderInfo);
-      }
-
-      {
-         SCOPED_LABEL("Masked");
-         renderMeshes<BlendMode::Masked>(commandBuffer, sceneRenderInfo);
-      }
-
-      {
-         SCOPED_LABEL("Translucent");
-         renderMeshes<BlendMode::Translucent>(commandBuffer, sceneRenderInfo);
-      }
-
       if (skyboxTexture)
       {
          SCOPED_LABEL("Skybox");
@@ -198,14 +181,14 @@ bool ForwardPass::supportsMaterialType(uint32_t typeMask) const
    return (typeMask & PhysicallyBasedMaterial::kTypeFlag) != 0;
 }
 
-void ForwardPass::renderMesh(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Mesh& mesh, uint32_t section, const Material& material)
+bool ForwardPass::bindMaterialDescriptorSets(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Material& material) const
 {
    ASSERT(lighting);
    const PhysicallyBasedMaterial& pbrMaterial = *Types::checked_cast<const PhysicallyBasedMaterial*>(&material);
 
    forwardShader->bindDescriptorSets(commandBuffer, pipeline.getLayout(), view.getDescriptorSet(), forwardDescriptorSet, lighting->getDescriptorSet(), pbrMaterial.getDescriptorSet());
 
-   SceneRenderPass::renderMesh(commandBuffer, pipeline, view, mesh, section, material);
+   return true;
 }
 
 vk::PipelineLayout ForwardPass::selectPipelineLayout(BlendMode blendMode) const
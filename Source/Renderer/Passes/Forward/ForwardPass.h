@@ -46,7 +46,7 @@ protected:
 
    bool supportsMaterialType(uint32_t typeMask) const;
 
-   void renderMesh(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Mesh& mesh, uint32_t section, const Material& material);
+   bool bindMaterialDescriptorSets(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Material& material) const;
    vk::PipelineLayout selectPipelineLayout(BlendMode blendMode) const;
 
    PipelineDescription<ForwardPass> getPipelineDescription(const View& view, const MeshSection& meshSection, const Material& material) const;
@@ -2,8 +2,6 @@
 
 #include "Graphics/SpecializationInfo.h"
 
-#include "Renderer/UniformData.h"
-
 // static
 void ForwardShaderConstants::registerMembers(ShaderPermutationManager<ForwardShaderConstants>& permutationManager)
 {
@@ -33,14 +31,3 @@ ForwardShader::ForwardShader(const GraphicsContext& graphicsContext, ResourceMan
    : ParameterizedShader(graphicsContext, resourceManager, Shader::ModuleInfo("Forward", "Forward"))
 {
 }
-
-std::vector<vk::PushConstantRange> ForwardShader::getPushConstantRanges() const
-{
-   return
-   {
-      vk::PushConstantRange()
-         .setStageFlags(vk::ShaderStageFlagBits::eVertex)
-         .setOffset(0)
-         .setSize(sizeof(MeshUniformData))
-   };
-}
@@ -31,6 +31,4 @@ class ForwardShader : public ParameterizedShader<ForwardShaderConstants, ViewDes
 {
 public:
    ForwardShader(const GraphicsContext& graphicsContext, ResourceManager& resourceManager);
-
-   std::vector<vk::PushConstantRange> getPushConstantRanges() const;
 };
@@ -9,7 +9,6 @@
 
 #include "Renderer/Passes/Normal/NormalShader.h"
 #include "Renderer/SceneRenderInfo.h"
-#include "Renderer/UniformData.h"
 
 #include <utility>
 
@@ -20,10 +19,8 @@ NormalPass::NormalPass(const GraphicsContext& graphicsContext, ResourceManager&
 
    {
       std::array descriptorSetLayouts = normalShader->getDescriptorSetLayouts();
-      std::vector<vk::PushConstantRange> pushConstantRanges = normalShader->getPushConstantRanges();
       vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo = vk::PipelineLayoutCreateInfo()
-         .setSetLayouts(descriptorSetLayouts)
-         .setPushConstantRanges(pushConstantRanges);
+         .setSetLayouts(descriptorSetLayouts);
       pipelineLayout = device.createPipelineLayout(pipelineLayoutCreateInfo);
       NAME_CHILD(pipelineLayout, "Pipeline Layout");
    }
@@ -49,18 +46,7 @@ void NormalPass::render(vk::CommandBuffer commandBuffer, const SceneRenderInfo&
       .setLoadOp(vk::AttachmentLoadOp::eClear)
       .setClearValue(vk::ClearDepthStencilValue(1.0f, 0));
 
-   executePass(commandBuffer, &colorAttachmentInfo, &depthStencilAttachmentInfo, [this, &sceneRenderInfo](vk::CommandBuffer commandBuffer)
-   {
-      {
-         SCOPED_LABEL("Opaque");
-         renderMeshes<BlendMode::Opaque>(commandBuffer, sceneRenderInfo);
-      }
-
-      {
-         SCOPED_LABEL("Masked");
-         renderMeshes<BlendMode::Masked>(commandBuffer, sceneRenderInfo);
-      }
-   });
+   executeScenePass(commandBuffer, std::span<const AttachmentInfo>(&colorAttachmentInfo, 1), &depthStencilAttachmentInfo, sceneRenderInfo, BlendMode::Masked);
 }
 
 bool NormalPass::supportsMaterialType(uint32_t typeMask) const
@@ -68,12 +54,12 @@ bool NormalPass::supportsMaterialType(uint32_t typeMask) const
    return (typeMask & PhysicallyBasedMaterial::kTypeFlag) != 0;
 }
 
-void NormalPass::renderMesh(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Mesh& mesh, uint32_t section, const Material& material)
+bool NormalPass::bindMaterialDescriptorSets(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Material& material) const
 {
    const PhysicallyBasedMaterial& pbrMaterial = *Types::checked_cast<const PhysicallyBasedMaterial*>(&material);
    normalShader->bindDescriptorSets(commandBuffer, pipeline.getLayout(), view.getDescriptorSet(), pbrMaterial.getDescriptorSet());
 
-   SceneRenderPass::renderMesh(commandBuffer, pipeline, view, mesh, section, material);
+   return true;
 }
 
 vk::PipelineLayout NormalPass::selectPipelineLayout(BlendMode blendMode) const
@@ -2,8 +2,6 @@
 
 #include "Graphics/SpecializationInfo.h"
 
-#include "Renderer/UniformData.h"
-
 // static
 void NormalShaderConstants::registerMembers(ShaderPermutationManager<NormalShaderConstants>& permutationManager)
 {
@@ -15,14 +13,3 @@ NormalShader::NormalShader(const GraphicsContext& graphicsContext, ResourceManag
    : ParameterizedShader(graphicsContext, resourceManager, Shader::ModuleInfo("Normal", "Normal"))
 {
 }
-
-std::vector<vk::PushConstantRange> NormalShader::getPushConstantRanges() const
-{
-   return
-   {
-      vk::PushConstantRange()
-         .setStageFlags(vk::ShaderStageFlagBits::eVertex)
-         .setOffset(0)
-         .setSize(sizeof(MeshUniformData))
-   };
-}
@@ -5,8 +5,6 @@
 #include "Renderer/PhysicallyBasedMaterial.h"
 #include "Renderer/View.h"
 
-#include <vector>
-
 struct NormalShaderConstants
 {
    VkBool32 withTextures = false;
@@ -21,6 +19,4 @@ class NormalShader : public ParameterizedShader<NormalShaderConstants, ViewDescr
 {
 public:
    NormalShader(const GraphicsContext& graphicsContext, ResourceManager& resourceManager);
-
-   std::vector<vk::PushConstantRange> getPushConstantRanges() const;
 };
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Core/Assert.h"
+#include "Core/Containers/FrameVector.h"
 #include "Core/Features.h"
+#include "Core/Jobs/JobSystem.h"
 
 #include "Graphics/DebugUtils.h"
 #include "Graphics/Material.h"
@@ -10,10 +12,17 @@
 #include "Graphics/RenderPass.h"
 #include "Graphics/Shader.h"
 
+#include "Renderer/DrawSortKey.h"
+#include "Renderer/DrawStats.h"
+#include "Renderer/ParallelRecording.h"
 #include "Renderer/SceneRenderInfo.h"
-#include "Renderer/UniformData.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <optional>
+#include <span>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -35,6 +44,22 @@ public:
    {
    }
 
+   const PassDrawStats& getDrawStats() const
+   {
+      return drawStats;
+   }
+
+   void resetDrawStats()
+   {
+      drawStats = {};
+   }
+
+   // Draws are recorded from multiple jobs when set (and the job system is running), otherwise directly into the primary command buffer
+   void setSecondaryCommandPool(SecondaryCommandPool* pool)
+   {
+      secondaryCommandPool = pool;
+   }
+
 protected:
    void onRenderPassBegin() override
    {
@@ -79,57 +104,111 @@ protected:
       return shader;
    }
 
-   template<BlendMode blendMode>
-   void renderMeshes(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo)
+   // Records the draws of each blend mode up to and including lastBlendMode. When a secondary command pool has been set, the draws are split into chunks that are recorded
+   // in parallel into secondary command buffers.
+   void executeScenePass(vk::CommandBuffer commandBuffer, std::span<const AttachmentInfo> colorAttachments, const AttachmentInfo* depthStencilAttachment, const SceneRenderInfo& sceneRenderInfo, BlendMode lastBlendMode)
    {
-      Derived* derivedThis = static_cast<Derived*>(this);
+      executeScenePass(commandBuffer, colorAttachments, depthStencilAttachment, sceneRenderInfo, lastBlendMode, nullptr);
+   }
 
-      vk::PipelineLayout pipelineLayout = derivedThis->selectPipelineLayout(blendMode);
+   // Same as above, with renderExtras recording anything else in the pass after the draws
+   template<typename Func>
+   void executeScenePass(vk::CommandBuffer commandBuffer, std::span<const AttachmentInfo> colorAttachments, const AttachmentInfo* depthStencilAttachment, const SceneRenderInfo& sceneRenderInfo, BlendMode lastBlendMode, Func&& renderExtras)
+   {
+      static constexpr bool kHasExtras = !std::is_null_pointer_v<std::decay_t<Func>>;
 
-      vk::Pipeline lastPipeline;
-      for (const MeshRenderInfo& meshRenderInfo : sceneRenderInfo.meshes)
+      std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+      // Draws are sorted by key, which starts with the blend mode
+      const FrameVector<DrawInfo>& allDraws = sceneRenderInfo.draws;
+      auto drawsEnd = std::partition_point(allDraws.begin(), allDraws.end(), [lastBlendMode](const DrawInfo& draw) { return DrawSortKey::getBlendMode(draw.sortKey) <= lastBlendMode; });
+      std::span<const DrawInfo> draws(allDraws.begin(), drawsEnd);
+
+      std::size_t numChunks = 1;
+      if (secondaryCommandPool && JobSystem::isInitialized())
       {
-         const FrameVector<uint32_t>& sections = blendMode == BlendMode::Translucent ? meshRenderInfo.visibleTranslucentSections : blendMode == BlendMode::Masked ? meshRenderInfo.visibleMaskedSections : meshRenderInfo.visibleOpaqueSections;
-         if (!sections.empty() && derivedThis->supportsMaterialType(meshRenderInfo.mesh->getMaterialTypeMask()))
-         {
-            ASSERT(meshRenderInfo.mesh);
+         numChunks = ParallelRecording::getNumChunks(draws.size(), JobSystem::getNumWorkers() + 1);
+      }
+      bool recordInParallel = numChunks > 1;
+
+      beginRenderPass(commandBuffer, colorAttachments, depthStencilAttachment, recordInParallel ? vk::RenderingFlagBits::eContentsSecondaryCommandBuffers : vk::RenderingFlags{});
 
-            SCOPED_LABEL(meshRenderInfo.mesh->getName());
+      FrameVector<const Pipeline*> pipelines;
+      resolvePipelines(sceneRenderInfo, draws, pipelines);
 
-            MeshUniformData meshUniformData;
-            meshUniformData.localToWorld = meshRenderInfo.localToWorld;
-            commandBuffer.pushConstants<MeshUniformData>(pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, meshUniformData);
+      if (recordInParallel)
+      {
+         FrameVector<vk::CommandBuffer> secondaryCommandBuffers(numChunks);
+         FrameVector<PassDrawStats> chunkDrawStats(numChunks);
+         std::size_t drawsPerChunk = (draws.size() + numChunks - 1) / numChunks;
 
-            for (uint32_t section : sections)
+         JobSystem::parallelFor(numChunks, 1, [this, &sceneRenderInfo, draws, &pipelines, &secondaryCommandBuffers, &chunkDrawStats, drawsPerChunk](std::size_t begin, std::size_t end)
+         {
+            for (std::size_t chunk = begin; chunk < end; ++chunk)
             {
-               const Material* material = meshRenderInfo.materials[section];
-               ASSERT(material);
+               std::size_t first = std::min(chunk * drawsPerChunk, draws.size());
+               std::size_t count = std::min(drawsPerChunk, draws.size() - first);
 
-               if (derivedThis->supportsMaterialType(material->getTypeFlag()))
-               {
-                  SCOPED_LABEL("Section " + DebugUtils::toString(section));
+               vk::CommandBuffer chunkCommandBuffer = beginSecondaryCommandBuffer(*secondaryCommandPool);
+               recordDraws(chunkCommandBuffer, sceneRenderInfo, draws.subspan(first, count), std::span<const Pipeline* const>(pipelines).subspan(first, count), chunkDrawStats[chunk]);
+               chunkCommandBuffer.end();
 
-                  PipelineDescription<Derived> pipelineDescription = derivedThis->getPipelineDescription(sceneRenderInfo.view, meshRenderInfo.mesh->getSection(section), *material);
-                  const Pipeline& pipeline = getPipeline(pipelineDescription);
-                  ASSERT(pipeline.getLayout() == pipelineLayout);
+               secondaryCommandBuffers[chunk] = chunkCommandBuffer;
+            }
+         });
 
-                  if (pipeline.getVkPipeline() != lastPipeline)
-                  {
-                     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.getVkPipeline());
-                     lastPipeline = pipeline.getVkPipeline();
-                  }
+         if constexpr (kHasExtras)
+         {
+            vk::CommandBuffer extrasCommandBuffer = beginSecondaryCommandBuffer(*secondaryCommandPool);
+            renderExtras(extrasCommandBuffer);
+            extrasCommandBuffer.end();
 
-                  derivedThis->renderMesh(commandBuffer, pipeline, sceneRenderInfo.view, *meshRenderInfo.mesh, section, *material);
-               }
-            }
+            secondaryCommandBuffers.push_back(extrasCommandBuffer);
+         }
+
+         commandBuffer.executeCommands(secondaryCommandBuffers);
+         drawStats.secondaryCommandBuffers += static_cast<uint32_t>(secondaryCommandBuffers.size());
+
+         for (const PassDrawStats& stats : chunkDrawStats)
+         {
+            drawStats.draws += stats.draws;
+            drawStats.instances += stats.instances;
+            drawStats.drawCalls += stats.drawCalls;
+            drawStats.pipelineBinds += stats.pipelineBinds;
+            drawStats.descriptorSetBinds += stats.descriptorSetBinds;
+            drawStats.bufferBinds += stats.bufferBinds;
          }
       }
+      else
+      {
+         recordDraws(commandBuffer, sceneRenderInfo, draws, pipelines, drawStats);
+
+         if constexpr (kHasExtras)
+         {
+            renderExtras(commandBuffer);
+         }
+      }
+
+      endRenderPass(commandBuffer);
+
+      drawStats.recordMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
    }
 
-   void renderMesh(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Mesh& mesh, uint32_t section, const Material& material)
+   // Called before the first draw of each blend mode in each command buffer, to set any state that the draws of that blend mode share
+   void setPassState(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, BlendMode blendMode) const
    {
-      mesh.bindBuffers(commandBuffer, section, pipeline.getInfo().positionOnly);
-      mesh.draw(commandBuffer, section);
+   }
+
+   // Returns whether any descriptor sets were bound
+   bool bindMaterialDescriptorSets(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Material& material) const
+   {
+      return false;
+   }
+
+   // Only used when draws are recorded directly. The mesh's buffers are already bound, and instances index the instance buffer bound with the view.
+   void renderMesh(vk::CommandBuffer commandBuffer, const Pipeline& pipeline, const View& view, const Mesh& mesh, uint32_t section, const Material& material, uint32_t numInstances, uint32_t firstInstance) const
+   {
+      mesh.draw(commandBuffer, section, numInstances, firstInstance);
    }
 
    void renderScreenMesh(vk::CommandBuffer commandBuffer, const Pipeline& pipeline)
@@ -164,8 +243,189 @@ protected:
 private:
    using PipelineMap = std::unordered_map<PipelineDescription<Derived>, Pipeline>;
 
+   static const char* getBlendModeLabel(BlendMode blendMode)
+   {
+      switch (blendMode)
+      {
+      case BlendMode::Opaque:
+         return "Opaque";
+      case BlendMode::Masked:
+         return "Masked";
+      case BlendMode::Translucent:
+         return "Translucent";
+      default:
+         ASSERT(false);
+         return nullptr;
+      }
+   }
+
+   // Finds the pipeline for each draw (or null if the pass doesn't support its material). This happens on the calling thread, since pipelines can't be created while
+   // draws are being recorded from other threads. Pipeline descriptions only depend on the view and the blend mode and pipeline state in the sort key, so pipelines are
+   // only looked up when those change.
+   void resolvePipelines(const SceneRenderInfo& sceneRenderInfo, std::span<const DrawInfo> draws, FrameVector<const Pipeline*>& pipelines)
+   {
+      Derived* derivedThis = static_cast<Derived*>(this);
+
+      pipelines.reserve(draws.size());
+
+      const Pipeline* pipeline = nullptr;
+      uint32_t pipelineKey = 0;
+      for (const DrawInfo& draw : draws)
+      {
+         const MeshRenderInfo& meshRenderInfo = sceneRenderInfo.meshes[draw.meshIndex];
+         ASSERT(meshRenderInfo.mesh && draw.material);
+
+         if (!derivedThis->supportsMaterialType(draw.material->getTypeFlag()))
+         {
+            pipelines.push_back(nullptr);
+            continue;
+         }
+
+         uint32_t drawPipelineKey = DrawSortKey::getPipelineKey(draw.sortKey);
+         if (!pipeline || drawPipelineKey != pipelineKey)
+         {
+            pipeline = &getPipeline(derivedThis->getPipelineDescription(sceneRenderInfo.view, meshRenderInfo.mesh->getSection(draw.section), *draw.material));
+            pipelineKey = drawPipelineKey;
+         }
+
+         pipelines.push_back(pipeline);
+      }
+   }
+
+   // Records a range of draws, which can span multiple blend modes. Safe to call from multiple threads at once, with different command buffers and stats.
+   void recordDraws(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, std::span<const DrawInfo> draws, std::span<const Pipeline* const> pipelines, PassDrawStats& stats) const
+   {
+      std::size_t begin = 0;
+      while (begin < draws.size())
+      {
+         BlendMode blendMode = DrawSortKey::getBlendMode(draws[begin].sortKey);
+         auto blendModeEnd = std::partition_point(draws.begin() + begin, draws.end(), [blendMode](const DrawInfo& draw) { return DrawSortKey::getBlendMode(draw.sortKey) == blendMode; });
+         std::size_t end = static_cast<std::size_t>(blendModeEnd - draws.begin());
+
+         SCOPED_LABEL(getBlendModeLabel(blendMode));
+         renderMeshes(commandBuffer, sceneRenderInfo, blendMode, draws.subspan(begin, end - begin), pipelines.subspan(begin, end - begin), stats);
+
+         begin = end;
+      }
+   }
+
+   // With indirect draws, each run of draws that share the pipeline, material and mesh arena block is submitted with a single call (for draws culled on the GPU, the
+   // runs are the cull batches)
+   void renderMeshes(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, BlendMode blendMode, std::span<const DrawInfo> draws, std::span<const Pipeline* const> pipelines, PassDrawStats& stats) const
+   {
+      static constexpr uint32_t kDrawCommandStride = sizeof(vk::DrawIndexedIndirectCommand);
+
+      const Derived* derivedThis = static_cast<const Derived*>(this);
+
+      derivedThis->setPassState(commandBuffer, sceneRenderInfo, blendMode);
+      vk::PipelineLayout pipelineLayout = derivedThis->selectPipelineLayout(blendMode);
+
+      bool indirect = static_cast<bool>(sceneRenderInfo.drawCommandBuffer);
+      std::size_t maxDrawsPerCall = 1;
+      if (indirect && context.getPhysicalDeviceFeatures().multiDrawIndirect)
+      {
+         maxDrawsPerCall = context.getPhysicalDeviceProperties().limits.maxDrawIndirectCount;
+      }
+
+      // All pipelines use the same layout, so descriptor sets stay bound when the pipeline changes
+      vk::Pipeline lastPipeline;
+      const Material* lastMaterial = nullptr;
+      std::optional<std::pair<uint32_t, bool>> lastBuffers;
+      std::size_t i = 0;
+      while (i < draws.size())
+      {
+         const Pipeline* pipeline = pipelines[i];
+         if (!pipeline)
+         {
+            ++i;
+            continue;
+         }
+
+         const DrawInfo& draw = draws[i];
+         const Mesh& mesh = *sceneRenderInfo.meshes[draw.meshIndex].mesh;
+
+         // Draws culled on the GPU are submitted in batches, with the first draw of each batch (which can be in another chunk)
+         std::size_t drawIndex = static_cast<std::size_t>(&draw - sceneRenderInfo.draws.data());
+         std::optional<uint32_t> cullBatchIndex;
+         if (drawIndex < sceneRenderInfo.numGPUCulledDraws)
+         {
+            cullBatchIndex = sceneRenderInfo.drawBatches[drawIndex];
+            if (sceneRenderInfo.cullBatches[*cullBatchIndex].firstDraw != drawIndex)
+            {
+               ++stats.draws;
+               stats.instances += draw.numInstances;
+               ++i;
+               continue;
+            }
+         }
+
+         ASSERT(pipeline->getLayout() == pipelineLayout);
+         if (pipeline->getVkPipeline() != lastPipeline)
+         {
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->getVkPipeline());
+            lastPipeline = pipeline->getVkPipeline();
+            ++stats.pipelineBinds;
+         }
+
+         if (draw.material != lastMaterial)
+         {
+            if (derivedThis->bindMaterialDescriptorSets(commandBuffer, *pipeline, sceneRenderInfo.view, *draw.material))
+            {
+               ++stats.descriptorSetBinds;
+            }
+            lastMaterial = draw.material;
+         }
+
+         std::pair<uint32_t, bool> buffers(mesh.getArenaBlock(), pipeline->getInfo().positionOnly);
+         if (buffers != lastBuffers)
+         {
+            mesh.bindBuffers(commandBuffer, buffers.second);
+            lastBuffers = buffers;
+            ++stats.bufferBinds;
+         }
+
+         std::size_t runEnd = i + 1;
+         while (!cullBatchIndex && runEnd < draws.size() && runEnd - i < maxDrawsPerCall && pipelines[runEnd] == pipeline && draws[runEnd].material == draw.material
+            && sceneRenderInfo.meshes[draws[runEnd].meshIndex].mesh->getArenaBlock() == buffers.first)
+         {
+            ++runEnd;
+         }
+
+         if (cullBatchIndex)
+         {
+            const CullBatch& cullBatch = sceneRenderInfo.cullBatches[*cullBatchIndex];
+            SCOPED_LABEL("Up To " + DebugUtils::toString(cullBatch.numDraws) + " Draws");
+
+            commandBuffer.drawIndexedIndirectCount(sceneRenderInfo.culledDrawCommandBuffer, cullBatch.firstDraw * kDrawCommandStride, sceneRenderInfo.drawCountBuffer, *cullBatchIndex * sizeof(uint32_t),
+               cullBatch.numDraws, kDrawCommandStride, GraphicsContext::GetDynamicLoader());
+         }
+         else if (indirect)
+         {
+            SCOPED_LABEL(DebugUtils::toString(runEnd - i) + " Draws");
+
+            // The draw commands are in the same order as the scene render info's draws
+            commandBuffer.drawIndexedIndirect(sceneRenderInfo.drawCommandBuffer, (sceneRenderInfo.drawCommandOffset + drawIndex) * kDrawCommandStride, static_cast<uint32_t>(runEnd - i), kDrawCommandStride);
+         }
+         else
+         {
+            SCOPED_LABEL(mesh.getName() + " Section " + DebugUtils::toString(draw.section));
+            derivedThis->renderMesh(commandBuffer, *pipeline, sceneRenderInfo.view, mesh, draw.section, *draw.material, draw.numInstances, sceneRenderInfo.instanceOffset + draw.firstInstance);
+         }
+         ++stats.drawCalls;
+
+         for (; i < runEnd; ++i)
+         {
+            ++stats.draws;
+            stats.instances += draws[i].numInstances;
+         }
+      }
+   }
+
    std::unordered_map<AttachmentFormats, PipelineMap> pipelineMapsByAttachmentFormat;
    PipelineMap* currentPipelineMap = nullptr;
 
+   SecondaryCommandPool* secondaryCommandPool = nullptr;
+   PassDrawStats drawStats;
+
    std::unordered_set<std::unique_ptr<Shader>> shaders;
 };
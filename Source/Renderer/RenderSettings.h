@@ -94,6 +94,12 @@ struct RenderSettings
    RenderQuality bloomQuality = RenderQuality::High;
    SwapchainSettings swapchainSettings;
    TonemapSettings tonemapSettings;
+   bool parallelCommandRecording = false; // Off until record times against inline recording (see DrawStats) have been measured on lavapipe with validation enabled
+   bool automaticInstancing = true;
+   bool sortDrawsByState = true; // Otherwise opaque and masked draws are ordered by depth alone, to compare bind counts (see DrawStats)
+   bool indirectDraws = true;
+   bool gpuCulling = false; // Only used with indirect draws, on devices that support indirect draw counts, in builds with FORGE_WITH_GPU_CULLING
+   bool softwareOcclusionCulling = false;
 
    bool operator==(const RenderSettings& other) const = default;
 
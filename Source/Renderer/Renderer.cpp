@@ -1,13 +1,25 @@
 #include "Renderer/Renderer.h"
 
+#include "Core/Jobs/JobSystem.h"
+#include "Core/Profiler.h"
+
 #include "Graphics/DebugUtils.h"
+#include "Graphics/Mesh.h"
+#include "Graphics/SecondaryCommandPool.h"
 #include "Graphics/Swapchain.h"
 #include "Graphics/Texture.h"
 
+#include "Math/Bounds.h"
+#include "Math/Frustum.h"
+#include "Math/FrustumBatch.h"
 #include "Math/MathUtils.h"
+#include "Math/OcclusionBuffer.h"
 
+#include "Renderer/DrawSortKey.h"
 #include "Renderer/ForwardLighting.h"
+#include "Renderer/InstanceBuffer.h"
 #include "Renderer/Passes/Composite/CompositePass.h"
+#include "Renderer/Passes/Culling/CullingPass.h"
 #include "Renderer/Passes/Depth/DepthPass.h"
 #include "Renderer/Passes/Forward/ForwardPass.h"
 #include "Renderer/Passes/Normal/NormalPass.h"
@@ -15,6 +27,8 @@
 #include "Renderer/Passes/PostProcess/Tonemap/TonemapPass.h"
 #include "Renderer/Passes/SSAO/SSAOPass.h"
 #include "Renderer/Passes/UI/UIPass.h"
+#include "Renderer/SceneCulling.h"
+#include "Renderer/SceneExtraction.h"
 #include "Renderer/SceneRenderInfo.h"
 #include "Renderer/View.h"
 
@@ -33,10 +47,17 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <span>
 
 namespace
 {
+   // Only needs enough resolution for large occluders, each pixel covers a few hundred on screen
+   const uint32_t kOcclusionBufferWidth = 256;
+   const uint32_t kOcclusionBufferHeight = 128;
+
    ViewInfo computeActiveCameraViewInfo(const GraphicsContext& context, const Scene& scene)
    {
       ViewInfo viewInfo;
@@ -179,181 +200,15 @@ namespace
       return std::make_unique<Texture>(context, depthImageProperties, depthTextureProperties, depthInitialLayout);
    }
 
-   std::array<glm::vec4, 6> computeFrustumPlanes(const glm::mat4& worldToClip)
+   void computeLightRenderInfo(const Scene& scene, SceneRenderInfo& sceneRenderInfo)
    {
-      std::array<glm::vec4, 6> frustumPlanes;
-
-      for (int i = 0; i < frustumPlanes.size(); ++i)
-      {
-         glm::vec4& frustumPlane = frustumPlanes[i];
-
-         int row = i / 2;
-         int sign = (i % 2) == 0 ? 1 : -1;
-
-         frustumPlane.x = worldToClip[0][3] + sign * worldToClip[0][row];
-         frustumPlane.y = worldToClip[1][3] + sign * worldToClip[1][row];
-         frustumPlane.z = worldToClip[2][3] + sign * worldToClip[2][row];
-         frustumPlane.w = worldToClip[3][3] + sign * worldToClip[3][row];
-
-         frustumPlane /= glm::length(glm::vec3(frustumPlane.x, frustumPlane.y, frustumPlane.z));
-      }
-
-      return frustumPlanes;
-   }
-
-   float signedPlaneDist(const glm::vec3& point, const glm::vec4& plane)
-   {
-      return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
-   }
-
-   bool outside(std::span<glm::vec3> points, const glm::vec4& plane)
-   {
-      for (const glm::vec3& point : points)
-      {
-         if (signedPlaneDist(point, plane) >= 0.0f)
-         {
-            return false;
-         }
-      }
-
-      return true;
-   }
-
-   bool frustumCull(const glm::vec3& position, float radius, const std::array<glm::vec4, 6>& frustumPlanes)
-   {
-      for (const glm::vec4& plane : frustumPlanes)
-      {
-         if (signedPlaneDist(position, plane) < -radius)
-         {
-            return true;
-         }
-      }
-
-      return false;
-   }
-
-   bool frustumCull(std::span<glm::vec3> points, const std::array<glm::vec4, 6>& frustumPlanes)
-   {
-      for (const glm::vec4& plane : frustumPlanes)
-      {
-         if (outside(points, plane))
-         {
-            return true;
-         }
-      }
-
-      return false;
-   }
-
-   bool frustumCull(const Bounds& bounds, const std::array<glm::vec4, 6>& frustumPlanes)
-   {
-      // First check the bounding sphere
-      if (frustumCull(bounds.getCenter(), bounds.getRadius(), frustumPlanes))
-      {
-         return true;
-      }
-
-      // Next, check the bounding box
-      glm::vec3 min = bounds.getMin();
-      glm::vec3 max = bounds.getMax();
-      std::array<glm::vec3, 8> corners =
-      {
-         glm::vec3(min.x, min.y, min.z),
-         glm::vec3(min.x, min.y, max.z),
-         glm::vec3(min.x, max.y, min.z),
-         glm::vec3(min.x, max.y, max.z),
-         glm::vec3(max.x, min.y, min.z),
-         glm::vec3(max.x, min.y, max.z),
-         glm::vec3(max.x, max.y, min.z),
-         glm::vec3(max.x, max.y, max.z)
-      };
-      if (frustumCull(corners, frustumPlanes))
-      {
-         return true;
-      }
-
-      return false;
-   }
-
-   Bounds transformBounds(const Bounds& bounds, const Transform& transform)
-   {
-      return Bounds(transform.transformPosition(bounds.getCenter()), transform.transformVector(bounds.getExtent()));
-   }
-
-   SceneRenderInfo computeSceneRenderInfo(const ResourceManager& resourceManager, const Scene& scene, const View& view, bool isShadowPass)
-   {
-      SceneRenderInfo sceneRenderInfo(view);
-
-      std::array<glm::vec4, 6> frustumPlanes = computeFrustumPlanes(view.getMatrices().worldToClip);
-
-      scene.forEach<TransformComponent, MeshComponent>([&resourceManager, &sceneRenderInfo, &frustumPlanes, isShadowPass](const TransformComponent& transformComponent, const MeshComponent& meshComponent)
-      {
-         if (isShadowPass && !meshComponent.castsShadows)
-         {
-            return;
-         }
-
-         if (const Mesh* mesh = resourceManager.getMesh(meshComponent.meshHandle))
-         {
-            MeshRenderInfo info(*mesh, transformComponent.getAbsoluteTransform());
-
-            bool anyVisible = false;
-            uint32_t numSections = mesh->getNumSections();
-
-            info.materials.resize(numSections);
-            info.visibleOpaqueSections.reserve(numSections);
-            info.visibleMaskedSections.reserve(numSections);
-            info.visibleTranslucentSections.reserve(numSections);
-
-            for (uint32_t section = 0; section < numSections; ++section)
-            {
-               const MeshSection& meshSection = mesh->getSection(section);
-
-               if (const Material* material = resourceManager.getMaterial(meshSection.materialHandle))
-               {
-                  bool visible = !frustumCull(transformBounds(meshSection.bounds, info.transform), frustumPlanes);
-                  if (visible)
-                  {
-                     anyVisible = true;
-
-                     BlendMode blendMode = material->getBlendMode();
-                     if (blendMode == BlendMode::Opaque)
-                     {
-                        info.visibleOpaqueSections.push_back(section);
-                     }
-                     else if (blendMode == BlendMode::Masked)
-                     {
-                        info.visibleMaskedSections.push_back(section);
-                     }
-                     else if (blendMode == BlendMode::Translucent)
-                     {
-                        info.visibleTranslucentSections.push_back(section);
-                     }
-
-                     info.materials[section] = material;
-                  }
-               }
-            }
+      PROFILE_SCOPE("computeLightRenderInfo");
 
-            if (anyVisible)
-            {
-               sceneRenderInfo.meshes.push_back(std::move(info));
-            }
-         }
-      });
-
-      std::sort(sceneRenderInfo.meshes.begin(), sceneRenderInfo.meshes.end(), [viewPosition = view.getMatrices().viewPosition](const MeshRenderInfo& first, const MeshRenderInfo& second)
-      {
-         float firstSquaredDistance = glm::distance2(first.transform.position, viewPosition);
-         float secondSquaredDistance = glm::distance2(second.transform.position, viewPosition);
-
-         return firstSquaredDistance > secondSquaredDistance;
-      });
+      Frustum frustum(sceneRenderInfo.view.getMatrices().worldToClip);
 
-      if (!isShadowPass)
       {
          uint32_t allocatedPointShadowMaps = 0;
-         scene.forEach<TransformComponent, PointLightComponent>([&sceneRenderInfo, &frustumPlanes, &allocatedPointShadowMaps](const TransformComponent& transformComponent, const PointLightComponent& pointLightComponent)
+         scene.forEach<TransformComponent, PointLightComponent>([&sceneRenderInfo, &frustum, &allocatedPointShadowMaps](const TransformComponent& transformComponent, const PointLightComponent& pointLightComponent)
          {
             Transform transform = transformComponent.getAbsoluteTransform();
 
@@ -365,7 +220,7 @@ namespace
 
             if (info.radius > 0.0f && glm::length2(info.color) > 0.0f)
             {
-               bool visible = !frustumCull(info.position, info.radius, frustumPlanes);
+               bool visible = !frustum.cull(info.position, info.radius);
                if (visible)
                {
                   if (pointLightComponent.castsShadows() && allocatedPointShadowMaps < ForwardLighting::kMaxPointShadowMaps)
@@ -380,7 +235,7 @@ namespace
          });
 
          uint32_t allocatedSpotShadowMaps = 0;
-         scene.forEach<TransformComponent, SpotLightComponent>([&sceneRenderInfo, &frustumPlanes, &allocatedSpotShadowMaps](const TransformComponent& transformComponent, const SpotLightComponent& spotLightComponent)
+         scene.forEach<TransformComponent, SpotLightComponent>([&sceneRenderInfo, &frustum, &allocatedSpotShadowMaps](const TransformComponent& transformComponent, const SpotLightComponent& spotLightComponent)
          {
             Transform transform = transformComponent.getAbsoluteTransform();
 
@@ -406,7 +261,7 @@ namespace
                   end - transform.getRightVector() * endWidth, // End left
                };
 
-               bool visible = !frustumCull(points, frustumPlanes);
+               bool visible = !frustum.cull(points);
                if (visible)
                {
                   if (spotLightComponent.castsShadows() && allocatedSpotShadowMaps < ForwardLighting::kMaxSpotShadowMaps)
@@ -421,7 +276,7 @@ namespace
          });
 
          uint32_t allocatedDirectionalShadowMaps = 0;
-         scene.forEach<TransformComponent, DirectionalLightComponent>([&sceneRenderInfo, &frustumPlanes, &allocatedDirectionalShadowMaps](const TransformComponent& transformComponent, const DirectionalLightComponent& directionalLightComponent)
+         scene.forEach<TransformComponent, DirectionalLightComponent>([&sceneRenderInfo, &frustum, &allocatedDirectionalShadowMaps](const TransformComponent& transformComponent, const DirectionalLightComponent& directionalLightComponent)
          {
             Transform transform = transformComponent.getAbsoluteTransform();
 
@@ -450,7 +305,7 @@ namespace
                      transform.position - forwardOffset - rightOffset - upOffset,
                   };
 
-                  bool shadowsVisible = !frustumCull(points, frustumPlanes);
+                  bool shadowsVisible = !frustum.cull(points);
                   if (shadowsVisible)
                   {
                      info.shadowViewInfo = shadowViewInfo;
@@ -463,18 +318,195 @@ namespace
             }
          });
       }
+   }
+
+   uint32_t getPipelineState(const MeshSection& meshSection, const Material& material)
+   {
+      return (material.isTwoSided() ? 1 : 0) | (meshSection.hasValidTexCoords ? 2 : 0);
+   }
+
+   // Rasterizes the sections that cover the most of the main view (the screen size of their bounding spheres) into the occlusion buffer, and then removes the main view
+   // from every other section that is entirely hidden behind them. Only opaque sections with few enough triangles to keep a copy of on the CPU can be occluders.
+   void cullOccludedSections(const ResourceManager& resourceManager, const SceneCulling& sceneCulling, const View& mainView, OcclusionBuffer& occlusionBuffer, FrameVector<SceneCulling::VisibleSection>& visibleSections, OcclusionStats& stats)
+   {
+      PROFILE_SCOPE("cullOccludedSections");
+
+      static const std::size_t kMaxOccluders = 32;
+      static const float kMinOccluderScreenSize = 0.05f;
+      static const std::size_t kBatchSize = 256;
+
+      std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+      const BoundingVolumeHierarchy& hierarchy = sceneCulling.getHierarchy();
+      const glm::mat4& worldToClip = mainView.getMatrices().worldToClip;
+      const glm::vec3& viewPosition = mainView.getMatrices().viewPosition;
+
+      struct OccluderCandidate
+      {
+         float screenSize = 0.0f;
+         uint32_t visibleSection = 0;
+      };
+
+      FrameVector<OccluderCandidate> candidates;
+      for (uint32_t i = 0; i < visibleSections.size(); ++i)
+      {
+         const SceneCulling::VisibleSection& visibleSection = visibleSections[i];
+         if ((visibleSection.views & FrustumBatch::bit(0)) == 0)
+         {
+            continue;
+         }
+
+         const SceneCulling::MeshEntry& entry = sceneCulling.getEntry(visibleSection.entry);
+         const MeshSection& meshSection = entry.mesh->getSection(visibleSection.section);
+         const Material* material = resourceManager.getMaterial(meshSection.materialHandle);
+         if (meshSection.occluderTriangles.empty() || !material || material->getBlendMode() != BlendMode::Opaque)
+         {
+            continue;
+         }
+
+         const Bounds& bounds = hierarchy.getLeafBounds(entry.leaves[visibleSection.section]);
+         float screenSize = bounds.getRadius() / std::max(glm::distance(bounds.getCenter(), viewPosition), MathUtils::kKindaSmallNumber);
+         if (screenSize >= kMinOccluderScreenSize)
+         {
+            candidates.push_back(OccluderCandidate{ screenSize, i });
+         }
+      }
+
+      std::size_t numOccluders = std::min(candidates.size(), kMaxOccluders);
+      std::partial_sort(candidates.begin(), candidates.begin() + numOccluders, candidates.end(), [](const OccluderCandidate& first, const OccluderCandidate& second)
+      {
+         return first.screenSize > second.screenSize;
+      });
+
+      // Occluders aren't tested against themselves (or each other), since their own depth is never quite in front of their bounds
+      FrameVector<uint8_t> isOccluder(visibleSections.size());
+      occlusionBuffer.clear();
+      for (std::size_t i = 0; i < numOccluders; ++i)
+      {
+         const SceneCulling::VisibleSection& visibleSection = visibleSections[candidates[i].visibleSection];
+         const SceneCulling::MeshEntry& entry = sceneCulling.getEntry(visibleSection.entry);
+         const MeshSection& meshSection = entry.mesh->getSection(visibleSection.section);
+
+         occlusionBuffer.rasterize(meshSection.occluderTriangles, worldToClip * entry.transformComponent->getAbsoluteMatrix());
+         isOccluder[candidates[i].visibleSection] = 1;
+
+         stats.occluderTriangles += static_cast<uint32_t>(meshSection.occluderTriangles.size() / 3);
+      }
+      occlusionBuffer.updateTiles();
+
+      std::atomic<uint32_t> numTested = 0;
+      std::atomic<uint32_t> numOccluded = 0;
+      if (numOccluders > 0)
+      {
+         JobSystem::parallelFor(visibleSections.size(), kBatchSize, [&sceneCulling, &hierarchy, &worldToClip, &occlusionBuffer, &visibleSections, &isOccluder, &numTested, &numOccluded](std::size_t begin, std::size_t end)
+         {
+            uint32_t batchTested = 0;
+            uint32_t batchOccluded = 0;
+            for (std::size_t i = begin; i < end; ++i)
+            {
+               SceneCulling::VisibleSection& visibleSection = visibleSections[i];
+               if ((visibleSection.views & FrustumBatch::bit(0)) == 0 || isOccluder[i])
+               {
+                  continue;
+               }
+
+               const Bounds& bounds = hierarchy.getLeafBounds(sceneCulling.getEntry(visibleSection.entry).leaves[visibleSection.section]);
+               ++batchTested;
+               if (occlusionBuffer.isOccluded(bounds.getMin(), bounds.getMax(), worldToClip))
+               {
+                  visibleSection.views &= ~FrustumBatch::bit(0);
+                  ++batchOccluded;
+               }
+            }
+
+            numTested += batchTested;
+            numOccluded += batchOccluded;
+         });
+      }
+
+      stats.occluders = static_cast<uint32_t>(numOccluders);
+      stats.testedSections = numTested;
+      stats.occludedSections = numOccluded;
+      stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+   }
+
+   // Extracts the meshes for all views with a single query of the scene's bounding volume hierarchy, so the cost scales with the number of visible sections rather than
+   // all meshes * views. Views map to the frustums in the batch (the first view is the main view, the rest are shadow views).
+   // The main view's sections are also tested against the occlusion buffer, if there is one.
+   void computeMeshRenderInfo(const ResourceManager& resourceManager, const SceneCulling& sceneCulling, const FrustumBatch& frustumBatch, std::span<SceneRenderInfo* const> sceneRenderInfos, OcclusionBuffer* occlusionBuffer, OcclusionStats& occlusionStats, const SceneExtraction::SortSettings& sortSettings)
+   {
+      PROFILE_SCOPE("computeMeshRenderInfo");
+
+      ASSERT(sceneRenderInfos.size() == frustumBatch.getNumFrustums());
+      glm::vec3 mainViewPosition = sceneRenderInfos[0]->view.getMatrices().viewPosition;
+
+      FrameVector<SceneCulling::VisibleSection> visibleSections;
+      sceneCulling.query(frustumBatch, visibleSections);
+
+      if (occlusionBuffer)
+      {
+         cullOccludedSections(resourceManager, sceneCulling, sceneRenderInfos[0]->view, *occlusionBuffer, visibleSections, occlusionStats);
+      }
+
+      FrameVector<DrawList*> drawLists;
+      drawLists.reserve(sceneRenderInfos.size());
+      for (SceneRenderInfo* sceneRenderInfo : sceneRenderInfos)
+      {
+         drawLists.push_back(sceneRenderInfo);
+      }
+
+      SceneExtraction::extractDraws(sceneCulling, visibleSections, mainViewPosition, [&resourceManager](const SceneCulling::MeshEntry& entry, uint32_t section, SceneExtraction::SectionDraw& sectionDraw)
+      {
+         ASSERT(entry.mesh);
+         const MeshSection& meshSection = entry.mesh->getSection(section);
+
+         const Material* material = resourceManager.getMaterial(meshSection.materialHandle);
+         if (!material)
+         {
+            return false;
+         }
+
+         sectionDraw.material = material;
+         sectionDraw.blendMode = material->getBlendMode();
+         sectionDraw.pipelineState = getPipelineState(meshSection, *material);
+         sectionDraw.materialIndex = meshSection.materialHandle.getHandle().getIndex();
+
+         return true;
+      }, drawLists, sortSettings);
+   }
+
+   // Textures that are still waiting to be finalized skip ahead of the rest when a draw in the main view uses them
+   void markVisibleTextures(ResourceManager& resourceManager, const SceneRenderInfo& sceneRenderInfo)
+   {
+      if (!resourceManager.hasQueuedTextures())
+      {
+         return;
+      }
 
-      return sceneRenderInfo;
+      PROFILE_SCOPE("markVisibleTextures");
+
+      // Draws are mostly grouped by material after sorting, so this skips most repeats
+      const Material* previousMaterial = nullptr;
+      for (const DrawInfo& draw : sceneRenderInfo.draws)
+      {
+         if (draw.material != previousMaterial)
+         {
+            previousMaterial = draw.material;
+            resourceManager.markMaterialVisible(sceneRenderInfo.meshes[draw.meshIndex].mesh->getSection(draw.section).materialHandle);
+         }
+      }
    }
 
    DynamicDescriptorPool::Sizes getDynamicDescriptorPoolSizes()
    {
       DynamicDescriptorPool::Sizes sizes;
 
-      sizes.maxSets = 50;
+      sizes.maxSets = 70;
 
       sizes.uniformBufferCount = 30;
-      sizes.combinedImageSamplerCount = 10;
+      sizes.storageBufferCount = 30;
+      sizes.combinedImageSamplerCount = 30;
+      sizes.storageImageCount = 20;
 
       return sizes;
    }
@@ -519,7 +551,22 @@ Renderer::Renderer(const GraphicsContext& graphicsContext, ResourceManager& reso
       NAME_POINTER(device, forwardLighting, "Forward Lighting");
    }
 
+   sceneCulling = std::make_unique<SceneCulling>();
+   occlusionBuffer = std::make_unique<OcclusionBuffer>(kOcclusionBufferWidth, kOcclusionBufferHeight);
+
+   instanceBuffer = std::make_unique<InstanceBuffer>(context);
+   NAME_POINTER(device, instanceBuffer, "Instance Buffer");
+
+   secondaryCommandPool = std::make_unique<SecondaryCommandPool>(context);
+   NAME_POINTER(device, secondaryCommandPool, "Secondary Command Pool");
+
    {
+      // Everything else that uses the culling pass checks whether it exists, so that it is still compiled (and type checked) in builds without GPU culling
+#if FORGE_WITH_GPU_CULLING
+      cullingPass = std::make_unique<CullingPass>(context, dynamicDescriptorPool, resourceManager);
+      NAME_POINTER(device, cullingPass, "Culling Pass");
+#endif // FORGE_WITH_GPU_CULLING
+
       normalPass = std::make_unique<NormalPass>(context, resourceManager);
       NAME_POINTER(device, normalPass, "Normal Pass");
 
@@ -550,6 +597,7 @@ Renderer::Renderer(const GraphicsContext& graphicsContext, ResourceManager& reso
 
 Renderer::~Renderer()
 {
+   cullingPass = nullptr;
    normalPass = nullptr;
    ssaoPass = nullptr;
    shadowPass = nullptr;
@@ -559,6 +607,9 @@ Renderer::~Renderer()
    compositePass = nullptr;
    tonemapPass = nullptr;
 
+   secondaryCommandPool = nullptr;
+   instanceBuffer = nullptr;
+
    depthTexture = nullptr;
    normalTexture = nullptr;
    ssaoTexture = nullptr;
@@ -587,9 +638,22 @@ Renderer::~Renderer()
 
 void Renderer::render(vk::CommandBuffer commandBuffer, const Scene& scene)
 {
+   PROFILE_SCOPE("Renderer::render");
    SCOPED_LABEL("Scene");
 
-   FrameAllocatorBase::reset();
+   static_assert(FrameAllocatorMemory::kNumRegions >= GraphicsContext::kMaxFramesInFlight, "Frame allocations must not be recycled while the GPU might still be using them");
+   FrameAllocatorBase::beginFrame();
+
+   secondaryCommandPool->beginFrame();
+
+   SecondaryCommandPool* scenePassCommandPool = renderSettings.parallelCommandRecording ? secondaryCommandPool.get() : nullptr;
+   normalPass->setSecondaryCommandPool(scenePassCommandPool);
+   shadowPass->setSecondaryCommandPool(scenePassCommandPool);
+   forwardPass->setSecondaryCommandPool(scenePassCommandPool);
+
+   normalPass->resetDrawStats();
+   shadowPass->resetDrawStats();
+   forwardPass->resetDrawStats();
 
    Texture* defaultBlackTexture = resourceManager.getDefaultTexture(DefaultTextureType::Black);
    Texture* defaultWhiteTexture = resourceManager.getDefaultTexture(DefaultTextureType::White);
@@ -599,7 +663,59 @@ void Renderer::render(vk::CommandBuffer commandBuffer, const Scene& scene)
    ViewInfo activeCameraViewInfo = computeActiveCameraViewInfo(context, scene);
    view->update(activeCameraViewInfo);
 
-   SceneRenderInfo sceneRenderInfo = computeSceneRenderInfo(resourceManager, scene, *view, false);
+   SceneRenderInfo sceneRenderInfo(*view);
+   computeLightRenderInfo(scene, sceneRenderInfo);
+
+   FrustumBatch frustumBatch;
+   frustumBatch.addFrustum(Frustum(view->getMatrices().worldToClip));
+
+   FrameVector<SceneRenderInfo> shadowSceneRenderInfo;
+   updateShadowViews(commandBuffer, sceneRenderInfo, shadowSceneRenderInfo, frustumBatch);
+
+   {
+      FrameVector<SceneRenderInfo*> allSceneRenderInfo;
+      allSceneRenderInfo.reserve(shadowSceneRenderInfo.size() + 1);
+
+      allSceneRenderInfo.push_back(&sceneRenderInfo);
+      for (SceneRenderInfo& info : shadowSceneRenderInfo)
+      {
+         allSceneRenderInfo.push_back(&info);
+      }
+
+      sceneCulling->update<MeshComponent>(scene, [&resourceManager](const MeshComponent& meshComponent)
+      {
+         SceneCulling::MeshSource meshSource;
+         meshSource.meshId = meshComponent.meshHandle.getHandle().getIndex();
+         meshSource.castsShadows = meshComponent.castsShadows;
+
+         if (const Mesh* mesh = resourceManager.getMesh(meshComponent.meshHandle))
+         {
+            meshSource.mesh = mesh;
+            meshSource.meshGeneration = mesh->getUniqueId();
+            meshSource.sectionBounds = mesh->getSectionBounds();
+         }
+
+         return meshSource;
+      });
+      drawStats.occlusion = OcclusionStats();
+      SceneExtraction::SortSettings sortSettings;
+      sortSettings.automaticInstancing = renderSettings.automaticInstancing;
+      sortSettings.groupByState = renderSettings.sortDrawsByState;
+      computeMeshRenderInfo(resourceManager, *sceneCulling, frustumBatch, allSceneRenderInfo, renderSettings.softwareOcclusionCulling ? occlusionBuffer.get() : nullptr, drawStats.occlusion, sortSettings);
+      markVisibleTextures(resourceManager, sceneRenderInfo);
+      updateDrawData(allSceneRenderInfo);
+
+      // Culling on the GPU relies on the draw commands written for indirect draws
+      if (cullingPass && renderSettings.gpuCulling && sceneRenderInfo.drawCommandBuffer && context.supportsDrawIndirectCount() && context.getPhysicalDeviceFeatures().multiDrawIndirect)
+      {
+         updateGPUCulling(sceneRenderInfo);
+      }
+   }
+
+   if (cullingPass)
+   {
+      cullingPass->cull(commandBuffer, sceneRenderInfo, *instanceBuffer);
+   }
 
    normalPass->render(commandBuffer, sceneRenderInfo, *depthTexture, *normalTexture);
 
@@ -609,7 +725,7 @@ void Renderer::render(vk::CommandBuffer commandBuffer, const Scene& scene)
       ssaoPass->render(commandBuffer, sceneRenderInfo, *depthTexture, *normalTexture, *ssaoTexture, *ssaoBlurTexture, renderSettings.ssaoQuality);
    }
 
-   renderShadowMaps(commandBuffer, scene, sceneRenderInfo);
+   renderShadowMaps(commandBuffer, sceneRenderInfo, shadowSceneRenderInfo);
 
    INLINE_LABEL("Update lighting");
    forwardLighting->update(sceneRenderInfo);
@@ -618,10 +734,20 @@ void Renderer::render(vk::CommandBuffer commandBuffer, const Scene& scene)
    scene.forEach<SkyboxComponent>([this, &skyboxTexture](const SkyboxComponent& skyboxComponent)
    {
       skyboxTexture = resourceManager.getTexture(skyboxComponent.textureHandle);
+      resourceManager.markTextureVisible(skyboxComponent.textureHandle);
    });
 
    forwardPass->render(commandBuffer, sceneRenderInfo, *depthTexture, *hdrColorTexture, hdrResolveTexture.get(), *roughnessMetalnessTexture, *normalTexture, ssaoEnabled ? *ssaoTexture : *defaultWhiteTexture, skyboxTexture);
 
+   if (sceneRenderInfo.numGPUCulledDraws > 0)
+   {
+      cullingPass->buildHiZ(commandBuffer, *depthTexture, view->getMatrices().worldToClip);
+   }
+
+   drawStats.normal = normalPass->getDrawStats();
+   drawStats.shadow = shadowPass->getDrawStats();
+   drawStats.forward = forwardPass->getDrawStats();
+
    bool bloomEnabled = renderSettings.bloomQuality != RenderQuality::Disabled;
    if (bloomEnabled)
    {
@@ -668,6 +794,10 @@ void Renderer::onSwapchainRecreated()
    NAME_POINTER(device, roughnessMetalnessTexture, "Roughness Metalness Texture");
    NAME_POINTER(device, uiColorTexture, "UI Color Texture");
 
+   if (cullingPass)
+   {
+      cullingPass->recreateTextures(depthTexture->getExtent(), depthTexture->getTextureProperties().sampleCount);
+   }
    bloomPass->recreateTextures(hdrColorTexture->getImageProperties().format, hdrColorTexture->getTextureProperties().sampleCount);
    uiPass->onOutputTextureCreated(*uiColorTexture);
 }
@@ -683,12 +813,226 @@ void Renderer::updateRenderSettings(const RenderSettings& settings)
    }
 }
 
-void Renderer::renderShadowMaps(vk::CommandBuffer commandBuffer, const Scene& scene, const SceneRenderInfo& sceneRenderInfo)
+void Renderer::updateDrawData(std::span<SceneRenderInfo* const> sceneRenderInfos)
+{
+   PROFILE_SCOPE("Renderer::updateDrawData");
+
+   static const std::size_t kBatchSize = 1024;
+
+   // Indirect draws can only start past the first instance if the device supports it
+   bool indirectDraws = renderSettings.indirectDraws && context.getPhysicalDeviceFeatures().drawIndirectFirstInstance;
+
+   // The instances and draw commands of all views share one buffer each
+   uint32_t numInstances = 0;
+   uint32_t numDrawCommands = 0;
+   for (SceneRenderInfo* sceneRenderInfo : sceneRenderInfos)
+   {
+      sceneRenderInfo->instanceOffset = numInstances;
+      numInstances += static_cast<uint32_t>(sceneRenderInfo->instances.size());
+
+      if (indirectDraws)
+      {
+         sceneRenderInfo->drawCommandOffset = numDrawCommands;
+         numDrawCommands += static_cast<uint32_t>(sceneRenderInfo->draws.size());
+      }
+   }
+
+   std::span<MeshUniformData> instanceData = instanceBuffer->map(numInstances);
+   for (const SceneRenderInfo* sceneRenderInfo : sceneRenderInfos)
+   {
+      std::span<MeshUniformData> viewInstanceData = instanceData.subspan(sceneRenderInfo->instanceOffset, sceneRenderInfo->instances.size());
+
+      JobSystem::parallelFor(viewInstanceData.size(), kBatchSize, [sceneRenderInfo, viewInstanceData](std::size_t begin, std::size_t end)
+      {
+         for (std::size_t i = begin; i < end; ++i)
+         {
+            viewInstanceData[i].localToWorld = sceneRenderInfo->meshes[sceneRenderInfo->instances[i]].localToWorld;
+         }
+      });
+   }
+
+   if (indirectDraws)
+   {
+      std::span<vk::DrawIndexedIndirectCommand> drawCommands = instanceBuffer->mapDrawCommands(numDrawCommands);
+      for (SceneRenderInfo* sceneRenderInfo : sceneRenderInfos)
+      {
+         std::span<vk::DrawIndexedIndirectCommand> viewDrawCommands = drawCommands.subspan(sceneRenderInfo->drawCommandOffset, sceneRenderInfo->draws.size());
+
+         JobSystem::parallelFor(viewDrawCommands.size(), kBatchSize, [sceneRenderInfo, viewDrawCommands](std::size_t begin, std::size_t end)
+         {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+               const DrawInfo& draw = sceneRenderInfo->draws[i];
+               const Mesh& mesh = *sceneRenderInfo->meshes[draw.meshIndex].mesh;
+               viewDrawCommands[i] = mesh.getDrawCommand(draw.section, draw.numInstances, sceneRenderInfo->instanceOffset + draw.firstInstance);
+            }
+         });
+
+         sceneRenderInfo->drawCommandBuffer = instanceBuffer->getDrawCommandBuffer();
+      }
+   }
+
+   // The buffer can be different every frame (each frame in flight has its own, and they can grow), so every view is pointed at it
+   vk::DescriptorBufferInfo instanceBufferInfo = instanceBuffer->getDescriptorBufferInfo();
+   view->updateInstanceDescriptorSet(instanceBufferInfo);
+   for (std::unique_ptr<View>& pointShadowView : pointShadowViews)
+   {
+      pointShadowView->updateInstanceDescriptorSet(instanceBufferInfo);
+   }
+   for (std::unique_ptr<View>& spotShadowView : spotShadowViews)
+   {
+      spotShadowView->updateInstanceDescriptorSet(instanceBufferInfo);
+   }
+   for (std::unique_ptr<View>& directionalShadowView : directionalShadowViews)
+   {
+      directionalShadowView->updateInstanceDescriptorSet(instanceBufferInfo);
+   }
+}
+
+// Splits the opaque and masked draws into batches that can each be submitted with one indirect draw, and writes the data that the cull shader needs for them
+void Renderer::updateGPUCulling(SceneRenderInfo& sceneRenderInfo)
 {
+   PROFILE_SCOPE("Renderer::updateGPUCulling");
+
+   static const std::size_t kJobBatchSize = 256;
+
+   // Draws are sorted by key, which starts with the blend mode
+   auto culledDrawsEnd = std::partition_point(sceneRenderInfo.draws.begin(), sceneRenderInfo.draws.end(), [](const DrawInfo& draw) { return DrawSortKey::getBlendMode(draw.sortKey) != BlendMode::Translucent; });
+   uint32_t numCulledDraws = static_cast<uint32_t>(culledDrawsEnd - sceneRenderInfo.draws.begin());
+   if (numCulledDraws == 0)
+   {
+      return;
+   }
+
+   // The upper half of opaque and masked keys holds the blend mode, pipeline state and material (the material is also compared directly, since its ID can be truncated)
+   uint32_t maxDrawsPerBatch = context.getPhysicalDeviceProperties().limits.maxDrawIndirectCount;
+   sceneRenderInfo.drawBatches.reserve(numCulledDraws);
+   for (uint32_t i = 0; i < numCulledDraws; ++i)
+   {
+      const DrawInfo& draw = sceneRenderInfo.draws[i];
+
+      bool startBatch = i == 0;
+      if (!startBatch)
+      {
+         const DrawInfo& previousDraw = sceneRenderInfo.draws[i - 1];
+         startBatch = (draw.sortKey >> 32) != (previousDraw.sortKey >> 32) || draw.material != previousDraw.material
+            || sceneRenderInfo.meshes[draw.meshIndex].mesh->getArenaBlock() != sceneRenderInfo.meshes[previousDraw.meshIndex].mesh->getArenaBlock()
+            || sceneRenderInfo.cullBatches.back().numDraws == maxDrawsPerBatch;
+      }
+
+      if (startBatch)
+      {
+         sceneRenderInfo.cullBatches.push_back(CullBatch{ i, 0 });
+      }
+
+      ++sceneRenderInfo.cullBatches.back().numDraws;
+      sceneRenderInfo.drawBatches.push_back(static_cast<uint32_t>(sceneRenderInfo.cullBatches.size() - 1));
+   }
+
+   std::span<glm::uvec2> cullDraws = cullingPass->mapDraws(numCulledDraws, static_cast<uint32_t>(sceneRenderInfo.cullBatches.size()));
+   std::span<InstanceBoundsData> bounds = instanceBuffer->mapBounds(sceneRenderInfo.instanceOffset + static_cast<uint32_t>(sceneRenderInfo.instances.size()));
+
+   JobSystem::parallelFor(numCulledDraws, kJobBatchSize, [&sceneRenderInfo, cullDraws, bounds](std::size_t begin, std::size_t end)
+   {
+      for (std::size_t i = begin; i < end; ++i)
+      {
+         const DrawInfo& draw = sceneRenderInfo.draws[i];
+
+         uint32_t batchIndex = sceneRenderInfo.drawBatches[i];
+         cullDraws[i] = glm::uvec2(batchIndex, sceneRenderInfo.cullBatches[batchIndex].firstDraw);
+
+         // The same world space bounds that scene culling uses
+         for (uint32_t instance = draw.firstInstance; instance < draw.firstInstance + draw.numInstances; ++instance)
+         {
+            const MeshRenderInfo& meshRenderInfo = sceneRenderInfo.meshes[sceneRenderInfo.instances[instance]];
+            const Bounds& sectionBounds = meshRenderInfo.mesh->getSectionBounds()[draw.section];
+            Bounds instanceBounds = meshRenderInfo.transform.transformBounds(sectionBounds);
+
+            InstanceBoundsData& instanceBoundsData = bounds[sceneRenderInfo.instanceOffset + instance];
+            instanceBoundsData.centerRadius = glm::vec4(instanceBounds.getCenter(), instanceBounds.getRadius());
+            instanceBoundsData.extent = glm::vec4(instanceBounds.getExtent(), 0.0f);
+         }
+      }
+   });
+
+   sceneRenderInfo.culledDrawCommandBuffer = cullingPass->getCulledDrawCommandBuffer();
+   sceneRenderInfo.drawCountBuffer = cullingPass->getDrawCountBuffer();
+   sceneRenderInfo.numGPUCulledDraws = numCulledDraws;
+}
+
+// Adds the frustum of each shadow view to the batch, in the same order as the shadow scene render info
+void Renderer::updateShadowViews(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, FrameVector<SceneRenderInfo>& shadowSceneRenderInfo, FrustumBatch& frustumBatch)
+{
+   PROFILE_SCOPE("Renderer::updateShadowViews");
+
+   // At most one shadow view per shadow map
+   shadowSceneRenderInfo.reserve(pointShadowViews.size() + spotShadowViews.size() + directionalShadowViews.size());
+
+   for (const PointLightRenderInfo& pointLightInfo : sceneRenderInfo.pointLights)
+   {
+      if (pointLightInfo.shadowViewInfo.has_value() && pointLightInfo.shadowMapIndex.has_value() && pointLightInfo.shadowMapIndex.value() < ForwardLighting::kMaxPointShadowMaps)
+      {
+         ViewInfo pointLightViewInfo = pointLightInfo.shadowViewInfo.value();
+         uint32_t shadowMapIndex = pointLightInfo.shadowMapIndex.value();
+
+         // Nothing outside of the light's radius can cast a shadow that matters, so all six faces can share one sphere test
+         uint32_t groupIndex = frustumBatch.addGroup(pointLightViewInfo.transform.position, pointLightViewInfo.perspectiveInfo.farPlane);
+
+         for (uint32_t faceIndex = 0; faceIndex < kNumCubeFaces; ++faceIndex)
+         {
+            pointLightViewInfo.cubeFace = static_cast<CubeFace>(faceIndex);
+
+            uint32_t viewIndex = ForwardLighting::getPointViewIndex(shadowMapIndex, faceIndex);
+            INLINE_LABEL("Update point shadow view " + DebugUtils::toString(viewIndex));
+            pointShadowViews[viewIndex]->update(pointLightViewInfo);
+            shadowSceneRenderInfo.emplace_back(*pointShadowViews[viewIndex]);
+            frustumBatch.addFrustum(Frustum(pointShadowViews[viewIndex]->getMatrices().worldToClip), groupIndex);
+         }
+      }
+   }
+
+   for (const SpotLightRenderInfo& spotLightInfo : sceneRenderInfo.spotLights)
+   {
+      if (spotLightInfo.shadowViewInfo.has_value() && spotLightInfo.shadowMapIndex.has_value() && spotLightInfo.shadowMapIndex.value() < ForwardLighting::kMaxSpotShadowMaps)
+      {
+         uint32_t shadowMapIndex = spotLightInfo.shadowMapIndex.value();
+
+         INLINE_LABEL("Update spot shadow view " + DebugUtils::toString(shadowMapIndex));
+         spotShadowViews[shadowMapIndex]->update(spotLightInfo.shadowViewInfo.value());
+         shadowSceneRenderInfo.emplace_back(*spotShadowViews[shadowMapIndex]);
+         frustumBatch.addFrustum(Frustum(spotShadowViews[shadowMapIndex]->getMatrices().worldToClip));
+      }
+   }
+
+   for (const DirectionalLightRenderInfo& directionalLightInfo : sceneRenderInfo.directionalLights)
+   {
+      if (directionalLightInfo.shadowViewInfo.has_value() && directionalLightInfo.shadowMapIndex.has_value() && directionalLightInfo.shadowMapIndex.value() < ForwardLighting::kMaxDirectionalShadowMaps)
+      {
+         uint32_t shadowMapIndex = directionalLightInfo.shadowMapIndex.value();
+
+         INLINE_LABEL("Update directional shadow view " + DebugUtils::toString(shadowMapIndex));
+         directionalShadowViews[shadowMapIndex]->update(directionalLightInfo.shadowViewInfo.value());
+         shadowSceneRenderInfo.emplace_back(*directionalShadowViews[shadowMapIndex]);
+         frustumBatch.addFrustum(Frustum(directionalShadowViews[shadowMapIndex]->getMatrices().worldToClip));
+      }
+   }
+}
+
+// Walks the lights in the same order as updateShadowViews(), so the shadow scene render info lines up with the shadow maps
+void Renderer::renderShadowMaps(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, std::span<const SceneRenderInfo> shadowSceneRenderInfo)
+{
+   PROFILE_SCOPE("Renderer::renderShadowMaps");
    SCOPED_LABEL("Shadow maps");
 
    forwardLighting->transitionShadowMapLayout(commandBuffer, false);
 
+   std::size_t shadowViewIndex = 0;
+   auto nextShadowSceneRenderInfo = [&shadowSceneRenderInfo, &shadowViewIndex](const View& shadowView) -> const SceneRenderInfo&
+   {
+      ASSERT(shadowViewIndex < shadowSceneRenderInfo.size() && &shadowSceneRenderInfo[shadowViewIndex].view == &shadowView);
+      return shadowSceneRenderInfo[shadowViewIndex++];
+   };
+
    if (!sceneRenderInfo.pointLights.empty())
    {
       SCOPED_LABEL("Point lights");
@@ -697,21 +1041,14 @@ void Renderer::renderShadowMaps(vk::CommandBuffer commandBuffer, const Scene& sc
       {
          if (pointLightInfo.shadowViewInfo.has_value() && pointLightInfo.shadowMapIndex.has_value() && pointLightInfo.shadowMapIndex.value() < ForwardLighting::kMaxPointShadowMaps)
          {
-            ViewInfo pointLightViewInfo = pointLightInfo.shadowViewInfo.value();
             uint32_t shadowMapIndex = pointLightInfo.shadowMapIndex.value();
 
             for (uint32_t faceIndex = 0; faceIndex < kNumCubeFaces; ++faceIndex)
             {
-               CubeFace cubeFace = static_cast<CubeFace>(faceIndex);
-               pointLightViewInfo.cubeFace = cubeFace;
-
                uint32_t viewIndex = ForwardLighting::getPointViewIndex(shadowMapIndex, faceIndex);
-               INLINE_LABEL("Update point shadow view " + DebugUtils::toString(viewIndex));
-               std::unique_ptr<View>& pointShadowView = pointShadowViews[viewIndex];
-               pointShadowView->update(pointLightViewInfo);
-               SceneRenderInfo shadowSceneRenderInfo = computeSceneRenderInfo(resourceManager, scene, *pointShadowView, true);
+               const SceneRenderInfo& shadowInfo = nextShadowSceneRenderInfo(*pointShadowViews[viewIndex]);
 
-               shadowPass->render(commandBuffer, shadowSceneRenderInfo, forwardLighting->getPointShadowTextureArray(), forwardLighting->getPointShadowView(shadowMapIndex, faceIndex));
+               shadowPass->render(commandBuffer, shadowInfo, forwardLighting->getPointShadowTextureArray(), forwardLighting->getPointShadowView(shadowMapIndex, faceIndex));
             }
          }
       }
@@ -726,13 +1063,9 @@ void Renderer::renderShadowMaps(vk::CommandBuffer commandBuffer, const Scene& sc
          if (spotLightInfo.shadowViewInfo.has_value() && spotLightInfo.shadowMapIndex.has_value() && spotLightInfo.shadowMapIndex.value() < ForwardLighting::kMaxSpotShadowMaps)
          {
             uint32_t shadowMapIndex = spotLightInfo.shadowMapIndex.value();
+            const SceneRenderInfo& shadowInfo = nextShadowSceneRenderInfo(*spotShadowViews[shadowMapIndex]);
 
-            INLINE_LABEL("Update spot shadow view " + DebugUtils::toString(shadowMapIndex));
-            std::unique_ptr<View>& spotShadowView = spotShadowViews[shadowMapIndex];
-            spotShadowView->update(spotLightInfo.shadowViewInfo.value());
-            SceneRenderInfo shadowSceneRenderInfo = computeSceneRenderInfo(resourceManager, scene, *spotShadowView, true);
-
-            shadowPass->render(commandBuffer, shadowSceneRenderInfo, forwardLighting->getSpotShadowTextureArray(), forwardLighting->getSpotShadowView(shadowMapIndex));
+            shadowPass->render(commandBuffer, shadowInfo, forwardLighting->getSpotShadowTextureArray(), forwardLighting->getSpotShadowView(shadowMapIndex));
          }
       }
    }
@@ -746,16 +1079,14 @@ void Renderer::renderShadowMaps(vk::CommandBuffer commandBuffer, const Scene& sc
          if (directionalLightInfo.shadowViewInfo.has_value() && directionalLightInfo.shadowMapIndex.has_value() && directionalLightInfo.shadowMapIndex.value() < ForwardLighting::kMaxDirectionalShadowMaps)
          {
             uint32_t shadowMapIndex = directionalLightInfo.shadowMapIndex.value();
+            const SceneRenderInfo& shadowInfo = nextShadowSceneRenderInfo(*directionalShadowViews[shadowMapIndex]);
 
-            INLINE_LABEL("Update directional shadow view " + DebugUtils::toString(shadowMapIndex));
-            std::unique_ptr<View>& directionalShadowView = directionalShadowViews[shadowMapIndex];
-            directionalShadowView->update(directionalLightInfo.shadowViewInfo.value());
-            SceneRenderInfo shadowSceneRenderInfo = computeSceneRenderInfo(resourceManager, scene, *directionalShadowView, true);
-
-            shadowPass->render(commandBuffer, shadowSceneRenderInfo, forwardLighting->getDirectionalShadowTextureArray(), forwardLighting->getDirectionalShadowView(shadowMapIndex));
+            shadowPass->render(commandBuffer, shadowInfo, forwardLighting->getDirectionalShadowTextureArray(), forwardLighting->getDirectionalShadowView(shadowMapIndex));
          }
       }
    }
 
+   ASSERT(shadowViewIndex == shadowSceneRenderInfo.size());
+
    forwardLighting->transitionShadowMapLayout(commandBuffer, true);
 }
@@ -1,26 +1,36 @@
 #pragma once
 
+#include "Core/Containers/FrameVector.h"
+
 #include "Graphics/DynamicDescriptorPool.h"
 #include "Graphics/GraphicsResource.h"
 #include "Graphics/RenderPass.h"
 #include "Graphics/UniformBuffer.h"
 
+#include "Renderer/DrawStats.h"
 #include "Renderer/ForwardLighting.h"
 #include "Renderer/RenderSettings.h"
 #include "Renderer/UniformData.h"
 #include "Renderer/ViewInfo.h"
 
 #include <memory>
+#include <span>
 #include <vector>
 
 class BloomPass;
 class CompositePass;
+class CullingPass;
 class DepthPass;
 class ForwardLighting;
 class ForwardPass;
+class FrustumBatch;
+class InstanceBuffer;
 class NormalPass;
+class OcclusionBuffer;
 class ResourceManager;
 class Scene;
+class SceneCulling;
+class SecondaryCommandPool;
 class SimpleRenderPass;
 class SSAOPass;
 class Swapchain;
@@ -41,12 +51,21 @@ public:
    void onSwapchainRecreated();
    void updateRenderSettings(const RenderSettings& settings);
 
+   const DrawStats& getDrawStats() const
+   {
+      return drawStats;
+   }
+
 private:
-   void renderShadowMaps(vk::CommandBuffer commandBuffer, const Scene& scene, const SceneRenderInfo& sceneRenderInfo);
+   void updateDrawData(std::span<SceneRenderInfo* const> sceneRenderInfos);
+   void updateGPUCulling(SceneRenderInfo& sceneRenderInfo);
+   void updateShadowViews(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, FrameVector<SceneRenderInfo>& shadowSceneRenderInfo, FrustumBatch& frustumBatch);
+   void renderShadowMaps(vk::CommandBuffer commandBuffer, const SceneRenderInfo& sceneRenderInfo, std::span<const SceneRenderInfo> shadowSceneRenderInfo);
 
    ResourceManager& resourceManager;
 
    RenderSettings renderSettings;
+   DrawStats drawStats;
 
    vk::Format depthStencilFormat = vk::Format::eUndefined;
 
@@ -58,6 +77,11 @@ private:
    std::array<std::unique_ptr<View>, ForwardLighting::kMaxDirectionalShadowMaps> directionalShadowViews;
    std::unique_ptr<ForwardLighting> forwardLighting;
 
+   std::unique_ptr<SceneCulling> sceneCulling;
+   std::unique_ptr<OcclusionBuffer> occlusionBuffer;
+   std::unique_ptr<SecondaryCommandPool> secondaryCommandPool;
+   std::unique_ptr<InstanceBuffer> instanceBuffer;
+
    std::unique_ptr<Texture> depthTexture;
    std::unique_ptr<Texture> normalTexture;
    std::unique_ptr<Texture> ssaoTexture;
@@ -67,6 +91,7 @@ private:
    std::unique_ptr<Texture> roughnessMetalnessTexture;
    std::unique_ptr<Texture> uiColorTexture;
 
+   std::unique_ptr<CullingPass> cullingPass; // Only with FORGE_WITH_GPU_CULLING
    std::unique_ptr<NormalPass> normalPass;
    std::unique_ptr<SSAOPass> ssaoPass;
    std::unique_ptr<DepthPass> shadowPass;
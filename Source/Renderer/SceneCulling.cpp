@@ -0,0 +1,132 @@
+#include "Renderer/SceneCulling.h"
+
+#include "Core/Assert.h"
+#include "Core/Profiler.h"
+
+#include <algorithm>
+
+namespace
+{
+   uint64_t packUserData(uint32_t entryIndex, uint32_t section)
+   {
+      return (static_cast<uint64_t>(entryIndex) << 32) | section;
+   }
+}
+
+void SceneCulling::beginUpdate()
+{
+   ++updateIndex;
+}
+
+void SceneCulling::updateEntry(entt::entity entity, const TransformComponent& transformComponent, const MeshSource& meshSource)
+{
+   auto [location, inserted] = entryIndices.try_emplace(entity, 0);
+   if (inserted)
+   {
+      if (freeEntries.empty())
+      {
+         location->second = static_cast<uint32_t>(entries.size());
+         entries.emplace_back();
+      }
+      else
+      {
+         location->second = freeEntries.back();
+         freeEntries.pop_back();
+      }
+   }
+
+   uint32_t entryIndex = location->second;
+   MeshEntry& entry = entries[entryIndex];
+   entry.transformComponent = &transformComponent;
+   entry.mesh = meshSource.mesh;
+   entry.meshId = meshSource.meshId;
+   entry.castsShadows = meshSource.castsShadows;
+   entry.sectionBounds = meshSource.sectionBounds;
+   entry.lastSeenUpdate = updateIndex;
+
+   if (meshSource.meshGeneration != entry.meshGeneration)
+   {
+      // Also covers the mesh finishing loading, being reloaded (even if the new mesh ends up at the same address), or being unloaded
+      removeSections(entry);
+      entry.meshGeneration = meshSource.meshGeneration;
+      entry.transformVersion = transformComponent.getAbsoluteTransformVersion();
+      insertSections(entryIndex);
+   }
+   else if (entry.transformVersion != transformComponent.getAbsoluteTransformVersion())
+   {
+      entry.transformVersion = transformComponent.getAbsoluteTransformVersion();
+      updateSections(entry);
+   }
+}
+
+void SceneCulling::endUpdate()
+{
+   // Anything that wasn't visited no longer has a mesh (or no longer exists)
+   for (auto location = entryIndices.begin(); location != entryIndices.end();)
+   {
+      MeshEntry& entry = entries[location->second];
+      if (entry.lastSeenUpdate == updateIndex)
+      {
+         ++location;
+         continue;
+      }
+
+      removeSections(entry);
+      entry = MeshEntry{};
+
+      freeEntries.push_back(location->second);
+      location = entryIndices.erase(location);
+   }
+
+   hierarchy.maintain();
+}
+
+void SceneCulling::query(const FrustumBatch& frustumBatch, FrameVector<VisibleSection>& visibleSections) const
+{
+   PROFILE_SCOPE("SceneCulling::query");
+
+   hierarchy.query(frustumBatch, frustumBatch.getAllMask(), [&visibleSections](uint64_t userData, FrustumBatch::Mask views)
+   {
+      visibleSections.push_back(VisibleSection{ static_cast<uint32_t>(userData >> 32), static_cast<uint32_t>(userData), views });
+   });
+
+   std::sort(visibleSections.begin(), visibleSections.end(), [](const VisibleSection& first, const VisibleSection& second)
+   {
+      return first.entry != second.entry ? first.entry < second.entry : first.section < second.section;
+   });
+}
+
+void SceneCulling::insertSections(uint32_t entryIndex)
+{
+   MeshEntry& entry = entries[entryIndex];
+   ASSERT(entry.leaves.empty());
+
+   const Transform& transform = entry.transformComponent->getAbsoluteTransform();
+   uint32_t numSections = static_cast<uint32_t>(entry.sectionBounds.size());
+
+   entry.leaves.reserve(numSections);
+   for (uint32_t section = 0; section < numSections; ++section)
+   {
+      entry.leaves.push_back(hierarchy.insert(transform.transformBounds(entry.sectionBounds[section]), packUserData(entryIndex, section)));
+   }
+}
+
+void SceneCulling::updateSections(MeshEntry& entry)
+{
+   ASSERT(entry.leaves.size() == entry.sectionBounds.size());
+
+   const Transform& transform = entry.transformComponent->getAbsoluteTransform();
+   for (uint32_t section = 0; section < entry.leaves.size(); ++section)
+   {
+      hierarchy.update(entry.leaves[section], transform.transformBounds(entry.sectionBounds[section]));
+   }
+}
+
+void SceneCulling::removeSections(MeshEntry& entry)
+{
+   for (BoundingVolumeHierarchy::LeafId leaf : entry.leaves)
+   {
+      hierarchy.remove(leaf);
+   }
+   entry.leaves.clear();
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Core/Containers/FrameVector.h"
+#include "Core/Containers/SmallVector.h"
+#include "Core/Profiler.h"
+
+#include "Math/BoundingVolumeHierarchy.h"
+#include "Math/Bounds.h"
+#include "Math/FrustumBatch.h"
+
+#include "Scene/Components/TransformComponent.h"
+#include "Scene/Scene.h"
+
+#include <entt/entity/entity.hpp>
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+
+// Keeps a bounding volume hierarchy of the world space bounds of every mesh section in the scene, so that views can be culled without testing every section
+// Bounds are only recomputed for meshes whose absolute transform changed, so static scenes cost a version check per mesh to keep in sync
+class SceneCulling
+{
+public:
+   // What the culling needs to know about the mesh of an entity (the mesh itself is only passed through to whoever consumes the entries)
+   struct MeshSource
+   {
+      const Mesh* mesh = nullptr;
+
+      // Unique to each loaded mesh, so that a mesh that is reloaded in place is still noticed. Entities with a generation of zero have no mesh yet.
+      uint64_t meshGeneration = 0;
+
+      // Same for every entity that uses the mesh
+      uint32_t meshId = 0;
+
+      bool castsShadows = true;
+      std::span<const Bounds> sectionBounds;
+   };
+
+   struct MeshEntry
+   {
+      // Refreshed on every update (since components can move in memory when others are added or removed)
+      const TransformComponent* transformComponent = nullptr;
+      const Mesh* mesh = nullptr;
+      uint32_t meshId = 0;
+      bool castsShadows = true;
+      std::span<const Bounds> sectionBounds;
+
+      uint64_t meshGeneration = 0;
+      uint64_t transformVersion = 0;
+      uint32_t lastSeenUpdate = 0;
+      // One per section, read for every visible section during extraction (kept inline, since most meshes only have a few sections)
+      SmallVector<BoundingVolumeHierarchy::LeafId, 4> leaves;
+   };
+
+   struct VisibleSection
+   {
+      uint32_t entry = 0;
+      uint32_t section = 0;
+      FrustumBatch::Mask views = 0;
+   };
+
+   // Adds, moves, and removes sections to match every entity with a transform and a MeshComponentType, with getMeshSource(meshComponent) returning a MeshSource.
+   // Must be called before querying each frame.
+   template<typename MeshComponentType, typename GetMeshSource>
+   void update(const Scene& scene, GetMeshSource&& getMeshSource)
+   {
+      PROFILE_SCOPE("SceneCulling::update");
+
+      beginUpdate();
+
+      scene.forEach<TransformComponent, MeshComponentType>([this, &getMeshSource](entt::entity entity, const TransformComponent& transformComponent, const MeshComponentType& meshComponent)
+      {
+         updateEntry(entity, transformComponent, getMeshSource(meshComponent));
+      });
+
+      endUpdate();
+   }
+
+   // Finds every section that is visible to at least one of the frustums, sorted by entry and then by section
+   void query(const FrustumBatch& frustumBatch, FrameVector<VisibleSection>& visibleSections) const;
+
+   const MeshEntry& getEntry(uint32_t index) const
+   {
+      return entries[index];
+   }
+
+   const BoundingVolumeHierarchy& getHierarchy() const
+   {
+      return hierarchy;
+   }
+
+private:
+   void beginUpdate();
+   void updateEntry(entt::entity entity, const TransformComponent& transformComponent, const MeshSource& meshSource);
+   void endUpdate();
+
+   void insertSections(uint32_t entryIndex);
+   void updateSections(MeshEntry& entry);
+   void removeSections(MeshEntry& entry);
+
+   std::unordered_map<entt::entity, uint32_t> entryIndices;
+   std::vector<MeshEntry> entries;
+   std::vector<uint32_t> freeEntries;
+   uint32_t updateIndex = 0;
+
+   BoundingVolumeHierarchy hierarchy;
+};
@@ -0,0 +1,228 @@
+#include "Renderer/SceneExtraction.h"
+
+#include "Core/Assert.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Core/Profiler.h"
+#include "Core/RadixSort.h"
+
+#include "Math/FrustumBatch.h"
+
+#include "Renderer/DrawSortKey.h"
+
+#include <glm/gtx/norm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <iterator>
+
+namespace
+{
+   // A range of visible sections that all belong to the same mesh
+   struct VisibleMesh
+   {
+      uint32_t entry = 0;
+      std::size_t begin = 0;
+      std::size_t end = 0;
+   };
+
+   // Meshes and draws that one batch of meshes extracted for one view (mesh indices are relative to this batch until they are gathered)
+   struct ViewDraws
+   {
+      FrameVector<MeshRenderInfo> meshes;
+      FrameVector<DrawInfo> draws;
+   };
+
+   void extractMesh(const SceneExtraction::GetSectionDrawFunction& getSectionDraw, const BoundingVolumeHierarchy& hierarchy, const glm::vec3& mainViewPosition, const SceneCulling::MeshEntry& entry, std::span<const SceneCulling::VisibleSection> visibleSections, std::span<ViewDraws> viewDraws)
+   {
+      static const uint32_t kInvalidMeshIndex = ~0u;
+
+      // The first view is the main view, the rest are shadow views
+      FrustumBatch::Mask candidateViews = entry.castsShadows ? ~FrustumBatch::Mask(0) : FrustumBatch::bit(0);
+
+      const Transform& transform = entry.transformComponent->getAbsoluteTransform();
+      const glm::mat4& localToWorld = entry.transformComponent->getAbsoluteMatrix();
+
+      std::array<uint32_t, FrustumBatch::kMaxFrustums> viewMeshIndices;
+      viewMeshIndices.fill(kInvalidMeshIndex);
+
+      for (const SceneCulling::VisibleSection& visibleSection : visibleSections)
+      {
+         uint32_t section = visibleSection.section;
+
+         SceneExtraction::SectionDraw sectionDraw;
+         if (!getSectionDraw(entry, section, sectionDraw))
+         {
+            continue;
+         }
+
+         FrustumBatch::Mask visibleViews = visibleSection.views & candidateViews;
+
+         // Sections of large meshes can be far apart, so each one is sorted by where it is rather than where the mesh's origin is
+         uint32_t mainViewDepth = 0;
+         if (visibleViews & FrustumBatch::bit(0))
+         {
+            const Bounds& sectionBounds = hierarchy.getLeafBounds(entry.leaves[section]);
+            mainViewDepth = DrawSortKey::quantizeDepth(glm::distance2(sectionBounds.getCenter(), mainViewPosition));
+         }
+
+         while (visibleViews != 0)
+         {
+            uint32_t viewIndex = static_cast<uint32_t>(std::countr_zero(visibleViews));
+            visibleViews &= visibleViews - 1;
+
+            ASSERT(viewIndex < viewDraws.size());
+            ViewDraws& draws = viewDraws[viewIndex];
+            uint32_t& meshIndex = viewMeshIndices[viewIndex];
+            if (meshIndex == kInvalidMeshIndex)
+            {
+               meshIndex = static_cast<uint32_t>(draws.meshes.size());
+               draws.meshes.emplace_back(entry.mesh, entry.meshId, transform, localToWorld);
+            }
+
+            uint64_t sortKey = DrawSortKey::create(sectionDraw.blendMode, sectionDraw.pipelineState, sectionDraw.materialIndex, viewIndex == 0 ? mainViewDepth : 0);
+            draws.draws.push_back(DrawInfo{ sortKey, meshIndex, section, sectionDraw.material });
+         }
+      }
+   }
+
+   // Mesh IDs are shared by every entity that uses the same mesh, so this doesn't need to look at the meshes themselves
+   bool canInstance(const DrawList& drawList, const DrawInfo& first, const DrawInfo& second)
+   {
+      return first.section == second.section && first.material == second.material && drawList.meshes[first.meshIndex].meshId == drawList.meshes[second.meshIndex].meshId;
+   }
+}
+
+namespace SceneExtraction
+{
+   void extractDraws(const SceneCulling& sceneCulling, std::span<const SceneCulling::VisibleSection> visibleSections, const glm::vec3& mainViewPosition, const GetSectionDrawFunction& getSectionDraw, std::span<DrawList* const> drawLists, const SortSettings& sortSettings)
+   {
+      PROFILE_SCOPE("SceneExtraction::extractDraws");
+
+      static const std::size_t kBatchSize = 64;
+
+      ASSERT(drawLists.size() <= FrustumBatch::kMaxFrustums);
+      std::size_t numViews = drawLists.size();
+
+      // Sections are sorted by entry, so each mesh's sections are contiguous
+      FrameVector<VisibleMesh> visibleMeshes;
+      for (std::size_t i = 0; i < visibleSections.size(); ++i)
+      {
+         if (visibleMeshes.empty() || visibleMeshes.back().entry != visibleSections[i].entry)
+         {
+            visibleMeshes.push_back(VisibleMesh{ visibleSections[i].entry, i, i });
+         }
+         visibleMeshes.back().end = i + 1;
+      }
+
+      // Each batch of meshes writes to its own lists per view, which are then gathered into the draw list of each view
+      std::size_t numBatches = (visibleMeshes.size() + kBatchSize - 1) / kBatchSize;
+      FrameVector<ViewDraws> batchViewDraws(numBatches * numViews);
+
+      JobSystem::parallelFor(visibleMeshes.size(), kBatchSize, [&sceneCulling, &getSectionDraw, &mainViewPosition, visibleSections, &visibleMeshes, &batchViewDraws, numViews](std::size_t begin, std::size_t end)
+      {
+         std::span<ViewDraws> viewDraws(batchViewDraws.data() + (begin / kBatchSize) * numViews, numViews);
+
+         for (std::size_t i = begin; i < end; ++i)
+         {
+            const VisibleMesh& visibleMesh = visibleMeshes[i];
+            std::span<const SceneCulling::VisibleSection> meshSections = visibleSections.subspan(visibleMesh.begin, visibleMesh.end - visibleMesh.begin);
+
+            extractMesh(getSectionDraw, sceneCulling.getHierarchy(), mainViewPosition, sceneCulling.getEntry(visibleMesh.entry), meshSections, viewDraws);
+         }
+      });
+
+      JobSystem::parallelFor(numViews, 1, [drawLists, &batchViewDraws, numViews, numBatches, &sortSettings](std::size_t begin, std::size_t end)
+      {
+         for (std::size_t viewIndex = begin; viewIndex < end; ++viewIndex)
+         {
+            DrawList& drawList = *drawLists[viewIndex];
+
+            std::size_t numMeshes = 0;
+            std::size_t numDraws = 0;
+            for (std::size_t batch = 0; batch < numBatches; ++batch)
+            {
+               numMeshes += batchViewDraws[batch * numViews + viewIndex].meshes.size();
+               numDraws += batchViewDraws[batch * numViews + viewIndex].draws.size();
+            }
+
+            drawList.meshes.reserve(numMeshes);
+            drawList.draws.reserve(numDraws);
+            for (std::size_t batch = 0; batch < numBatches; ++batch)
+            {
+               ViewDraws& viewDraws = batchViewDraws[batch * numViews + viewIndex];
+
+               uint32_t meshOffset = static_cast<uint32_t>(drawList.meshes.size());
+               std::move(viewDraws.meshes.begin(), viewDraws.meshes.end(), std::back_inserter(drawList.meshes));
+
+               for (DrawInfo& draw : viewDraws.draws)
+               {
+                  draw.meshIndex += meshOffset;
+                  drawList.draws.push_back(draw);
+               }
+            }
+
+            sortDraws(drawList, sortSettings);
+         }
+      });
+   }
+
+   // Opaque and masked draws are first sorted by mesh section instead of depth to group them, and each merged draw then uses the key of its nearest instance.
+   // Translucent draws have to stay in back to front order, so only neighboring translucent draws are merged.
+   void sortDraws(DrawList& drawList, const SortSettings& sortSettings)
+   {
+      FrameVector<DrawInfo>& draws = drawList.draws;
+      FrameVector<uint32_t>& instances = drawList.instances;
+
+      FrameVector<DrawInfo> scratch(draws.size());
+      auto getSortKey = [groupByState = sortSettings.groupByState](const DrawInfo& draw)
+      {
+         return groupByState ? draw.sortKey : DrawSortKey::getDepthFirstKey(draw.sortKey);
+      };
+
+      instances.reserve(draws.size());
+      if (!sortSettings.automaticInstancing)
+      {
+         radixSort(std::span<DrawInfo>(draws), std::span<DrawInfo>(scratch), getSortKey);
+
+         for (uint32_t i = 0; i < draws.size(); ++i)
+         {
+            draws[i].firstInstance = i;
+            instances.push_back(draws[i].meshIndex);
+         }
+
+         return;
+      }
+
+      radixSort(std::span<DrawInfo>(draws), std::span<DrawInfo>(scratch), [&drawList](const DrawInfo& draw)
+      {
+         return DrawSortKey::getInstanceKey(draw.sortKey, drawList.meshes[draw.meshIndex].meshId, draw.section);
+      });
+
+      // Merged in place, since there are never more merged draws than draws that have been read
+      std::size_t numMergedDraws = 0;
+      for (std::size_t i = 0; i < draws.size(); ++i)
+      {
+         uint32_t meshIndex = draws[i].meshIndex;
+
+         if (numMergedDraws > 0 && canInstance(drawList, draws[numMergedDraws - 1], draws[i]))
+         {
+            DrawInfo& mergedDraw = draws[numMergedDraws - 1];
+            mergedDraw.sortKey = std::min(mergedDraw.sortKey, draws[i].sortKey);
+            ++mergedDraw.numInstances;
+         }
+         else
+         {
+            DrawInfo& mergedDraw = draws[numMergedDraws++];
+            mergedDraw = draws[i];
+            mergedDraw.firstInstance = static_cast<uint32_t>(instances.size());
+            mergedDraw.numInstances = 1;
+         }
+
+         instances.push_back(meshIndex);
+      }
+      draws.resize(numMergedDraws);
+
+      radixSort(std::span<DrawInfo>(draws), std::span<DrawInfo>(scratch), getSortKey);
+   }
+}
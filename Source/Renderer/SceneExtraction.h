@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Graphics/BlendMode.h"
+
+#include "Renderer/DrawList.h"
+#include "Renderer/SceneCulling.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+
+class Material;
+
+// Turns the sections that scene culling found visible into sorted draw lists, one per view. Knows nothing about materials beyond what the renderer passes in, so that
+// it can run (and be benchmarked) without a graphics context.
+namespace SceneExtraction
+{
+   // How a section is drawn
+   struct SectionDraw
+   {
+      const Material* material = nullptr;
+      BlendMode blendMode = BlendMode::Opaque;
+      uint32_t pipelineState = 0;
+      uint32_t materialIndex = 0;
+   };
+
+   // Fills in how the section of the entry is drawn, returning false if it can't be drawn (yet)
+   using GetSectionDrawFunction = std::function<bool(const SceneCulling::MeshEntry& entry, uint32_t section, SectionDraw& sectionDraw)>;
+
+   struct SortSettings
+   {
+      // Merges draws of the same mesh section with the same material into instanced draws
+      bool automaticInstancing = true;
+
+      // Orders opaque and masked draws by state (and then by depth). Otherwise they're ordered by depth alone, to compare how many state changes that costs.
+      bool groupByState = true;
+   };
+
+   // Adds a draw for each visible section to the list of each view that can see it, then sorts each list. Views map to the frustums that the sections were queried
+   // with (the first view is the main view, the rest are shadow views). Only the main view sorts by depth, shadow views only render depth so they just group draws
+   // by state. The depth of a section is the distance from the main view to the center of its world space bounds. Meshes are extracted in parallel batches, and the
+   // lists of each view are gathered and sorted in parallel.
+   void extractDraws(const SceneCulling& sceneCulling, std::span<const SceneCulling::VisibleSection> visibleSections, const glm::vec3& mainViewPosition, const GetSectionDrawFunction& getSectionDraw, std::span<DrawList* const> drawLists, const SortSettings& sortSettings);
+
+   // Sorts draws by key (see SortSettings)
+   void sortDraws(DrawList& drawList, const SortSettings& sortSettings);
+}
@@ -2,36 +2,24 @@
 
 #include "Core/Containers/FrameVector.h"
 
-#include "Math/Transform.h"
+#include "Graphics/Vulkan.h"
 
+#include "Renderer/DrawList.h"
 #include "Renderer/ViewInfo.h"
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <optional>
 #include <vector>
 
-class Material;
-class Mesh;
 class View;
 
-struct MeshRenderInfo
+// A run of draws that share the pipeline state, material and mesh arena block, culled on the GPU and submitted with a single indirect draw
+struct CullBatch
 {
-   Transform transform;
-   glm::mat4 localToWorld;
-
-   FrameVector<uint32_t> visibleOpaqueSections;
-   FrameVector<uint32_t> visibleMaskedSections;
-   FrameVector<uint32_t> visibleTranslucentSections;
-   FrameVector<const Material*> materials;
-   const Mesh* mesh = nullptr;
-
-   MeshRenderInfo(const Mesh& m, const Transform& t)
-      : mesh(&m)
-      , transform(t)
-      , localToWorld(t.toMatrix())
-   {
-   }
+   uint32_t firstDraw = 0;
+   uint32_t numDraws = 0;
 };
 
 struct LightRenderInfo
@@ -63,11 +51,24 @@ struct DirectionalLightRenderInfo : public LightRenderInfo
    float shadowOrthoDepth = 0.0f;
 };
 
-struct SceneRenderInfo
+struct SceneRenderInfo : public DrawList
 {
    const View& view;
 
-   FrameVector<MeshRenderInfo> meshes;
+   // Where the instances of this view start in the frame's instance buffer
+   uint32_t instanceOffset = 0;
+
+   // Holds an indirect draw command for each draw, starting at drawCommandOffset (null if draws should be recorded directly)
+   vk::Buffer drawCommandBuffer;
+   uint32_t drawCommandOffset = 0;
+
+   // With GPU culling, the first numGPUCulledDraws draws (opaque and masked) are split into batches. The draws of each batch that pass culling are compacted into
+   // culledDrawCommandBuffer, starting at the batch's first draw, and their number is written to drawCountBuffer (one count per batch).
+   vk::Buffer culledDrawCommandBuffer;
+   vk::Buffer drawCountBuffer;
+   uint32_t numGPUCulledDraws = 0;
+   FrameVector<CullBatch> cullBatches;
+   FrameVector<uint32_t> drawBatches; // Batch index of each GPU culled draw
 
    FrameVector<PointLightRenderInfo> pointLights;
    FrameVector<SpotLightRenderInfo> spotLights;
@@ -6,3 +6,10 @@ struct MeshUniformData
 {
    alignas(16) glm::mat4 localToWorld;
 };
+
+// Matches the bounds used for CPU culling: a sphere, and a box with the same center
+struct InstanceBoundsData
+{
+   alignas(16) glm::vec4 centerRadius;
+   alignas(16) glm::vec4 extent;
+};
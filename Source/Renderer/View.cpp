@@ -11,7 +11,12 @@ std::vector<vk::DescriptorSetLayoutBinding> ViewDescriptorSet::getBindings()
          .setBinding(0)
          .setDescriptorType(vk::DescriptorType::eUniformBuffer)
          .setDescriptorCount(1)
-         .setStageFlags(vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment)
+         .setStageFlags(vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment),
+      vk::DescriptorSetLayoutBinding()
+         .setBinding(1)
+         .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+         .setDescriptorCount(1)
+         .setStageFlags(vk::ShaderStageFlagBits::eVertex)
    };
 }
 
@@ -50,6 +55,19 @@ void View::update(const ViewInfo& viewInfo)
    uniformBuffer.update(viewUniformData);
 }
 
+void View::updateInstanceDescriptorSet(const vk::DescriptorBufferInfo& instanceBufferInfo)
+{
+   vk::WriteDescriptorSet instanceDescriptorWrite = vk::WriteDescriptorSet()
+      .setDstSet(descriptorSet.getCurrentSet())
+      .setDstBinding(1)
+      .setDstArrayElement(0)
+      .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+      .setDescriptorCount(1)
+      .setPBufferInfo(&instanceBufferInfo);
+
+   device.updateDescriptorSets({ instanceDescriptorWrite }, {});
+}
+
 void View::updateDescriptorSets()
 {
    for (uint32_t frameIndex = 0; frameIndex < GraphicsContext::kMaxFramesInFlight; ++frameIndex)
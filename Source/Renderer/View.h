@@ -44,6 +44,9 @@ public:
 
    void update(const ViewInfo& viewInfo);
 
+   // Points the current frame's descriptor set at the instance buffer that draws of this view read from
+   void updateInstanceDescriptorSet(const vk::DescriptorBufferInfo& instanceBufferInfo);
+
    vk::DescriptorBufferInfo getDescriptorBufferInfo(uint32_t frameIndex) const
    {
       return uniformBuffer.getDescriptorBufferInfo(frameIndex);
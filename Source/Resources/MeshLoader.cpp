@@ -1,8 +1,10 @@
 #include "Resources/MeshLoader.h"
 
 #include "Core/Enum.h"
+#include "Core/Profiler.h"
 
 #include "Graphics/DebugUtils.h"
+#include "Graphics/UploadQueue.h"
 
 #include "Math/MathUtils.h"
 
@@ -201,32 +203,33 @@ namespace
       return materialInfo;
    }
 
-   MeshLoader::SectionInfo processAssimpMesh(const aiScene& assimpScene, const aiMesh& assimpMesh, const glm::mat3& swizzle, float scale, bool interpretTextureAlphaAsMask, const std::filesystem::path& directory)
+   void processAssimpMesh(MeshLoader::MeshInfo& meshInfo, const aiScene& assimpScene, const aiMesh& assimpMesh, const glm::mat3& swizzle, float scale, bool interpretTextureAlphaAsMask, const std::filesystem::path& directory)
    {
-      MeshLoader::SectionInfo sectionInfo;
+      MeshSectionSourceData sectionData;
+      MeshLoader::MaterialInfo materialInfo;
 
       static_assert(sizeof(unsigned int) == sizeof(uint32_t), "Index data types don't match");
-      sectionInfo.indices = std::vector<uint32_t>(assimpMesh.mNumFaces * 3);
+      sectionData.indices = std::vector<uint32_t>(assimpMesh.mNumFaces * 3);
       for (unsigned int i = 0; i < assimpMesh.mNumFaces; ++i)
       {
          const aiFace& face = assimpMesh.mFaces[i];
          ASSERT(face.mNumIndices == 3);
 
-         std::memcpy(&sectionInfo.indices[i * 3], face.mIndices, 3 * sizeof(uint32_t));
+         std::memcpy(&sectionData.indices[i * 3], face.mIndices, 3 * sizeof(uint32_t));
       }
 
       if (assimpMesh.mNumVertices > 0)
       {
-         sectionInfo.vertices.resize(assimpMesh.mNumVertices);
+         sectionData.vertices.resize(assimpMesh.mNumVertices);
          bool hasTextureCoordinates = assimpMesh.mTextureCoords[0] && assimpMesh.mNumUVComponents[0] == 2;
-         sectionInfo.hasValidTexCoords = hasTextureCoordinates;
+         sectionData.hasValidTexCoords = hasTextureCoordinates;
 
          glm::vec3 minPosition(std::numeric_limits<float>::max());
          glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
 
          for (unsigned int i = 0; i < assimpMesh.mNumVertices; ++i)
          {
-            Vertex& vertex = sectionInfo.vertices[i];
+            Vertex& vertex = sectionData.vertices[i];
 
             vertex.position = swizzle * glm::vec3(assimpMesh.mVertices[i].x, assimpMesh.mVertices[i].y, assimpMesh.mVertices[i].z) * scale;
 
@@ -264,34 +267,37 @@ namespace
          }
 
          std::array<glm::vec3, 2> points = { minPosition, maxPosition };
-         sectionInfo.bounds = Bounds(points);
+         sectionData.bounds = Bounds(points);
       }
 
       if (assimpMesh.mMaterialIndex < assimpScene.mNumMaterials && assimpScene.mMaterials[assimpMesh.mMaterialIndex])
       {
-         sectionInfo.materialInfo = processAssimpMaterial(*assimpScene.mMaterials[assimpMesh.mMaterialIndex], interpretTextureAlphaAsMask, directory);
+         materialInfo = processAssimpMaterial(*assimpScene.mMaterials[assimpMesh.mMaterialIndex], interpretTextureAlphaAsMask, directory);
       }
 
-      return sectionInfo;
+      meshInfo.sections.push_back(std::move(sectionData));
+      meshInfo.sectionMaterials.push_back(std::move(materialInfo));
    }
 
-   void processAssimpNode(std::vector<MeshLoader::SectionInfo>& sectionInfo, const aiScene& assimpScene, const aiNode& assimpNode, const glm::mat3& swizzle, float scale, bool interpretTextureAlphaAsMask, const std::filesystem::path& directory)
+   void processAssimpNode(MeshLoader::MeshInfo& meshInfo, const aiScene& assimpScene, const aiNode& assimpNode, const glm::mat3& swizzle, float scale, bool interpretTextureAlphaAsMask, const std::filesystem::path& directory)
    {
       for (unsigned int i = 0; i < assimpNode.mNumMeshes; ++i)
       {
          const aiMesh& assimpMesh = *assimpScene.mMeshes[assimpNode.mMeshes[i]];
-         sectionInfo.push_back(processAssimpMesh(assimpScene, assimpMesh, swizzle, scale, interpretTextureAlphaAsMask, directory));
+         processAssimpMesh(meshInfo, assimpScene, assimpMesh, swizzle, scale, interpretTextureAlphaAsMask, directory);
       }
 
       for (unsigned int i = 0; i < assimpNode.mNumChildren; ++i)
       {
-         processAssimpNode(sectionInfo, assimpScene, *assimpNode.mChildren[i], swizzle, scale, interpretTextureAlphaAsMask, directory);
+         processAssimpNode(meshInfo, assimpScene, *assimpNode.mChildren[i], swizzle, scale, interpretTextureAlphaAsMask, directory);
       }
    }
 
-   std::vector<MeshLoader::SectionInfo> loadMesh(const std::filesystem::path& path, const MeshLoadOptions& loadOptions)
+   MeshLoader::MeshInfo loadMesh(const std::filesystem::path& path, const MeshLoadOptions& loadOptions)
    {
-      std::vector<MeshLoader::SectionInfo> sectionInfo;
+      PROFILE_SCOPE("MeshLoader::loadMesh");
+
+      MeshLoader::MeshInfo meshInfo;
 
       unsigned int flags = aiProcess_CalcTangentSpace | aiProcess_JoinIdenticalVertices | aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_PreTransformVertices | aiProcess_FlipUVs;
 
@@ -300,10 +306,25 @@ namespace
       if (assimpScene && assimpScene->mRootNode && !(assimpScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE))
       {
          std::filesystem::path directory = path.parent_path();
-         processAssimpNode(sectionInfo, *assimpScene, *assimpScene->mRootNode, getSwizzleMatrix(loadOptions), loadOptions.scale, loadOptions.interpretTextureAlphaAsMask, directory);
+         processAssimpNode(meshInfo, *assimpScene, *assimpScene->mRootNode, getSwizzleMatrix(loadOptions), loadOptions.scale, loadOptions.interpretTextureAlphaAsMask, directory);
+      }
+
+      return meshInfo;
+   }
+
+   // Writes the vertex and index data straight to the staging ring (from the load task when loading asynchronously), so that the main thread only needs to record the
+   // copies
+   StagingRing::Allocation stageMesh(std::span<const MeshSectionSourceData> sourceData, StagingRing& stagingRing)
+   {
+      PROFILE_SCOPE("MeshLoader::stageMesh");
+
+      StagingRing::Allocation stagingAllocation = stagingRing.reserve(Mesh::getStagingDataSize(sourceData));
+      if (stagingAllocation)
+      {
+         Mesh::writeStagingData(sourceData, stagingAllocation.getBytes());
       }
 
-      return sectionInfo;
+      return stagingAllocation;
    }
 
    StrongTextureHandle createTexture(const MeshLoader::TextureInfo& textureInfo, ResourceManager& resourceManager)
@@ -340,30 +361,16 @@ namespace
       return resourceManager.loadMaterial(materialParameters);
    }
 
-   MeshSectionSourceData createSectionSourceData(MeshLoader::SectionInfo& sectionInfo, ResourceManager& resourceManager)
-   {
-      MeshSectionSourceData sourceData;
-
-      sourceData.vertices = std::move(sectionInfo.vertices);
-      sourceData.indices = std::move(sectionInfo.indices);
-      sourceData.hasValidTexCoords = sectionInfo.hasValidTexCoords;
-      sourceData.bounds = sectionInfo.bounds;
-      sourceData.materialHandle = createMaterial(sectionInfo.materialInfo, resourceManager);
-
-      return sourceData;
-   }
-
-   std::vector<MeshSectionSourceData> createSourceData(std::vector<MeshLoader::SectionInfo> allSectionInfo, ResourceManager& resourceManager)
+   std::vector<MeshSectionSourceData> createSourceData(MeshLoader::MeshInfo meshInfo, ResourceManager& resourceManager)
    {
-      std::vector<MeshSectionSourceData> allSourceData;
-      allSourceData.reserve(allSectionInfo.size());
+      ASSERT(meshInfo.sections.size() == meshInfo.sectionMaterials.size());
 
-      for (MeshLoader::SectionInfo& sectionInfo : allSectionInfo)
+      for (std::size_t i = 0; i < meshInfo.sections.size(); ++i)
       {
-         allSourceData.push_back(createSectionSourceData(sectionInfo, resourceManager));
+         meshInfo.sections[i].materialHandle = createMaterial(meshInfo.sectionMaterials[i], resourceManager);
       }
 
-      return allSourceData;
+      return std::move(meshInfo.sections);
    }
 }
 
@@ -378,17 +385,48 @@ MeshLoader::MeshLoader(const GraphicsContext& graphicsContext, ResourceManager&
    defaultMesh = std::make_unique<Mesh>(context, std::span<const MeshSectionSourceData>{});
 }
 
+MeshLoader::~MeshLoader()
+{
+   // Load tasks write to the staging ring, so they need to finish before it is destroyed (without waiting for space that will never be freed)
+   StagingRing& stagingRing = context.getUploadQueue().getStagingRing();
+   stagingRing.close();
+
+   for (Task<LoadResult>& task : loadTasks)
+   {
+      JobSystem::wait(task.getJobHandle());
+
+      LoadResult result = task.getResult();
+      if (result.stagingAllocation)
+      {
+         stagingRing.free(result.stagingAllocation);
+      }
+   }
+
+   for (const LoadResult& result : loadedResults)
+   {
+      if (result.stagingAllocation)
+      {
+         stagingRing.free(result.stagingAllocation);
+      }
+   }
+}
+
 void MeshLoader::update()
 {
+   PROFILE_SCOPE("MeshLoader::update");
+
    for (Task<LoadResult>& task : loadTasks)
    {
       if (task.isDone())
       {
-         onMeshLoaded(task.getResult());
+         loadedResults.push_back(task.getResult());
       }
    }
 
    std::erase_if(loadTasks, [](const Task<LoadResult>& task) { return !task.isValid(); });
+
+   finalizeLoadedResults();
+   publishCompletedUploads();
 }
 
 MeshHandle MeshLoader::load(const std::filesystem::path& path, const MeshLoadOptions& loadOptions, LoadDelegate&& loadDelegate)
@@ -406,23 +444,41 @@ MeshHandle MeshLoader::load(const std::filesystem::path& path, const MeshLoadOpt
 
       MeshHandle handle = container.addReference(key, defaultMesh.get());
 
-      loadTasks.push_back(Task<LoadResult>([canonicalPath = key.canonicalPath, loadOptions, delegate = std::move(loadDelegate), handle]()
+      bool synchronous = resourceManager.getLoadingMode() == LoadingMode::Synchronous;
+      auto loadFunction = [canonicalPath = key.canonicalPath, loadOptions, delegate = std::move(loadDelegate), handle, synchronous, &stagingRing = context.getUploadQueue().getStagingRing()]()
       {
          LoadResult result;
-         result.sectionInfo = loadMesh(canonicalPath, loadOptions);
+         result.meshInfo = loadMesh(canonicalPath, loadOptions);
+         if (!synchronous)
+         {
+            result.stagingAllocation = stageMesh(result.meshInfo.sections, stagingRing);
+            if (result.stagingAllocation)
+            {
+               // The mesh is created from the staged data, so there's no need to hold on to a second copy of it until the main thread gets around to finalizing it
+               Mesh::releaseVertexData(result.meshInfo.sections);
+            }
+         }
          result.canonicalPath = std::move(canonicalPath);
          result.loadDelegate = std::move(delegate);
          result.handle = handle;
 
          return result;
-      }));
+      };
 
-      if (resourceManager.getLoadingMode() == LoadingMode::Synchronous)
+      if (synchronous)
       {
-         while (!loadTasks.empty())
-         {
-            update();
-         }
+         // Loaded on this thread rather than waiting for a job, since a job could be stuck waiting for staging ring space that only this thread frees (this thread
+         // never waits for space, it falls back to a staging buffer instead). Every synchronous load waits for its upload to complete, which frees its ring space
+         // again, so only data larger than the whole ring ends up in a staging buffer of its own.
+         loadedResults.push_back(loadFunction());
+         finalizeLoadedResults();
+
+         context.getUploadQueue().flush();
+         publishCompletedUploads();
+      }
+      else
+      {
+         loadTasks.push_back(Task<LoadResult>(std::move(loadFunction)));
       }
 
       return handle;
@@ -431,14 +487,64 @@ MeshHandle MeshLoader::load(const std::filesystem::path& path, const MeshLoadOpt
    return MeshHandle{};
 }
 
+void MeshLoader::finalizeLoadedResults()
+{
+   std::size_t numFinalized = 0;
+   while (numFinalized < loadedResults.size() && resourceManager.beginFinalize())
+   {
+      onMeshLoaded(std::move(loadedResults[numFinalized]));
+      ++numFinalized;
+   }
+
+   loadedResults.erase(loadedResults.begin(), loadedResults.begin() + numFinalized);
+}
+
 void MeshLoader::onMeshLoaded(LoadResult result)
 {
-   std::vector<MeshSectionSourceData> sourceData = createSourceData(std::move(result.sectionInfo), resourceManager);
+   PROFILE_SCOPE("MeshLoader::onMeshLoaded");
+
+   UploadQueue& uploadQueue = context.getUploadQueue();
+
+   std::vector<MeshSectionSourceData> sourceData = createSourceData(std::move(result.meshInfo), resourceManager);
    if (!sourceData.empty())
    {
-      container.replace(result.handle, context, sourceData);
-      NAME_POINTER(context.getDevice(), get(result.handle), ResourceLoadHelpers::getName(result.canonicalPath));
+      // Synchronous loads are staged after their textures have loaded (and freed their own ring space), since ring space is only reused in order, so holding on to
+      // the mesh's space while they load would push every texture past the end of the ring into a staging buffer
+      if (!result.stagingAllocation && resourceManager.getLoadingMode() == LoadingMode::Synchronous)
+      {
+         result.stagingAllocation = stageMesh(sourceData, uploadQueue.getStagingRing());
+      }
+
+      PendingUpload pendingUpload;
+      pendingUpload.mesh = std::make_unique<Mesh>(context, sourceData, result.stagingAllocation.getBytes());
+      pendingUpload.loadDelegate = std::move(result.loadDelegate);
+      pendingUpload.handle = result.handle;
+      pendingUpload.uploadValue = uploadQueue.getPendingValue();
+      NAME_POINTER(context.getDevice(), pendingUpload.mesh, ResourceLoadHelpers::getName(result.canonicalPath));
+
+      pendingUploads.push_back(std::move(pendingUpload));
+   }
 
-      result.loadDelegate.executeIfBound(result.handle);
+   if (result.stagingAllocation)
+   {
+      uploadQueue.releaseStagingAllocation(result.stagingAllocation);
    }
 }
+
+void MeshLoader::publishCompletedUploads()
+{
+   UploadQueue& uploadQueue = context.getUploadQueue();
+
+   for (PendingUpload& pendingUpload : pendingUploads)
+   {
+      if (!uploadQueue.isComplete(pendingUpload.uploadValue))
+      {
+         continue;
+      }
+
+      container.replace(pendingUpload.handle, std::move(pendingUpload.mesh));
+      pendingUpload.loadDelegate.executeIfBound(pendingUpload.handle);
+   }
+
+   std::erase_if(pendingUploads, [](const PendingUpload& pendingUpload) { return !pendingUpload.mesh; });
+}
@@ -9,6 +9,7 @@
 #include "Resources/TextureLoader.h"
 
 #include "Graphics/Mesh.h"
+#include "Graphics/StagingRing.h"
 
 #include <filesystem>
 #include <string>
@@ -48,12 +49,25 @@ class MeshLoader : public ResourceLoader<MeshKey, Mesh>
 {
 public:
    MeshLoader(const GraphicsContext& graphicsContext, ResourceManager& owningResourceManager);
+   ~MeshLoader();
 
    void update();
 
    using LoadDelegate = Delegate<void, MeshHandle>;
    MeshHandle load(const std::filesystem::path& path, const MeshLoadOptions& loadOptions = {}, LoadDelegate&& loadDelegate = {});
 
+   // Loaded meshes waiting to be finalized
+   std::size_t getNumQueued() const
+   {
+      return loadedResults.size();
+   }
+
+   // Whether any meshes are still loading, waiting to be finalized or uploading
+   bool isStreaming() const
+   {
+      return !loadTasks.empty() || !loadedResults.empty() || !pendingUploads.empty();
+   }
+
    struct TextureInfo
    {
       std::filesystem::path path;
@@ -73,27 +87,39 @@ public:
       bool twoSided = false;
    };
 
-   struct SectionInfo
+   // Sections are loaded by a load task, apart from their materials (which are only created once the mesh gets back to the main thread)
+   struct MeshInfo
    {
-      std::vector<Vertex> vertices;
-      std::vector<uint32_t> indices;
-      bool hasValidTexCoords = false;
-      Bounds bounds;
-      MaterialInfo materialInfo;
+      std::vector<MeshSectionSourceData> sections;
+      std::vector<MaterialInfo> sectionMaterials;
    };
 
 private:
    struct LoadResult
    {
-      std::vector<SectionInfo> sectionInfo;
+      MeshInfo meshInfo;
+      StagingRing::Allocation stagingAllocation; // Empty if the data didn't fit in the staging ring
       std::string canonicalPath;
       LoadDelegate loadDelegate;
       MeshHandle handle;
    };
 
+   // Meshes whose data is still being uploaded, which replace the default mesh once the upload completes
+   struct PendingUpload
+   {
+      std::unique_ptr<Mesh> mesh;
+      LoadDelegate loadDelegate;
+      MeshHandle handle;
+      uint64_t uploadValue = 0;
+   };
+
+   void finalizeLoadedResults();
    void onMeshLoaded(LoadResult result);
+   void publishCompletedUploads();
 
    std::unique_ptr<Mesh> defaultMesh;
 
    std::vector<Task<LoadResult>> loadTasks;
+   std::vector<LoadResult> loadedResults;
+   std::vector<PendingUpload> pendingUploads;
 };
@@ -18,6 +18,40 @@ ResourceManager::~ResourceManager()
    clearRefCounts(textureRefCounts);
 }
 
+void ResourceManager::update()
+{
+   PROFILE_SCOPE("ResourceManager::update");
+
+   shaderModuleLoader.update();
+
+   // Textures that were on screen last frame go first, so that streaming meshes can't use up the budget ahead of them. Then meshes, since finalizing them is what
+   // starts loading their materials' textures, and then the rest of the textures.
+   std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+   finalizeDeadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(finalizeBudgetMilliseconds));
+   finalizeStats = ResourceFinalizeStats();
+
+   textureLoader.finalizeVisible();
+   meshLoader.update();
+   textureLoader.update();
+
+   finalizeStats.queuedMeshes = static_cast<uint32_t>(meshLoader.getNumQueued());
+   finalizeStats.queuedTextures = static_cast<uint32_t>(textureLoader.getNumQueued());
+   finalizeStats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+   materialLoader.updateMaterials();
+}
+
+void ResourceManager::markMaterialVisible(MaterialHandle handle)
+{
+   if (const MaterialParameters* materialParameters = materialLoader.findKey(handle))
+   {
+      for (const TextureMaterialParameter& textureParameter : materialParameters->textureParameters)
+      {
+         textureLoader.markVisible(textureParameter.value);
+      }
+   }
+}
+
 #define FOR_EACH_RESOURCE_TYPE(resource_type) \
 template<> resource_type* ResourceManager::get<resource_type>(ResourceHandle<resource_type> handle) { return get##resource_type(handle); } \
 template<> const resource_type* ResourceManager::get<resource_type>(ResourceHandle<resource_type> handle) const { return get##resource_type(handle); }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Core/Profiler.h"
+
 #include "ResourceContainer.h"
 #include "ResourceTypes.h"
 
@@ -8,6 +10,8 @@
 #include "Resources/ShaderModuleLoader.h"
 #include "Resources/TextureLoader.h"
 
+#include <chrono>
+#include <cstdint>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -18,6 +22,15 @@ enum class LoadingMode
    Asynchronous
 };
 
+// Main thread work done to turn loaded data into resources during the last update
+struct ResourceFinalizeStats
+{
+   uint32_t finalized = 0;
+   uint32_t queuedMeshes = 0; // Loaded, but waiting for a later frame's budget
+   uint32_t queuedTextures = 0;
+   double milliseconds = 0.0;
+};
+
 class ResourceManager
 {
 public:
@@ -26,14 +39,7 @@ public:
 
    // All
 
-   void update()
-   {
-      shaderModuleLoader.update();
-      meshLoader.update();
-      textureLoader.update();
-
-      materialLoader.updateMaterials();
-   }
+   void update();
 
    LoadingMode getLoadingMode() const
    {
@@ -45,6 +51,39 @@ public:
       loadingMode = mode;
    }
 
+   double getFinalizeBudget() const
+   {
+      return finalizeBudgetMilliseconds;
+   }
+
+   void setFinalizeBudget(double milliseconds)
+   {
+      finalizeBudgetMilliseconds = milliseconds;
+   }
+
+   // Loaded resources are finalized (creating their GPU objects and recording their uploads) until the frame's budget runs out, but at least one is finalized per
+   // update so that loading always makes progress. Synchronous loading ignores the budget.
+   bool beginFinalize()
+   {
+      if (loadingMode == LoadingMode::Asynchronous && finalizeStats.finalized > 0 && std::chrono::steady_clock::now() >= finalizeDeadline)
+      {
+         return false;
+      }
+
+      ++finalizeStats.finalized;
+      return true;
+   }
+
+   const ResourceFinalizeStats& getFinalizeStats() const
+   {
+      return finalizeStats;
+   }
+
+   bool isStreaming() const
+   {
+      return meshLoader.isStreaming() || textureLoader.isStreaming();
+   }
+
    // Material
 
    StrongMaterialHandle loadMaterial(const MaterialParameters& materialParameters)
@@ -77,6 +116,9 @@ public:
       materialLoader.requestSetOfUpdates(handle);
    }
 
+   // Lets the textures of a material that is on screen skip ahead of the other loaded textures waiting to be finalized
+   void markMaterialVisible(MaterialHandle handle);
+
    // Mesh
 
    StrongMeshHandle loadMesh(const std::filesystem::path& path, const MeshLoadOptions& loadOptions = {}, MeshLoader::LoadDelegate&& loadDelegate = {})
@@ -192,6 +234,16 @@ public:
       textureLoader.unregisterReplaceDelegate(textureHandle, delegateHandle);
    }
 
+   bool hasQueuedTextures() const
+   {
+      return textureLoader.getNumQueued() > 0;
+   }
+
+   void markTextureVisible(TextureHandle handle)
+   {
+      textureLoader.markVisible(handle);
+   }
+
 private:
    template<typename T>
    friend class StrongResourceHandle;
@@ -234,4 +286,8 @@ private:
    RefCountMap<Texture> textureRefCounts;
 
    LoadingMode loadingMode = LoadingMode::Asynchronous;
+
+   double finalizeBudgetMilliseconds = 2.0;
+   std::chrono::steady_clock::time_point finalizeDeadline;
+   ResourceFinalizeStats finalizeStats;
 };
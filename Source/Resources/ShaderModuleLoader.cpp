@@ -1,6 +1,7 @@
 #include "Resources/ShaderModuleLoader.h"
 
 #include "Core/Log.h"
+#include "Core/Profiler.h"
 
 #include "Graphics/DebugUtils.h"
 
@@ -112,6 +113,8 @@ ShaderModuleLoader::ShaderModuleLoader(const GraphicsContext& graphicsContext, R
 
 void ShaderModuleLoader::update()
 {
+   PROFILE_SCOPE("ShaderModuleLoader::update");
+
 #if FORGE_WITH_SHADER_HOT_RELOADING
    pollCompilationResults();
    shaderSourceDirectoryWatcher.update();
@@ -1,8 +1,10 @@
 #include "Resources/TextureLoader.h"
 
 #include "Core/Assert.h"
+#include "Core/Profiler.h"
 
 #include "Graphics/DebugUtils.h"
+#include "Graphics/UploadQueue.h"
 
 #include "Resources/DDSImage.h"
 #include "Resources/Image.h"
@@ -16,6 +18,8 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
+#include <numeric>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -24,6 +28,8 @@ namespace
 {
    std::unique_ptr<Image> loadImage(const std::filesystem::path& path, const TextureLoadOptions& loadOptions)
    {
+      PROFILE_SCOPE("TextureLoader::loadImage");
+
       if (std::optional<std::vector<uint8_t>> fileData = IOUtils::readBinaryFile(path))
       {
          std::string extension = path.extension().string();
@@ -42,6 +48,26 @@ namespace
       return nullptr;
    }
 
+   StagingRing::Allocation stageImage(const Image& image, StagingRing& stagingRing)
+   {
+      PROFILE_SCOPE("TextureLoader::stageImage");
+
+      TextureData textureData = image.getTextureData();
+
+      // Buffer offsets of image copies need to be a multiple of both the texel block size and 4
+      vk::Format format = image.getProperties().format;
+      uint32_t texelBlockSize = FormatHelpers::bytesPerBlock(format) > 0 ? FormatHelpers::bytesPerBlock(format) : FormatHelpers::bitsPerPixel(format) / 8;
+      vk::DeviceSize alignment = std::lcm(std::max(texelBlockSize, 1u), 4u);
+
+      StagingRing::Allocation stagingAllocation = stagingRing.reserve(textureData.bytes.size_bytes(), alignment);
+      if (stagingAllocation)
+      {
+         std::memcpy(stagingAllocation.data, textureData.bytes.data(), textureData.bytes.size_bytes());
+      }
+
+      return stagingAllocation;
+   }
+
    struct Color
    {
       uint8_t r = 0;
@@ -232,19 +258,46 @@ TextureLoader::TextureLoader(const GraphicsContext& graphicsContext, ResourceMan
 
 TextureLoader::~TextureLoader()
 {
+   // Load tasks write to the staging ring, so they need to finish before it is destroyed (without waiting for space that will never be freed)
+   StagingRing& stagingRing = context.getUploadQueue().getStagingRing();
+   stagingRing.close();
+
+   for (Task<LoadResult>& task : loadTasks)
+   {
+      JobSystem::wait(task.getJobHandle());
+
+      LoadResult result = task.getResult();
+      if (result.stagingAllocation)
+      {
+         stagingRing.free(result.stagingAllocation);
+      }
+   }
+
+   for (const LoadResult& result : loadedResults)
+   {
+      if (result.stagingAllocation)
+      {
+         stagingRing.free(result.stagingAllocation);
+      }
+   }
 }
 
 void TextureLoader::update()
 {
+   PROFILE_SCOPE("TextureLoader::update");
+
    for (Task<LoadResult>& task : loadTasks)
    {
       if (task.isDone())
       {
-         onImageLoaded(task.getResult());
+         loadedResults.push_back(task.getResult());
       }
    }
 
    std::erase_if(loadTasks, [](const Task<LoadResult>& task) { return !task.isValid(); });
+
+   finalizeLoadedResults(loadedResults.size());
+   publishCompletedUploads();
 }
 
 TextureHandle TextureLoader::load(const std::filesystem::path& path, const TextureLoadOptions& loadOptions)
@@ -268,23 +321,43 @@ TextureHandle TextureLoader::load(const std::filesystem::path& path, const Textu
 
    TextureHandle handle = container.addReference(key, getDefault(loadOptions.fallbackDefaultTextureType));
 
-   loadTasks.push_back(Task<LoadResult>([canonicalPath = key.canonicalPath, loadOptions, handle]()
+   auto loadFunction = [canonicalPath = key.canonicalPath, loadOptions, handle, &stagingRing = context.getUploadQueue().getStagingRing()]()
    {
       LoadResult result;
       result.image = loadImage(canonicalPath, loadOptions);
+      if (result.image)
+      {
+         result.imageProperties = result.image->getProperties();
+         result.stagingAllocation = stageImage(*result.image, stagingRing);
+
+         if (result.stagingAllocation)
+         {
+            TextureData textureData = result.image->getTextureData();
+            result.mips.assign(textureData.mips.begin(), textureData.mips.end());
+            result.mipsPerLayer = textureData.mipsPerLayer;
+
+            result.image = nullptr;
+         }
+      }
       result.canonicalPath = canonicalPath;
       result.loadOptions = loadOptions;
       result.handle = handle;
 
       return result;
-   }));
+   };
 
    if (resourceManager.getLoadingMode() == LoadingMode::Synchronous)
    {
-      while (!loadTasks.empty())
-      {
-         update();
-      }
+      // Loaded on this thread for the same reason as meshes (see MeshLoader::load())
+      loadedResults.push_back(loadFunction());
+      finalizeLoadedResults(loadedResults.size());
+
+      context.getUploadQueue().flush();
+      publishCompletedUploads();
+   }
+   else
+   {
+      loadTasks.push_back(Task<LoadResult>(std::move(loadFunction)));
    }
 
    return handle;
@@ -364,19 +437,94 @@ void TextureLoader::unregisterReplaceDelegate(TextureHandle textureHandle, Deleg
    delegateHandle.invalidate();
 }
 
+void TextureLoader::markVisible(TextureHandle textureHandle)
+{
+   if (!loadedResults.empty())
+   {
+      visibleTextures.insert(textureHandle);
+   }
+}
+
+void TextureLoader::finalizeVisible()
+{
+   // A single pass moves the visible textures to the front, keeping both groups in the order they finished loading
+   auto visibleEnd = std::stable_partition(loadedResults.begin(), loadedResults.end(), [this](const LoadResult& result) { return visibleTextures.contains(result.handle); });
+   visibleTextures.clear();
+
+   finalizeLoadedResults(static_cast<std::size_t>(visibleEnd - loadedResults.begin()));
+}
+
+// Finalizes from the front of the queue, and removes everything that was finalized at once
+void TextureLoader::finalizeLoadedResults(std::size_t maxResults)
+{
+   std::size_t numFinalized = 0;
+   while (numFinalized < std::min(maxResults, loadedResults.size()) && resourceManager.beginFinalize())
+   {
+      onImageLoaded(std::move(loadedResults[numFinalized]));
+      ++numFinalized;
+   }
+
+   loadedResults.erase(loadedResults.begin(), loadedResults.begin() + numFinalized);
+}
+
 void TextureLoader::onImageLoaded(LoadResult result)
 {
-   if (result.image)
+   PROFILE_SCOPE("TextureLoader::onImageLoaded");
+
+   if (!result.image && !result.stagingAllocation)
    {
-      container.replace(result.handle, std::make_unique<Texture>(context, result.image->getProperties(), getTextureProperties(result.loadOptions.generateMipMaps), getInitialLayout(), result.image->getTextureData()));
-      NAME_POINTER(context.getDevice(), get(result.handle), ResourceLoadHelpers::getName(result.canonicalPath));
+      return;
+   }
+
+   UploadQueue& uploadQueue = context.getUploadQueue();
 
-      auto location = replaceDelegates.find(result.handle);
+   TextureData textureData;
+   if (result.stagingAllocation)
+   {
+      textureData.bytes = result.stagingAllocation.getBytes();
+      textureData.mips = result.mips;
+      textureData.mipsPerLayer = result.mipsPerLayer;
+   }
+   else
+   {
+      textureData = result.image->getTextureData();
+   }
+
+   PendingUpload pendingUpload;
+   pendingUpload.texture = std::make_unique<Texture>(context, result.imageProperties, getTextureProperties(result.loadOptions.generateMipMaps), getInitialLayout(), textureData);
+   pendingUpload.handle = result.handle;
+   pendingUpload.uploadValue = uploadQueue.getPendingValue();
+   NAME_POINTER(context.getDevice(), pendingUpload.texture, ResourceLoadHelpers::getName(result.canonicalPath));
+
+   pendingUploads.push_back(std::move(pendingUpload));
+
+   if (result.stagingAllocation)
+   {
+      uploadQueue.releaseStagingAllocation(result.stagingAllocation);
+   }
+}
+
+void TextureLoader::publishCompletedUploads()
+{
+   UploadQueue& uploadQueue = context.getUploadQueue();
+
+   for (PendingUpload& pendingUpload : pendingUploads)
+   {
+      if (!uploadQueue.isComplete(pendingUpload.uploadValue))
+      {
+         continue;
+      }
+
+      container.replace(pendingUpload.handle, std::move(pendingUpload.texture));
+
+      auto location = replaceDelegates.find(pendingUpload.handle);
       if (location != replaceDelegates.end())
       {
-         location->second.broadcast(result.handle);
+         location->second.broadcast(pendingUpload.handle);
       }
    }
+
+   std::erase_if(pendingUploads, [](const PendingUpload& pendingUpload) { return !pendingUpload.texture; });
 }
 
 std::unique_ptr<Texture> TextureLoader::createDefault(DefaultTextureType type) const
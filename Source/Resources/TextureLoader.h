@@ -6,11 +6,13 @@
 
 #include "Resources/ResourceLoader.h"
 
+#include "Graphics/StagingRing.h"
 #include "Graphics/Texture.h"
 
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 class Image;
 
@@ -62,16 +64,51 @@ public:
    DelegateHandle registerReplaceDelegate(TextureHandle textureHandle, ReplaceDelegate::FuncType function);
    void unregisterReplaceDelegate(TextureHandle textureHandle, DelegateHandle& delegateHandle);
 
+   // Loaded textures waiting to be finalized
+   std::size_t getNumQueued() const
+   {
+      return loadedResults.size();
+   }
+
+   // Whether any textures are still loading, waiting to be finalized or uploading
+   bool isStreaming() const
+   {
+      return !loadTasks.empty() || !loadedResults.empty() || !pendingUploads.empty();
+   }
+
+   // Visible textures are finalized by the next finalizeVisible()
+   void markVisible(TextureHandle textureHandle);
+
+   // Finalizes the loaded textures that were marked visible since the last call, ahead of everything else waiting for the frame's budget
+   void finalizeVisible();
+
 private:
    struct LoadResult
    {
+      ImageProperties imageProperties;
+
+      // The image's data is copied to the staging ring by the load task when it fits, in which case the image itself is freed right away
       std::unique_ptr<Image> image;
+      StagingRing::Allocation stagingAllocation;
+      std::vector<MipInfo> mips;
+      uint32_t mipsPerLayer = 0;
+
       std::string canonicalPath;
       TextureLoadOptions loadOptions;
       TextureHandle handle;
    };
 
+   // Textures whose data is still being uploaded, which replace the fallback once the upload completes
+   struct PendingUpload
+   {
+      std::unique_ptr<Texture> texture;
+      TextureHandle handle;
+      uint64_t uploadValue = 0;
+   };
+
+   void finalizeLoadedResults(std::size_t maxResults);
    void onImageLoaded(LoadResult result);
+   void publishCompletedUploads();
    std::unique_ptr<Texture> createDefault(DefaultTextureType type) const;
 
    std::unique_ptr<Texture> defaultBlack;
@@ -82,5 +119,8 @@ private:
    std::unique_ptr<Texture> defaultVolume;
 
    std::vector<Task<LoadResult>> loadTasks;
+   std::vector<LoadResult> loadedResults;
+   std::unordered_set<TextureHandle> visibleTextures;
+   std::vector<PendingUpload> pendingUploads;
    std::unordered_map<Handle, ReplaceDelegate> replaceDelegates;
 };
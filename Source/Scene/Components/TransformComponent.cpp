@@ -1,24 +1,20 @@
 #include "Scene/Components/TransformComponent.h"
 
-Transform TransformComponent::getAbsoluteTransform() const
+namespace
 {
-   if (const TransformComponent* parentComponent = getParentComponent())
-   {
-      return parentComponent->getAbsoluteTransform() * transform;
-   }
-
-   return transform;
+   // Shared by all scenes (transforms are only updated on the main thread)
+   uint64_t lastAbsoluteTransformVersion = 0;
 }
 
-void TransformComponent::setAbsoluteTransform(const Transform& absoluteTransform)
+void TransformComponent::setAbsoluteTransform(const Transform& newAbsoluteTransform)
 {
    if (const TransformComponent* parentComponent = getParentComponent())
    {
-      transform = absoluteTransform.relativeTo(parentComponent->getAbsoluteTransform());
+      setRelativeTransform(newAbsoluteTransform.relativeTo(parentComponent->computeAbsoluteTransform()));
    }
    else
    {
-      transform = absoluteTransform;
+      setRelativeTransform(newAbsoluteTransform);
    }
 }
 
@@ -31,3 +27,41 @@ const TransformComponent* TransformComponent::getParentComponent() const
 {
    return parent ? parent.tryGetComponent<TransformComponent>() : nullptr;
 }
+
+Transform TransformComponent::computeAbsoluteTransform() const
+{
+   if (const TransformComponent* parentComponent = getParentComponent())
+   {
+      return parentComponent->computeAbsoluteTransform() * relativeTransform;
+   }
+
+   return relativeTransform;
+}
+
+bool TransformComponent::updateAbsoluteTransform(uint32_t updateIndex)
+{
+   if (lastUpdateIndex == updateIndex)
+   {
+      return changedInLastUpdate;
+   }
+
+   TransformComponent* parentComponent = getParentComponent();
+   bool parentChanged = parentComponent && parentComponent->updateAbsoluteTransform(updateIndex);
+
+   // Also catches the parent's transform component going away, which doesn't mark its children as dirty
+   bool hasParentComponent = parentComponent != nullptr;
+
+   changedInLastUpdate = dirty || parentChanged || hasParentComponent != hadParentComponent;
+   if (changedInLastUpdate)
+   {
+      absoluteTransform = parentComponent ? parentComponent->absoluteTransform * relativeTransform : relativeTransform;
+      absoluteMatrix = absoluteTransform.toMatrix();
+      absoluteTransformVersion = ++lastAbsoluteTransformVersion;
+
+      dirty = false;
+      hadParentComponent = hasParentComponent;
+   }
+
+   lastUpdateIndex = updateIndex;
+   return changedInLastUpdate;
+}
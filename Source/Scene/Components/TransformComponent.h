@@ -4,14 +4,75 @@
 
 #include "Scene/Entity.h"
 
-struct TransformComponent
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+// Absolute transforms are cached, and refreshed by Scene::updateTransforms() (which only recomputes components whose relative transform, parent, or ancestors changed)
+class TransformComponent
 {
-   Transform transform;
-   Entity parent;
+public:
+   const Transform& getRelativeTransform() const
+   {
+      return relativeTransform;
+   }
+
+   void setRelativeTransform(const Transform& newRelativeTransform)
+   {
+      relativeTransform = newRelativeTransform;
+      dirty = true;
+   }
+
+   Entity getParent() const
+   {
+      return parent;
+   }
+
+   void setParent(Entity newParent)
+   {
+      parent = newParent;
+      dirty = true;
+   }
+
+   const Transform& getAbsoluteTransform() const
+   {
+      return absoluteTransform;
+   }
+
+   const glm::mat4& getAbsoluteMatrix() const
+   {
+      return absoluteMatrix;
+   }
 
-   Transform getAbsoluteTransform() const;
-   void setAbsoluteTransform(const Transform& absoluteTransform);
+   // Changes whenever the cached absolute transform does, and is unique across all components (so a version recorded for one component never matches another)
+   uint64_t getAbsoluteTransformVersion() const
+   {
+      return absoluteTransformVersion;
+   }
+
+   void setAbsoluteTransform(const Transform& newAbsoluteTransform);
 
    TransformComponent* getParentComponent();
    const TransformComponent* getParentComponent() const;
+
+private:
+   friend class Scene;
+
+   // Walks up the parent chain, so it is correct even if the cache is out of date
+   Transform computeAbsoluteTransform() const;
+
+   // Updates the parent first, so each component is visited once per update (in topological order). Returns whether the absolute transform changed.
+   bool updateAbsoluteTransform(uint32_t updateIndex);
+
+   Transform relativeTransform;
+   Entity parent;
+
+   Transform absoluteTransform;
+   glm::mat4 absoluteMatrix = glm::mat4(1.0f);
+   uint64_t absoluteTransformVersion = 0;
+
+   uint32_t lastUpdateIndex = 0;
+   bool dirty = true;
+   bool changedInLastUpdate = false;
+   bool hadParentComponent = false;
 };
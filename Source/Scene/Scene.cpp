@@ -1,9 +1,8 @@
 #include "Scene/Scene.h"
 
-#if FORGE_WITH_MIDI
-#include "Platform/Midi.h"
-#endif // FORGE_WITH_MIDI
+#include "Core/Profiler.h"
 
+#include "Scene/Components/TransformComponent.h"
 #include "Scene/Entity.h"
 #include "Scene/System.h"
 
@@ -28,6 +27,8 @@ void Scene::removeTickDelegate(DelegateHandle handle)
 
 void Scene::tick(float dt)
 {
+   PROFILE_SCOPE("Scene::tick");
+
    float scaledDt = dt * timeScale;
 
    time += scaledDt;
@@ -42,6 +43,19 @@ void Scene::tick(float dt)
    }
 
    tickDelegate.broadcast(scaledDt);
+
+   updateTransforms();
+}
+
+void Scene::updateTransforms()
+{
+   PROFILE_SCOPE("Scene::updateTransforms");
+
+   uint32_t updateIndex = ++transformUpdateIndex;
+   registry.view<TransformComponent>().each([updateIndex](TransformComponent& transformComponent)
+   {
+      transformComponent.updateAbsoluteTransform(updateIndex);
+   });
 }
 
 void Scene::storeSystem(std::unique_ptr<System> system, std::type_index typeIndex)
@@ -6,6 +6,7 @@
 
 #include <entt/entity/registry.hpp>
 
+#include <cstdint>
 #include <memory>
 #include <typeindex>
 #include <typeinfo>
@@ -26,6 +27,9 @@ public:
 
    void tick(float dt);
 
+   // Refreshes the cached absolute transforms of every component whose transform (or any ancestor's) changed since the last update, also done at the end of each tick
+   void updateTransforms();
+
    float getTimeScale() const
    {
       return timeScale;
@@ -113,4 +117,6 @@ private:
 
    float rawTime = 0.0f;
    float rawDeltaTime = 0.0f;
+
+   uint32_t transformUpdateIndex = 0;
 };
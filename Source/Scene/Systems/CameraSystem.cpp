@@ -49,7 +49,7 @@ void CameraSystem::tick(float dt)
    TransformComponent* transformComponent = activeCameraEntity.tryGetComponent<TransformComponent>();
    if (transformComponent && activeCameraEntity.tryGetComponent<CameraComponent>())
    {
-      Transform& transform = transformComponent->transform;
+      Transform transform = transformComponent->getRelativeTransform();
 
       glm::vec3 euler = glm::degrees(glm::eulerAngles(transform.orientation));
       euler.x = glm::clamp(euler.x + lookInput.y * lookSpeed * 0.75f * scene.getRawDeltaTime(), -89.0f, 89.0f);
@@ -57,6 +57,8 @@ void CameraSystem::tick(float dt)
       transform.orientation = glm::quat(glm::radians(euler));
 
       transform.translateBy(transform.rotateVector(moveInput) * moveSpeed * scene.getRawDeltaTime());
+
+      transformComponent->setRelativeTransform(transform);
    }
 
    moveInput = glm::vec3(0.0f);
@@ -31,12 +31,16 @@ void OscillatingMovementSystem::tick(float dt)
       glm::quat lastRotation = glm::quat(glm::radians(evaluateOscillation(oscillatingMovementComponent.rotation, lastTime)));
       glm::quat currentRotation = glm::quat(glm::radians(evaluateOscillation(oscillatingMovementComponent.rotation, currentTime)));
       glm::quat rotationDiff = currentRotation * glm::inverse(lastRotation);
-      transformComponent.transform.rotateBy(rotationDiff);
+
+      Transform transform = transformComponent.getRelativeTransform();
+      transform.rotateBy(rotationDiff);
 
       glm::vec3 lastLocation = evaluateOscillation(oscillatingMovementComponent.location, lastTime);
       glm::vec3 currentLocation = evaluateOscillation(oscillatingMovementComponent.location, currentTime);
       glm::vec3 locationDiff = currentLocation - lastLocation;
-      transformComponent.transform.translateBy(locationDiff);
+      transform.translateBy(locationDiff);
+
+      transformComponent.setRelativeTransform(transform);
    });
 
    lastTime = currentTime;
@@ -1,11 +1,16 @@
 #include "UI/UI.h"
 
 #include "Core/Enum.h"
+#include "Core/Log.h"
+#include "Core/Memory/FrameAllocator.h"
+#include "Core/Profiler.h"
 
 #include "Graphics/GraphicsContext.h"
+#include "Graphics/UploadQueue.h"
 
 #include "Math/MathUtils.h"
 
+#include "Renderer/DrawStats.h"
 #include "Renderer/PhysicallyBasedMaterial.h"
 #include "Renderer/RenderSettings.h"
 
@@ -30,6 +35,14 @@
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_vulkan.h>
 
+#if FORGE_WITH_CPU_PROFILING
+#  include <PlatformUtils/IOUtils.h>
+#endif // FORGE_WITH_CPU_PROFILING
+
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -203,7 +216,11 @@ namespace
             ImGui::TextUnformatted("Relative");
          }
 
-         renderTransform(transformComponent.transform);
+         Transform relativeTransform = transformComponent.getRelativeTransform();
+         if (renderTransform(relativeTransform))
+         {
+            transformComponent.setRelativeTransform(relativeTransform);
+         }
 
          ImGui::TreePop();
       }
@@ -515,6 +532,199 @@ namespace
       }
    }
 
+   void renderDrawStats(const DrawStats& drawStats, std::span<const double, 3> averageRecordMilliseconds)
+   {
+      if (!ImGui::TreeNode("Draws"))
+      {
+         return;
+      }
+
+      if (ImGui::BeginTable("Draw Stats", 10, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+      {
+         ImGui::TableSetupColumn("Pass");
+         ImGui::TableSetupColumn("Draws");
+         ImGui::TableSetupColumn("Instances");
+         ImGui::TableSetupColumn("API Calls");
+         ImGui::TableSetupColumn("Pipelines");
+         ImGui::TableSetupColumn("Descriptors");
+         ImGui::TableSetupColumn("Buffers");
+         ImGui::TableSetupColumn("Secondaries");
+         ImGui::TableSetupColumn("Record (ms)");
+         ImGui::TableSetupColumn("Average");
+         ImGui::TableHeadersRow();
+
+         auto renderRow = [](const char* passName, const PassDrawStats& passStats, double averageMilliseconds)
+         {
+            ImGui::TableNextRow();
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(passName);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", passStats.draws);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", passStats.instances);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", passStats.drawCalls);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", passStats.pipelineBinds);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", passStats.descriptorSetBinds);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", passStats.bufferBinds);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", passStats.secondaryCommandBuffers);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", passStats.recordMilliseconds);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", averageMilliseconds);
+         };
+
+         renderRow("Normal", drawStats.normal, averageRecordMilliseconds[0]);
+         renderRow("Shadow", drawStats.shadow, averageRecordMilliseconds[1]);
+         renderRow("Forward", drawStats.forward, averageRecordMilliseconds[2]);
+
+         ImGui::EndTable();
+      }
+
+      const OcclusionStats& occlusionStats = drawStats.occlusion;
+      ImGui::Text("Occluders: %u (%u triangles)", occlusionStats.occluders, occlusionStats.occluderTriangles);
+      ImGui::Text("Occluded sections: %u / %u (%.3f ms)", occlusionStats.occludedSections, occlusionStats.testedSections, occlusionStats.milliseconds);
+
+      ImGui::TreePop();
+   }
+
+   void renderUploadStats(const UploadStats& uploadStats)
+   {
+      if (!ImGui::TreeNode("Uploads"))
+      {
+         return;
+      }
+
+      static const float kBytesPerKilobyte = 1024.0f;
+      static const float kBytesPerMegabyte = 1024.0f * 1024.0f;
+
+      ImGui::Text("Queue: %s", uploadStats.dedicatedTransferQueue ? "Dedicated transfer" : "Graphics");
+      ImGui::Text("Submitted batches: %u", uploadStats.submittedBatches);
+      ImGui::Text("Ownership transfers: %u", uploadStats.ownershipTransfers);
+      ImGui::Text("Staging buffers: %u, ring allocations: %u (%.1f KB)", uploadStats.stagingBuffers, uploadStats.stagingRingAllocations, uploadStats.stagingBytes / kBytesPerKilobyte);
+      ImGui::Text("Pending batches: %u", uploadStats.pendingBatches);
+
+      const StagingRingStats& ringStats = uploadStats.stagingRing;
+      ImGui::Text("Staging ring: %.1f / %.1f MB (peak %.1f MB)", ringStats.bytesInUse / kBytesPerMegabyte, ringStats.capacity / kBytesPerMegabyte, ringStats.peakBytesInUse / kBytesPerMegabyte);
+      ImGui::Text("Staging ring waits: %u", ringStats.numWaits);
+
+      ImGui::TreePop();
+   }
+
+   void renderFinalizeStats(ResourceManager& resourceManager)
+   {
+      if (!ImGui::TreeNode("Resource Finalization"))
+      {
+         return;
+      }
+
+      float budget = static_cast<float>(resourceManager.getFinalizeBudget());
+      if (ImGui::SliderFloat("Budget", &budget, 0.0f, 16.0f, "%.1f ms"))
+      {
+         resourceManager.setFinalizeBudget(budget);
+      }
+
+      const ResourceFinalizeStats& finalizeStats = resourceManager.getFinalizeStats();
+      ImGui::Text("Finalized: %u (%.3f ms)", finalizeStats.finalized, finalizeStats.milliseconds);
+      ImGui::Text("Queued meshes: %u, textures: %u", finalizeStats.queuedMeshes, finalizeStats.queuedTextures);
+
+      ImGui::TreePop();
+   }
+
+   void renderFrameAllocatorStats()
+   {
+      if (!ImGui::TreeNode("Frame Allocator"))
+      {
+         return;
+      }
+
+      static const float kBytesPerKilobyte = 1024.0f;
+
+      if (ImGui::BeginTable("Frame Allocator Stats", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+      {
+         ImGui::TableSetupColumn("Thread");
+         ImGui::TableSetupColumn("Used (KB)");
+         ImGui::TableSetupColumn("Peak (KB)");
+         ImGui::TableSetupColumn("Reserved (KB)");
+         ImGui::TableHeadersRow();
+
+         for (const FrameAllocatorStats& stats : FrameAllocatorBase::getStats())
+         {
+            ImGui::TableNextRow();
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", stats.threadIndex);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", stats.usedBytes / kBytesPerKilobyte);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", stats.peakBytes / kBytesPerKilobyte);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", stats.reservedBytes / kBytesPerKilobyte);
+         }
+
+         ImGui::EndTable();
+      }
+
+      ImGui::TreePop();
+   }
+
+#if FORGE_WITH_CPU_PROFILING
+   void renderProfilerZones()
+   {
+      if (!ImGui::TreeNode("CPU Zones"))
+      {
+         return;
+      }
+
+      if (ImGui::Button("Export Trace"))
+      {
+         if (std::optional<std::filesystem::path> tracePath = IOUtils::getAbsoluteAppDataPath(FORGE_PROJECT_NAME, "Trace.json"))
+         {
+            if (Profiler::exportChromeTrace(*tracePath))
+            {
+               LOG_INFO("Exported CPU trace to " << *tracePath);
+            }
+            else
+            {
+               LOG_WARNING("Failed to export CPU trace to " << *tracePath);
+            }
+         }
+      }
+
+      if (ImGui::BeginTable("CPU Zones", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+      {
+         ImGui::TableSetupColumn("Zone");
+         ImGui::TableSetupColumn("Calls");
+         ImGui::TableSetupColumn("Total (ms)");
+         ImGui::TableSetupColumn("Max (ms)");
+         ImGui::TableHeadersRow();
+
+         for (const Profiler::ZoneStats& stats : Profiler::getZoneStats())
+         {
+            ImGui::TableNextRow();
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(stats.name.data(), stats.name.data() + stats.name.size());
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", stats.calls);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.totalMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.maxMs);
+         }
+
+         ImGui::EndTable();
+      }
+
+      ImGui::TreePop();
+   }
+#endif // FORGE_WITH_CPU_PROFILING
+
    const float kWindowPadding = 5.0f;
 }
 
@@ -590,16 +800,26 @@ void UI::setIgnoreMouse(bool ignore)
 // static
 bool UI::visible = true;
 
-void UI::render(const GraphicsContext& graphicsContext, Scene& scene, const RenderCapabilities& capabilities, RenderSettings& settings, ResourceManager& resourceManager)
+void UI::render(const GraphicsContext& graphicsContext, Scene& scene, const RenderCapabilities& capabilities, const DrawStats& drawStats, RenderSettings& settings, ResourceManager& resourceManager)
 {
    static const float kTimeBetweenFrameRateUpdates = 1.0f / frameRates.size();
 
+   PROFILE_SCOPE("UI::render");
+
    if (!ImGui::GetCurrentContext())
    {
       return;
    }
    ImGuiIO& io = ImGui::GetIO();
 
+   // Measured separately from the scene's delta time, which is clamped
+   std::chrono::steady_clock::time_point renderTime = std::chrono::steady_clock::now();
+   if (lastRenderTime != std::chrono::steady_clock::time_point())
+   {
+      maxFrameTimeSinceUpdate = glm::max(maxFrameTimeSinceUpdate, std::chrono::duration<float, std::milli>(renderTime - lastRenderTime).count());
+   }
+   lastRenderTime = renderTime;
+
    io.DeltaTime = scene.getRawDeltaTime();
    timeUntilFrameRateUpdate -= scene.getRawDeltaTime();
    if (timeUntilFrameRateUpdate <= 0.0f)
@@ -608,23 +828,27 @@ void UI::render(const GraphicsContext& graphicsContext, Scene& scene, const Rend
 
       maxFrameRate = glm::max(maxFrameRate, io.Framerate);
       frameRates[frameIndex] = io.Framerate;
+      maxFrameTimes[frameIndex] = maxFrameTimeSinceUpdate;
+      maxFrameTimeSinceUpdate = 0.0f;
       frameIndex = (frameIndex + 1) % frameRates.size();
    }
 
+   updateAverageRecordTimes(drawStats);
+
    ImGui_ImplGlfw_NewFrame();
    ImGui_ImplVulkan_NewFrame();
    ImGui::NewFrame();
 
    if (isVisible())
    {
-      renderRendererWindow(graphicsContext, capabilities, settings);
+      renderRendererWindow(graphicsContext, capabilities, drawStats, settings, resourceManager);
       renderSceneWindow(scene, resourceManager);
    }
 
    ImGui::Render();
 }
 
-void UI::renderRendererWindow(const GraphicsContext& graphicsContext, const RenderCapabilities& renderCapabilities, RenderSettings& settings)
+void UI::renderRendererWindow(const GraphicsContext& graphicsContext, const RenderCapabilities& renderCapabilities, const DrawStats& drawStats, RenderSettings& settings, ResourceManager& resourceManager)
 {
    const float kRendererWindowWidth = 350.0f;
 
@@ -634,7 +858,7 @@ void UI::renderRendererWindow(const GraphicsContext& graphicsContext, const Rend
    {
       ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.5f);
 
-      renderFrameRate();
+      renderFrameRate(drawStats, graphicsContext.getUploadQueue().getStats(), resourceManager);
       renderSettings(graphicsContext, renderCapabilities, settings);
 
       ImGui::PopItemWidth();
@@ -663,7 +887,7 @@ void UI::renderSceneWindow(Scene& scene, ResourceManager& resourceManager)
    ImGui::End();
 }
 
-void UI::renderFrameRate()
+void UI::renderFrameRate(const DrawStats& drawStats, const UploadStats& uploadStats, ResourceManager& resourceManager)
 {
    if (!ImGui::CollapsingHeader("Performance", ImGuiTreeNodeFlags_DefaultOpen))
    {
@@ -674,6 +898,29 @@ void UI::renderFrameRate()
    std::string overlay = std::to_string(static_cast<int>(ImGui::GetIO().Framerate + 0.5f)) + " FPS";
    ImGui::PlotLines("###Frame Rate", frameRates.data(), static_cast<int>(frameRates.size()), static_cast<int>(frameIndex), overlay.c_str(), 0.0f, maxFrameRate, ImVec2(0, 240.0f));
    ImGui::PopItemWidth();
+
+   ImGui::Text("Longest frame: %.2f ms", *std::max_element(maxFrameTimes.begin(), maxFrameTimes.end()));
+
+   renderDrawStats(drawStats, averageRecordMilliseconds);
+   renderUploadStats(uploadStats);
+   renderFinalizeStats(resourceManager);
+   renderFrameAllocatorStats();
+
+#if FORGE_WITH_CPU_PROFILING
+   renderProfilerZones();
+#endif // FORGE_WITH_CPU_PROFILING
+}
+
+// Exponential moving averages, weighted so that the last hundred or so frames make up most of the average
+void UI::updateAverageRecordTimes(const DrawStats& drawStats)
+{
+   static const double kNewFrameWeight = 0.02;
+
+   std::array<double, 3> recordMilliseconds = { drawStats.normal.recordMilliseconds, drawStats.shadow.recordMilliseconds, drawStats.forward.recordMilliseconds };
+   for (std::size_t pass = 0; pass < recordMilliseconds.size(); ++pass)
+   {
+      averageRecordMilliseconds[pass] += (recordMilliseconds[pass] - averageRecordMilliseconds[pass]) * kNewFrameWeight;
+   }
 }
 
 void UI::renderTime(Scene& scene)
@@ -925,6 +1172,20 @@ void UI::renderSettings(const GraphicsContext& graphicsContext, const RenderCapa
       ImGui::TreePop();
    }
 
+   if (ImGui::TreeNodeEx("Command Recording", ImGuiTreeNodeFlags_DefaultOpen))
+   {
+      ImGui::Checkbox("Parallel", &settings.parallelCommandRecording);
+      ImGui::Checkbox("Automatic Instancing", &settings.automaticInstancing);
+      ImGui::Checkbox("Sort Draws By State", &settings.sortDrawsByState);
+      ImGui::Checkbox("Indirect Draws", &settings.indirectDraws);
+#if FORGE_WITH_GPU_CULLING
+      ImGui::Checkbox("GPU Culling", &settings.gpuCulling);
+#endif // FORGE_WITH_GPU_CULLING
+      ImGui::Checkbox("Software Occlusion Culling", &settings.softwareOcclusionCulling);
+
+      ImGui::TreePop();
+   }
+
    if (ImGui::TreeNodeEx("Tonemapping", ImGuiTreeNodeFlags_DefaultOpen))
    {
       ImGui::Checkbox("Show Test Pattern", &settings.tonemapSettings.showTestPattern);
@@ -996,7 +1257,7 @@ void UI::renderEntityList(Scene& scene)
       bool hasParent = false;
       if (TransformComponent* transformComponent = entity.tryGetComponent<TransformComponent>())
       {
-         if (Entity parent = transformComponent->parent)
+         if (Entity parent = transformComponent->getParent())
          {
             hasParent = true;
 
@@ -3,12 +3,15 @@
 #include "Scene/Entity.h"
 
 #include <array>
+#include <chrono>
 
 class GraphicsContext;
 class ResourceManager;
 class Scene;
+struct DrawStats;
 struct RenderCapabilities;
 struct RenderSettings;
+struct UploadStats;
 
 class UI
 {
@@ -23,12 +26,13 @@ public:
    static bool wantsKeyboardInput();
    static void setIgnoreMouse(bool ignore);
 
-   void render(const GraphicsContext& graphicsContext, Scene& scene, const RenderCapabilities& renderCapabilities, RenderSettings& settings, ResourceManager& resourceManager);
+   void render(const GraphicsContext& graphicsContext, Scene& scene, const RenderCapabilities& renderCapabilities, const DrawStats& drawStats, RenderSettings& settings, ResourceManager& resourceManager);
 
 private:
-   void renderRendererWindow(const GraphicsContext& graphicsContext, const RenderCapabilities& renderCapabilities, RenderSettings& settings);
+   void renderRendererWindow(const GraphicsContext& graphicsContext, const RenderCapabilities& renderCapabilities, const DrawStats& drawStats, RenderSettings& settings, ResourceManager& resourceManager);
    void renderSceneWindow(Scene& scene, ResourceManager& resourceManager);
-   void renderFrameRate();
+   void renderFrameRate(const DrawStats& drawStats, const UploadStats& uploadStats, ResourceManager& resourceManager);
+   void updateAverageRecordTimes(const DrawStats& drawStats);
    void renderTime(Scene& scene);
    void renderSettings(const GraphicsContext& graphicsContext, const RenderCapabilities& renderCapabilities, RenderSettings& settings);
    void renderEntityList(Scene& scene);
@@ -41,5 +45,13 @@ private:
    uint32_t frameIndex = 0;
    std::array<float, 100> frameRates{};
 
+   // Longest frame in each frame rate update interval, to catch hitches that the averaged frame rate hides
+   std::array<float, 100> maxFrameTimes{};
+   float maxFrameTimeSinceUpdate = 0.0f;
+   std::chrono::steady_clock::time_point lastRenderTime;
+
+   // Record times of the normal, shadow, and forward passes averaged over many frames, which are steady enough to compare single threaded and parallel recording
+   std::array<double, 3> averageRecordMilliseconds{};
+
    Entity selectedEntity;
 };
@@ -0,0 +1,26 @@
+set(TEST_DIR "${PROJECT_SOURCE_DIR}/Tests")
+set(TEST_TARGET_NAME "${PROJECT_NAME}Tests")
+
+add_executable(${TEST_TARGET_NAME} "")
+target_link_libraries(${TEST_TARGET_NAME} PRIVATE ${CORE_LIBRARY_NAME})
+
+target_sources(${TEST_TARGET_NAME} PRIVATE
+   "${TEST_DIR}/CoreTests.cpp"
+   "${TEST_DIR}/GraphicsTests.cpp"
+   "${TEST_DIR}/MathTests.cpp"
+   "${TEST_DIR}/Test.cpp"
+   "${TEST_DIR}/Test.h"
+   "${TEST_DIR}/TestMain.cpp"
+)
+
+get_target_property(TEST_SOURCE_FILES ${TEST_TARGET_NAME} SOURCES)
+source_group(TREE "${TEST_DIR}" PREFIX Tests FILES ${TEST_SOURCE_FILES})
+
+# Replaces the global allocation functions, so it is compiled into each executable that counts allocations instead of into the core library (added after grouping the
+# sources above, since it lives outside of their directory)
+target_sources(${TEST_TARGET_NAME} PRIVATE
+   "${SRC_DIR}/Core/Memory/AllocationCounter.cpp"
+   "${SRC_DIR}/Core/Memory/AllocationCounter.h"
+)
+
+add_test(NAME ${TEST_TARGET_NAME} COMMAND ${TEST_TARGET_NAME})
@@ -0,0 +1,299 @@
+#include "Test.h"
+
+#include "Core/Delegate.h"
+#include "Core/Hash.h"
+#include "Core/Memory/RangeAllocator.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace
+{
+   // Every byte is part of the value, but only the key takes part in equality and hashing
+   struct KeyedValue
+   {
+      uint32_t key = 0;
+      uint32_t cachedValue = 0;
+
+      std::size_t hash() const
+      {
+         return Hash::of(key);
+      }
+
+      bool operator==(const KeyedValue& other) const
+      {
+         return key == other.key;
+      }
+   };
+}
+
+USE_MEMBER_HASH_FUNCTION(KeyedValue);
+
+namespace
+{
+   // Captures as much state as a typical member function lambda does
+   void delegateInline(Test::Context& context)
+   {
+      float total = 0.0f;
+      float scale = 0.5f;
+      uint32_t calls = 0;
+
+      uint64_t allocationsBefore = Test::getAllocationCount();
+
+      Delegate<void, float> delegate;
+      delegate.bind([&total, &scale, &calls](float dt)
+      {
+         total += dt * scale;
+         ++calls;
+      });
+      delegate.execute(1.0f);
+      delegate.executeIfBound(1.0f);
+
+      Delegate<void, float> movedDelegate = std::move(delegate);
+      movedDelegate.execute(1.0f);
+      movedDelegate.unbind();
+      movedDelegate.executeIfBound(1.0f);
+
+      CHECK(context, Test::getAllocationCount() == allocationsBefore);
+      CHECK(context, calls == 3);
+      CHECK(context, total == 1.5f);
+   }
+
+   // Makes sure that allocations are counted at all, so that the other delegate tests can't pass by accident
+   void delegateHeapFallback(Test::Context& context)
+   {
+      std::array<uint64_t, kDefaultInlineFunctionCapacity> large{};
+      large[0] = 1;
+
+      uint64_t allocationsBefore = Test::getAllocationCount();
+
+      Delegate<uint64_t> delegate;
+      delegate.bind([large]() { return large[0]; });
+
+      CHECK(context, Test::getAllocationCount() > allocationsBefore);
+      CHECK(context, delegate.execute() == 1);
+   }
+
+   void multicastDelegateBroadcast(Test::Context& context)
+   {
+      static const uint32_t kNumListeners = 16;
+
+      float total = 0.0f;
+      float scale = 0.5f;
+      uint32_t calls = 0;
+
+      // Adding listeners grows the list of delegates, which is the only allocation that adding an inline sized listener may make
+      uint64_t allocationsBefore = Test::getAllocationCount();
+      MulticastDelegate<void, float> emptyDelegate;
+      for (uint32_t i = 0; i < kNumListeners; ++i)
+      {
+         emptyDelegate.add([](float dt) {});
+      }
+      uint64_t listAllocations = Test::getAllocationCount() - allocationsBefore;
+
+      allocationsBefore = Test::getAllocationCount();
+      MulticastDelegate<void, float> delegate;
+      std::array<DelegateHandle, kNumListeners> handles;
+      for (uint32_t i = 0; i < kNumListeners; ++i)
+      {
+         handles[i] = delegate.add([&total, &scale, &calls](float dt)
+         {
+            total += dt * scale;
+            ++calls;
+         });
+      }
+      CHECK(context, Test::getAllocationCount() - allocationsBefore == listAllocations);
+
+      allocationsBefore = Test::getAllocationCount();
+      for (uint32_t i = 0; i < 100; ++i)
+      {
+         delegate.broadcast(1.0f);
+      }
+      CHECK(context, delegate.remove(handles[0]));
+      delegate.broadcast(1.0f);
+      CHECK(context, Test::getAllocationCount() == allocationsBefore);
+
+      CHECK(context, calls == 100 * kNumListeners + kNumListeners - 1);
+   }
+
+   // Spans of types with a hash function of their own have to use it, rather than hashing their bytes in bulk
+   void hashSpanUsesElementHash(Test::Context& context)
+   {
+      std::array<KeyedValue, 3> values = { KeyedValue{ 1, 10 }, KeyedValue{ 2, 20 }, KeyedValue{ 3, 30 } };
+      std::array<KeyedValue, 3> equalValues = { KeyedValue{ 1, 11 }, KeyedValue{ 2, 21 }, KeyedValue{ 3, 31 } };
+
+      CHECK(context, std::equal(values.begin(), values.end(), equalValues.begin()));
+      CHECK(context, Hash::of(std::span<const KeyedValue>(values)) == Hash::of(std::span<const KeyedValue>(equalValues)));
+
+      std::array<uint32_t, 3> keys = { 1, 2, 3 };
+      std::array<uint32_t, 3> otherKeys = { 1, 2, 4 };
+      CHECK(context, Hash::of(std::span<const uint32_t>(keys)) != Hash::of(std::span<const uint32_t>(otherKeys)));
+   }
+
+   void rangeAllocatorFirstFit(Test::Context& context)
+   {
+      RangeAllocator allocator(100);
+      CHECK(context, allocator.allocate(10) == 0);
+      CHECK(context, allocator.allocate(20) == 10);
+      CHECK(context, allocator.allocate(30) == 30);
+      CHECK(context, allocator.getFreeSize() == 40);
+
+      // Leaves free ranges of 10 (at 0) and 70 (at 30, merged with the unused space at the end)
+      allocator.free(0, 10);
+      allocator.free(30, 30);
+
+      // Each allocation takes the first range that is large enough
+      CHECK(context, allocator.allocate(5) == 0);
+      CHECK(context, allocator.allocate(25) == 30);
+      CHECK(context, allocator.allocate(40) == 55);
+      CHECK(context, allocator.allocate(6) == RangeAllocator::kInvalidOffset);
+      CHECK(context, allocator.allocate(5) == 5);
+      CHECK(context, allocator.allocate(5) == 95);
+      CHECK(context, allocator.getFreeSize() == 0);
+      CHECK(context, allocator.allocate(1) == RangeAllocator::kInvalidOffset);
+   }
+
+   void rangeAllocatorCoalescing(Test::Context& context)
+   {
+      RangeAllocator allocator(40);
+      for (uint32_t i = 0; i < 4; ++i)
+      {
+         CHECK(context, allocator.allocate(10) == i * 10);
+      }
+
+      // Merging with the next range, then the previous one, then both
+      allocator.free(10, 10);
+      allocator.free(0, 10);
+      CHECK(context, allocator.allocate(20) == 0);
+
+      allocator.free(0, 10);
+      allocator.free(10, 10);
+      CHECK(context, allocator.allocate(20) == 0);
+
+      allocator.free(0, 10);
+      allocator.free(20, 10);
+      allocator.free(10, 10);
+      CHECK(context, allocator.allocate(30) == 0);
+
+      allocator.free(0, 30);
+      allocator.free(30, 10);
+      CHECK(context, allocator.getFreeSize() == 40);
+      CHECK(context, allocator.allocate(40) == 0);
+   }
+
+   void rangeAllocatorFragmentation(Test::Context& context)
+   {
+      RangeAllocator allocator(100);
+      for (uint32_t i = 0; i < 10; ++i)
+      {
+         CHECK(context, allocator.allocate(10) == i * 10);
+      }
+
+      // Half of the space is free, but no more than 10 of it is contiguous
+      for (uint32_t i = 0; i < 10; i += 2)
+      {
+         allocator.free(i * 10, 10);
+      }
+      CHECK(context, allocator.getFreeSize() == 50);
+      CHECK(context, allocator.allocate(11) == RangeAllocator::kInvalidOffset);
+      CHECK(context, allocator.allocate(10) == 0);
+
+      // Freeing the ranges between the holes joins them back up
+      for (uint32_t i = 1; i < 10; i += 2)
+      {
+         allocator.free(i * 10, 10);
+      }
+      CHECK(context, allocator.allocate(90) == 10);
+   }
+
+   // Random allocations and frees, checked against a simple map of which units are in use
+   void rangeAllocatorRandom(Test::Context& context)
+   {
+      struct Allocation
+      {
+         uint32_t offset = 0;
+         uint32_t size = 0;
+      };
+
+      static const uint32_t kCapacity = 1000;
+
+      RangeAllocator allocator(kCapacity);
+      std::vector<uint8_t> used(kCapacity);
+      std::vector<Allocation> allocations;
+      std::minstd_rand random(1);
+
+      uint32_t numOverlaps = 0;
+      uint32_t numMissedFits = 0;
+      for (uint32_t i = 0; i < 20000; ++i)
+      {
+         if (allocations.empty() || random() % 2 == 0)
+         {
+            uint32_t size = 1 + random() % 50;
+            uint32_t offset = allocator.allocate(size);
+            if (offset == RangeAllocator::kInvalidOffset)
+            {
+               // Only fails if there really is no free range that's large enough
+               uint32_t run = 0;
+               for (uint32_t unit = 0; unit < kCapacity && run < size; ++unit)
+               {
+                  run = used[unit] ? 0 : run + 1;
+               }
+               numMissedFits += run >= size ? 1 : 0;
+               continue;
+            }
+
+            for (uint32_t unit = offset; unit < offset + size; ++unit)
+            {
+               numOverlaps += used[unit];
+               used[unit] = 1;
+            }
+            allocations.push_back(Allocation{ offset, size });
+         }
+         else
+         {
+            std::size_t index = random() % allocations.size();
+            Allocation allocation = allocations[index];
+            allocations[index] = allocations.back();
+            allocations.pop_back();
+
+            allocator.free(allocation.offset, allocation.size);
+            for (uint32_t unit = allocation.offset; unit < allocation.offset + allocation.size; ++unit)
+            {
+               used[unit] = 0;
+            }
+         }
+      }
+
+      CHECK(context, numOverlaps == 0);
+      CHECK(context, numMissedFits == 0);
+
+      uint32_t numUsed = 0;
+      for (uint8_t unit : used)
+      {
+         numUsed += unit;
+      }
+      CHECK(context, allocator.getFreeSize() == kCapacity - numUsed);
+
+      for (const Allocation& allocation : allocations)
+      {
+         allocator.free(allocation.offset, allocation.size);
+      }
+      CHECK(context, allocator.allocate(kCapacity) == 0);
+   }
+}
+
+void registerCoreTests(Test::Registry& registry)
+{
+   registry.add("Core/Delegate/Inline", delegateInline);
+   registry.add("Core/Delegate/HeapFallback", delegateHeapFallback);
+   registry.add("Core/MulticastDelegate/Broadcast", multicastDelegateBroadcast);
+   registry.add("Core/Hash/SpanUsesElementHash", hashSpanUsesElementHash);
+   registry.add("Core/RangeAllocator/FirstFit", rangeAllocatorFirstFit);
+   registry.add("Core/RangeAllocator/Coalescing", rangeAllocatorCoalescing);
+   registry.add("Core/RangeAllocator/Fragmentation", rangeAllocatorFragmentation);
+   registry.add("Core/RangeAllocator/Random", rangeAllocatorRandom);
+}
@@ -0,0 +1,107 @@
+#include "Test.h"
+
+#include "Graphics/QueueOwnership.h"
+
+#include <vector>
+
+namespace
+{
+   vk::QueueFamilyProperties createQueueFamily(vk::QueueFlags queueFlags, uint32_t queueCount = 1)
+   {
+      // Returned-only structure, so it has no setters
+      vk::QueueFamilyProperties queueFamily;
+      queueFamily.queueFlags = queueFlags;
+      queueFamily.queueCount = queueCount;
+      return queueFamily;
+   }
+
+   void queueOwnershipSelectTransferFamily(Test::Context& context)
+   {
+      vk::QueueFlags graphics = vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute | vk::QueueFlagBits::eTransfer;
+      vk::QueueFlags compute = vk::QueueFlagBits::eCompute | vk::QueueFlagBits::eTransfer;
+      vk::QueueFlags transfer = vk::QueueFlagBits::eTransfer;
+
+      // Only one family (e.g. lavapipe), so uploads stay on the graphics queue
+      std::vector<vk::QueueFamilyProperties> singleFamily = { createQueueFamily(graphics) };
+      CHECK(context, QueueOwnership::selectTransferFamily(singleFamily, 0) == 0);
+
+      // A transfer-only family wins over an async compute family that comes before it
+      std::vector<vk::QueueFamilyProperties> discrete = { createQueueFamily(graphics), createQueueFamily(compute), createQueueFamily(transfer) };
+      CHECK(context, QueueOwnership::selectTransferFamily(discrete, 0) == 2);
+
+      // The first async compute family is used when there is no transfer-only family
+      std::vector<vk::QueueFamilyProperties> computeOnly = { createQueueFamily(compute), createQueueFamily(graphics), createQueueFamily(compute) };
+      CHECK(context, QueueOwnership::selectTransferFamily(computeOnly, 1) == 0);
+
+      // Compute families can do transfers without reporting it
+      std::vector<vk::QueueFamilyProperties> unreportedTransfer = { createQueueFamily(graphics), createQueueFamily(vk::QueueFlagBits::eCompute) };
+      CHECK(context, QueueOwnership::selectTransferFamily(unreportedTransfer, 0) == 1);
+
+      // Families without queues, and ones that can't do transfers at all, are skipped
+      std::vector<vk::QueueFamilyProperties> unusable = { createQueueFamily(graphics), createQueueFamily(transfer, 0), createQueueFamily(vk::QueueFlagBits::eSparseBinding), createQueueFamily(graphics) };
+      CHECK(context, QueueOwnership::selectTransferFamily(unusable, 0) == 0);
+
+      // Other graphics families are never picked, since they would need the same ownership transfers without running on a separate engine
+      std::vector<vk::QueueFamilyProperties> twoGraphicsFamilies = { createQueueFamily(graphics), createQueueFamily(graphics) };
+      CHECK(context, QueueOwnership::selectTransferFamily(twoGraphicsFamilies, 0) == 0);
+   }
+
+   void queueOwnershipBufferTransfer(Test::Context& context)
+   {
+      static const uint32_t kTransferFamilyIndex = 2;
+      static const uint32_t kGraphicsFamilyIndex = 0;
+
+      vk::AccessFlags dstAccessMask = vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead;
+      QueueOwnership::Transfer<vk::BufferMemoryBarrier> transfer = QueueOwnership::createBufferTransfer(kTransferFamilyIndex, kGraphicsFamilyIndex, vk::Buffer(), 256, 1024, dstAccessMask);
+
+      // Both halves have to describe the same transfer of the same range
+      for (const vk::BufferMemoryBarrier& barrier : { transfer.release, transfer.acquire })
+      {
+         CHECK(context, barrier.srcQueueFamilyIndex == kTransferFamilyIndex);
+         CHECK(context, barrier.dstQueueFamilyIndex == kGraphicsFamilyIndex);
+         CHECK(context, barrier.offset == 256);
+         CHECK(context, barrier.size == 1024);
+      }
+
+      CHECK(context, transfer.release.srcAccessMask == vk::AccessFlagBits::eTransferWrite);
+      CHECK(context, !transfer.release.dstAccessMask);
+      CHECK(context, !transfer.acquire.srcAccessMask);
+      CHECK(context, transfer.acquire.dstAccessMask == dstAccessMask);
+   }
+
+   void queueOwnershipImageTransfer(Test::Context& context)
+   {
+      static const uint32_t kTransferFamilyIndex = 1;
+      static const uint32_t kGraphicsFamilyIndex = 0;
+
+      vk::ImageSubresourceRange subresourceRange = vk::ImageSubresourceRange()
+         .setAspectMask(vk::ImageAspectFlagBits::eColor)
+         .setBaseMipLevel(0)
+         .setLevelCount(10)
+         .setBaseArrayLayer(0)
+         .setLayerCount(6);
+      QueueOwnership::Transfer<vk::ImageMemoryBarrier> transfer = QueueOwnership::createImageTransfer(kTransferFamilyIndex, kGraphicsFamilyIndex, vk::Image(), subresourceRange, vk::ImageLayout::eTransferDstOptimal);
+
+      // A layout change in only one half would make the transfer invalid, so neither half changes it
+      for (const vk::ImageMemoryBarrier& barrier : { transfer.release, transfer.acquire })
+      {
+         CHECK(context, barrier.srcQueueFamilyIndex == kTransferFamilyIndex);
+         CHECK(context, barrier.dstQueueFamilyIndex == kGraphicsFamilyIndex);
+         CHECK(context, barrier.oldLayout == vk::ImageLayout::eTransferDstOptimal);
+         CHECK(context, barrier.newLayout == vk::ImageLayout::eTransferDstOptimal);
+         CHECK(context, barrier.subresourceRange == subresourceRange);
+      }
+
+      CHECK(context, transfer.release.srcAccessMask == vk::AccessFlagBits::eTransferWrite);
+      CHECK(context, !transfer.release.dstAccessMask);
+      CHECK(context, !transfer.acquire.srcAccessMask);
+      CHECK(context, transfer.acquire.dstAccessMask == (vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite));
+   }
+}
+
+void registerGraphicsTests(Test::Registry& registry)
+{
+   registry.add("Graphics/QueueOwnership/SelectTransferFamily", queueOwnershipSelectTransferFamily);
+   registry.add("Graphics/QueueOwnership/BufferTransfer", queueOwnershipBufferTransfer);
+   registry.add("Graphics/QueueOwnership/ImageTransfer", queueOwnershipImageTransfer);
+}
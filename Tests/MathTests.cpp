@@ -0,0 +1,605 @@
+#include "Test.h"
+
+#include "Math/Bounds.h"
+#include "Math/BoundingVolumeHierarchy.h"
+#include "Math/Frustum.h"
+#include "Math/FrustumBatch.h"
+#include "Math/FrustumCulling.h"
+#include "Math/OcclusionBuffer.h"
+#include "Math/Transform.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+   const uint32_t kOcclusionWidth = 64;
+   const uint32_t kOcclusionHeight = 32;
+
+   // With an identity transform, positions map straight onto the occlusion buffer, so they can be given in pixels
+   glm::vec3 pixelPosition(float x, float y, float depth)
+   {
+      return glm::vec3(x / kOcclusionWidth * 2.0f - 1.0f, y / kOcclusionHeight * 2.0f - 1.0f, depth);
+   }
+
+   // Depth changes linearly from the left to the right of the rectangle
+   void addRectangle(std::vector<glm::vec3>& triangles, float minX, float minY, float maxX, float maxY, float leftDepth, float rightDepth)
+   {
+      glm::vec3 bottomLeft = pixelPosition(minX, minY, leftDepth);
+      glm::vec3 bottomRight = pixelPosition(maxX, minY, rightDepth);
+      glm::vec3 topLeft = pixelPosition(minX, maxY, leftDepth);
+      glm::vec3 topRight = pixelPosition(maxX, maxY, rightDepth);
+
+      triangles.insert(triangles.end(), { bottomLeft, bottomRight, topRight, bottomLeft, topRight, topLeft });
+   }
+
+   bool isBoxOccluded(const OcclusionBuffer& occlusionBuffer, float minX, float minY, float maxX, float maxY, float minDepth, float maxDepth)
+   {
+      return occlusionBuffer.isOccluded(pixelPosition(minX, minY, minDepth), pixelPosition(maxX, maxY, maxDepth), glm::mat4(1.0f));
+   }
+
+   void occlusionOccluded(Test::Context& context)
+   {
+      OcclusionBuffer occlusionBuffer(kOcclusionWidth, kOcclusionHeight);
+      CHECK(context, !isBoxOccluded(occlusionBuffer, 10.0f, 5.0f, 20.0f, 15.0f, 0.6f, 0.7f));
+
+      std::vector<glm::vec3> triangles;
+      addRectangle(triangles, -8.0f, -8.0f, kOcclusionWidth + 8.0f, kOcclusionHeight + 8.0f, 0.5f, 0.5f);
+      occlusionBuffer.rasterize(triangles, glm::mat4(1.0f));
+      occlusionBuffer.updateTiles();
+
+      CHECK(context, isBoxOccluded(occlusionBuffer, 10.0f, 5.0f, 20.0f, 15.0f, 0.6f, 0.7f));
+      CHECK(context, isBoxOccluded(occlusionBuffer, -4.0f, -4.0f, 4.0f, 4.0f, 0.6f, 0.7f));
+      CHECK(context, !isBoxOccluded(occlusionBuffer, 10.0f, 5.0f, 20.0f, 15.0f, 0.4f, 0.45f));
+      CHECK(context, !isBoxOccluded(occlusionBuffer, 10.0f, 5.0f, 20.0f, 15.0f, 0.45f, 0.55f));
+   }
+
+   void occlusionPartlyVisible(Test::Context& context)
+   {
+      OcclusionBuffer occlusionBuffer(kOcclusionWidth, kOcclusionHeight);
+
+      // The edge of the occluder is past the center of pixel 10, but doesn't cover all of it. The occluder is made of two triangles, which shouldn't leave a gap
+      // along the edge between them.
+      std::vector<glm::vec3> triangles;
+      addRectangle(triangles, -8.0f, -8.0f, 10.7f, kOcclusionHeight + 8.0f, 0.5f, 0.5f);
+      occlusionBuffer.rasterize(triangles, glm::mat4(1.0f));
+      occlusionBuffer.updateTiles();
+
+      CHECK(context, occlusionBuffer.getDepth(9, 0) < 0.51f);
+      CHECK(context, occlusionBuffer.getDepth(10, 0) == 1.0f);
+
+      CHECK(context, isBoxOccluded(occlusionBuffer, 2.0f, 5.0f, 9.5f, 15.0f, 0.6f, 0.7f));
+      CHECK(context, !isBoxOccluded(occlusionBuffer, 9.0f, 5.0f, 10.9f, 15.0f, 0.6f, 0.7f));
+      CHECK(context, !isBoxOccluded(occlusionBuffer, 5.0f, 5.0f, 30.0f, 15.0f, 0.6f, 0.7f));
+
+      // A sloped occluder is further away at the right edge of each pixel than at its center, so a box at the right edge of a pixel can be visible even if it is
+      // behind the occluder's depth at the center
+      occlusionBuffer.clear();
+      triangles.clear();
+      addRectangle(triangles, -8.0f, -8.0f, kOcclusionWidth + 8.0f, kOcclusionHeight + 8.0f, 0.5f - 8.0f * 0.001f, 0.5f + (kOcclusionWidth + 8.0f) * 0.001f);
+      occlusionBuffer.rasterize(triangles, glm::mat4(1.0f));
+      occlusionBuffer.updateTiles();
+
+      CHECK(context, !isBoxOccluded(occlusionBuffer, 5.6f, 5.2f, 5.9f, 5.8f, 0.5055f, 0.51f));
+      CHECK(context, isBoxOccluded(occlusionBuffer, 5.6f, 5.2f, 5.9f, 5.8f, 0.507f, 0.51f));
+   }
+
+   void occlusionNearPlane(Test::Context& context)
+   {
+      glm::mat4 worldToClip = glm::perspective(glm::radians(90.0f), 2.0f, 0.1f, 100.0f) * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+      OcclusionBuffer occlusionBuffer(kOcclusionWidth, kOcclusionHeight);
+
+      // Occluders that cross the near plane are skipped entirely
+      std::vector<glm::vec3> triangles = { glm::vec3(-100.0f, -1.0f, -100.0f), glm::vec3(100.0f, 10.0f, -100.0f), glm::vec3(0.0f, 10.0f, 100.0f) };
+      occlusionBuffer.rasterize(triangles, worldToClip);
+      occlusionBuffer.updateTiles();
+
+      bool anyCovered = false;
+      for (uint32_t y = 0; y < occlusionBuffer.getHeight(); ++y)
+      {
+         for (uint32_t x = 0; x < occlusionBuffer.getWidth(); ++x)
+         {
+            anyCovered |= occlusionBuffer.getDepth(x, y) < 1.0f;
+         }
+      }
+      CHECK(context, !anyCovered);
+
+      // A wall just past the near plane that covers the whole view
+      triangles = { glm::vec3(-100.0f, 0.2f, -100.0f), glm::vec3(100.0f, 0.2f, -100.0f), glm::vec3(100.0f, 0.2f, 100.0f), glm::vec3(-100.0f, 0.2f, -100.0f), glm::vec3(100.0f, 0.2f, 100.0f), glm::vec3(-100.0f, 0.2f, 100.0f) };
+      occlusionBuffer.rasterize(triangles, worldToClip);
+      occlusionBuffer.updateTiles();
+
+      CHECK(context, occlusionBuffer.isOccluded(glm::vec3(-1.0f, 5.0f, -1.0f), glm::vec3(1.0f, 7.0f, 1.0f), worldToClip));
+
+      // Boxes that reach behind the near plane (or the camera) are never occluded, even though their projections can land anywhere on screen
+      CHECK(context, !occlusionBuffer.isOccluded(glm::vec3(-1.0f, 0.05f, -1.0f), glm::vec3(1.0f, 7.0f, 1.0f), worldToClip));
+      CHECK(context, !occlusionBuffer.isOccluded(glm::vec3(-1.0f, -7.0f, -1.0f), glm::vec3(1.0f, 7.0f, 1.0f), worldToClip));
+      CHECK(context, !occlusionBuffer.isOccluded(glm::vec3(-1.0f, -7.0f, -1.0f), glm::vec3(1.0f, -5.0f, 1.0f), worldToClip));
+   }
+
+   // Occludees are tested with their world bounds, which have to cover every corner of a rotated box, or corners that stick out past an occluder's edge are missed
+   void occlusionRotatedOccludee(Test::Context& context)
+   {
+      glm::mat4 worldToClip = glm::perspective(glm::radians(90.0f), 2.0f, 0.1f, 100.0f) * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+      OcclusionBuffer occlusionBuffer(kOcclusionWidth, kOcclusionHeight);
+
+      // A wall that covers the left half of the view
+      std::vector<glm::vec3> triangles = { glm::vec3(-100.0f, 10.0f, -100.0f), glm::vec3(0.0f, 10.0f, -100.0f), glm::vec3(0.0f, 10.0f, 100.0f), glm::vec3(-100.0f, 10.0f, -100.0f), glm::vec3(0.0f, 10.0f, 100.0f), glm::vec3(-100.0f, 10.0f, 100.0f) };
+      occlusionBuffer.rasterize(triangles, worldToClip);
+      occlusionBuffer.updateTiles();
+
+      Bounds localBounds(glm::vec3(0.0f), glm::vec3(1.0f));
+      glm::quat orientation = glm::angleAxis(glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+
+      // Rotated by 45 degrees, one corner reaches x = -1.2 + sqrt(2), past the edge of the wall
+      Bounds partlyHidden = Transform(orientation, glm::vec3(-1.2f, 20.0f, 0.0f), glm::vec3(1.0f)).transformBounds(localBounds);
+      CHECK(context, !occlusionBuffer.isOccluded(partlyHidden.getMin(), partlyHidden.getMax(), worldToClip));
+
+      // Mirroring doesn't change which space the box covers
+      Bounds mirrored = Transform(orientation, glm::vec3(-1.2f, 20.0f, 0.0f), glm::vec3(-1.0f, 1.0f, -1.0f)).transformBounds(localBounds);
+      CHECK(context, !occlusionBuffer.isOccluded(mirrored.getMin(), mirrored.getMax(), worldToClip));
+
+      Bounds hidden = Transform(orientation, glm::vec3(-5.0f, 20.0f, 0.0f), glm::vec3(1.0f)).transformBounds(localBounds);
+      CHECK(context, occlusionBuffer.isOccluded(hidden.getMin(), hidden.getMax(), worldToClip));
+   }
+
+   // The SIMD rasterizer is supposed to produce exactly the same depths as the scalar one
+   void occlusionSimdMatchesScalar(Test::Context& context)
+   {
+      std::minstd_rand random(1);
+      auto nextFloat = [&random](float min, float max)
+      {
+         return min + (max - min) * (static_cast<float>(random() - std::minstd_rand::min()) / static_cast<float>(std::minstd_rand::max() - std::minstd_rand::min()));
+      };
+
+      std::vector<glm::vec3> triangles;
+      for (uint32_t i = 0; i < 500; ++i)
+      {
+         glm::vec3 center(nextFloat(-50.0f, 50.0f), nextFloat(5.0f, 100.0f), nextFloat(-20.0f, 20.0f));
+         for (uint32_t vertex = 0; vertex < 3; ++vertex)
+         {
+            triangles.push_back(center + glm::vec3(nextFloat(-10.0f, 10.0f), nextFloat(-10.0f, 10.0f), nextFloat(-10.0f, 10.0f)));
+         }
+      }
+
+      glm::mat4 worldToClip = glm::perspective(glm::radians(70.0f), 2.0f, 0.1f, 1000.0f) * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+
+      // Includes a width that isn't a multiple of the tile width, to cover vectors that straddle the right edge of triangles' bounding boxes
+      for (glm::uvec2 size : { glm::uvec2(256, 128), glm::uvec2(100, 50) })
+      {
+         OcclusionBuffer simdBuffer(size.x, size.y);
+         OcclusionBuffer scalarBuffer(size.x, size.y);
+         simdBuffer.rasterize(triangles, worldToClip);
+         scalarBuffer.rasterizeScalar(triangles, worldToClip);
+
+         uint32_t numCovered = 0;
+         uint32_t numMismatched = 0;
+         for (uint32_t y = 0; y < simdBuffer.getHeight(); ++y)
+         {
+            for (uint32_t x = 0; x < simdBuffer.getWidth(); ++x)
+            {
+               numCovered += simdBuffer.getDepth(x, y) < 1.0f ? 1 : 0;
+               numMismatched += simdBuffer.getDepth(x, y) != scalarBuffer.getDepth(x, y) ? 1 : 0;
+            }
+         }
+
+         CHECK(context, numCovered > 0);
+         CHECK(context, numMismatched == 0);
+      }
+   }
+
+   float nextFloat(std::minstd_rand& random, float min, float max)
+   {
+      return min + (max - min) * (static_cast<float>(random() - std::minstd_rand::min()) / static_cast<float>(std::minstd_rand::max() - std::minstd_rand::min()));
+   }
+
+   // Scattered around the camera of createCameraFrustum(), so that plenty of them straddle its planes
+   Bounds createRandomBounds(std::minstd_rand& random)
+   {
+      glm::vec3 center(nextFloat(random, -100.0f, 100.0f), nextFloat(random, -20.0f, 150.0f), nextFloat(random, -30.0f, 30.0f));
+      glm::vec3 extent(nextFloat(random, 0.1f, 8.0f), nextFloat(random, 0.1f, 8.0f), nextFloat(random, 0.1f, 8.0f));
+      return Bounds(center, extent);
+   }
+
+   Frustum createCameraFrustum()
+   {
+      return Frustum(glm::perspective(glm::radians(70.0f), 2.0f, 0.1f, 100.0f) * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+   }
+
+   // The camera frustum, plus the six faces of a point light (grouped under the light's bounding sphere)
+   FrustumBatch createFrustumBatch()
+   {
+      FrustumBatch frustumBatch;
+      frustumBatch.addFrustum(createCameraFrustum());
+
+      static const glm::vec3 kLightPosition(30.0f, 40.0f, 0.0f);
+      static const float kLightRadius = 20.0f;
+      static const std::array<glm::vec3, 6> kFaceDirections = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f) };
+
+      glm::mat4 lightProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, kLightRadius);
+      uint32_t groupIndex = frustumBatch.addGroup(kLightPosition, kLightRadius);
+      for (const glm::vec3& direction : kFaceDirections)
+      {
+         glm::vec3 up = direction.z == 0.0f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+         frustumBatch.addFrustum(Frustum(lightProjection * glm::lookAt(kLightPosition, kLightPosition + direction, up)), groupIndex);
+      }
+
+      return frustumBatch;
+   }
+
+   // The SIMD kernel is supposed to give exactly the same results as Frustum::cull(), including counts that aren't a multiple of its lane width
+   void frustumCullingMatchesFrustum(Test::Context& context)
+   {
+      std::minstd_rand random(2);
+      Frustum frustum = createCameraFrustum();
+
+      for (uint32_t numBounds : { 1000u, 37u, 1u })
+      {
+         std::vector<Bounds> bounds;
+         BoundsSoA boundsSoA;
+         for (uint32_t i = 0; i < numBounds; ++i)
+         {
+            bounds.push_back(createRandomBounds(random));
+            boundsSoA.add(bounds.back());
+         }
+
+         std::vector<uint8_t> visible(numBounds);
+         std::vector<uint8_t> scalarVisible(numBounds);
+         std::size_t numVisible = FrustumCulling::cull(frustum, boundsSoA, visible);
+         std::size_t numScalarVisible = FrustumCulling::cullScalar(frustum, boundsSoA, scalarVisible);
+
+         std::size_t numExpectedVisible = 0;
+         uint32_t numMismatched = 0;
+         for (uint32_t i = 0; i < numBounds; ++i)
+         {
+            uint8_t expected = frustum.cull(bounds[i]) ? 0 : 1;
+            numExpectedVisible += expected;
+            numMismatched += (visible[i] != expected ? 1 : 0) + (scalarVisible[i] != expected ? 1 : 0);
+         }
+
+         CHECK(context, numMismatched == 0);
+         CHECK(context, numVisible == numExpectedVisible);
+         CHECK(context, numScalarVisible == numExpectedVisible);
+      }
+   }
+
+   // Testing a block of bounds at a time has to give the same masks as testing them one at a time, for any candidates
+   void frustumBatchMasksMatchSingle(Test::Context& context)
+   {
+      std::minstd_rand random(3);
+      FrustumBatch frustumBatch = createFrustumBatch();
+
+      uint32_t numVisible = 0;
+      uint32_t numMismatched = 0;
+      for (uint32_t block = 0; block < 100; ++block)
+      {
+         std::vector<Bounds> bounds;
+         BoundsSoA boundsSoA;
+         std::vector<FrustumBatch::Mask> masks;
+         std::size_t numBounds = 1 + random() % BoundsSoA::kInlineCapacity;
+         for (std::size_t i = 0; i < numBounds; ++i)
+         {
+            bounds.push_back(createRandomBounds(random));
+            boundsSoA.add(bounds.back());
+            masks.push_back(static_cast<FrustumBatch::Mask>(random()));
+         }
+
+         std::vector<FrustumBatch::Mask> candidates = masks;
+         frustumBatch.getVisibilityMasks(boundsSoA, masks);
+
+         for (std::size_t i = 0; i < numBounds; ++i)
+         {
+            numVisible += masks[i] != 0 ? 1 : 0;
+            numMismatched += masks[i] != frustumBatch.getVisibilityMask(bounds[i], candidates[i]) ? 1 : 0;
+         }
+      }
+
+      CHECK(context, numVisible > 0);
+      CHECK(context, numMismatched == 0);
+   }
+
+   // A hierarchy along with the bounds of each of its leaves, keyed by user data, to check its queries against
+   class HierarchyChecker
+   {
+   public:
+      HierarchyChecker(std::minstd_rand& randomGenerator)
+         : random(randomGenerator)
+      {
+      }
+
+      BoundingVolumeHierarchy& getHierarchy()
+      {
+         return hierarchy;
+      }
+
+      void insertLeaves(uint32_t count)
+      {
+         for (uint32_t i = 0; i < count; ++i)
+         {
+            uint64_t userData = leafIds.size();
+            Bounds bounds = createRandomBounds(random);
+            leafIds.push_back(hierarchy.insert(bounds, userData));
+            leafBounds[userData] = bounds;
+         }
+      }
+
+      void removeLeaves(uint32_t count)
+      {
+         for (uint32_t i = 0; i < count; ++i)
+         {
+            uint64_t userData = random() % leafIds.size();
+            if (leafIds[userData] != BoundingVolumeHierarchy::kInvalidLeaf)
+            {
+               hierarchy.remove(leafIds[userData]);
+               leafIds[userData] = BoundingVolumeHierarchy::kInvalidLeaf;
+               leafBounds.erase(userData);
+            }
+         }
+      }
+
+      void moveLeaves(uint32_t count)
+      {
+         for (uint32_t i = 0; i < count; ++i)
+         {
+            uint64_t userData = random() % leafIds.size();
+            if (leafIds[userData] != BoundingVolumeHierarchy::kInvalidLeaf)
+            {
+               Bounds bounds = createRandomBounds(random);
+               hierarchy.update(leafIds[userData], bounds);
+               leafBounds[userData] = bounds;
+            }
+         }
+      }
+
+      // Queries report the same leaves and masks as testing every leaf
+      void checkQuery(Test::Context& context, const FrustumBatch& frustumBatch) const
+      {
+         std::unordered_map<uint64_t, FrustumBatch::Mask> visible;
+         uint32_t numDuplicates = 0;
+         hierarchy.query(frustumBatch, frustumBatch.getAllMask(), [&visible, &numDuplicates](uint64_t userData, FrustumBatch::Mask mask)
+         {
+            numDuplicates += visible.emplace(userData, mask).second ? 0 : 1;
+         });
+
+         uint32_t numMismatched = 0;
+         std::size_t numExpected = 0;
+         for (const auto& [userData, bounds] : leafBounds)
+         {
+            FrustumBatch::Mask expected = frustumBatch.getVisibilityMask(bounds, frustumBatch.getAllMask());
+            if (expected != 0)
+            {
+               ++numExpected;
+               auto location = visible.find(userData);
+               numMismatched += location == visible.end() || location->second != expected ? 1 : 0;
+            }
+         }
+
+         CHECK(context, numExpected > 0);
+         CHECK(context, numDuplicates == 0);
+         CHECK(context, numMismatched == 0);
+         CHECK(context, visible.size() == numExpected);
+         CHECK(context, hierarchy.getNumLeaves() == leafBounds.size());
+      }
+
+   private:
+      std::minstd_rand& random;
+      BoundingVolumeHierarchy hierarchy;
+      std::unordered_map<uint64_t, Bounds> leafBounds;
+      std::vector<BoundingVolumeHierarchy::LeafId> leafIds;
+   };
+
+   // Whether the leaves are linked into the tree or not
+   void boundingVolumeHierarchyQueryMatchesLinear(Test::Context& context)
+   {
+      std::minstd_rand random(4);
+      FrustumBatch frustumBatch = createFrustumBatch();
+      HierarchyChecker checker(random);
+
+      checker.insertLeaves(2000);
+      checker.getHierarchy().rebuild();
+      checker.checkQuery(context, frustumBatch);
+
+      checker.insertLeaves(100);
+      checker.removeLeaves(200);
+      checker.moveLeaves(200);
+      checker.checkQuery(context, frustumBatch);
+
+      checker.getHierarchy().maintain();
+      checker.checkQuery(context, frustumBatch);
+   }
+
+   // Changes made while a rebuild is in progress mustn't wait for it, and mustn't be lost when the rebuilt tree is swapped in
+   void boundingVolumeHierarchyChangesDuringRebuild(Test::Context& context)
+   {
+      std::minstd_rand random(5);
+      FrustumBatch frustumBatch = createFrustumBatch();
+      HierarchyChecker checker(random);
+      BoundingVolumeHierarchy& hierarchy = checker.getHierarchy();
+
+      for (uint32_t round = 0; round < 5; ++round)
+      {
+         // Enough new leaves to start a rebuild in the background
+         checker.insertLeaves(std::max(hierarchy.getNumLeaves(), 1000u));
+         hierarchy.maintain();
+         CHECK(context, hierarchy.isRebuilding());
+
+         // Removing leaves frees up leaf IDs that the inserts reuse, so the same leaf can be removed and inserted again before the rebuild is swapped in
+         checker.moveLeaves(300);
+         checker.removeLeaves(300);
+         checker.insertLeaves(300);
+         checker.moveLeaves(300);
+         CHECK(context, hierarchy.isRebuilding());
+         checker.checkQuery(context, frustumBatch);
+
+         while (hierarchy.isRebuilding())
+         {
+            hierarchy.maintain();
+         }
+         checker.checkQuery(context, frustumBatch);
+
+         // The tree that was swapped in has to be just as usable as one that was built from scratch
+         checker.moveLeaves(100);
+         checker.removeLeaves(100);
+         hierarchy.maintain();
+         checker.checkQuery(context, frustumBatch);
+
+         // Maintaining the tree may have started another rebuild
+         while (hierarchy.isRebuilding())
+         {
+            hierarchy.maintain();
+         }
+      }
+   }
+
+   // A tree without any leaves (e.g. a scene without meshes) has nothing to rebuild, no matter how often it is maintained
+   void boundingVolumeHierarchyEmpty(Test::Context& context)
+   {
+      std::minstd_rand random(6);
+      BoundingVolumeHierarchy hierarchy;
+
+      hierarchy.maintain();
+      CHECK(context, !hierarchy.isRebuilding());
+
+      // Empty again after having had leaves
+      std::vector<BoundingVolumeHierarchy::LeafId> leafIds;
+      for (uint64_t userData = 0; userData < 100; ++userData)
+      {
+         leafIds.push_back(hierarchy.insert(createRandomBounds(random), userData));
+      }
+      do
+      {
+         hierarchy.maintain();
+      } while (hierarchy.isRebuilding());
+
+      for (BoundingVolumeHierarchy::LeafId leafId : leafIds)
+      {
+         hierarchy.remove(leafId);
+      }
+      CHECK(context, hierarchy.getNumLeaves() == 0);
+
+      for (uint32_t frame = 0; frame < 4; ++frame)
+      {
+         hierarchy.maintain();
+         CHECK(context, !hierarchy.isRebuilding());
+      }
+   }
+
+   bool isInside(const Frustum& frustum, const glm::vec3& point)
+   {
+      for (const glm::vec4& plane : frustum.getPlanes())
+      {
+         if (glm::dot(glm::vec3(plane), point) + plane.w < 0.0f)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   std::array<glm::vec3, 8> transformCorners(const Bounds& bounds, const Transform& transform)
+   {
+      std::array<glm::vec3, 8> corners;
+      for (uint32_t i = 0; i < corners.size(); ++i)
+      {
+         glm::vec3 sign((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+         corners[i] = transform.transformPosition(bounds.getCenter() + sign * bounds.getExtent());
+      }
+
+      return corners;
+   }
+
+   // World bounds of rotated and mirrored sections have to contain every corner of the transformed box, or the hierarchy skips sections that are partly in view
+   void boundingVolumeHierarchyRotatedAndMirroredLeaves(Test::Context& context)
+   {
+      std::minstd_rand random(6);
+      Frustum frustum = createCameraFrustum();
+      FrustumBatch frustumBatch;
+      frustumBatch.addFrustum(frustum);
+
+      Bounds localBounds(glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f));
+
+      // Rotating the extent itself by 45 degrees around Z gives no width along X at all, and the right plane of the camera is at x = 70 at this distance, so only the
+      // rotated box's corner is in view. Mirroring flips the sign of the extent.
+      std::vector<Transform> transforms;
+      transforms.emplace_back(glm::angleAxis(glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f)), glm::vec3(70.8f, 50.0f, 0.0f), glm::vec3(1.0f));
+      transforms.emplace_back(glm::identity<glm::quat>(), glm::vec3(0.0f, 50.0f, 0.0f), glm::vec3(-1.0f, 2.0f, -0.5f));
+      transforms.emplace_back(glm::angleAxis(glm::radians(-30.0f), glm::vec3(1.0f, 0.0f, 0.0f)), glm::vec3(-10.0f, 30.0f, 5.0f), glm::vec3(3.0f, -1.0f, 1.0f));
+      for (uint32_t i = 0; i < 2000; ++i)
+      {
+         glm::vec3 axis(nextFloat(random, -1.0f, 1.0f), nextFloat(random, -1.0f, 1.0f), nextFloat(random, -1.0f, 1.0f));
+         glm::quat orientation = glm::angleAxis(nextFloat(random, -glm::pi<float>(), glm::pi<float>()), glm::normalize(axis + glm::vec3(0.0f, 0.0f, 0.01f)));
+         glm::vec3 position(nextFloat(random, -100.0f, 100.0f), nextFloat(random, -20.0f, 150.0f), nextFloat(random, -30.0f, 30.0f));
+         glm::vec3 scale(nextFloat(random, 0.2f, 4.0f), nextFloat(random, 0.2f, 4.0f), nextFloat(random, 0.2f, 4.0f));
+         scale *= glm::vec3((random() & 1) ? 1.0f : -1.0f, (random() & 1) ? 1.0f : -1.0f, (random() & 1) ? 1.0f : -1.0f);
+         transforms.emplace_back(orientation, position, scale);
+      }
+
+      BoundingVolumeHierarchy hierarchy;
+      uint32_t numUncontained = 0;
+      std::vector<bool> cornerInView(transforms.size());
+      for (uint32_t i = 0; i < transforms.size(); ++i)
+      {
+         Bounds worldBounds = transforms[i].transformBounds(localBounds);
+         glm::vec3 min = worldBounds.getMin() - glm::vec3(0.001f);
+         glm::vec3 max = worldBounds.getMax() + glm::vec3(0.001f);
+
+         for (const glm::vec3& corner : transformCorners(localBounds, transforms[i]))
+         {
+            numUncontained += glm::all(glm::greaterThanEqual(corner, min)) && glm::all(glm::lessThanEqual(corner, max)) ? 0 : 1;
+            cornerInView[i] = cornerInView[i] || isInside(frustum, corner);
+         }
+
+         hierarchy.insert(worldBounds, i);
+      }
+      CHECK(context, cornerInView[0]);
+      CHECK(context, numUncontained == 0);
+
+      // Both while the leaves are unlinked and once they have been built into a tree
+      for (bool built : { false, true })
+      {
+         if (built)
+         {
+            hierarchy.rebuild();
+         }
+
+         std::vector<bool> visible(transforms.size());
+         hierarchy.query(frustumBatch, frustumBatch.getAllMask(), [&visible](uint64_t userData, FrustumBatch::Mask views)
+         {
+            visible[userData] = true;
+         });
+
+         uint32_t numMissed = 0;
+         for (uint32_t i = 0; i < transforms.size(); ++i)
+         {
+            numMissed += cornerInView[i] && !visible[i] ? 1 : 0;
+         }
+         CHECK(context, visible[0]);
+         CHECK(context, numMissed == 0);
+      }
+   }
+
+}
+
+void registerMathTests(Test::Registry& registry)
+{
+   registry.add("Math/Occlusion/Occluded", occlusionOccluded);
+   registry.add("Math/Occlusion/PartlyVisible", occlusionPartlyVisible);
+   registry.add("Math/Occlusion/NearPlane", occlusionNearPlane);
+   registry.add("Math/Occlusion/RotatedOccludee", occlusionRotatedOccludee);
+   registry.add("Math/Occlusion/SimdMatchesScalar", occlusionSimdMatchesScalar);
+   registry.add("Math/FrustumCulling/MatchesFrustum", frustumCullingMatchesFrustum);
+   registry.add("Math/FrustumBatch/MasksMatchSingle", frustumBatchMasksMatchSingle);
+   registry.add("Math/BVH/QueryMatchesLinear", boundingVolumeHierarchyQueryMatchesLinear);
+   registry.add("Math/BVH/ChangesDuringRebuild", boundingVolumeHierarchyChangesDuringRebuild);
+   registry.add("Math/BVH/Empty", boundingVolumeHierarchyEmpty);
+   registry.add("Math/BVH/RotatedAndMirroredLeaves", boundingVolumeHierarchyRotatedAndMirroredLeaves);
+}
@@ -0,0 +1,75 @@
+#include "Test.h"
+
+#include "Core/Memory/AllocationCounter.h"
+
+#include <exception>
+
+namespace Test
+{
+   uint64_t getAllocationCount()
+   {
+      return AllocationCounter::getCount();
+   }
+
+   void Context::check(bool condition, const char* expression, const char* file, int line)
+   {
+      if (!condition)
+      {
+         stream << "\n   " << file << "(" << line << "): CHECK(" << expression << ") failed";
+         ++numFailures;
+      }
+   }
+
+   void Registry::add(std::string name, Function function)
+   {
+      tests.emplace_back(std::move(name), std::move(function));
+   }
+
+   void Registry::list(std::ostream& stream) const
+   {
+      for (const std::pair<std::string, Function>& test : tests)
+      {
+         stream << test.first << "\n";
+      }
+   }
+
+   uint32_t Registry::run(std::string_view filter, std::ostream& stream) const
+   {
+      uint32_t numRun = 0;
+      uint32_t numFailed = 0;
+
+      for (const std::pair<std::string, Function>& test : tests)
+      {
+         if (!filter.empty() && test.first.find(filter) == std::string::npos)
+         {
+            continue;
+         }
+
+         stream << test.first << "... " << std::flush;
+
+         Context context(stream);
+         try
+         {
+            test.second(context);
+         }
+         catch (const std::exception& exception)
+         {
+            context.check(false, exception.what(), __FILE__, __LINE__);
+         }
+
+         ++numRun;
+         if (context.getNumFailures() > 0)
+         {
+            ++numFailed;
+            stream << "\nFAILED\n";
+         }
+         else
+         {
+            stream << "passed\n";
+         }
+      }
+
+      stream << numRun - numFailed << " of " << numRun << " tests passed\n";
+      return numFailed;
+   }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Test
+{
+   // Number of global operator new calls made so far (by any thread)
+   uint64_t getAllocationCount();
+
+   class Context
+   {
+   public:
+      Context(std::ostream& failureStream)
+         : stream(failureStream)
+      {
+      }
+
+      // Reports a failure (and keeps going) if the condition is false
+      void check(bool condition, const char* expression, const char* file, int line);
+
+      uint32_t getNumFailures() const
+      {
+         return numFailures;
+      }
+
+   private:
+      std::ostream& stream;
+      uint32_t numFailures = 0;
+   };
+
+   using Function = std::function<void(Context& context)>;
+
+   class Registry
+   {
+   public:
+      // Names are hierarchical ("Group/Test"), which is what filters match against
+      void add(std::string name, Function function);
+
+      void list(std::ostream& stream) const;
+
+      // Returns the number of tests that failed
+      uint32_t run(std::string_view filter, std::ostream& stream) const;
+
+   private:
+      std::vector<std::pair<std::string, Function>> tests;
+   };
+}
+
+#define CHECK(context, condition) (context).check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+void registerCoreTests(Test::Registry& registry);
+void registerGraphicsTests(Test::Registry& registry);
+void registerMathTests(Test::Registry& registry);
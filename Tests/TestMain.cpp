@@ -0,0 +1,56 @@
+#include "Test.h"
+
+#include "Core/Jobs/JobSystem.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace
+{
+   void printUsage(const char* executableName)
+   {
+      std::cerr << "Usage: " << executableName << " [--filter <substring>] [--list]\n";
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   std::string filter;
+   bool listOnly = false;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string_view argument = argv[i];
+      if (argument == "--list")
+      {
+         listOnly = true;
+      }
+      else if (argument == "--filter" && i + 1 < argc)
+      {
+         filter = argv[++i];
+      }
+      else
+      {
+         printUsage(argv[0]);
+         return 1;
+      }
+   }
+
+   Test::Registry registry;
+   registerCoreTests(registry);
+   registerGraphicsTests(registry);
+   registerMathTests(registry);
+
+   if (listOnly)
+   {
+      registry.list(std::cout);
+      return 0;
+   }
+
+   JobSystem::initialize(0);
+   uint32_t numFailed = registry.run(filter, std::cout);
+   JobSystem::terminate();
+
+   return numFailed == 0 ? 0 : 1;
+}